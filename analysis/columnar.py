@@ -0,0 +1,109 @@
+#!/usr/bin/python3
+"""
+Reader of the monitoring outputs (VOQ, uplink, conn) for the analysis scripts.
+
+The simulator writes them either as CSV text (default) or, with
+`MONITOR_FORMAT columnar`, as `<name>.col` columnar files: a header with the
+column names, then blocks of rows where each column is zigzag-varint deltas,
+zlib-compressed (see src/point-to-point/model/columnar-output.h). The blocks are
+decoded with numpy, so loading is much faster than parsing the text.
+
+    from columnar import load_monitor
+    cols = load_monitor("mix/output/1/1_out_uplink.txt")  # or its .col, whichever exists
+    ts, tor, port, txbytes = cols
+"""
+
+import os
+import struct
+import zlib
+
+import numpy as np
+
+MAGIC = b"MONCOL\0\0"
+VERSION = 1
+HEADER = struct.Struct("<8sIIII")  # magic, version, nColumn, blockRows, namesSize
+BLOCK = struct.Struct("<IIII")  # nRow, codec, rawSize, storedSize
+CODEC_RAW = 0
+CODEC_ZLIB = 1
+
+
+def columnar_path(text_path):
+    """ "x_out_uplink.txt" -> "x_out_uplink.col" (GetColumnarPath in columnar-output.cc) """
+    if text_path.endswith(".txt"):
+        return text_path[:-4] + ".col"
+    return text_path + ".col"
+
+
+def _decode_varints(buf):
+    # all varints of a block at once: a byte < 0x80 ends a value
+    b = np.frombuffer(buf, dtype=np.uint8)
+    ends = np.flatnonzero(b < 0x80)
+    starts = np.empty_like(ends)
+    starts[0] = 0
+    starts[1:] = ends[:-1] + 1
+    lengths = ends - starts + 1
+    shift = (np.arange(len(b)) - np.repeat(starts, lengths)) * 7
+    parts = (b & 0x7F).astype(np.uint64) << shift.astype(np.uint64)
+    z = np.add.reduceat(parts, starts)
+    # zigzag -> signed delta
+    return (z >> np.uint64(1)).astype(np.int64) ^ -(z & np.uint64(1)).astype(np.int64)
+
+
+def read_columnar(filename):
+    """ Returns (column names, list of int64 numpy arrays, one per column) """
+    with open(filename, "rb") as f:
+        data = f.read()
+    magic, version, n_col, _, names_size = HEADER.unpack_from(data, 0)
+    if magic != MAGIC or version != VERSION:
+        raise ValueError("{} is not a (version {}) columnar file".format(filename, VERSION))
+    pos = HEADER.size
+    names = data[pos:pos + names_size].split(b"\0")[:n_col]
+    names = [x.decode() for x in names]
+    pos += names_size
+
+    blocks = [[] for _ in range(n_col)]
+    while pos + BLOCK.size <= len(data):
+        n_row, codec, raw_size, stored_size = BLOCK.unpack_from(data, pos)
+        pos += BLOCK.size
+        raw = data[pos:pos + stored_size]
+        pos += stored_size
+        if codec == CODEC_ZLIB:
+            raw = zlib.decompress(raw)
+        elif codec != CODEC_RAW:
+            raise ValueError("{}: unknown codec {}".format(filename, codec))
+        deltas = _decode_varints(raw).reshape(n_col, n_row)
+        for c in range(n_col):
+            blocks[c].append(np.cumsum(deltas[c]))
+
+    columns = [np.concatenate(x) if x else np.zeros(0, dtype=np.int64) for x in blocks]
+    return names, columns
+
+
+def read_text(filename, n_col=4):
+    """ Same as read_columnar, for a CSV monitoring file of n_col columns (unnamed) """
+    if os.path.getsize(filename) == 0:
+        return [], [np.zeros(0, dtype=np.int64) for _ in range(n_col)]
+    arr = np.loadtxt(filename, delimiter=",", dtype=np.int64, ndmin=2, usecols=range(n_col))
+    return [], [arr[:, c] for c in range(n_col)]
+
+
+def load_monitor(text_path, n_col=4):
+    """ Columns of a monitoring output, from its columnar file if there is one, or the text """
+    col_path = columnar_path(text_path)
+    if os.path.exists(col_path):
+        return read_columnar(col_path)[1]
+    return read_text(text_path, n_col)[1]
+
+
+def iter_monitor(text_path, n_col=4):
+    """ Rows (tuples of ints) of a monitoring output, see load_monitor """
+    columns = load_monitor(text_path, n_col)
+    return zip(*[c.tolist() for c in columns])
+
+
+if __name__ == "__main__":
+    # python3 columnar.py <file.col>: print it as the CSV text
+    import sys
+    _, cols = read_columnar(sys.argv[1])
+    for row in zip(*[c.tolist() for c in cols]):
+        print(",".join(str(x) for x in row))
@@ -10,6 +10,7 @@ import matplotlib.ticker as tick
 import math
 from cycler import cycler
 import numpy as np
+from columnar import iter_monitor
 
 
 
@@ -214,69 +215,63 @@ def main():
                     filename_uplink = output_dir + "/{id}/{id}_out_uplink.txt".format(id=config_id)
                     port_list = set()
 
-                    with open(filename_uplink, "r") as f:
-                        # parsing the results: (switch) -> timestamp
+                    # parsing the results: (switch) -> timestamp (text or columnar output)
+                    
+                    history_data = {}
+                    diff_data = {}
+                    last_ts = 0
+                    for now_ts, now_swid, now_portid, now_val in iter_monitor(filename_uplink):
                         
-                        history_data = {}
-                        diff_data = {}
-                        last_ts = 0
-                        for line in f.readlines():
-                            parsed_line = line.replace("\n", "").split(",")
-                            now_ts = int(parsed_line[0])
-                            now_swid = int(parsed_line[1])
-                            now_portid = int(parsed_line[2])
-                            now_val = int(parsed_line[3])
-                            
-                            if now_ts < time_start or now_ts > time_end:
-                                continue
-
-                            if last_ts == 0:
-                                last_ts = now_ts
-                            elif last_ts + time_interval <= now_ts:
-                                last_ts = now_ts
-                            elif last_ts == now_ts:
-                                pass
+                        if now_ts < time_start or now_ts > time_end:
+                            continue
+
+                        if last_ts == 0:
+                            last_ts = now_ts
+                        elif last_ts + time_interval <= now_ts:
+                            last_ts = now_ts
+                        elif last_ts == now_ts:
+                            pass
+                        else:
+                            continue
+
+
+                        key = (now_swid, now_portid)
+                        port_list.add(now_portid)
+
+                        if key not in history_data:
+                            history_data[key] = now_val
+                        else:
+                            if key not in diff_data:
+                                diff_data[key] = [now_val - history_data[key]]
                             else:
+                                diff_data[key].append(now_val - history_data[key])
+                            history_data[key] = now_val
+                    
+                    # clustering with switch_id
+                    switch_diff_data = {}
+                    for kkk, vvv in diff_data.items():
+                        switch_id, port_id = kkk
+                        if switch_id not in switch_diff_data:
+                            switch_diff_data[switch_id] = [vvv]
+                        else:
+                            switch_diff_data[switch_id].append(vvv)
+                        
+                    ts_data_arr = []
+                    for switch_id, vvvv in switch_diff_data.items():
+                        v_t = np.array(vvvv).T.tolist()
+                        for vec in v_t:
+                            if np.average(vec) == 0:
                                 continue
+                            val = (np.max(vec) - np.min(vec)) / np.average(vec) * 100
+                            ts_data_arr.append(val)
 
-
-                            key = (now_swid, now_portid)
-                            port_list.add(now_portid)
-
-                            if key not in history_data:
-                                history_data[key] = now_val
-                            else:
-                                if key not in diff_data:
-                                    diff_data[key] = [now_val - history_data[key]]
-                                else:
-                                    diff_data[key].append(now_val - history_data[key])
-                                history_data[key] = now_val
-                        
-                        # clustering with switch_id
-                        switch_diff_data = {}
-                        for kkk, vvv in diff_data.items():
-                            switch_id, port_id = kkk
-                            if switch_id not in switch_diff_data:
-                                switch_diff_data[switch_id] = [vvv]
-                            else:
-                                switch_diff_data[switch_id].append(vvv)
-                            
-                        ts_data_arr = []
-                        for switch_id, vvvv in switch_diff_data.items():
-                            v_t = np.array(vvvv).T.tolist()
-                            for vec in v_t:
-                                if np.average(vec) == 0:
-                                    continue
-                                val = (np.max(vec) - np.min(vec)) / np.average(vec) * 100
-                                ts_data_arr.append(val)
-
-                        cdf_ts_data_arr = getCdfFromArray(ts_data_arr)
-                        
-                        ax.plot([x[0] for x in cdf_ts_data_arr],
-                                [x[3] for x in cdf_ts_data_arr],
-                                markersize=0,
-                                linewidth=3.0,
-                                label="{}".format(lb_mode))
+                    cdf_ts_data_arr = getCdfFromArray(ts_data_arr)
+                    
+                    ax.plot([x[0] for x in cdf_ts_data_arr],
+                            [x[3] for x in cdf_ts_data_arr],
+                            markersize=0,
+                            linewidth=3.0,
+                            label="{}".format(lb_mode))
         
         ax.legend(frameon=False, fontsize=12, facecolor='white')
         
@@ -0,0 +1,283 @@
+#!/usr/bin/python3
+"""
+End-to-end throughput benchmark of the simulator.
+
+Runs fixed short scenarios (leaf-spine and fat-tree, each LB/CC pair, lossless and IRN)
+with in-simulator flow generation, and collects the performance report of each run
+(PERF_OUTPUT_FILE: wall time, simulated ns per wall second, events/s, forwarded
+packets/s, peak RSS, heap allocations by subsystem with --enable-alloc-stats) into one JSON file.
+
+    python3 bench.py -o base.json                       # all scenarios, ./build
+    python3 bench.py -o new.json --build ../other/build --filter leaf_spine
+    python3 bench.py --compare base.json new.json       # ratios new / base
+
+The scenarios are deterministic (same seed and flows), so two builds of the same model
+execute the same events; compare flags the scenarios where they do not.
+"""
+import argparse
+import json
+import os
+import subprocess
+import sys
+import time
+
+# same topologies as config/leaf_spine_128_100G_OS2.txt and config/fat_k8_100G_OS2.txt
+topologies = {
+    "leaf_spine": "leaf_spine:leaves=8,spines=8,hosts=16",
+    "fat_tree": "fat_tree:k=8,os=2",
+}
+
+lb_modes = {
+    "fecmp": 0,
+    "drill": 2,
+    "conga": 3,
+    "letflow": 6,
+    "conweave": 9,
+}
+
+# CC_MODE and the parameters that differ from DCQCN's (see run.py)
+cc_modes = {
+    "dcqcn": (1, {}),
+    "hpcc": (3, {"HAS_WIN": 1, "VAR_WIN": 1, "FAST_REACT": 1, "INT_MULTI": 4}),
+    "timely": (7, {}),
+    "dctcp": (8, {"HAS_WIN": 1, "VAR_WIN": 1, "EWMA_GAIN": 0.0625}),
+}
+
+FLOWGEN_START_TIME = 2.0
+
+config_template = """TOPOLOGY_GEN {topo}
+FLOWGEN_CDF_FILE traffic_gen/AliStorage2019.txt
+FLOWGEN_PATTERN poisson
+FLOWGEN_LOAD {hostload}
+FLOWGEN_START_TIME {start}
+FLOWGEN_STOP_TIME {stop}
+STOP_TIME {deadline}
+PERF_OUTPUT_FILE {dir}/perf.json
+
+FLOW_INPUT_FILE {dir}/in.txt
+CNP_OUTPUT_FILE {dir}/out_cnp.txt
+FCT_OUTPUT_FILE {dir}/out_fct.txt
+PFC_OUTPUT_FILE {dir}/out_pfc.txt
+QLEN_MON_FILE {dir}/out_qlen.txt
+VOQ_MON_FILE {dir}/out_voq.txt
+VOQ_MON_DETAIL_FILE {dir}/out_voq_per_dst.txt
+UPLINK_MON_FILE {dir}/out_uplink.txt
+CONN_MON_FILE {dir}/out_conn.txt
+EST_ERROR_MON_FILE {dir}/out_est_error.txt
+QLEN_MON_START {start}
+QLEN_MON_END {stop}
+SW_MONITORING_INTERVAL 10000
+
+BUFFER_SIZE 9
+CC_MODE {cc_mode}
+LB_MODE {lb_mode}
+ENABLE_PFC {pfc}
+ENABLE_IRN {irn}
+
+CONWEAVE_TX_EXPIRY_TIME {cwh_tx_expiry_time}
+CONWEAVE_REPLY_TIMEOUT_EXTRA 4
+CONWEAVE_PATH_PAUSE_TIME 16
+CONWEAVE_EXTRA_VOQ_FLUSH_TIME {cwh_extra_voq_flush_time}
+CONWEAVE_DEFAULT_VOQ_WAITING_TIME {cwh_default_voq_waiting_time}
+
+ALPHA_RESUME_INTERVAL 1
+RATE_DECREASE_INTERVAL 4
+CLAMP_TARGET_RATE 0
+RP_TIMER 300
+FAST_RECOVERY_TIMES 1
+EWMA_GAIN {EWMA_GAIN}
+RATE_AI 40Mb/s
+RATE_HAI 100Mb/s
+MIN_RATE 100Mb/s
+DCTCP_RATE_AI 1000Mb/s
+
+ERROR_RATE_PER_LINK 0.0000
+L2_CHUNK_SIZE 4000
+L2_ACK_INTERVAL 1
+L2_BACK_TO_ZERO 0
+
+RATE_BOUND 1
+HAS_WIN {HAS_WIN}
+VAR_WIN {VAR_WIN}
+FAST_REACT {FAST_REACT}
+MI_THRESH 0
+INT_MULTI {INT_MULTI}
+GLOBAL_T 1
+U_TARGET 0.95
+MULTI_RATE 0
+SAMPLE_FEEDBACK 0
+
+ENABLE_QCN 1
+USE_DYNAMIC_PFC_THRESHOLD 1
+PACKET_PAYLOAD_SIZE 1000
+
+LINK_DOWN 0 0 0
+KMAX_MAP 6 20000000000 400 50000000000 400 100000000000 400 200000000000 400 250000000000 400 400000000000 400
+KMIN_MAP 6 20000000000 100 50000000000 100 100000000000 100 200000000000 100 250000000000 100 400000000000 100
+PMAX_MAP 6 20000000000 0.2 50000000000 0.2 100000000000 0.2 200000000000 0.2 250000000000 0.2 400000000000 0.2
+LOAD {netload}
+RANDOM_SEED 1
+"""
+
+# reported per scenario by --compare: (key, higher is better)
+compare_metrics = [
+    ("wall_run_s", False),
+    ("sim_ns_per_wall_s", True),
+    ("events_per_s", True),
+    ("fwd_pkts_per_s", True),
+    ("peak_rss_kb", False),
+    ("allocs_run", False),
+]
+
+
+def scenarios(args):
+    for topo in args.topo.split(","):
+        for lb in args.lb.split(","):
+            for cc in args.cc.split(","):
+                if lb == "conweave" and cc != "dcqcn":
+                    continue  # ConWeave supports only DCQCN
+                for irn in [int(x) for x in args.irn.split(",")]:
+                    name = "{}-{}-{}-{}".format(topo, lb, cc, "irn" if irn else "pfc")
+                    if args.filter and args.filter not in name:
+                        continue
+                    yield name, topo, lb, cc, irn
+
+
+def make_config(dir, topo, lb, cc, irn, args):
+    # ConWeave parameters as in run.py
+    if "leaf_spine" in topo:
+        cwh = (300, 16, 200)
+    elif irn:
+        cwh = (1000, 16, 300)
+    else:
+        cwh = (1000, 64, 600)
+    cc_mode, cc_params = cc_modes[cc]
+    params = {"HAS_WIN": 0, "VAR_WIN": 0, "FAST_REACT": 0, "INT_MULTI": 1, "EWMA_GAIN": 0.00390625}
+    params.update(cc_params)
+    stop = FLOWGEN_START_TIME + args.time
+    return config_template.format(
+        topo=topologies[topo], dir=dir, start=FLOWGEN_START_TIME, stop=stop,
+        deadline=stop + 0.05, hostload=args.netload / 2 / 100.0, netload=args.netload,
+        cc_mode=cc_mode, lb_mode=lb_modes[lb], pfc=0 if irn else 1, irn=irn,
+        cwh_tx_expiry_time=cwh[0], cwh_extra_voq_flush_time=cwh[1],
+        cwh_default_voq_waiting_time=cwh[2], **params)
+
+
+def run_scenario(name, topo, lb, cc, irn, args):
+    dir = os.path.abspath(os.path.join(args.workdir, name))
+    os.makedirs(dir, exist_ok=True)
+    config_name = os.path.join(dir, "config.txt")
+    with open(config_name, "w") as f:
+        f.write(make_config(dir, topo, lb, cc, irn, args))
+
+    build = os.path.abspath(args.build)
+    env = dict(os.environ, LD_LIBRARY_PATH=build)
+    runs = []
+    for _ in range(args.repeat):
+        with open(os.path.join(dir, "log.txt"), "w") as log:
+            ret = subprocess.call([os.path.join(build, "scratch", "network-load-balance"),
+                                   config_name], stdout=log, stderr=subprocess.STDOUT, env=env)
+        if ret != 0:
+            print("{}: exit code {}, see {}/log.txt".format(name, ret, dir), flush=True)
+            return None
+        with open(os.path.join(dir, "perf.json")) as f:
+            runs.append(json.load(f))
+    runs.sort(key=lambda r: r["wall_run_s"])
+    return runs[len(runs) // 2]  # median wall time
+
+
+def bench(args):
+    results = {}
+    for name, topo, lb, cc, irn in scenarios(args):
+        perf = run_scenario(name, topo, lb, cc, irn, args)
+        if perf is None:
+            continue
+        results[name] = perf
+        allocs = metric(perf, "allocs_run")
+        print("{:36s} wall {:8.2f}s  {:12.0f} events/s  {:11.0f} pkts/s  {:8d} KB  {:>10} allocs".format(
+            name, perf["wall_run_s"], perf["events_per_s"], perf["fwd_pkts_per_s"],
+            perf["peak_rss_kb"], "-" if allocs is None else allocs), flush=True)
+    try:
+        rev = subprocess.check_output(["git", "rev-parse", "--short", "HEAD"],
+                                      stderr=subprocess.DEVNULL).decode().strip()
+    except (OSError, subprocess.CalledProcessError):
+        rev = ""
+    out = {"build": os.path.abspath(args.build), "git": rev, "date": time.strftime("%Y-%m-%d %H:%M:%S"),
+           "time": args.time, "netload": args.netload, "repeat": args.repeat, "scenarios": results}
+    with open(args.output, "w") as f:
+        json.dump(out, f, indent=2)
+    print("Results: {}".format(args.output))
+
+
+def metric(perf, key):
+    if key not in perf:
+        return None  # allocs_run: only with ./waf configure --enable-alloc-stats
+    if key == "allocs_run":
+        return sum(perf[key].values())
+    return perf[key]
+
+
+def compare(base_file, new_file):
+    with open(base_file) as f:
+        base = json.load(f)
+    with open(new_file) as f:
+        new = json.load(f)
+    print("base: {} ({})\nnew:  {} ({})".format(base["build"], base["git"], new["build"], new["git"]))
+    print("ratio new / base, + if better")
+    print("{:36s}".format("scenario") + "".join("{:>20s}".format(k) for k, _ in compare_metrics))
+    for name in sorted(set(base["scenarios"]) & set(new["scenarios"])):
+        b, n = base["scenarios"][name], new["scenarios"][name]
+        line = "{:36s}".format(name)
+        for key, higher_better in compare_metrics:
+            vb, vn = metric(b, key), metric(n, key)
+            if vb is None or vn is None or vb == 0:
+                line += "{:>20s}".format("-")
+                continue
+            better = (vn > vb) == higher_better and vn != vb
+            line += "{:>20s}".format("{:.3f}{}".format(vn / vb, "+" if better else " "))
+        if b["events"] != n["events"] or b["fwd_pkts"] != n["fwd_pkts"]:
+            line += "  (simulation differs: {} vs {} events)".format(b["events"], n["events"])
+        print(line)
+    for name in sorted(set(base["scenarios"]) ^ set(new["scenarios"])):
+        print("{:36s} only in {}".format(name, base_file if name in base["scenarios"] else new_file))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='simulator throughput benchmark')
+    parser.add_argument('-o', '--output', dest='output', action='store',
+                        default='bench.json', help="results file (default: bench.json)")
+    parser.add_argument('--build', dest='build', action='store',
+                        default='build', help="ns-3 build directory to benchmark (default: build)")
+    parser.add_argument('--topo', dest='topo', action='store',
+                        default=','.join(topologies), help="topologies (default: leaf_spine,fat_tree)")
+    parser.add_argument('--lb', dest='lb', action='store',
+                        default=','.join(lb_modes), help="LBs (default: all)")
+    parser.add_argument('--cc', dest='cc', action='store',
+                        default=','.join(cc_modes), help="CCs (default: all)")
+    parser.add_argument('--irn', dest='irn', action='store',
+                        default='0,1', help="0: lossless (PFC), 1: IRN (default: 0,1)")
+    parser.add_argument('--filter', dest='filter', action='store',
+                        default='', help="run only the scenarios whose name contains this")
+    parser.add_argument('--time', dest='time', action='store', type=float,
+                        default=0.0003, help="traffic time to simulate (s) (default: 0.0003)")
+    parser.add_argument('--netload', dest='netload', action='store', type=int,
+                        default=50, help="network load (%%) (default: 50)")
+    parser.add_argument('--repeat', dest='repeat', action='store', type=int,
+                        default=1, help="runs per scenario, the median wall time is kept (default: 1)")
+    parser.add_argument('--workdir', dest='workdir', action='store',
+                        default='mix/output/bench', help="outputs of the runs (default: mix/output/bench)")
+    parser.add_argument('--compare', dest='compare', nargs=2, metavar=('BASE', 'NEW'),
+                        help="compare two results files instead of running")
+    args = parser.parse_args()
+
+    if args.compare:
+        compare(*args.compare)
+        return
+    if not os.path.exists(os.path.join(args.build, "scratch", "network-load-balance")):
+        print("{}/scratch/network-load-balance not found (./waf build)".format(args.build))
+        sys.exit(1)
+    bench(args)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,116 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2023 NUS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Chahwan Song <songch@comp.nus.edu.sg>
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <atomic>
+#include <initializer_list>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "ns3/columnar-output.h"
+
+namespace ns3 {
+
+/**
+ * @brief Output sink for the monitoring files (FCT, PFC, CNP, VOQ, uplink, ...).
+ *
+ * Every output line is a record of up to MAX_FIELDS unsigned integers, written
+ * as "v0<sep>v1<sep>...\n" (the same text as fprintf with %u/%lu). The simulation
+ * thread only copies the record into the channel's lock-free single-producer /
+ * single-consumer ring; a background thread formats the records and writes the
+ * files in large blocks, flushing them whenever it runs out of records. A full
+ * ring blocks the simulation thread until the writer catches up, and such stalls
+ * are counted (backpressure statistics).
+ *
+ * A channel can also be columnar (see columnar-output.h): its records are then
+ * encoded into column blocks instead of text lines, by the same thread.
+ *
+ * With async disabled, records are formatted in the simulation thread into the
+ * same buffers (no thread). Either way, Close() writes everything out in order
+ * and flushes the files; it is scheduled for Simulator::Destroy by Start().
+ * The FILEs stay owned by the caller.
+ */
+class AsyncOutput {
+   public:
+    static const uint32_t MAX_FIELDS = 8;
+
+    AsyncOutput();
+    ~AsyncOutput();
+
+    /** @brief Add an output file (before Start), returns its channel */
+    uint32_t OpenChannel(FILE* file, char separator);
+    /** @brief Add a columnar output file (before Start), records must have columns.size() fields */
+    uint32_t OpenColumnarChannel(FILE* file, const std::vector<std::string>& columns);
+
+    /** @brief Start the writer thread (if async); ringCapacity is in records per channel */
+    void Start(bool async, uint32_t ringCapacity);
+
+    /** @brief Append one line to the channel */
+    void Write(uint32_t channel, std::initializer_list<uint64_t> fields) {
+        Write(channel, fields.begin(), fields.size());
+    }
+    void Write(uint32_t channel, const uint64_t* fields, uint32_t nField);
+
+    /** @brief Drain all channels, flush the files and stop the writer thread */
+    void Close();
+
+    uint64_t GetNRecords() const;
+    uint64_t GetNStalls() const;  // writes that found their ring full
+
+   private:
+    struct Record {
+        uint32_t nField;
+        uint64_t field[MAX_FIELDS];
+    };
+
+    struct Channel {
+        FILE* file;
+        char separator;
+        std::vector<char> buf;  // formatted, not yet written (writer side)
+        std::unique_ptr<ColumnarWriter> columnar;  // instead of text, if set
+
+        std::vector<Record> ring;
+        uint64_t mask;
+        alignas(64) std::atomic<uint64_t> head;  // next slot to fill (producer)
+        uint64_t cachedTail;                    // producer's last view of tail
+        uint64_t nRecords;
+        uint64_t nStalls;
+        uint64_t maxOccupancy;
+        alignas(64) std::atomic<uint64_t> tail;  // next slot to format (consumer)
+    };
+
+    void Format(Channel& ch, const Record& r);
+    void WriteOut(Channel& ch, bool flush);  // writer side: write the buffer to the file
+    uint64_t Drain(Channel& ch);             // writer side: format the ring's records
+    void Run();                              // writer thread
+
+    std::vector<std::unique_ptr<Channel> > m_channels;
+    bool m_async;
+    bool m_started;
+    std::atomic<bool> m_stop;
+    std::thread m_thread;
+};
+
+}  // namespace ns3
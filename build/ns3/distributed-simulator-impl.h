@@ -0,0 +1,179 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: George Riley <riley@ece.gatech.edu>
+ */
+
+#ifndef DISTRIBUTED_SIMULATOR_IMPL_H
+#define DISTRIBUTED_SIMULATOR_IMPL_H
+
+#include "ns3/simulator-impl.h"
+#include "ns3/scheduler.h"
+#include "ns3/event-impl.h"
+#include "ns3/ptr.h"
+
+#include <list>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup mpi
+ *
+ * \brief Structure used for all-reduce LBTS computation
+ */
+class LbtsMessage
+{
+public:
+  LbtsMessage ()
+    : m_txCount (0),
+      m_rxCount (0),
+      m_myId (0),
+      m_isFinished (false)
+  {
+  }
+
+  /**
+   * \param rxc received count
+   * \param txc transmitted count
+   * \param id mpi rank
+   * \param isFinished whether the rank has stopped (or run out of events)
+   * \param t smallest time
+   */
+  LbtsMessage (uint32_t rxc, uint32_t txc, uint32_t id, bool isFinished, const Time& t)
+    : m_txCount (txc),
+      m_rxCount (rxc),
+      m_myId (id),
+      m_isFinished (isFinished),
+      m_smallestTime (t)
+  {
+  }
+
+  ~LbtsMessage ();
+
+  /**
+   * \return smallest time
+   */
+  Time GetSmallestTime ();
+  /**
+   * \return transmitted count
+   */
+  uint32_t GetTxCount ();
+  /**
+   * \return receieved count
+   */
+  uint32_t GetRxCount ();
+  /**
+   * \return id which corresponds to mpi rank
+   */
+  uint32_t GetMyId ();
+  /**
+   * \return whether the rank has stopped (or run out of events)
+   */
+  bool IsFinished ();
+
+private:
+  uint32_t m_txCount;
+  uint32_t m_rxCount;
+  uint32_t m_myId;
+  bool     m_isFinished;
+  Time     m_smallestTime;
+};
+
+/**
+ * \ingroup mpi
+ *
+ * \brief distributed simulator implementation using lookahead
+ *
+ * The ranks stop together: Stop () only marks this rank as finished, and it
+ * keeps processing its events (e.g. packets it forwards for the other ranks)
+ * until every rank has stopped or run out of events, which is checked at the
+ * next LBTS synchronization.
+ */
+class DistributedSimulatorImpl : public SimulatorImpl
+{
+public:
+  static TypeId GetTypeId (void);
+
+  DistributedSimulatorImpl ();
+  ~DistributedSimulatorImpl ();
+
+  // virtual from SimulatorImpl
+  virtual void Destroy ();
+  virtual bool IsFinished (void) const;
+  virtual void Stop (void);
+  virtual void Stop (Time const &time);
+  virtual EventId Schedule (Time const &time, EventImpl *event);
+  virtual void ScheduleWithContext (uint32_t context, Time const &time, EventImpl *event);
+  virtual EventId ScheduleNow (EventImpl *event);
+  virtual EventId ScheduleDestroy (EventImpl *event);
+  virtual void Remove (const EventId &ev);
+  virtual void Cancel (const EventId &ev);
+  virtual bool IsExpired (const EventId &ev) const;
+  virtual void Run (void);
+  virtual Time Now (void) const;
+  virtual Time GetDelayLeft (const EventId &id) const;
+  virtual Time GetMaximumSimulationTime (void) const;
+  virtual void SetScheduler (ObjectFactory schedulerFactory);
+  virtual uint32_t GetSystemId (void) const;
+  virtual uint32_t GetContext (void) const;
+  virtual uint64_t GetEventCount (void) const;
+
+  /**
+   * \param ts the timestamp of an event scheduled now
+   * \return the uid of the event, which orders it among the events of its
+   * timestamp independently of the partition of the nodes over the ranks
+   */
+  uint64_t NextUid (uint64_t ts);
+  /**
+   * \brief Insert an event received from another rank, with the uid that its
+   * sender allocated with NextUid
+   */
+  void ScheduleRemote (uint32_t context, uint64_t ts, uint64_t uid, EventImpl *event);
+
+private:
+  virtual void DoDispose (void);
+  void CalculateLookAhead (void);
+
+  void ProcessOneEvent (void);
+  uint64_t NextTs (void) const;
+  Time Next (void) const;
+  typedef std::list<EventId> DestroyEvents;
+
+  DestroyEvents m_destroyEvents;
+  bool m_stop;
+  bool m_globalFinished;      // all ranks have stopped
+  Ptr<Scheduler> m_events;
+  uint64_t m_globalSeq;                // sequence of the events scheduled out of any node
+  std::vector<uint64_t> m_contextSeq;  // sequence of the events scheduled per context
+  uint64_t m_currentUid;
+  uint64_t m_currentTs;
+  uint32_t m_currentContext;
+  uint64_t m_eventCount;               // number of events executed
+  // number of events that have been inserted but not yet scheduled,
+  // not counting the "destroy" events; this is used for validation
+  int m_unscheduledEvents;
+
+  LbtsMessage* m_pLBTS;       // Allocated once we know how many systems
+  uint32_t     m_myId;        // MPI Rank
+  uint32_t     m_systemCount; // MPI Size
+  Time         m_grantedTime; // Last LBTS
+  static Time  m_lookAhead;   // Lookahead value
+
+};
+
+} // namespace ns3
+
+#endif /* DISTRIBUTED_SIMULATOR_IMPL_H */
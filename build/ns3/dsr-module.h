@@ -0,0 +1,23 @@
+
+#ifdef NS3_MODULE_COMPILATION
+# error "Do not include ns3 module aggregator headers from other modules; these are meant only for end user scripts."
+#endif
+
+#ifndef NS3_MODULE_DSR
+    
+
+// Module headers:
+#include "dsr-errorbuff.h"
+#include "dsr-fs-header.h"
+#include "dsr-gratuitous-reply-table.h"
+#include "dsr-helper.h"
+#include "dsr-main-helper.h"
+#include "dsr-maintain-buff.h"
+#include "dsr-network-queue.h"
+#include "dsr-option-header.h"
+#include "dsr-options.h"
+#include "dsr-rcache.h"
+#include "dsr-routing.h"
+#include "dsr-rreq-table.h"
+#include "dsr-rsendbuff.h"
+#endif
@@ -0,0 +1,118 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2023 NUS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Chahwan Song <songch@comp.nus.edu.sg>
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <string>
+
+namespace ns3 {
+
+/**
+ * @brief Binary flow trace: a FlowTraceHeader followed by flowCount fixed-width
+ * FlowTraceRecords, all little-endian. The flow-trace-convert program (utils/)
+ * converts the text FLOW_FILE format into it:
+ *   ./waf --run "flow-trace-convert --in=<flow>.txt --out=<flow>.bin --hosts=<#hosts>"
+ */
+struct FlowTraceHeader {
+    static const uint32_t SORTED = 1;  // flags: records are in non-decreasing startNs
+
+    char magic[8];          // "FLOWTRC\0"
+    uint32_t version;       // 1
+    uint32_t recordSize;    // sizeof(FlowTraceRecord)
+    uint32_t hostCount;     // number of hosts of the topology the trace is made for
+    uint32_t flags;
+    uint64_t flowCount;
+    uint64_t firstStartNs;  // startNs of the first/last record (if flowCount > 0)
+    uint64_t lastStartNs;
+};
+
+struct FlowTraceRecord {
+    // the simulated flows have 32-bit sequence numbers: larger sizes are rejected
+    static const uint64_t MAX_SIZE = UINT32_MAX;
+
+    uint32_t src;  // node IDs
+    uint32_t dst;
+    uint64_t size;  // bytes, at most MAX_SIZE
+    uint64_t startNs;
+    uint32_t pg;
+    uint32_t reserved;
+};
+
+/**
+ * @brief Reads a flow trace through mmap with a streaming cursor. Records are
+ * neither copied nor parsed; the cursor just walks the mapping. On a sorted
+ * trace, SetWindow() binary-searches the records of a time window, so a short
+ * window of a huge trace costs no more than the window itself.
+ */
+class FlowTraceReader {
+   public:
+    FlowTraceReader();
+    ~FlowTraceReader();
+
+    /** @brief Map the file and check its header. Returns false (with a message) on error */
+    bool Open(const std::string& file);
+    void Close();
+    bool IsOpen() const { return m_records != NULL; }
+
+    const FlowTraceHeader& GetHeader() const { return *m_header; }
+
+    /**
+     * @brief Restrict the cursor to records with startNs in [startNs, stopNs] and rewind
+     * to the first one. Needs a sorted trace.
+     */
+    void SetWindow(uint64_t startNs, uint64_t stopNs);
+
+    uint64_t GetNRemaining() const { return m_end - m_cur; }
+    /** @brief Next record, or NULL at the end (of the window) */
+    const FlowTraceRecord* Next() { return m_cur < m_end ? &m_records[m_cur++] : NULL; }
+
+   private:
+    uint64_t LowerBound(uint64_t startNs) const;  // first record with startNs >= startNs
+
+    void* m_map;
+    size_t m_mapSize;
+    const FlowTraceHeader* m_header;
+    const FlowTraceRecord* m_records;
+    uint64_t m_cur, m_end;  // cursor, end of the window (record indices)
+};
+
+/**
+ * @brief Writes a flow trace; the header (count, sortedness, time range) is
+ * finalized by Close().
+ */
+class FlowTraceWriter {
+   public:
+    FlowTraceWriter();
+    ~FlowTraceWriter();
+
+    bool Open(const std::string& file, uint32_t hostCount);
+    void Write(const FlowTraceRecord& record);
+    void SetHostCount(uint32_t hostCount) { m_header.hostCount = hostCount; }
+    void Close();
+
+   private:
+    FILE* m_file;
+    FlowTraceHeader m_header;
+};
+
+}  // namespace ns3
@@ -0,0 +1,109 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2023 NUS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Chahwan Song <songch@comp.nus.edu.sg>
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "ns3/nstime.h"
+#include "ns3/settings.h"
+
+namespace ns3 {
+
+/**
+ * @brief Flowlet table shared by flowlet-based load balancers (Conga, Letflow).
+ *
+ * Flowlets are stored inline in a flat, power-of-two sized slot array, so a
+ * lookup never allocates and never chases a pointer. Entries are not erased by
+ * a periodic scan; an entry idle for longer than the aging time is treated as
+ * absent and its slot is reused by the next insertion on the same probe chain
+ * (or dropped at the next rehash).
+ *
+ * Two modes are supported:
+ * - EXACT: open addressing with linear probing. Every flow gets its own entry
+ *   and the table grows as needed (same semantics as the former std::map).
+ * - HARDWARE: fixed number of hash-indexed entries, like a switch ASIC's flowlet
+ *   table (e.g., 64K entries in CONGA). A flow hashing to another flow's active
+ *   entry starts a new flowlet and takes the entry over; such collisions are
+ *   counted. (Sharing the entry is not an option, as a path is only valid for
+ *   the destination ToR it was chosen for.)
+ */
+class FlowletTable {
+   public:
+    enum Mode {
+        EXACT = 0,
+        HARDWARE = 1,
+    };
+
+    FlowletTable();
+
+    /**
+     * @brief (Re)configure the table. Existing entries are discarded.
+     * @param capacity initial (EXACT) or fixed (HARDWARE) number of entries,
+     *        rounded up to a power of two
+     */
+    void Configure(Mode mode, uint32_t capacity, Time agingTime);
+    void SetAgingTime(Time agingTime);
+
+    /**
+     * @brief Return the live flowlet of the key, or NULL if it does not exist
+     * or has been idle for longer than the aging time.
+     */
+    Flowlet* Find(uint64_t key, Time now);
+
+    /**
+     * @brief Return a fresh entry for the key (overwriting an expired entry or a
+     * colliding one in HARDWARE mode). The caller fills in the flowlet.
+     */
+    Flowlet* Insert(uint64_t key, Time now);
+
+    void Clear();
+
+    Mode GetMode() const { return m_mode; }
+    uint32_t GetCapacity() const { return m_mask + 1; }
+    uint32_t GetNOccupied() const { return m_nOccupied; }  // including expired entries
+    uint64_t GetNCollisions() const { return m_nCollisions; }
+    size_t GetMemoryUsage() const { return m_slots.capacity() * sizeof(Slot); }
+
+    static uint64_t Hash(uint64_t key);  // 64-bit mixer (murmur3 finalizer)
+
+   private:
+    struct Slot {
+        uint64_t key;
+        Flowlet flowlet;
+        bool used;
+    };
+
+    bool IsExpired(const Slot& slot, Time now) const {
+        return now - slot.flowlet._activeTime > m_agingTime;
+    }
+    void Rehash(Time now);
+
+    Mode m_mode;
+    Time m_agingTime;
+    std::vector<Slot> m_slots;
+    uint32_t m_mask;
+    uint32_t m_nOccupied;
+    uint64_t m_nCollisions;  // HARDWARE mode: lookups that hit another flow's active entry
+};
+
+}  // namespace ns3
@@ -0,0 +1,115 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2023 NUS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Chahwan Song <songch@comp.nus.edu.sg>
+ */
+
+
+#pragma once
+
+#include <stdint.h>
+
+#include <functional>
+#include <vector>
+
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+/**
+ * @brief Fluid model of a class of flows, for the hybrid fluid/packet mode (FLUID_* in the
+ * config): instead of packets, each flow is a rate on the directed links of its path.
+ *
+ * Rates are the max-min fair shares of the links' fluid capacity (a fraction, SetMaxShare,
+ * of each link, so that packets always keep the rest), recomputed when a flow starts or
+ * finishes. By default a flow moves to its new share at once. With SetConvergence(tau),
+ * the convergence is DCQCN-like: rate cuts are immediate, and rate increases approach the
+ * share exponentially with time constant tau, updated every tau / 4.
+ *
+ * The packet-level side sees the fluid through the link callback, called whenever the
+ * fluid rate of a link or its standing queue changes. The queue is the link's SetQueueBytes
+ * (e.g., the ECN threshold, around which DCQCN keeps a queue) while the fluid flows
+ * saturate the link, and zero otherwise.
+ */
+class FluidModel {
+   public:
+    struct Flow {
+        uint32_t id;           // flow index
+        uint32_t src, dst;     // node IDs
+        uint16_t sport, dport;
+        uint64_t size;         // bytes
+        Time start;
+    };
+
+    typedef std::function<void(uint32_t link, uint64_t bps, uint32_t queueBytes)> LinkCallback;
+    typedef std::function<void(const Flow &flow)> FinishCallback;
+
+    FluidModel();
+
+    /** @brief Add a directed link of the given capacity. Returns its ID (0, 1, ...) */
+    uint32_t AddLink(uint64_t bps);
+    void SetQueueBytes(uint32_t link, uint32_t bytes) { m_links[link].queueBytes = bytes; }
+    /** @brief Fraction of each link (0-1) that the fluid flows may take */
+    void SetMaxShare(double share) { m_maxShare = share; }
+    /** @brief DCQCN-like convergence with time constant tau (0: immediate) */
+    void SetConvergence(Time tau) { m_tau = tau; }
+    void SetLinkCallback(LinkCallback cb) { m_linkCb = cb; }
+    void SetFinishCallback(FinishCallback cb) { m_finishCb = cb; }
+
+    /** @brief Start a flow now on the links of its path */
+    void AddFlow(const Flow &flow, const std::vector<uint32_t> &path);
+
+    uint32_t GetNActive() const { return m_flows.size(); }
+    uint64_t GetNFinished() const { return m_nFinished; }
+
+   private:
+    struct Link {
+        double capacity;  // bps for the fluid
+        uint32_t queueBytes;
+        double rate;      // current fluid rate, as last reported
+        bool saturated;   // as last reported
+        // scratch of Allocate and Apply
+        double left;
+        uint32_t nOpen;
+        double sum;
+    };
+    struct ActiveFlow {
+        Flow flow;
+        std::vector<uint32_t> path;
+        double remaining;  // bytes
+        double rate;       // bps
+        double target;     // max-min share (bps)
+    };
+
+    void Advance();   // progress of the flows since m_lastUpdate
+    void Allocate();  // max-min targets
+    void Update();    // finish, reallocate, report and schedule the next update
+    void Apply();     // move rates towards the targets, report the links, schedule
+
+    std::vector<Link> m_links;
+    std::vector<ActiveFlow> m_flows;
+    double m_maxShare;
+    Time m_tau;
+    Time m_lastUpdate;
+    EventId m_next;
+    LinkCallback m_linkCb;
+    FinishCallback m_finishCb;
+    uint64_t m_nFinished;
+};
+
+}  // namespace ns3
@@ -0,0 +1,124 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2023 NUS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Chahwan Song <songch@comp.nus.edu.sg>
+ */
+
+
+#pragma once
+
+#include <arpa/inet.h>
+
+#include <map>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+#include "ns3/address.h"
+#include "ns3/callback.h"
+#include "ns3/event-id.h"
+#include "ns3/flowlet-table.h"
+#include "ns3/hdr-histogram.h"
+#include "ns3/load-balancer.h"
+#include "ns3/net-device.h"
+#include "ns3/object.h"
+#include "ns3/packet.h"
+#include "ns3/ptr.h"
+#include "ns3/settings.h"
+#include "ns3/simulator.h"
+#include "ns3/tag.h"
+
+namespace ns3 {
+
+const uint32_t LETFLOW_NULL = UINT32_MAX;
+
+class LetflowTag : public Tag {
+   public:
+    LetflowTag();
+    ~LetflowTag();
+    static TypeId GetTypeId(void);
+    void SetPathId(PathId pathId);
+    PathId GetPathId(void) const;
+    void SetHopCount(uint32_t hopCount);
+    uint32_t GetHopCount(void) const;
+    virtual TypeId GetInstanceTypeId(void) const;
+    virtual uint32_t GetSerializedSize(void) const;
+    virtual void Serialize(TagBuffer i) const;
+    virtual void Deserialize(TagBuffer i);
+    virtual void Print(std::ostream& os) const;
+
+   private:
+    PathId m_pathId;      // forward
+    uint32_t m_hopCount;  // hopCount to get outPort
+};
+
+/**
+ * @brief Letflow object is created for each Switch (lb_mode = 6)
+ */
+class LetflowRouting : public LoadBalancer {
+    friend class SwitchNode;
+
+   public:
+    LetflowRouting();
+
+    /** path <-> outPort: PathCodec (path-id.h) **/
+
+    /* static */
+    static TypeId GetTypeId(void);
+    static uint64_t GetQpKey(uint32_t dip, uint16_t sport, uint16_t dport, uint16_t pg);              // same as in rdma_hw.cc
+    static uint32_t nFlowletTimeout;                                                                  // number of flowlet's timeout
+    static HdrHistogram m_flowletGapHist;                                                             // idle time (ns) before a new flowlet
+
+    /* main function */
+    uint32_t RouteInput(Ptr<Packet> p, CustomHeader ch);
+    PathId GetRandomPath(uint32_t dstTorId);
+    bool HasPath(uint32_t dstToRId, PathId pathId);  // false once removed by RemovePath
+    uint32_t SelectOutPort(Ptr<Packet> p, CustomHeader& ch, const std::vector<int>& nexthops);
+    virtual void InstallTo(Ptr<SwitchNode> sw);
+    virtual void DoDispose();
+
+    /* SET functions */
+    void SetConstants(Time agingTime, Time flowletTimeout);
+    virtual void SetSwitchInfo(bool isToR, uint32_t switch_id);
+    virtual bool UsesPathTable() const { return true; }
+    virtual void AddPath(uint32_t dstToRId, PathId pathId, Time baseRtt);
+    virtual void RemovePath(uint32_t dstToRId, PathId pathId);
+    virtual uint32_t GetTagSize() const { return LetflowTag().GetSerializedSize(); }
+    virtual uint64_t GetPathTableBytes() const;
+    virtual void ReportMemory(MemStats& stats) const;
+    void SetFlowletTableMode(FlowletTable::Mode mode, uint32_t capacity);  // e.g., HARDWARE, 64K
+    const FlowletTable& GetFlowletTable() const { return m_flowletTable; }
+
+    // topological info (should be initialized in the beginning)
+    std::map<uint32_t, std::set<PathId> > m_letflowRoutingTable;  // routing table (ToRId -> pathId) (stable)
+
+    /*-----------*/
+
+   private:
+    // topology parameters
+    bool m_isToR;          // is ToR (leaf)
+    uint32_t m_switch_id;  // switch's nodeID
+
+    // conga constants
+    Time m_agingTime;       // expiry of flowlet entry
+    Time m_flowletTimeout;  // flowlet timeout (e.g., 100us)
+
+    // local
+    FlowletTable m_flowletTable;  // QpKey -> Flowlet (at SrcToR), expired lazily after m_agingTime
+};
+
+}  // namespace ns3
\ No newline at end of file
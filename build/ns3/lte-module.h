@@ -0,0 +1,71 @@
+
+#ifdef NS3_MODULE_COMPILATION
+# error "Do not include ns3 module aggregator headers from other modules; these are meant only for end user scripts."
+#endif
+
+#ifndef NS3_MODULE_LTE
+    
+
+// Module headers:
+#include "epc-enb-application.h"
+#include "epc-gtpu-header.h"
+#include "epc-helper.h"
+#include "epc-sgw-pgw-application.h"
+#include "epc-tft-classifier.h"
+#include "epc-tft.h"
+#include "eps-bearer.h"
+#include "ff-mac-common.h"
+#include "ff-mac-csched-sap.h"
+#include "ff-mac-sched-sap.h"
+#include "ff-mac-scheduler.h"
+#include "ideal-control-messages.h"
+#include "lte-amc.h"
+#include "lte-common.h"
+#include "lte-enb-cmac-sap.h"
+#include "lte-enb-mac.h"
+#include "lte-enb-net-device.h"
+#include "lte-enb-phy-sap.h"
+#include "lte-enb-phy.h"
+#include "lte-enb-rrc.h"
+#include "lte-helper.h"
+#include "lte-hex-grid-enb-topology-helper.h"
+#include "lte-interference.h"
+#include "lte-mac-sap.h"
+#include "lte-mi-error-model.h"
+#include "lte-net-device.h"
+#include "lte-pdcp-header.h"
+#include "lte-pdcp-sap.h"
+#include "lte-pdcp-tag.h"
+#include "lte-pdcp.h"
+#include "lte-phy-tag.h"
+#include "lte-phy.h"
+#include "lte-radio-bearer-info.h"
+#include "lte-radio-bearer-tag.h"
+#include "lte-rlc-am-header.h"
+#include "lte-rlc-am.h"
+#include "lte-rlc-header.h"
+#include "lte-rlc-sap.h"
+#include "lte-rlc-sdu-status-tag.h"
+#include "lte-rlc-sequence-number.h"
+#include "lte-rlc-tag.h"
+#include "lte-rlc-um.h"
+#include "lte-rlc.h"
+#include "lte-sinr-chunk-processor.h"
+#include "lte-spectrum-phy.h"
+#include "lte-spectrum-signal-parameters.h"
+#include "lte-spectrum-value-helper.h"
+#include "lte-stats-calculator.h"
+#include "lte-ue-cmac-sap.h"
+#include "lte-ue-mac.h"
+#include "lte-ue-net-device.h"
+#include "lte-ue-phy-sap.h"
+#include "lte-ue-phy.h"
+#include "lte-ue-rrc.h"
+#include "mac-stats-calculator.h"
+#include "pf-ff-mac-scheduler.h"
+#include "radio-bearer-stats-calculator.h"
+#include "radio-environment-map-helper.h"
+#include "rem-spectrum-phy.h"
+#include "rr-ff-mac-scheduler.h"
+#include "trace-fading-loss-model.h"
+#endif
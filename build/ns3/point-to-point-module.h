@@ -0,0 +1,52 @@
+
+#ifdef NS3_MODULE_COMPILATION
+# error "Do not include ns3 module aggregator headers from other modules; these are meant only for end user scripts."
+#endif
+
+#ifndef NS3_MODULE_POINT_TO_POINT
+    
+
+// Module headers:
+#include "alloc-stats.h"
+#include "async-output.h"
+#include "batch-means.h"
+#include "cn-header.h"
+#include "columnar-output.h"
+#include "conga-routing.h"
+#include "conweave-routing.h"
+#include "conweave-voq.h"
+#include "dc-topology.h"
+#include "drill-routing.h"
+#include "fast-forward.h"
+#include "flow-generator.h"
+#include "flow-stat-tag.h"
+#include "flow-trace.h"
+#include "flowlet-table.h"
+#include "fluid-model.h"
+#include "hdr-histogram.h"
+#include "letflow-routing.h"
+#include "load-balancer.h"
+#include "mem-stats.h"
+#include "path-id.h"
+#include "pause-header.h"
+#include "point-to-point-channel.h"
+#include "point-to-point-helper.h"
+#include "point-to-point-net-device.h"
+#include "point-to-point-remote-channel.h"
+#include "ppp-header.h"
+#include "qbb-channel.h"
+#include "qbb-header.h"
+#include "qbb-helper.h"
+#include "qbb-net-device.h"
+#include "qbb-remote-channel.h"
+#include "quantile-sketch.h"
+#include "rdma-driver.h"
+#include "rdma-hw.h"
+#include "rdma-queue-pair.h"
+#include "selective-packet-queue.h"
+#include "settings.h"
+#include "sim-setting.h"
+#include "switch-mmu.h"
+#include "switch-node.h"
+#include "trace-format.h"
+#endif
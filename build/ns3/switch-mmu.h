@@ -0,0 +1,205 @@
+#ifndef SWITCH_MMU_H
+#define SWITCH_MMU_H
+
+#include <ns3/event-id.h>
+#include <ns3/node.h>
+#include <ns3/random-variable-stream.h>
+
+#include <algorithm>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include "ns3/settings.h"
+
+
+namespace ns3 {
+
+class Packet;
+
+class SwitchMmu : public Object {
+   public:
+    static const unsigned qCnt = 8;    // Number of queues/priorities used
+    static const unsigned MTU = 1048;  // 1000 + headers
+
+    static TypeId GetTypeId(void);
+
+    SwitchMmu(void);
+    void InitSwitch(void);
+
+    bool CheckIngressAdmission(uint32_t port, uint32_t qIndex, uint32_t psize);
+    bool CheckEgressAdmission(uint32_t port, uint32_t qIndex, uint32_t psize);
+    void UpdateIngressAdmission(uint32_t port, uint32_t qIndex, uint32_t psize);
+    void UpdateEgressAdmission(uint32_t port, uint32_t qIndex, uint32_t psize);
+    void RemoveFromIngressAdmission(uint32_t port, uint32_t qIndex, uint32_t psize);
+    void RemoveFromEgressAdmission(uint32_t port, uint32_t qIndex, uint32_t psize);
+
+    void SetPause(uint32_t port, uint32_t qIndex, uint32_t pause_time);
+    void SetResume(uint32_t port, uint32_t qIndex);
+    void GetPauseClasses(uint32_t port, uint32_t qIndex, bool pClasses[]);
+    bool GetResumeClasses(uint32_t port, uint32_t qIndex);
+
+    void SetBroadcomParams(uint32_t buffer_cell_limit_sp,  // ingress sp buffer threshold p.120
+                           uint32_t buffer_cell_limit_sp_shared,  // ingress sp buffer shared
+                                                                  // threshold, nonshare -> share
+                           uint32_t pg_min_cell,                  // ingress pg guarantee
+                           uint32_t port_min_cell,                // ingress port guarantee
+                           uint32_t pg_shared_limit_cell,         // max buffer for an ingress pg
+                           uint32_t port_max_shared_cell,         // max buffer for an ingress port
+                           uint32_t pg_hdrm_limit,                // ingress pg headroom
+                           uint32_t port_max_pkt_size,            // ingress global headroom
+                           uint32_t q_min_cell,                   // egress queue guaranteed buffer
+                           uint32_t op_uc_port_config1_cell,      // egress queue threshold
+                           uint32_t op_uc_port_config_cell,       // egress port threshold
+                           uint32_t op_buffer_shared_limit_cell,  // egress sp threshold
+                           uint32_t q_shared_alpha_cell, uint32_t port_share_alpha_cell,
+                           uint32_t pg_qcn_threshold);
+
+    void SetMarkingThreshold(uint32_t kmin, uint32_t kmax, double pmax);
+
+    bool ShouldSendCN(uint32_t ifindex, uint32_t qIndex);
+
+    uint32_t GetUsedBufferTotal();
+
+    void SetDynamicThreshold(bool value);
+    bool GetDynamicThreshold(void) const { return m_dynamicth; }
+
+    // void printQueueStat(std::ostream& os, uint32_t port);
+
+    void ConfigEcn(uint32_t port, uint32_t _kmin, uint32_t _kmax, double _pmax);
+    void ConfigBufferSize(uint32_t size);
+
+    void ConfigHdrm(uint32_t port, uint32_t size);
+    void ConfigNPort(uint32_t n_port);
+
+    uint32_t GetIngressSP(uint32_t port, uint32_t pgIndex);
+    uint32_t GetEgressSP(uint32_t port, uint32_t qIndex);
+
+    // egress queue occupancy in bytes (guaranteed + shared)
+    uint32_t GetEgressQBytes(uint32_t port, uint32_t qIndex) const {
+        return m_usedEgressQMinBytes[PortQ(port, qIndex)] +
+               m_usedEgressQSharedBytes[PortQ(port, qIndex)];
+    }
+
+    // whether we have paused the upstream of (port, qIndex)
+    bool GetPauseRemote(uint32_t port, uint32_t qIndex) const {
+        return m_pause_remote[PortQ(port, qIndex)];
+    }
+    void SetPauseRemote(uint32_t port, uint32_t qIndex, bool v) {
+        m_pause_remote[PortQ(port, qIndex)] = v;
+    }
+
+    /**
+     * @brief Standing queue of the fluid flows on (port, qIndex), in the hybrid fluid/packet
+     * mode. It counts for ECN marking and the egress dynamic threshold, but takes no buffer.
+     */
+    void SetFluidQueue(uint32_t port, uint32_t qIndex, uint32_t bytes) {
+        m_fluidQBytes[PortQ(port, qIndex)] = bytes;
+    }
+
+    // config
+    uint32_t node_id;
+
+    uint32_t GetActivePortCnt(void) const { return m_activePortCnt; }
+    void SetActivePortCnt(uint32_t v) {
+        m_activePortCnt = v;
+        InitSwitch();
+    }
+
+    uint32_t GetMmuBufferBytes(void) const { return m_maxBufferBytes; }
+    uint32_t GetMaxBufferBytesPerPort(void) const { return m_maxBufferBytesPerPort; }
+    void SetMaxBufferBytesPerPort(uint32_t v) {
+        m_maxBufferBytesPerPort = v;
+        InitSwitch();
+    }
+
+    uint32_t GetPgHdrmLimit(void) const { return m_pg_hdrm_limit_default; }
+    void SetPgHdrmLimit(uint32_t v) {
+        m_pg_hdrm_limit_default = v;
+        std::fill(m_pg_hdrm_limit.begin(), m_pg_hdrm_limit.end(), v);
+        InitSwitch();
+    }
+
+    uint32_t GetPortSlotCnt(void) const { return m_portSlotCnt; }
+    size_t GetMemoryUsage(void) const;  // bytes of the per-port state
+    /** @brief PFC headroom and guarantees of the active ports; the buffer must be larger */
+    uint64_t GetReservedBytes(void) const;
+
+   private:
+    /**
+     * Per-port state is sized at setup from the number of ports (port 0 is not
+     * used), see ConfigNPort. Per-(port, queue) arrays are flat with stride qCnt.
+     */
+    static uint32_t PortQ(uint32_t port, uint32_t qIndex) { return port * qCnt + qIndex; }
+    void ResizePorts(uint32_t portSlotCnt);  // grow-only, keeps the port configs
+
+    uint32_t m_portSlotCnt{0};
+
+    // per-port config
+    std::vector<uint32_t> kmin, kmax;
+    std::vector<double> pmax;
+    std::vector<uint8_t> paused;        // [PortQ]
+    std::vector<EventId> resumeEvt;     // [PortQ]
+    std::vector<uint8_t> m_pause_remote;  // [PortQ]
+
+    bool m_PFCenabled;
+
+    uint32_t m_maxBufferBytes{0};
+    uint32_t m_usedTotalBytes{0};
+
+    unsigned m_activePortCnt{0};
+    uint32_t m_maxBufferBytesPerPort{0};  // use this to calculate m_maxBufferBytes
+    uint32_t m_staticMaxBufferBytes{0};   // use this to calculate m_maxBufferBytes
+
+    // admission counters, one array per counter (touched per packet)
+    std::vector<uint32_t> m_usedIngressPGBytes;  // [PortQ]
+    std::vector<uint32_t> m_usedIngressPortBytes;
+    uint32_t m_usedIngressSPBytes[4];
+    std::vector<uint32_t> m_usedIngressPGHeadroomBytes;  // [PortQ]
+
+    std::vector<uint32_t> m_usedEgressQMinBytes;     // [PortQ]
+    std::vector<uint32_t> m_usedEgressQSharedBytes;  // [PortQ]
+    std::vector<uint32_t> m_fluidQBytes;             // [PortQ], see SetFluidQueue
+    std::vector<uint32_t> m_usedEgressPortBytes;
+    uint32_t m_usedEgressSPBytes[4];
+
+    // ingress params
+    uint32_t m_buffer_cell_limit_sp;  // ingress sp buffer threshold p.120
+    uint32_t
+        m_buffer_cell_limit_sp_shared;  // ingress sp buffer shared threshold, nonshare -> share
+    uint32_t m_pg_min_cell;             // ingress pg guarantee
+    uint32_t m_port_min_cell;           // ingress port guarantee
+    uint32_t m_pg_shared_limit_cell;    // max buffer for an ingress pg
+    uint32_t m_port_max_shared_cell;    // max buffer for an ingress port
+    std::vector<uint32_t> m_pg_hdrm_limit;  // ingress pg headroom
+    uint32_t m_pg_hdrm_limit_default{0};    // for ports not set by ConfigHdrm
+    uint32_t m_port_max_pkt_size;       // ingress global headroom
+    // still needs reset limits..
+    uint32_t m_port_min_cell_off;  // PAUSE off threshold
+    uint32_t m_pg_shared_limit_cell_off;
+    uint32_t m_global_hdrm_limit;
+
+    // egress params
+    uint32_t m_q_min_cell;                   // egress queue guaranteed buffer
+    uint32_t m_op_uc_port_config1_cell;      // egress queue threshold
+    uint32_t m_op_uc_port_config_cell;       // egress port threshold
+    uint32_t m_op_buffer_shared_limit_cell;  // egress sp threshold
+
+    // dynamic threshold
+    double m_pg_shared_alpha_cell{0};
+    double m_pg_shared_alpha_cell_egress{0};
+    double m_pg_shared_alpha_cell_off_diff;
+    double m_port_shared_alpha_cell;
+    double m_port_shared_alpha_cell_off_diff;
+    bool m_dynamicth;
+
+    double m_log_start;
+    double m_log_end;
+    double m_log_step;
+
+    UniformRandomVariable m_uniform_random_var;
+};
+
+} /* namespace ns3 */
+
+#endif /* SWITCH_MMU_H */
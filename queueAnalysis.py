@@ -11,6 +11,9 @@ import argparse
 from datetime import date
 import glob
 
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "analysis"))
+from columnar import load_monitor
+
 
 # LB/CC mode matching
 cc_modes = {
@@ -67,37 +70,20 @@ def get_cdf(v: list):
 
 def get_queue_per_switch_info_from_raw(filename, time_limit_start, time_limit_end, monitoring_interval, cdf_flag=True):
 
+    # text or columnar output: time, ToR, #VOQ, #Pkts
+    timestamp, tor, nQueue, nPkt = load_monitor(filename)
+
     # get number of ToR switches
-    num_switch = 0
-    set_switch = set()
-    with open(filename, "r") as f:
-        for line in f.readlines():
-            parsed_line = line.replace("\n", "").split(",")
-            if len(parsed_line) != 4:
-                continue
-            set_switch.add(int(parsed_line[1]))
-    num_switch = len(set_switch)
+    num_switch = len(np.unique(tor))
     print("Number of ToR switches: {}".format(num_switch))
     assert(num_switch != 0)
 
     # start calculating percentiles
     nSample = int((float(time_limit_end) - float(time_limit_start)) / float(monitoring_interval) * num_switch) # 10us sampling interval
     result = {"nQueue": [], "nPkt": [], "nSample": nSample} 
-    with open(filename, "r") as f:
-        for line in f.readlines():
-            parsed_line = line.replace("\n", "").split(",")
-            if len(parsed_line) != 4:
-                continue
-
-            timestamp = int(parsed_line[0])
-            if timestamp < time_limit_start or timestamp > time_limit_end:
-                continue
-
-            nQueue = int(parsed_line[2])
-            nPkt = int(parsed_line[3])
-
-            result["nQueue"].append(nQueue)
-            result["nPkt"].append(nPkt)
+    in_time = (timestamp >= time_limit_start) & (timestamp <= time_limit_end)
+    result["nQueue"] = nQueue[in_time].tolist()
+    result["nPkt"] = nPkt[in_time].tolist()
 
     print("-> Total sample: {}, non-empty sample: {}".format(nSample, len(result["nQueue"])))
     result["nQueue"] += [0] * int(nSample - len(result["nQueue"]))
@@ -164,18 +150,11 @@ def get_queue_per_dst_info_from_raw(filename, time_limit_start, time_limit_end,
     nSample = int((time_limit_end - time_limit_start) / monitoring_interval * nHost) # 10us sampling interval
 
     result = {"nQueue": [], "nPkt": [], "nSample": nSample} 
-    with open(filename, "r") as f:
-        for line in f.readlines():
-            parsed_line = line.replace("\n", "").split(",")
-            timestamp = int(parsed_line[0])
-            if timestamp < time_limit_start or timestamp > time_limit_end:
-                continue
-
-            nQueue = int(parsed_line[2])
-            nPkt = int(parsed_line[3])
-
-            result["nQueue"].append(nQueue)
-            result["nPkt"].append(nPkt)
+    # text or columnar output: time, dst IP, #VOQ, #Pkts
+    timestamp, _, nQueue, nPkt = load_monitor(filename)
+    in_time = (timestamp >= time_limit_start) & (timestamp <= time_limit_end)
+    result["nQueue"] = nQueue[in_time].tolist()
+    result["nPkt"] = nPkt[in_time].tolist()
     
     print("-> Total sample: {}, non-empty sample: {}".format(nSample, len(result["nQueue"])))
     result["nQueue"] += [0] * int(nSample - len(result["nQueue"]))
@@ -145,6 +145,24 @@ def main():
                         default='leaf_spine_128_100G', help="the name of the topology file (default: leaf_spine_128_100G_OS2)")
     parser.add_argument('--cdf', dest='cdf', action='store',
                         default='AliStorage2019', help="the name of the cdf file (default: AliStorage2019)")
+    parser.add_argument('--flowgen', dest='flowgen', action='store',
+                        default='', help="generate flows in the simulator (poisson/incast/alltoall) instead of traffic_gen.py (default: off)")
+    parser.add_argument('--incast_fanin', dest='incast_fanin', action='store',
+                        type=int, default=16, help="number of senders per incast with --flowgen incast (default: 16)")
+    parser.add_argument('--monitor_format', dest='monitor_format', action='store',
+                        default='text', help="format of the VOQ/uplink/conn monitoring outputs, text or columnar (default: text)")
+    parser.add_argument('--fct_sketch', dest='fct_sketch', action='store_true',
+                        help="also keep FCT slowdown quantile sketches in the simulator (XXX_out_fct_sketch.txt)")
+    parser.add_argument('--ci_stop', dest='ci_stop', action='store',
+                        type=float, default=0, help="stop starting new flows once the 95%% CIs of the p50/p99 slowdown are within this fraction (e.g. 0.05, default: off)")
+    parser.add_argument('--mpi', dest='mpi', action='store',
+                        type=int, default=0, help="run on this many MPI ranks, partitioned by pod (needs ./waf configure --enable-mpi, default: off)")
+    parser.add_argument('--fluid', dest='fluid', action='store',
+                        type=int, default=0, help="simulate the flows of at least this many bytes as fluid rates instead of packets (default: off)")
+    parser.add_argument('--fast_forward', dest='fast_forward', action='store',
+                        type=int, default=0, help="1: flows alone on idle links skip the packet-level simulation, 2: only report the FCT error it would make (default: 0)")
+    parser.add_argument('--mem_monitor', dest='mem_monitor', action='store',
+                        type=int, default=0, help="snapshot the memory footprint per component every this many us (XXX_out_mem.txt, default: off)")
     parser.add_argument('--enforce_win', dest='enforce_win', action='store',
                         type=int, default=0, help="enforce to use window scheme (default: 0)")
     parser.add_argument('--sw_monitoring_interval', dest='sw_monitoring_interval', action='store',
@@ -218,7 +236,9 @@ def main():
         load=hostload, cdf=args.cdf, n_host=n_host, time=int(float(args.simul_time)*1000), bw=bw)
 
     # check the file exists
-    if (exists(os.getcwd() + "/config/" + flow + ".txt")):
+    if args.flowgen:  # generated in the simulator, see FLOWGEN_* in the config
+        print("Flows are generated in the simulator ({pattern})".format(pattern=args.flowgen))
+    elif (exists(os.getcwd() + "/config/" + flow + ".txt")):
         print("Input traffic file with load:{load:.2f}, cdf:{cdf}, n_host:{n_host} already exists".format(
             load=hostload, cdf=cdf, n_host=n_host))
     else:  # make the input traffic file
@@ -373,6 +393,26 @@ def main():
     else:
         print("unknown cc:{}".format(args.cc))
 
+    if args.flowgen:
+        config += "\nFLOWGEN_CDF_FILE traffic_gen/{cdf}.txt\nFLOWGEN_PATTERN {pattern}\nFLOWGEN_LOAD {load}\nFLOWGEN_INCAST_FANIN {fanin}\n".format(
+            cdf=args.cdf, pattern=args.flowgen, load=hostload / 100.0, fanin=args.incast_fanin)
+    if args.monitor_format != "text":  # analysis/columnar.py reads both
+        config += "\nMONITOR_FORMAT {}\n".format(args.monitor_format)
+    if args.fct_sketch:  # same flows as fctAnalysis.py below
+        config += "\nFCT_SKETCH_FILE mix/output/{id}/{id}_out_fct_sketch.txt\nFCT_SKETCH_WINDOW {start} {end}\n".format(
+            id=config_ID, start=flowgen_start_time + 0.005, end=flowgen_stop_time + 0.05)
+    if args.ci_stop > 0:  # same warm-up as fctAnalysis.py
+        config += "\nCI_STOP_PRECISION {}\nCI_STOP_WARMUP 0.005\n".format(args.ci_stop)
+    if args.mpi > 0:
+        config += "\nENABLE_MPI 1\n"
+    if args.fluid > 0:
+        config += "\nFLUID_MIN_SIZE {}\n".format(args.fluid)
+    if args.fast_forward > 0:
+        config += "\nFAST_FORWARD {}\n".format(args.fast_forward)
+    if args.mem_monitor > 0:
+        config += "\nMEM_MON_FILE mix/output/{id}/{id}_out_mem.txt\nMEM_MON_INTERVAL {interval}\n".format(
+            id=config_ID, interval=args.mem_monitor)
+
     with open(config_name, "w") as file:
         file.write(config)
 
@@ -381,6 +421,9 @@ def main():
     output_log = config_name.replace(".txt", ".log")
     run_command = "./waf --run 'scratch/network-load-balance {config_name}' > {output_log} 2>&1".format(
         config_name=config_name, output_log=output_log)
+    if args.mpi > 0:
+        run_command = "./waf --run 'scratch/network-load-balance' --command-template='mpirun -np {np} %s {config_name}' > {output_log} 2>&1".format(
+            np=args.mpi, config_name=config_name, output_log=output_log)
     with open("./mix/.history", "a") as history:
         history.write(run_command + "\n")
         history.write(
@@ -390,8 +433,7 @@ def main():
         history.write("\n")
 
     print(run_command)
-    os.system("./waf --run 'scratch/network-load-balance {config_name}' > {output_log} 2>&1".format(
-        config_name=config_name, output_log=output_log))
+    os.system(run_command)
 
     ####################################################
     #                 Analyze the output FCT           #
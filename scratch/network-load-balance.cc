@@ -25,28 +25,53 @@
 #include <ns3/rdma.h>
 #include <ns3/sim-setting.h>
 #include <ns3/switch-node.h>
+#include <sys/resource.h>
 #include <time.h>
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <fstream>
 #include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
 #include <unordered_map>
 
+#include "ns3/alloc-stats.h"
 #include "ns3/applications-module.h"
 #include "ns3/broadcom-node.h"
 #include "ns3/conga-routing.h"
+#include "ns3/conweave-routing.h"
 #include "ns3/conweave-voq.h"
 #include "ns3/core-module.h"
+#include "ns3/dc-topology.h"
 #include "ns3/error-model.h"
+#include "ns3/flow-generator.h"
+#include "ns3/fast-forward.h"
+#include "ns3/fluid-model.h"
+#include "ns3/async-output.h"
+#include "ns3/batch-means.h"
+#include "ns3/columnar-output.h"
+#include "ns3/flow-trace.h"
+#include "ns3/quantile-sketch.h"
 #include "ns3/global-route-manager.h"
+#include "ns3/hdr-histogram.h"
 #include "ns3/internet-module.h"
 #include "ns3/ipv4-static-routing-helper.h"
 #include "ns3/letflow-routing.h"
+#include "ns3/load-balancer.h"
+#include "ns3/mem-stats.h"
+#include "ns3/mpi-interface.h"
 #include "ns3/packet.h"
 #include "ns3/point-to-point-helper.h"
 #include "ns3/qbb-helper.h"
 #include "ns3/qbb-net-device.h"
 #include "ns3/rdma-hw.h"
 #include "ns3/settings.h"
+#ifdef NS3_MPI
+#include <mpi.h>
+#endif
 
 using namespace ns3;
 using namespace std;
@@ -68,6 +93,15 @@ double conga_alpha = 0.2;
 Time letflow_flowletTimeout = MicroSeconds(100);  // 100us
 Time letflow_agingTime = MilliSeconds(2);  // just to clear the unused map entries for simul speed
 
+// Flowlet table (Conga, Letflow), 0: exact-match (grows), 1: hardware (fixed, hash-indexed)
+uint32_t flowlet_table_mode = 0;
+uint32_t flowlet_table_size = 1024;  // initial (exact) or fixed (hardware) number of entries
+
+// DRILL params
+uint32_t drill_sample_num = 2;  // d, random samples per decision
+uint32_t drill_memory_num = 1;  // m, remembered best ports per destination
+bool drill_memory_per_tor = false;  // share the memory among hosts of a destination ToR
+
 // Conweave params
 Time conweave_extraReplyDeadline = MicroSeconds(4);       // additional term to reply deadline
 Time conweave_pathPauseTime = MicroSeconds(8);            // time to send packets to congested path
@@ -77,11 +111,12 @@ Time conweave_defaultVOQWaitingTime = MicroSeconds(500);  // default flush timer
 bool conweave_pathAwareRerouting = true;
 
 /*------------------------ simulation variables -----------------------------*/
-uint64_t one_hop_delay = 1000;  // nanoseconds
+uint64_t one_hop_delay = 1000;  // nanoseconds, of every link (from the topology)
 uint32_t cc_mode = 1;           // mode for congestion control, 1: DCQCN
 bool enable_qcn = true, enable_pfc = true, use_dynamic_pfc_threshold = true;
 uint32_t packet_payload_size = 1000, l2_chunk_size = 0, l2_ack_interval = 0;
 double pause_time = 5;  // PFC pause, microseconds
+bool pause_time_accounting = false;  // per-flow PFC pause time (acc_pause_time), slow
 double flowgen_start_time = 2.0, flowgen_stop_time = 2.5, simulator_extra_time = 0.1;
 // queue length monitoring time is not used in this simulator
 // uint32_t qlen_dump_interval = 100000000, qlen_mon_interval = 1000;  // ns
@@ -103,7 +138,50 @@ FILE *voq_detail_output = NULL;
 FILE *uplink_output = NULL;
 FILE *conn_output = NULL;
 
-std::string data_rate, link_delay, topology_file, flow_file;
+// all the monitoring files above are written through monitor_output (see async-output.h)
+AsyncOutput monitor_output;
+bool async_output = true;              // ASYNC_OUTPUT: format/write on a background thread
+uint32_t async_output_ring = 1 << 14;  // ASYNC_OUTPUT_RING: records per file
+// MONITOR_FORMAT columnar: VOQ/uplink/conn monitoring in columnar files (see columnar-output.h)
+bool monitor_columnar = false;
+uint32_t pfc_channel, fct_channel, cnp_channel, voq_channel, voq_detail_channel,
+    uplink_channel, conn_channel;
+
+// FCT_SKETCH_FILE: slowdown/FCT quantile sketches, updated in qp_finish (see quantile-sketch.h)
+std::string fct_sketch_file;
+FILE *fct_sketch_output = NULL;
+uint64_t fct_sketch_interval = 0;           // FCT_SKETCH_INTERVAL (us): snapshots, 0: at the end only
+double fct_sketch_accuracy = 0.01;          // FCT_SKETCH_ACCURACY: relative error of the quantiles
+std::vector<uint64_t> fct_sketch_bounds;    // FCT_SKETCH_BUCKETS: flow size bounds (default: 1 BDP)
+uint64_t fct_sketch_window_start = 0;       // FCT_SKETCH_WINDOW (ns): flows that start after and
+uint64_t fct_sketch_window_end = UINT64_MAX;  // finish before, as fctAnalysis.py -sT/-fT
+bool fct_per_flow = true;                   // FCT_PER_FLOW 0: no per-flow lines in FCT_OUTPUT_FILE
+struct FctSketch {
+    uint64_t size_lo, size_hi;  // flow sizes in [size_lo, size_hi)
+    QuantileSketch slowdown;
+    QuantileSketch fct_us;
+    FctSketch(uint64_t lo, uint64_t hi, double accuracy)
+        : size_lo(lo), size_hi(hi), slowdown(accuracy), fct_us(accuracy) {}
+};
+std::vector<FctSketch> fct_sketches;  // [0]: all flows, then one per size bucket
+
+// CI_STOP_PRECISION: stop generating flows once the 95% CIs of the p50/p99 slowdown of every
+// size bucket (FCT_SKETCH_BUCKETS) are within this fraction of their value (see batch-means.h)
+double ci_stop_precision = 0;       // 0: off
+uint32_t ci_stop_batch = 1000;      // CI_STOP_BATCH: flows per batch (of a bucket)
+uint32_t ci_stop_min_batches = 10;  // CI_STOP_MIN_BATCHES
+double ci_stop_warmup = 0.005;      // CI_STOP_WARMUP (s after FLOWGEN_START_TIME): flows started
+uint64_t ci_stop_warmup_end;        // before are not counted
+struct CiBucket {
+    uint64_t size_lo, size_hi;  // flow sizes in [size_lo, size_hi)
+    BatchMeansCi ci;
+    CiBucket(uint64_t lo, uint64_t hi)
+        : size_lo(lo), size_hi(hi), ci(ci_stop_batch, std::vector<double>{0.5, 0.99}) {}
+};
+std::vector<CiBucket> ci_buckets;
+bool ci_stopped = false;
+
+std::string data_rate, link_delay, topology_file, topology_gen, flow_file;
 std::string flow_input_file = "flow.txt";
 std::string fct_output_file = "fct.txt";
 std::string pfc_output_file = "pfc.txt";
@@ -136,12 +214,23 @@ bool rate_bound = true;
 unordered_map<uint64_t, uint32_t> rate2kmax, rate2kmin;
 unordered_map<uint64_t, double> rate2pmax;
 unordered_map<uint32_t, Ptr<SwitchNode>> idxNodeToR;  // Id -> Ptr
-
-// config of link-down scenario, ACK priority, and buffer
-uint64_t link_down_time = 0;
-uint32_t link_down_A = 0, link_down_B = 0;
+bool lb_uses_path_table = false;                      // LB needs AddPath() (Conga, Letflow, ConWeave)
+map<pair<uint32_t, uint32_t>, set<PathId>> torPairPaths;  // (src ToR, dst ToR) -> installed pathIds
+
+// config of link failure/recovery scenario, ACK priority, and buffer
+struct LinkEvent {
+    uint64_t time;  // us after FLOWGEN_START_TIME
+    bool up;        // recovery if true, failure otherwise
+    uint32_t a, b;  // node IDs of the link's ends
+    std::string line;  // where it was given, for the error messages
+};
+vector<LinkEvent> link_events;
 uint32_t buffer_size = 0;  // 0 to set buffer size automatically
 
+// ns-3 global routing (all-pairs SPF over LSAs). Forwarding never uses it: switches and
+// RDMA NICs forward with the tables filled by SetRoutingEntries.
+bool populate_ipv4_routes = false;
+
 // Added from Here
 double load = 10.0;
 int enable_irn = 0;
@@ -158,21 +247,36 @@ struct Interface {
 
     Interface() : idx(0), up(false) {}
 };
-map<Ptr<Node>, map<Ptr<Node>, Interface>> nbr2if;
-// Mapping destination to next hop for each node: <node, <dest, <nexthop0, ...> > >
-map<Ptr<Node>, map<Ptr<Node>, vector<Ptr<Node>>>> nextHop;
-map<Ptr<Node>, map<Ptr<Node>, uint64_t>> pairDelay;
-map<Ptr<Node>, map<Ptr<Node>, uint64_t>> pairTxDelay;
-map<Ptr<Node>, map<Ptr<Node>, uint64_t>> pairBw;
-map<Ptr<Node>, map<Ptr<Node>, uint64_t>> pairBdp;
-map<Ptr<Node>, map<Ptr<Node>, uint64_t>> pairRtt;
+// topology graph by node ID: nbr2if[node][neighbor], neighbors in ID order
+vector<map<uint32_t, Interface>> nbr2if;
+
+// Routes towards one host, from a BFS rooted at the host. All indexed by node ID.
+struct HostRoute {
+    vector<vector<uint32_t>> nextHop;  // next hops (node IDs) towards the host
+    vector<uint64_t> delay;            // propagation delay to the host
+    vector<uint64_t> txDelay;          // transmission delay of a packet to the host
+    vector<uint64_t> bw;               // bottleneck bandwidth to the host
+    vector<int> dis;                   // hop count to the host, -1 if unreachable
+};
+uint32_t route_calc_threads = 0;  // threads for CalculateRoutes, 0: hardware concurrency
+vector<uint32_t> hostIds;         // node IDs of the hosts
+vector<uint32_t> nodeId2HostIdx;  // node ID -> index in hostIds (UINT32_MAX if a switch)
+vector<HostRoute> hostRoutes;     // [host index]
+
+// host-to-host matrices, indexed by PairIdx(src node ID, dst node ID)
+vector<uint64_t> pairBw;
+vector<uint64_t> pairBdp;
+vector<uint64_t> pairRtt;
+inline size_t PairIdx(uint32_t srcId, uint32_t dstId) {
+    return (size_t)nodeId2HostIdx[srcId] * hostIds.size() + nodeId2HostIdx[dstId];
+}
 
 // for uplink/Downlink monitoring at TOR switches (load balance performance)
 std::map<uint32_t, std::vector<uint32_t>> torId2UplinkIf;
 std::map<uint32_t, std::vector<uint32_t>> torId2DownlinkIf;
 
 // input files
-std::ifstream topof, flowf;
+std::ifstream flowf;
 NodeContainer n;                         // node container
 std::vector<Ipv4Address> serverAddress;  // server address
 
@@ -186,22 +290,164 @@ uint16_t *port_per_host;
 // Scheduling input flows from flow.txt
 struct FlowInput {
     uint32_t src, dst, pg, maxPacketCount, port;
-    double start_time;
+    Time start;  // exact (ns) for flow traces and flowgen
     uint32_t idx;
 };
 FlowInput flow_input = {0};  // global variable
 uint32_t flow_num;
 
+// stop criteria, checked where they can change instead of by polling events (see finish_simulation)
+uint32_t stop_flow_watermark = 0;           // STOP_FLOW_WATERMARK: flow IDs below it finished
+uint32_t cnt_finished_below_watermark = 0;
+double stop_time = 0;                       // STOP_TIME (s): simulated deadline (default:
+                                            // FLOWGEN_STOP_TIME + 10)
+double stop_wallclock = 0;                  // STOP_WALLCLOCK (s): wall-clock budget of the run
+bool simulation_finishing = false;
+std::mutex wallclock_mutex;
+std::condition_variable wallclock_cv;
+bool wallclock_done = false;
+void check_flow_completion();
+
+// PERF_OUTPUT_FILE: performance report of the run (JSON, per MPI rank), e.g. for bench.py
+std::string perf_output_file;
+std::chrono::steady_clock::time_point wall_start, wall_run_start;
+uint64_t allocs_setup[AllocStats::N_SUBSYSTEMS];  // before Simulator::Run
+#ifdef NS3_ALLOC_STATS
+static thread_local bool count_allocs = false;  // set on the simulation thread only
+
+// counts the heap allocations of the simulation thread by subsystem (AllocStats). The array
+// forms and the sized deletes default to these.
+void *operator new(size_t size) {
+    if (count_allocs) AllocStats::Count();
+    void *p = malloc(size ? size : 1);
+    if (p == NULL) throw std::bad_alloc();
+    return p;
+}
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+    if (count_allocs) AllocStats::Count();
+    return malloc(size ? size : 1);
+}
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, const std::nothrow_t &) noexcept { free(p); }
+#ifdef __cpp_aligned_new
+void *operator new(size_t size, std::align_val_t al) {
+    if (count_allocs) AllocStats::Count();
+    void *p = NULL;
+    if (posix_memalign(&p, std::max((size_t)al, sizeof(void *)), size ? size : 1) != 0)
+        throw std::bad_alloc();
+    return p;
+}
+void *operator new(size_t size, std::align_val_t al, const std::nothrow_t &) noexcept {
+    if (count_allocs) AllocStats::Count();
+    void *p = NULL;
+    if (posix_memalign(&p, std::max((size_t)al, sizeof(void *)), size ? size : 1) != 0)
+        return NULL;
+    return p;
+}
+void operator delete(void *p, std::align_val_t) noexcept { free(p); }
+void operator delete(void *p, std::align_val_t, const std::nothrow_t &) noexcept { free(p); }
+#endif
+#endif
+
+// MEM_MON_FILE: memory footprint snapshots <time, component, entries, bytes> (MemStats, the
+// component by its index), every MEM_MON_INTERVAL (us) of periodic_monitoring, and the peaks at
+// the end
+std::string mem_mon_file;
+uint32_t mem_mon_interval = 1000;  // us
+FILE *mem_output = NULL;
+uint32_t mem_channel;
+MemStats mem_stats;
+uint64_t mem_next_snapshot = 0;  // ns
+namespace ns3 {
+extern std::unordered_map<unsigned, Time> acc_pause_time;  // PauseTimeAccounting
+}
+
+// ENABLE_MPI (build configured with --enable-mpi): distributed run over the MPI ranks, e.g.
+// `mpirun -np 4 build/scratch/network-load-balance config.txt`. Every rank builds the whole
+// topology and routing state, but simulates only the nodes of its pods (partition_by_pod), over
+// QbbRemoteChannels between ranks. Flows are started by the rank of their source, and rank 0
+// gathers the FCT and PFC outputs; the other outputs are written per rank (rank_path).
+bool enable_mpi = false;
+uint32_t mpi_rank = 0, mpi_size = 1;
+std::vector<uint32_t> node_rank;  // rank of each node, empty without MPI
+uint32_t flow_num_local = 0;      // flows started by this rank
+inline bool is_local_node(uint32_t id) { return node_rank.empty() || node_rank[id] == mpi_rank; }
+
+// in-simulator flow generation (instead of FLOW_FILE) if flowgen_cdf_file is set
+std::string flowgen_cdf_file;
+std::string flowgen_pattern = "poisson";
+double flowgen_load = 0;  // fraction of the host bandwidth per host
+uint32_t flowgen_incast_fanin = 16;
+FlowGenerator flowgen;
+
+// binary flow trace (instead of FLOW_FILE) if flow_trace_file is set, see flow-trace.h
+std::string flow_trace_file;
+uint64_t flow_trace_window_start = 0, flow_trace_window_stop = UINT64_MAX;  // ns
+FlowTraceReader flow_trace;
+
+// hybrid fluid/packet mode (see fluid-model.h): the flows of at least FLUID_MIN_SIZE bytes, or
+// of priority group FLUID_PG, are rates on their path's links instead of packets
+uint64_t fluid_min_size = 0;    // 0: off
+int fluid_pg = -1;              // -1: none
+double fluid_max_share = 0.9;   // of each link
+double fluid_convergence = 0;   // us, 0: immediate max-min
+FluidModel fluid;
+inline bool is_fluid_flow(uint64_t size, uint32_t pg) {
+    return (fluid_min_size > 0 && size >= fluid_min_size) || (fluid_pg >= 0 && (int)pg == fluid_pg);
+}
+
+// FAST_FORWARD (see fast-forward.h): 1: flows alone on idle links skip the packets, 2: only
+// check the FCT that it would give them against the packet-level one
+uint32_t fast_forward = 0;
+FastForward ff;
+bool ff_start(uint32_t pg, uint32_t src, uint32_t dst, uint32_t sport, uint32_t dport,
+              uint64_t size);
+
+// directed links of the fluid and fast-forward modes, in nbr2if order
+unordered_map<uint64_t, uint32_t> link_id;  // (node << 32 | neighbor) -> link ID
+vector<pair<uint32_t, uint32_t>> link_dev;  // link ID -> (node, interface)
+vector<uint32_t> ecmp_path(uint32_t flowIdx, uint32_t src, uint32_t dst);
+
 /**
- * Read flow input from file "flowf"
+ * Read flow input from file "flowf", or take it from flowgen or flow_trace. With flowgen,
+ * flow_num is unknown (UINT32_MAX) until the generator runs out of flows.
  */
 void ReadFlowInput() {
-    if (flow_input.idx < flow_num) {
+    if (flow_input.idx < flow_num && flow_trace.IsOpen()) {
+        const FlowTraceRecord *r = flow_trace.Next();
+        if (r->size > FlowTraceRecord::MAX_SIZE) {
+            std::cerr << "FLOW_TRACE_FILE: flow " << flow_input.idx << " has " << r->size
+                      << " bytes, above " << FlowTraceRecord::MAX_SIZE << std::endl;
+            exit(1);
+        }
+        flow_input.src = r->src;
+        flow_input.dst = r->dst;
+        flow_input.pg = r->pg;
+        flow_input.maxPacketCount = r->size;
+        flow_input.start = NanoSeconds(r->startNs);
+        assert(flow_input.src < n.GetN() && flow_input.dst < n.GetN() &&
+               n.Get(flow_input.src)->GetNodeType() == 0 &&
+               n.Get(flow_input.dst)->GetNodeType() == 0);
+    } else if (flow_input.idx < flow_num && !flowgen_cdf_file.empty()) {
+        FlowGenerator::Flow f;
+        if (flowgen.Next(f)) {
+            flow_input.src = f.src;
+            flow_input.dst = f.dst;
+            flow_input.pg = 3;
+            flow_input.maxPacketCount = f.size;
+            flow_input.start = NanoSeconds(f.startNs);
+        } else {
+            flow_num = flow_input.idx;
+        }
+    } else if (flow_input.idx < flow_num) {
+        double start_time;
         flowf >> flow_input.src >> flow_input.dst >> flow_input.pg >> flow_input.maxPacketCount >>
-            flow_input.start_time;
+            start_time;
+        flow_input.start = Seconds(start_time);
         assert(n.Get(flow_input.src)->GetNodeType() == 0 &&
                n.Get(flow_input.dst)->GetNodeType() == 0);
-    } else {
+    }
+    if (flow_input.idx >= flow_num) {
         std::cout << "*** input flow is over the prefixed number -- flow number : " << flow_num
                   << std::endl;
         std::cout << "*** flow_input.idx : " << flow_input.idx << std::endl;
@@ -214,7 +460,7 @@ void ReadFlowInput() {
  */
 void ScheduleFlowInputs(FILE *infile) {
     NS_LOG_DEBUG("ScheduleFlowInputs at " << Simulator::Now());
-    while (flow_input.idx < flow_num && Seconds(flow_input.start_time) == Simulator::Now()) {
+    while (flow_input.idx < flow_num && flow_input.start == Simulator::Now()) {
         uint32_t pg, src, dst, sport, dport, maxPacketCount, target_len;
         pg = flow_input.pg;
         src = flow_input.src;
@@ -244,7 +490,7 @@ void ScheduleFlowInputs(FILE *infile) {
              * record flow's 4-tuple
              ************************/
             fprintf(infile, "%u %u %u %u %u %lu\n", src, dst, sport, dport, target_len,
-                    (uint64_t)(flow_input.start_time * (uint64_t)1000000000));
+                    (uint64_t)flow_input.start.GetNanoSeconds());
             fflush(infile);
 
             /***********    FCT Tracking    **************/
@@ -262,22 +508,32 @@ void ScheduleFlowInputs(FILE *infile) {
             apps0s.Stop(Seconds(100.0));
         }  // end of logging input streams
 
-        if (pairRtt.find(n.Get(src)) == pairRtt.end() ||
-            pairRtt[n.Get(src)].find(n.Get(dst)) == pairRtt[n.Get(src)].end()) {
+        if (src >= nodeId2HostIdx.size() || nodeId2HostIdx[src] == UINT32_MAX ||
+            dst >= nodeId2HostIdx.size() || nodeId2HostIdx[dst] == UINT32_MAX) {
             std::cerr << "pairRtt src: " << src << " -> dst: " << dst
                       << " ==> cannot be found from database" << std::endl;
             assert(false);
         }
 
-        RdmaClientHelper clientHelper(
-            pg, serverAddress[src], serverAddress[dst], sport, dport, target_len,
-            has_win ? (global_t == 1 ? maxBdp : pairBdp[n.Get(src)][n.Get(dst)]) : 0,
-            global_t == 1 ? maxRtt : pairRtt[n.Get(src)][n.Get(dst)]);
-        clientHelper.SetAttribute("StatFlowID", IntegerValue(flow_input.idx));
-
-        ApplicationContainer appCon = clientHelper.Install(n.Get(src));  // SRC
-        appCon.Start(Seconds(Time(0)));
-        appCon.Stop(Seconds(100.0));
+        if (is_fluid_flow(target_len, pg)) {
+            FluidModel::Flow f = {flow_input.idx, src, dst, (uint16_t)sport, (uint16_t)dport,
+                                  target_len, Simulator::Now()};
+            fluid.AddFlow(f, ecmp_path(flow_input.idx, src, dst));
+            flow_num_local++;
+        } else if (fast_forward && ff_start(pg, src, dst, sport, dport, target_len)) {
+            flow_num_local++;
+        } else if (is_local_node(src)) {  // with MPI, the rank of the sender starts the flow
+            RdmaClientHelper clientHelper(
+                pg, serverAddress[src], serverAddress[dst], sport, dport, target_len,
+                has_win ? (global_t == 1 ? maxBdp : pairBdp[PairIdx(src, dst)]) : 0,
+                global_t == 1 ? maxRtt : pairRtt[PairIdx(src, dst)]);
+            clientHelper.SetAttribute("StatFlowID", IntegerValue(flow_input.idx));
+
+            ApplicationContainer appCon = clientHelper.Install(n.Get(src));  // SRC
+            appCon.Start(Seconds(Time(0)));
+            appCon.Stop(Seconds(100.0));
+            flow_num_local++;
+        }
 
         flow_input.idx++;
         ReadFlowInput();
@@ -285,22 +541,24 @@ void ScheduleFlowInputs(FILE *infile) {
 
     // schedule the next time to run this function
     if (flow_input.idx < flow_num) {
-        Simulator::Schedule(Seconds(flow_input.start_time) - Simulator::Now(), &ScheduleFlowInputs,
+        Simulator::Schedule(flow_input.start - Simulator::Now(), &ScheduleFlowInputs,
                             infile);
     } else {  // no more flows, close the file
         flowf.close();
+        if (enable_mpi) check_flow_completion();  // a rank may have no flow to wait for
     }
 }
 
 /**
  * @brief CNP frequency monitoring (timestamp nodeId ECN OoO Total)
  */
-void cnp_freq_monitoring(FILE *fout, Ptr<RdmaHw> rdmahw) {
+void cnp_freq_monitoring(uint32_t channel, Ptr<RdmaHw> rdmahw) {
+    AllocStats::Scope allocScope(AllocStats::MONITOR);
     if (rdmahw->cnp_total > 0) {
         // flush
-        fprintf(fout, "%lu %u %u %u %u\n", Simulator::Now().GetNanoSeconds(),
-                rdmahw->m_node->GetId(), rdmahw->cnp_by_ecn, rdmahw->cnp_by_ooo, rdmahw->cnp_total);
-        fflush(fout);
+        monitor_output.Write(channel, {(uint64_t)Simulator::Now().GetNanoSeconds(),
+                                       rdmahw->m_node->GetId(), rdmahw->cnp_by_ecn,
+                                       rdmahw->cnp_by_ooo, rdmahw->cnp_total});
 
         // initialize
         rdmahw->cnp_by_ecn = 0;
@@ -309,7 +567,53 @@ void cnp_freq_monitoring(FILE *fout, Ptr<RdmaHw> rdmahw) {
     }
 
     // recursive callback
-    Simulator::Schedule(NanoSeconds(cnp_monitor_bucket), &cnp_freq_monitoring, fout, rdmahw);
+    Simulator::Schedule(NanoSeconds(cnp_monitor_bucket), &cnp_freq_monitoring, channel, rdmahw);
+}
+
+/**
+ * @brief Memory footprint snapshot (MEM_MON_FILE) of the local nodes and of the program's own
+ * tables, which every MPI rank holds
+ */
+void mem_snapshot(uint64_t now) {
+    mem_stats.Clear();
+    for (uint32_t i = 0; i < n.GetN(); i++) {
+        if (!is_local_node(i)) continue;
+        Ptr<Node> node = n.Get(i);
+        for (uint32_t j = 0; j < node->GetNDevices(); j++) {
+            Ptr<QbbNetDevice> dev = DynamicCast<QbbNetDevice>(node->GetDevice(j));
+            if (dev != NULL) dev->ReportMemory(mem_stats);
+        }
+        if (node->GetNodeType() == 1) {
+            DynamicCast<SwitchNode>(node)->ReportMemory(mem_stats);
+        } else {
+            node->GetObject<RdmaDriver>()->m_rdma->ReportMemory(mem_stats);
+        }
+    }
+
+    uint64_t routeBytes = MemStats::VectorBytes(hostRoutes) + MemStats::VectorBytes(hostIds) +
+                          MemStats::VectorBytes(nodeId2HostIdx) + MemStats::VectorBytes(pairBw) +
+                          MemStats::VectorBytes(pairBdp) + MemStats::VectorBytes(pairRtt);
+    for (const HostRoute &r : hostRoutes) {
+        routeBytes += MemStats::VectorBytes(r.nextHop) + MemStats::VectorBytes(r.delay) +
+                      MemStats::VectorBytes(r.txDelay) + MemStats::VectorBytes(r.bw) +
+                      MemStats::VectorBytes(r.dis);
+        for (const auto &hops : r.nextHop) routeBytes += MemStats::VectorBytes(hops);
+    }
+    for (const auto &nbrs : nbr2if) routeBytes += MemStats::TreeBytes(nbrs);
+    mem_stats.Add(MemStats::ROUTES, pairBw.size(), routeBytes);
+    mem_stats.Add(MemStats::LINK_PAUSE, acc_pause_time.size(), MemStats::HashBytes(acc_pause_time));
+    mem_stats.Add(MemStats::HISTORY, 4,
+                  CongaRouting::m_flowletGapHist.GetMemoryUsage() +
+                      LetflowRouting::m_flowletGapHist.GetMemoryUsage() +
+                      ConWeaveRouting::m_voqSizeHist.GetMemoryUsage() +
+                      ConWeaveVOQ::m_flushEstErrorHist.GetMemoryUsage());
+    mem_stats.UpdatePeaks();
+
+    for (uint32_t c = 0; c < MemStats::N_COMPONENTS; c++) {
+        MemStats::Component comp = (MemStats::Component)c;
+        monitor_output.Write(mem_channel,
+                             {now, c, mem_stats.GetEntries(comp), mem_stats.GetBytes(comp)});
+    }
 }
 
 /**
@@ -317,31 +621,37 @@ void cnp_freq_monitoring(FILE *fout, Ptr<RdmaHw> rdmahw) {
  * - VOQ number and uplink throughput at switches
  * - the number of active connections at RNICS
  */
-void periodic_monitoring(FILE *fout_voq, FILE *fout_voq_detail, FILE *fout_uplink, FILE *fout_conn,
-                         uint32_t *lb_mode) {
+void periodic_monitoring(uint32_t *lb_mode) {
+    AllocStats::Scope allocScope(AllocStats::MONITOR);
     uint32_t lb_mode_val = *lb_mode;
     uint64_t now = Simulator::Now().GetNanoSeconds();
+    if (mem_output != NULL && now >= mem_next_snapshot) {
+        mem_snapshot(now);
+        mem_next_snapshot = now + mem_mon_interval * 1000ull;
+    }
     for (const auto &tor2If : torId2UplinkIf) {  // for each TOR switches
+        if (!is_local_node(tor2If.first)) continue;
         Ptr<Node> node = n.Get(tor2If.first);    // tor id
         auto swNode = DynamicCast<SwitchNode>(node);
         assert(swNode->m_isToR == true);  // sanity check
 
         if (lb_mode_val == 9) {  // Conweave
+            auto conweave = DynamicCast<ConWeaveRouting>(swNode->GetLoadBalancer());
             // monitor VOQ number per switch <time, ToRId, #VOQ, #Pkts>
-            uint32_t nVOQ = swNode->m_mmu->m_conweaveRouting.GetNumVOQ();
-            uint32_t nVolumeVOQ = swNode->m_mmu->m_conweaveRouting.GetVolumeVOQ();
-            fprintf(fout_voq, "%lu,%u,%u,%u\n", now, tor2If.first, nVOQ, nVolumeVOQ);
+            uint32_t nVOQ = conweave->GetNumVOQ();
+            uint32_t nVolumeVOQ = conweave->GetVolumeVOQ();
+            monitor_output.Write(voq_channel, {now, tor2If.first, nVOQ, nVolumeVOQ});
 
             // monitor VOQ per destination IP <time, dstip, #VOQ, #Pkts>
             std::unordered_map<uint32_t, std::pair<uint32_t, uint32_t>> dip_to_nvoq_npkt;
-            for (auto voq : swNode->m_mmu->m_conweaveRouting.GetVOQMap()) {
+            for (auto voq : conweave->GetVOQMap()) {
                 auto &nvoq_npkt = dip_to_nvoq_npkt[voq.second.getDIP()];
                 nvoq_npkt.first += 1;
                 nvoq_npkt.second += voq.second.getQueueSize();
             }
             for (auto x : dip_to_nvoq_npkt) {
-                fprintf(fout_voq_detail, "%lu,%u,%u,%u\n", now, x.first, x.second.first,
-                        x.second.second);
+                monitor_output.Write(voq_detail_channel,
+                                     {now, x.first, x.second.first, x.second.second});
             }
         }
 
@@ -349,13 +659,13 @@ void periodic_monitoring(FILE *fout_voq, FILE *fout_voq_detail, FILE *fout_uplin
         for (const auto &iface : tor2If.second) {
             // monitor uplink txBytes <time, ToRId, OutDev, Bytes>
             uint64_t uplink_txbyte = swNode->GetTxBytesOutDev(iface);
-            fprintf(fout_uplink, "%lu,%u,%u,%lu\n", now, tor2If.first, iface, uplink_txbyte);
+            monitor_output.Write(uplink_channel, {now, tor2If.first, iface, uplink_txbyte});
         }
     }
 
     // common: get number of concurrent connections at each server
     for (uint32_t i = 0; i < Settings::node_num; i++) {
-        if (n.Get(i)->GetNodeType() == 0) {  // is server
+        if (n.Get(i)->GetNodeType() == 0 && is_local_node(i)) {  // is server
             Ptr<Node> server = n.Get(i);
             Ptr<RdmaDriver> rdmaDriver = server->GetObject<RdmaDriver>();
             Ptr<RdmaHw> rdmaHw = rdmaDriver->m_rdma;
@@ -367,18 +677,28 @@ void periodic_monitoring(FILE *fout_voq, FILE *fout_voq_detail, FILE *fout_uplin
                     nActiveQP++;
                 }
             }
-            fprintf(fout_conn, "%lu,%u,%lu,%lu\n", now, i, nQP, nActiveQP);
+            monitor_output.Write(conn_channel, {now, i, nQP, nActiveQP});
         }
     }
 
     if (Simulator::Now() < Seconds(flowgen_stop_time + 0.05)) {
         // recursive callback
-        Simulator::Schedule(NanoSeconds(switch_mon_interval), &periodic_monitoring, fout_voq,
-                            fout_voq_detail, fout_uplink, fout_conn, lb_mode);  // every 10us
+        Simulator::Schedule(NanoSeconds(switch_mon_interval), &periodic_monitoring,
+                            lb_mode);  // every 10us
     }
     return;
 }
 
+/**
+ * @brief One line of the LB history reports, the same for all LB modes
+ */
+void print_histogram(const std::string &name, const HdrHistogram &h) {
+    std::cout << name << ": count " << h.GetCount() << ", avg " << h.GetAvg() << ", min "
+              << h.GetMin() << ", p50 " << h.GetQuantile(0.5) << ", p90 " << h.GetQuantile(0.9)
+              << ", p99 " << h.GetQuantile(0.99) << ", p99.9 " << h.GetQuantile(0.999)
+              << ", max " << h.GetMax() << std::endl;
+}
+
 /**
  * @brief Conga timeout number recording
  */
@@ -386,6 +706,16 @@ void conga_history_print() {
     std::cout << "\n------------CONGA History---------------" << std::endl;
     std::cout << "Number of flowlet's timeout:" << CongaRouting::nFlowletTimeout
               << "Conga's timeout: " << conga_flowletTimeout << std::endl;
+    uint64_t nCollisions = 0;
+    for (uint32_t i = 0; i < n.GetN(); i++) {
+        if (n.Get(i)->GetNodeType() == 1) {
+            Ptr<SwitchNode> sw = DynamicCast<SwitchNode>(n.Get(i));
+            Ptr<CongaRouting> conga = DynamicCast<CongaRouting>(sw->GetLoadBalancer());
+            nCollisions += conga->GetFlowletTable().GetNCollisions();
+        }
+    }
+    std::cout << "Number of flowlet table collisions:" << nCollisions << std::endl;
+    print_histogram("Flowlet gap (ns)", CongaRouting::m_flowletGapHist);
 }
 
 /**
@@ -395,6 +725,16 @@ void letflow_history_print() {
     std::cout << "\n------------Letflow History---------------" << std::endl;
     std::cout << "Number of flowlet's timeout:" << LetflowRouting::nFlowletTimeout
               << "\nLetflow's timeout: " << letflow_flowletTimeout << std::endl;
+    uint64_t nCollisions = 0;
+    for (uint32_t i = 0; i < n.GetN(); i++) {
+        if (n.Get(i)->GetNodeType() == 1) {
+            Ptr<SwitchNode> sw = DynamicCast<SwitchNode>(n.Get(i));
+            Ptr<LetflowRouting> letflow = DynamicCast<LetflowRouting>(sw->GetLoadBalancer());
+            nCollisions += letflow->GetFlowletTable().GetNCollisions();
+        }
+    }
+    std::cout << "Number of flowlet table collisions:" << nCollisions << std::endl;
+    print_histogram("Flowlet gap (ns)", LetflowRouting::m_flowletGapHist);
 }
 
 /**
@@ -419,9 +759,11 @@ void conweave_history_print() {
               << "\nNumber of Rerouting:" << ConWeaveRouting::m_nReRoute
               << "\nNumber of OoO enqueued pkts:" << ConWeaveRouting::m_nOutOfOrderPkts
               << "\nNumber of VOQ Flush Total:" << ConWeaveRouting::m_nFlushVOQTotal
-              << "\nNumber of VOQ Flush From History:" << ConWeaveRouting::m_historyVOQSize.size()
+              << "\nNumber of VOQ Flush From History:" << ConWeaveRouting::m_voqSizeHist.GetCount()
               << "\nNumber of VOQ Flush by TAIL:" << ConWeaveRouting::m_nFlushVOQByTail
               << std::endl;
+    print_histogram("VOQ size at flush (pkts)", ConWeaveRouting::m_voqSizeHist);
+    print_histogram("VOQ flush estimation error (ns)", ConWeaveVOQ::m_flushEstErrorHist);
 
     std::cout << "--------------------------" << std::endl;
 
@@ -431,7 +773,8 @@ void conweave_history_print() {
         if (node->GetNodeType() == 1) {  // switches
             auto swNode = DynamicCast<SwitchNode>(n.Get(ToRId));
             if (swNode->m_isToR) {  // TOR switch
-                uint32_t num_remained_voq = swNode->m_mmu->m_conweaveRouting.GetNumVOQ();
+                uint32_t num_remained_voq =
+                    DynamicCast<ConWeaveRouting>(swNode->GetLoadBalancer())->GetNumVOQ();
                 if (num_remained_voq > 0) {
                     printf("*******************************\n");
                     printf("*** WARNING - Tor Sw (%lu) - VOQ (num=%u) is not flushed yet!! ***\n",
@@ -453,55 +796,293 @@ void conweave_history_print() {
         std::cout << "\n--------------------------" << std::endl;
         std::cout << "Extracting ConWeave Estimation Error Data..." << std::endl;
         est_error_output = fopen(est_error_output_file.c_str(), "w");
-        for (auto x : ConWeaveVOQ::m_flushEstErrorhistory) {
-            fprintf(est_error_output, "%d\n", x);
-        }
-        ConWeaveVOQ::m_flushEstErrorhistory.clear();
+        fprintf(est_error_output, "%s\n", ConWeaveVOQ::m_flushEstErrorHist.Serialize().c_str());
+        fclose(est_error_output);
         std::cout << "---------D O N E---------" << std::endl;
     }
 }
 
 /**
- * @brief When one RDMA is finished, so does (1) QP, (2) RxQP, (3) write it on file fct.txt.
+ * @brief Add a finished flow to the FCT sketches (same filter and slowdown as fctAnalysis.py)
  */
-void qp_finish(FILE *fout, Ptr<RdmaQueuePair> q) {
-    uint32_t sid = Settings::ip_to_node_id(q->sip), did = Settings::ip_to_node_id(q->dip);
-    uint64_t base_rtt = pairRtt[n.Get(sid)][n.Get(did)];
-    uint64_t b = pairBw[n.Get(sid)][n.Get(did)];
-    uint32_t total_bytes =
-        q->m_size + ((q->m_size - 1) / packet_payload_size + 1) *
-                        (CustomHeader::GetStaticWholeHeaderSize() -
-                         IntHeader::GetStaticSize());  // translate to the minimum bytes required
-                                                       // (with header but no INT)
-    uint64_t standalone_fct = base_rtt + total_bytes * 8000000000lu / b;
-
-    // XXX: remove rxQP from the receiver
-    Ptr<Node> dstNode = n.Get(did);
-    Ptr<RdmaDriver> rdma = dstNode->GetObject<RdmaDriver>();
-    rdma->m_rdma->DeleteRxQp(q->sip.Get(), q->sport, q->dport, q->m_pg);
+void fct_sketch_add(uint64_t size, uint64_t start, uint64_t fct, uint64_t standalone_fct) {
+    if (start <= fct_sketch_window_start || start + fct >= fct_sketch_window_end) return;
+    double slowdown = std::max(1.0, (double)fct / standalone_fct);
+    for (uint32_t i = 0; i < fct_sketches.size(); i++) {
+        FctSketch &s = fct_sketches[i];
+        if (i > 0 && (size < s.size_lo || size >= s.size_hi)) continue;
+        s.slowdown.Add(slowdown);
+        s.fct_us.Add(fct / 1000.0);
+    }
+}
+
+/**
+ * @brief Add a finished flow to the steady-state CIs. Once all of them are precise enough, no
+ * more flows are started (flow_num is cut to the flows started so far), and the run ends when the
+ * started ones finish.
+ */
+void ci_add(uint64_t size, uint64_t start, double slowdown) {
+    if (ci_stopped || start < ci_stop_warmup_end) return;
+    bool batchDone = false;
+    for (auto &b : ci_buckets) {
+        if (size >= b.size_lo && size < b.size_hi) batchDone |= b.ci.Add(slowdown);
+    }
+    if (!batchDone) return;
+    for (const auto &b : ci_buckets) {
+        if (!b.ci.IsPrecise(ci_stop_precision, ci_stop_min_batches)) return;
+    }
+    ci_stopped = true;
+    std::cout << "\n*** Slowdown CIs within " << ci_stop_precision * 100 << "% at "
+              << Simulator::Now() << ": no more flows after " << flow_input.idx << std::endl;
+    flow_num = flow_input.idx;  // drain (see check_flow_completion)
+}
+
+void ci_print_report() {
+    std::cout << "Slowdown 95% CI by batch means (" << ci_stop_batch << " flows per batch), "
+              << (ci_stopped ? "precision reached" : "precision NOT reached") << "\n";
+    std::cout << "size range\t#batches\tp50\tp99\n";
+    for (const auto &b : ci_buckets) {
+        double m50, h50, m99, h99;
+        b.ci.GetCi(0, m50, h50);
+        b.ci.GetCi(1, m99, h99);
+        printf("[%lu, %s)\t%u\t%.3f +- %.3f (%.1f%%)\t%.3f +- %.3f (%.1f%%)\n", b.size_lo,
+               b.size_hi == UINT64_MAX ? "inf" : std::to_string(b.size_hi).c_str(),
+               b.ci.GetNBatches(), m50, h50, m50 > 0 ? h50 / m50 * 100 : 0, m99, h99,
+               m99 > 0 ? h99 / m99 * 100 : 0);
+    }
+    fflush(stdout);
+}
+
+/**
+ * @brief Write the current sketches to FCT_SKETCH_FILE (cumulative since the start), one line per
+ * <size bucket, metric>: time lb cc size_lo size_hi metric sketch. utils/fct-sketch-merge merges
+ * the last snapshots of several runs.
+ */
+void fct_sketch_snapshot() {
+    uint64_t now = Simulator::Now().GetTimeStep();
+    for (const auto &s : fct_sketches) {
+        fprintf(fct_sketch_output, "%lu %u %u %lu %lu slowdown %s\n", now, lb_mode, cc_mode,
+                s.size_lo, s.size_hi, s.slowdown.Serialize().c_str());
+        fprintf(fct_sketch_output, "%lu %u %u %lu %lu fct_us %s\n", now, lb_mode, cc_mode,
+                s.size_lo, s.size_hi, s.fct_us.Serialize().c_str());
+    }
+    fflush(fct_sketch_output);
+}
+
+void fct_sketch_periodic() {
+    AllocStats::Scope allocScope(AllocStats::MONITOR);
+    fct_sketch_snapshot();
+    Simulator::Schedule(MicroSeconds(fct_sketch_interval), &fct_sketch_periodic);
+}
+
+void fct_sketch_print_summary() {
+    std::cout << "FCT slowdown (" << fct_sketch_accuracy * 100 << "% relative error)\n";
+    std::cout << "size range\t#flows\tavg\tp50\tp95\tp99\tp99.9\n";
+    for (const auto &s : fct_sketches) {
+        const QuantileSketch &q = s.slowdown;
+        printf("[%lu, %s)\t%lu\t%.3f\t%.3f\t%.3f\t%.3f\t%.3f\n", s.size_lo,
+               s.size_hi == UINT64_MAX ? "inf" : std::to_string(s.size_hi).c_str(), q.GetCount(),
+               q.GetAvg(), q.GetQuantile(0.5), q.GetQuantile(0.95), q.GetQuantile(0.99),
+               q.GetQuantile(0.999));
+    }
+    fflush(stdout);
+}
+
+/**
+ * @brief FCT of a flow alone in the network: base RTT + serialization at the bottleneck.
+ */
+uint64_t get_standalone_fct(uint32_t sid, uint32_t did, uint64_t size) {
+    uint64_t base_rtt = pairRtt[PairIdx(sid, did)];
+    uint64_t b = pairBw[PairIdx(sid, did)];
+    uint64_t total_bytes =
+        size + ((size - 1) / packet_payload_size + 1) *
+                   (CustomHeader::GetStaticWholeHeaderSize() -
+                    IntHeader::GetStaticSize());  // translate to the minimum bytes required
+                                                  // (with header but no INT)
+    // in 128 bits: bytes * 8e9 overflows 64 bits from ~2.3GB
+    return base_rtt + (uint64_t)((__uint128_t)total_bytes * 8000000000lu / b);
+}
+
+/**
+ * @brief Records a finished flow (fct.txt, FCT sketches, CIs) and checks the stop criteria.
+ */
+void flow_finish(uint32_t channel, uint32_t sid, uint32_t did, uint16_t sport, uint16_t dport,
+                 uint64_t size, Time startTime, uint32_t flowId) {
+    uint64_t standalone_fct = get_standalone_fct(sid, did, size);
 
     // fprintf(fout, "%lu QP complete\n", Simulator::Now().GetTimeStep());
-    fprintf(fout, "%u %u %u %u %lu %lu %lu %lu\n", Settings::ip_to_node_id(q->sip),
-            Settings::ip_to_node_id(q->dip), q->sport, q->dport, q->m_size,
-            q->startTime.GetTimeStep(), (Simulator::Now() - q->startTime).GetTimeStep(),
-            standalone_fct);
+    uint64_t start = startTime.GetTimeStep();
+    uint64_t fct = (Simulator::Now() - startTime).GetTimeStep();
+    if (fct_per_flow) {
+        monitor_output.Write(channel, {sid, did, sport, dport, size, start, fct, standalone_fct});
+    }
+    if (!fct_sketches.empty()) fct_sketch_add(size, start, fct, standalone_fct);
+    if (!ci_buckets.empty()) ci_add(size, start, std::max(1.0, (double)fct / standalone_fct));
 
     // for debugging
     NS_LOG_DEBUG("%u %u %u %u %lu %lu %lu %lu\n" %
-                 (Settings::ip_to_node_id(q->sip), Settings::ip_to_node_id(q->dip), q->sport,
-                  q->dport, q->m_size, q->startTime.GetTimeStep(),
-                  (Simulator::Now() - q->startTime).GetTimeStep(), standalone_fct));
+                 (sid, did, sport, dport, size, start, fct, standalone_fct));
+    if (fast_forward) ff.RemoveFlow(flowId, Simulator::Now() - startTime);
     Settings::cnt_finished_flows++;
-    fflush(fout);
+    if (flowId < stop_flow_watermark) {
+        cnt_finished_below_watermark++;
+    }
+    check_flow_completion();
+}
+
+/**
+ * @brief When one RDMA is finished, so does (1) QP, (2) RxQP, (3) write it on file fct.txt.
+ */
+void qp_finish(uint32_t channel, Ptr<RdmaQueuePair> q) {
+    AllocStats::Scope allocScope(AllocStats::MONITOR);
+    uint32_t sid = Settings::ip_to_node_id(q->sip), did = Settings::ip_to_node_id(q->dip);
+
+    // XXX: remove rxQP from the receiver. With MPI, the receiver's rank does not learn when the
+    // sender finishes, so the rxQPs are kept on all ranks: late duplicates are then ACKed
+    // whatever the partition, instead of depending on whether the receiver is local
+    if (!enable_mpi) {
+        Ptr<Node> dstNode = n.Get(did);
+        Ptr<RdmaDriver> rdma = dstNode->GetObject<RdmaDriver>();
+        rdma->m_rdma->DeleteRxQp(q->sip.Get(), q->sport, q->dport, q->m_pg);
+    }
+    flow_finish(channel, sid, did, q->sport, q->dport, q->m_size, q->startTime,
+                q->m_flow_id >= 0 ? (uint32_t)q->m_flow_id : UINT32_MAX);
+}
+
+/**
+ * @brief A path of a flow that follows the routing tables, one of the equal-cost next hops
+ * per node by a hash of the flow (like ECMP). Used for the fluid flows, and to account the
+ * bytes of the fast-forwarded ones.
+ */
+vector<uint32_t> ecmp_path(uint32_t flowIdx, uint32_t src, uint32_t dst) {
+    vector<uint32_t> path;
+    const vector<vector<uint32_t>> &nextHop = hostRoutes[nodeId2HostIdx[dst]].nextHop;
+    for (uint32_t node = src; node != dst;) {
+        const vector<uint32_t> &nh = nextHop[node];
+        assert(!nh.empty());
+        uint64_t h = ((uint64_t)flowIdx << 32 | node) * 0x9E3779B97F4A7C15lu;
+        uint32_t next = nh[(h >> 32) % nh.size()];
+        path.push_back(link_id[(uint64_t)node << 32 | next]);
+        node = next;
+    }
+    return path;
+}
+
+/**
+ * @brief The fluid rate (and standing queue) of a link changed: the packets of the link get
+ * the rest of its rate, and see the queue for ECN marking and the egress threshold.
+ */
+void fluid_link_update(uint32_t link, uint64_t bps, uint32_t queueBytes) {
+    uint32_t node = link_dev[link].first, ifIdx = link_dev[link].second;
+    DynamicCast<QbbNetDevice>(n.Get(node)->GetDevice(ifIdx))->SetFluidRate(bps);
+    if (n.Get(node)->GetNodeType() == 1) {
+        DynamicCast<SwitchNode>(n.Get(node))
+            ->m_mmu->SetFluidQueue(ifIdx, fluid_pg >= 0 ? fluid_pg : 3, queueBytes);
+    }
+}
+
+// a fluid flow finishes when its last byte is sent; it completes once acked, a base RTT later
+void fluid_flow_complete(FluidModel::Flow f) {
+    AllocStats::Scope allocScope(AllocStats::MONITOR);
+    flow_finish(fct_channel, f.src, f.dst, f.sport, f.dport, f.size, f.start, f.id);
+}
+void fluid_flow_sent(const FluidModel::Flow &f) {
+    Simulator::Schedule(NanoSeconds(pairRtt[PairIdx(f.src, f.dst)]), &fluid_flow_complete, f);
+}
+
+/**
+ * @brief Fast-forward: the links that the data and the ACKs of a flow may take, i.e., both
+ * directions of every link of its routes.
+ */
+vector<uint32_t> route_links(uint32_t src, uint32_t dst) {
+    vector<uint32_t> links;
+    const vector<vector<uint32_t>> &nextHop = hostRoutes[nodeId2HostIdx[dst]].nextHop;
+    vector<uint32_t> nodes(1, src);  // visited, BFS order
+    for (uint32_t k = 0; k < nodes.size(); k++) {
+        uint32_t node = nodes[k];
+        for (uint32_t next : nextHop[node]) {
+            links.push_back(link_id[(uint64_t)node << 32 | next]);
+            links.push_back(link_id[(uint64_t)next << 32 | node]);
+            if (std::find(nodes.begin(), nodes.end(), next) == nodes.end()) nodes.push_back(next);
+        }
+    }
+    return links;
+}
+
+/**
+ * @brief A flow starts: registers it with the fast-forward, and returns true if it is
+ * fast-forwarded instead of simulated in packets. It may be, if its links have no queue
+ * and its NIC is not faster than its bottleneck.
+ */
+bool ff_start(uint32_t pg, uint32_t src, uint32_t dst, uint32_t sport, uint32_t dport,
+              uint64_t size) {
+    vector<uint32_t> links = route_links(src, dst);
+    Ptr<QbbNetDevice> nic = DynamicCast<QbbNetDevice>(n.Get(src)->GetDevice(1));
+    bool idle = nic->GetDataRate().GetBitRate() == pairBw[PairIdx(src, dst)];
+    for (uint32_t l : links) {
+        uint32_t node = link_dev[l].first, ifIdx = link_dev[l].second;
+        if (!idle || n.Get(node)->GetNodeType() != 1) continue;
+        Ptr<SwitchMmu> mmu = DynamicCast<SwitchNode>(n.Get(node))->m_mmu;
+        for (uint32_t q = 1; q < SwitchMmu::qCnt; q++) {
+            idle &= mmu->GetEgressQBytes(ifIdx, q) == 0;
+        }
+    }
+    uint32_t payload = packet_payload_size;
+    uint32_t header = CustomHeader::GetStaticWholeHeaderSize() - IntHeader::GetStaticSize();
+    FastForward::Flow f = {flow_input.idx, src, dst, (uint16_t)sport, (uint16_t)dport,
+                           (uint16_t)pg, size, Simulator::Now(),
+                           NanoSeconds(get_standalone_fct(src, dst, size)),
+                           pairBw[PairIdx(src, dst)], payload, payload + header,
+                           NanoSeconds(pairRtt[PairIdx(src, dst)] +
+                                       (payload + header) * 8000000000lu /
+                                           pairBw[PairIdx(src, dst)])};
+    return ff.AddFlow(f, links, idle) && fast_forward == 1;
+}
+
+// credits the switches on the (ECMP) path of a fast-forwarded flow with its sent bytes
+void ff_count_bytes(const FastForward::Flow &f, uint64_t sent) {
+    if (sent == 0) return;
+    uint64_t bytes = sent + (sent - 1) / f.payload * (f.pktBytes - f.payload) + f.pktBytes -
+                     f.payload;  // with the headers of its packets
+    for (uint32_t l : ecmp_path(f.id, f.src, f.dst)) {
+        if (n.Get(link_dev[l].first)->GetNodeType() != 1) continue;
+        DynamicCast<SwitchNode>(n.Get(link_dev[l].first))
+            ->AddTxBytesOutDev(link_dev[l].second, bytes);
+    }
+}
+
+void ff_finish(const FastForward::Flow &f) {
+    AllocStats::Scope allocScope(AllocStats::MONITOR);
+    ff_count_bytes(f, f.size);
+    flow_finish(fct_channel, f.src, f.dst, f.sport, f.dport, f.size, f.start, f.id);
+}
+
+// continues a fast-forwarded flow in packets, after its first `sent` bytes
+void ff_resume(const FastForward::Flow &f, uint64_t sent) {
+    ff_count_bytes(f, sent);
+    Ptr<RdmaHw> srcRdma = n.Get(f.src)->GetObject<RdmaDriver>()->m_rdma;
+    Ptr<RdmaHw> dstRdma = n.Get(f.dst)->GetObject<RdmaDriver>()->m_rdma;
+    uint32_t win = has_win ? (global_t == 1 ? maxBdp : pairBdp[PairIdx(f.src, f.dst)]) : 0;
+    uint64_t baseRtt = global_t == 1 ? maxRtt : pairRtt[PairIdx(f.src, f.dst)];
+    dstRdma->AddRxQp(serverAddress[f.dst].Get(), serverAddress[f.src].Get(), f.dport, f.sport,
+                     f.pg, sent);
+    srcRdma->AddQueuePair(f.size, f.pg, serverAddress[f.src], serverAddress[f.dst], f.sport,
+                          f.dport, win, baseRtt, f.id, f.start, sent);
+}
+
+// a PFC pause stops the link: its fast-forwarded flow goes back to packets
+void ff_pfc(uint32_t link, uint32_t type) {
+    if (type == 1) ff.Touch(link);
 }
 
 /**
  * @brief PFC event logging
  */
-void get_pfc(FILE *fout, Ptr<QbbNetDevice> dev, uint32_t type) {
+void get_pfc(uint32_t channel, Ptr<QbbNetDevice> dev, uint32_t type) {
+    AllocStats::Scope allocScope(AllocStats::MONITOR);
     // time, nodeID, nodeType, Interface's Idx, 0:resume, 1:pause
-    fprintf(fout, "%lu %u %u %u %u\n", Simulator::Now().GetTimeStep(), dev->GetNode()->GetId(),
-            dev->GetNode()->GetNodeType(), dev->GetIfIndex(), type);
+    monitor_output.Write(channel, {(uint64_t)Simulator::Now().GetTimeStep(), dev->GetNode()->GetId(),
+                                   dev->GetNode()->GetNodeType(), dev->GetIfIndex(), type});
 }
 
 /*******************************************************************/
@@ -532,7 +1113,7 @@ void monitor_buffer(FILE *qlen_output, NodeContainer *n) {
             for (uint32_t j = 1; j < sw->GetNDevices(); j++) {
                 uint32_t size = 0;
                 for (uint32_t k = 0; k < SwitchMmu::qCnt; k++)
-                    size += sw->m_mmu->egress_bytes[j][k];
+                    size += sw->m_mmu->GetEgressQBytes(j, k);
                 queue_result[i][j].add(size);
             }
         }
@@ -556,115 +1137,171 @@ void monitor_buffer(FILE *qlen_output, NodeContainer *n) {
 /*******************************************************************/
 
 /**
- * @brief Stop simulation in the middle (when almost all flows are done).
- * This function allows to finish simulation quickly when all messages are sent.
+ * @brief Stop simulation in the middle (when all flows are done, or another stop criterion
+ * is met). This function allows to finish simulation quickly when all messages are sent.
  */
-void stop_simulation_middle() {
-    uint32_t target_flow_num = flow_num - 0;  // can be lower than flownum
-    if (Settings::cnt_finished_flows >= target_flow_num) {
-        std::cout << "\n*** Simulator is enforced to be finished, finished so far: "
-                  << Settings::cnt_finished_flows << "/ total: " << target_flow_num
-                  << ", Time:" << Simulator::Now() << std::endl;
+void finish_simulation(std::string reason) {
+    if (simulation_finishing) return;
+    simulation_finishing = true;
+    std::cout << "\n*** Simulator is enforced to be finished (" << reason
+              << "), finished so far: " << Settings::cnt_finished_flows << "/ total: " << flow_num
+              << ", Time:" << Simulator::Now() << std::endl;
+
+    // schedule conga timeout monitor
+    if (lb_mode == 3) {  // CONGA
+        conga_history_print();
+    }
+    if (lb_mode == 6) {  // LETFLOW
+        letflow_history_print();
+    }
+    if (lb_mode == 9) {  // CONWEAVE
+        conweave_history_print();
+    }
+    Simulator::Stop(NanoSeconds(1));  // finish soon, stop this schedule (NECESSARY!)
+}
 
-        // schedule conga timeout monitor
-        if (lb_mode == 3) {  // CONGA
-            conga_history_print();
-        }
-        if (lb_mode == 6) {  // LETFLOW
-            letflow_history_print();
-        }
-        if (lb_mode == 9) {  // CONWEAVE
-            conweave_history_print();
+/**
+ * @brief Flow completion stop criteria, checked in qp_finish when a flow finishes
+ * (and once at FLOWGEN_START_TIME, for runs without flows).
+ */
+void check_flow_completion() {
+    if (enable_mpi) {  // the ranks stop together once each has finished its own flows
+        if (flow_input.idx >= flow_num && Settings::cnt_finished_flows >= flow_num_local) {
+            finish_simulation("all flows of rank " + std::to_string(mpi_rank) + " finished");
         }
-        Simulator::Stop(NanoSeconds(1));  // finish soon, stop this schedule (NECESSARY!)
-        return;
+    } else if (Settings::cnt_finished_flows >= flow_num) {
+        finish_simulation("all flows finished");
+    } else if (stop_flow_watermark > 0 && cnt_finished_below_watermark >= stop_flow_watermark) {
+        finish_simulation("flows below STOP_FLOW_WATERMARK finished");
     }
+}
 
-    Simulator::Schedule(MicroSeconds(100), &stop_simulation_middle);  // check every 100us
+/**
+ * @brief Waits for the STOP_WALLCLOCK budget (or the end of the run) in its own thread, then hands
+ * the stop to the simulation thread (ScheduleWithContext is thread-safe).
+ */
+void wallclock_watchdog() {
+    std::unique_lock<std::mutex> lock(wallclock_mutex);
+    if (!wallclock_cv.wait_for(lock, std::chrono::duration<double>(stop_wallclock),
+                               [] { return wallclock_done; })) {
+        Simulator::ScheduleWithContext(0xffffffff, Seconds(0), &finish_simulation,
+                                       std::string("STOP_WALLCLOCK budget"));
+    }
 }
 
 /**
  * @brief Calculate edge-to-edge delays, TX delays, and bandwidths
+ * towards a host (BFS rooted at the host). Reads only nbr2if and isSwitch,
+ * so it can run concurrently for different hosts.
  */
-void CalculateRoute(Ptr<Node> host) {
+void CalculateRoute(uint32_t host, const vector<uint8_t> &isSwitch, HostRoute &route) {
+    uint32_t nNode = nbr2if.size();
     // queue for the BFS.
-    vector<Ptr<Node>> q;
+    vector<uint32_t> q;
+    q.reserve(nNode);
+    route.nextHop.assign(nNode, vector<uint32_t>());
     // Distance from the host to each node.
-    map<Ptr<Node>, int> dis;
-    map<Ptr<Node>, uint64_t> delay;
-    map<Ptr<Node>, uint64_t> txDelay;
-    map<Ptr<Node>, uint64_t> bw;
+    route.dis.assign(nNode, -1);
+    route.delay.assign(nNode, 0);
+    route.txDelay.assign(nNode, 0);
+    route.bw.assign(nNode, 0);
     // init BFS.
     q.push_back(host);
-    dis[host] = 0;
-    delay[host] = 0;
-    txDelay[host] = 0;
-    bw[host] = 0xfffffffffffffffflu;
+    route.dis[host] = 0;
+    route.bw[host] = 0xfffffffffffffffflu;
 
     // BFS.
-    for (int i = 0; i < (int)q.size(); i++) {
-        Ptr<Node> now = q[i];
-        int d = dis[now];
+    for (size_t i = 0; i < q.size(); i++) {
+        uint32_t now = q[i];
+        int d = route.dis[now];
         for (auto it = nbr2if[now].begin(); it != nbr2if[now].end(); it++) {
             // skip down link
             if (!it->second.up) continue;
-            Ptr<Node> next = it->first;
+            uint32_t next = it->first;
             // If 'next' have not been visited.
-            if (dis.find(next) == dis.end()) {
-                dis[next] = d + 1;
-                delay[next] = delay[now] + it->second.delay;  // maybe nanoseconds?
-                txDelay[next] = txDelay[now] + packet_payload_size * 1000000000lu * 8 /
-                                                   it->second.bw;  // maybe nanoseconds?
-                bw[next] = std::min(bw[now], it->second.bw);
+            if (route.dis[next] < 0) {
+                route.dis[next] = d + 1;
+                route.delay[next] = route.delay[now] + it->second.delay;  // maybe nanoseconds?
+                route.txDelay[next] = route.txDelay[now] + packet_payload_size * 1000000000lu * 8 /
+                                                               it->second.bw;  // maybe nanoseconds?
+                route.bw[next] = std::min(route.bw[now], it->second.bw);
                 // we only enqueue switch, because we do not want packets to go through host as
                 // middle point
-                if (next->GetNodeType() == 1) {
+                if (isSwitch[next]) {
                     q.push_back(next);
                 }
             }
             // if 'now' is on the shortest path from 'next' to 'host'.
-            if (d + 1 == dis[next]) {
-                nextHop[next][host].push_back(now);
+            if (d + 1 == route.dis[next]) {
+                route.nextHop[next].push_back(now);
             }
         }
     }
-    for (auto it : delay) {
-        pairDelay[it.first][host] = it.second;
-    }
-    for (auto it : txDelay) {
-        pairTxDelay[it.first][host] = it.second;
-    }
-    for (auto it : bw) {
-        pairBw[it.first][host] = it.second;
+}
+
+/**
+ * @brief BFS from every host, in parallel over route_calc_threads threads.
+ * Also updates pairBw (the host-to-host bottleneck bandwidth).
+ */
+void CalculateRoutes(NodeContainer &n, const vector<uint32_t> &hosts) {
+    uint32_t nNode = n.GetN();
+    vector<uint8_t> isSwitch(nNode, 0);
+    for (uint32_t i = 0; i < nNode; i++) isSwitch[i] = (n.Get(i)->GetNodeType() == 1);
+
+    uint32_t nThread = route_calc_threads ? route_calc_threads : std::thread::hardware_concurrency();
+    nThread = std::max(1u, std::min<uint32_t>(nThread, hosts.size()));
+    std::atomic<uint32_t> nextHost(0);
+    auto worker = [&]() {
+        for (uint32_t k = nextHost++; k < hosts.size(); k = nextHost++) {
+            CalculateRoute(hostIds[hosts[k]], isSwitch, hostRoutes[hosts[k]]);
+        }
+    };
+    vector<std::thread> threads;
+    for (uint32_t t = 1; t < nThread; t++) threads.push_back(std::thread(worker));
+    worker();
+    for (auto &t : threads) t.join();
+
+    for (uint32_t dst : hosts) {
+        const HostRoute &route = hostRoutes[dst];
+        for (uint32_t src = 0; src < hostIds.size(); src++) {
+            if (route.dis[hostIds[src]] >= 0)
+                pairBw[(size_t)src * hostIds.size() + dst] = route.bw[hostIds[src]];
+        }
     }
 }
 void CalculateRoutes(NodeContainer &n) {
-    for (int i = 0; i < (int)n.GetN(); i++) {
-        Ptr<Node> node = n.Get(i);
-        if (node->GetNodeType() == 0) {
-            CalculateRoute(node);
+    if (hostIds.empty()) {
+        nodeId2HostIdx.assign(n.GetN(), UINT32_MAX);
+        for (uint32_t i = 0; i < n.GetN(); i++) {
+            if (n.Get(i)->GetNodeType() == 0) {
+                nodeId2HostIdx[i] = hostIds.size();
+                hostIds.push_back(i);
+            }
         }
+        hostRoutes.resize(hostIds.size());
+        pairBw.assign(hostIds.size() * hostIds.size(), 0);
     }
+    vector<uint32_t> hosts(hostIds.size());
+    for (uint32_t h = 0; h < hostIds.size(); h++) hosts[h] = h;
+    CalculateRoutes(n, hosts);
 }
 
 /**
  * @brief Set the Routing Entries object
  */
 void SetRoutingEntries() {
-    // For each node.
-    for (auto i = nextHop.begin(); i != nextHop.end(); i++) {
-        Ptr<Node> node = i->first;
-        auto &table = i->second;
-        for (auto j = table.begin(); j != table.end(); j++) {
-            // The destination node.
-            Ptr<Node> dst = j->first;
-            // The IP address of the dst.
-            Ipv4Address dstAddr = dst->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal();
+    // For each destination host.
+    for (uint32_t h = 0; h < hostIds.size(); h++) {
+        Ptr<Node> dst = n.Get(hostIds[h]);
+        // The IP address of the dst.
+        Ipv4Address dstAddr = dst->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal();
+        const vector<vector<uint32_t>> &nextHop = hostRoutes[h].nextHop;
+        // For each node.
+        for (uint32_t i = 0; i < nextHop.size(); i++) {
+            Ptr<Node> node = n.Get(i);
             // The next hops towards the dst.
-            vector<Ptr<Node>> nexts = j->second;
-            for (int k = 0; k < (int)nexts.size(); k++) {
-                Ptr<Node> next = nexts[k];
-                uint32_t interface = nbr2if[node][next].idx;
+            for (uint32_t next : nextHop[i]) {
+                uint32_t interface = nbr2if[i][next].idx;
                 if (node->GetNodeType() == 1)
                     DynamicCast<SwitchNode>(node)->AddTableEntry(dstAddr, interface);
                 else {
@@ -675,35 +1312,363 @@ void SetRoutingEntries() {
     }
 }
 /**
- * @brief take down the link between a and b, and redo the routing
+ * @brief Extend a path, whose first hop hops end at node, along the BFS next hops
+ * towards the host until the destination ToR swDstId; every complete path goes to paths.
+ */
+void ExtendPaths(uint32_t node, uint32_t hops, PathId pathId, uint32_t swDstId,
+                 const vector<vector<uint32_t>> &nextHop, map<PathId, Time> &paths) {
+    for (uint32_t next : nextHop[node]) {
+        if (hops >= PathCodec::GetMaxHops()) {
+            printf("Too large topology? paths longer than %u hops\n", PathCodec::GetMaxHops());
+            assert(false);
+        }
+        PathCodec::SetOutPort(pathId, hops, nbr2if[node][next].idx);
+        if (next == swDstId) {
+            paths[pathId] = NanoSeconds(one_hop_delay * 2 * (hops + 1));
+        } else {
+            ExtendPaths(next, hops + 1, pathId, swDstId, nextHop, paths);
+        }
+    }
+}
+
+/**
+ * @brief ToR-to-ToR paths (pathId -> base RTT) from the ToR swSrcId towards the host
+ * (index h), following the BFS next hops. A pathId holds the out ports of each hop.
+ */
+void CollectPaths(uint32_t swSrcId, uint32_t h, map<PathId, Time> &paths) {
+    uint32_t dstIP = Settings::hostId2IpMap[hostIds[h]];
+    uint32_t swDstId = Settings::hostIp2SwitchId[dstIP];  // Rx(dst)ToR
+    ExtendPaths(swSrcId, 0, 0, swDstId, hostRoutes[h].nextHop, paths);
+}
+
+/**
+ * @brief Fit the PathIds to the topology: the largest port index of the switches and
+ * the longest ToR-to-ToR route (in switch hops).
+ */
+void ConfigurePathCodec() {
+    uint32_t maxPort = 0, maxHops = 0;
+    for (uint32_t i = 0; i < nbr2if.size(); i++) {
+        if (n.Get(i)->GetNodeType() != 1) continue;
+        for (auto &nbr : nbr2if[i]) maxPort = std::max(maxPort, nbr.second.idx);
+    }
+    for (uint32_t h = 0; h < hostIds.size(); h++) {
+        for (auto &tor : idxNodeToR) {
+            int dis = hostRoutes[h].dis[tor.first];  // the ToR's links to the host
+            if (dis > 1) maxHops = std::max(maxHops, (uint32_t)dis - 1);
+        }
+    }
+    PathCodec::Configure(maxPort, maxHops);
+}
+
+/**
+ * @brief Bring the LBs' path tables (Conga, Letflow, ConWeave) of every ToR in line with
+ * the current routes towards the given destination ToRs: only added/removed paths are applied.
+ */
+void UpdateLbPaths(const set<uint32_t> &dstToRs) {
+    // hosts of each destination ToR
+    map<uint32_t, vector<uint32_t>> torHosts;
+    for (uint32_t h = 0; h < hostIds.size(); h++) {
+        uint32_t swDstId = Settings::hostIp2SwitchId[Settings::hostId2IpMap[hostIds[h]]];
+        if (dstToRs.count(swDstId)) torHosts[swDstId].push_back(h);
+    }
+
+    for (auto &src : idxNodeToR) {
+        uint32_t swSrcId = src.first;
+        Ptr<LoadBalancer> lb = src.second->GetLoadBalancer();
+        for (auto &dst : torHosts) {
+            uint32_t swDstId = dst.first;
+            if (swSrcId == swDstId) {
+                continue;  // if in the same pod, then skip
+            }
+            map<PathId, Time> paths;
+            for (uint32_t h : dst.second) CollectPaths(swSrcId, h, paths);
+
+            set<PathId> &installed = torPairPaths[std::make_pair(swSrcId, swDstId)];
+            for (auto it = installed.begin(); it != installed.end();) {
+                if (paths.find(*it) == paths.end()) {
+                    lb->RemovePath(swDstId, *it);
+                    it = installed.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+            for (auto &path : paths) {
+                if (installed.insert(path.first).second) {
+                    lb->AddPath(swDstId, path.first, path.second);
+                }
+            }
+            if (installed.empty()) {
+                std::cerr << "WARNING: no path from ToR " << swSrcId << " to ToR " << swDstId
+                          << std::endl;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Whether the routes towards a host can change if the link a-b goes down (it is in
+ * the host's shortest-path DAG) or comes up (it would be on a shortest path).
+ */
+bool IsRouteAffected(const HostRoute &route, uint32_t host, uint32_t a, uint32_t b, bool up) {
+    if (!up) {
+        const vector<uint32_t> &na = route.nextHop[a], &nb = route.nextHop[b];
+        return std::find(na.begin(), na.end(), b) != na.end() ||
+               std::find(nb.begin(), nb.end(), a) != nb.end();
+    }
+    // the BFS expands the host itself and switches only
+    bool expandA = (a == host || n.Get(a)->GetNodeType() == 1) && route.dis[a] >= 0;
+    bool expandB = (b == host || n.Get(b)->GetNodeType() == 1) && route.dis[b] >= 0;
+    return (expandA && (route.dis[b] < 0 || route.dis[b] >= route.dis[a] + 1)) ||
+           (expandB && (route.dis[a] < 0 || route.dis[a] >= route.dis[b] + 1));
+}
+
+/**
+ * @brief Repair the routes after the link a-b went down or came up: only the destinations
+ * whose routes can change are recomputed, and only the changed entries are reinstalled.
+ */
+void UpdateRoutes(NodeContainer &n, uint32_t a, uint32_t b, bool up) {
+    vector<uint32_t> affected;
+    for (uint32_t h = 0; h < hostIds.size(); h++) {
+        if (IsRouteAffected(hostRoutes[h], hostIds[h], a, b, up)) affected.push_back(h);
+    }
+
+    vector<vector<vector<uint32_t>>> oldNextHop(affected.size());
+    for (uint32_t k = 0; k < affected.size(); k++) {
+        oldNextHop[k].swap(hostRoutes[affected[k]].nextHop);
+    }
+    CalculateRoutes(n, affected);
+
+    set<uint32_t> redistributeHosts, dstToRs;
+    uint32_t nUpdated = 0;  // (node, destination) entries reinstalled
+    for (uint32_t k = 0; k < affected.size(); k++) {
+        uint32_t h = affected[k];
+        Ptr<Node> dst = n.Get(hostIds[h]);
+        Ipv4Address dstAddr = dst->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal();
+        const vector<vector<uint32_t>> &nextHop = hostRoutes[h].nextHop;
+        for (uint32_t i = 0; i < nextHop.size(); i++) {
+            if (nextHop[i] == oldNextHop[k][i]) continue;
+            nUpdated++;
+            Ptr<Node> node = n.Get(i);
+            if (node->GetNodeType() == 1) {
+                Ptr<SwitchNode> sw = DynamicCast<SwitchNode>(node);
+                sw->RemoveTableEntries(dstAddr);
+                for (uint32_t next : nextHop[i]) sw->AddTableEntry(dstAddr, nbr2if[i][next].idx);
+            } else {
+                Ptr<RdmaHw> rdma = node->GetObject<RdmaDriver>()->m_rdma;
+                rdma->RemoveTableEntries(dstAddr);
+                for (uint32_t next : nextHop[i]) rdma->AddTableEntry(dstAddr, nbr2if[i][next].idx);
+                redistributeHosts.insert(i);
+            }
+        }
+        dstToRs.insert(Settings::hostIp2SwitchId[Settings::hostId2IpMap[hostIds[h]]]);
+    }
+
+    // redistribute qp on the hosts whose routes changed
+    for (uint32_t i : redistributeHosts) {
+        n.Get(i)->GetObject<RdmaDriver>()->m_rdma->RedistributeQp();
+    }
+
+    if (lb_uses_path_table) {
+        UpdateLbPaths(dstToRs);
+    }
+    std::cout << Simulator::Now() << " link " << a << "-" << b << (up ? " up" : " down")
+              << ": rerouted " << affected.size() << "/" << hostIds.size() << " destinations, "
+              << nUpdated << " table entries updated" << std::endl;
+}
+
+/**
+ * @brief take down the link between a and b, and repair the routing
  */
 void TakeDownLink(NodeContainer n, Ptr<Node> a, Ptr<Node> b) {
-    if (!nbr2if[a][b].up) return;
+    uint32_t aId = a->GetId(), bId = b->GetId();
+    if (!nbr2if[aId][bId].up) return;
     // take down link between a and b
-    nbr2if[a][b].up = nbr2if[b][a].up = false;
-    nextHop.clear();
-    CalculateRoutes(n);
-    // clear routing tables
-    for (uint32_t i = 0; i < n.GetN(); i++) {
-        if (n.Get(i)->GetNodeType() == 1)
-            DynamicCast<SwitchNode>(n.Get(i))->ClearTable();
-        else
-            n.Get(i)->GetObject<RdmaDriver>()->m_rdma->ClearTable();
-    }
-    DynamicCast<QbbNetDevice>(a->GetDevice(nbr2if[a][b].idx))->TakeDown();
-    DynamicCast<QbbNetDevice>(b->GetDevice(nbr2if[b][a].idx))->TakeDown();
-    // reset routing table
-    SetRoutingEntries();
+    nbr2if[aId][bId].up = nbr2if[bId][aId].up = false;
+    if (fast_forward) {
+        ff.Touch(link_id[(uint64_t)aId << 32 | bId]);
+        ff.Touch(link_id[(uint64_t)bId << 32 | aId]);
+    }
+    DynamicCast<QbbNetDevice>(a->GetDevice(nbr2if[aId][bId].idx))->TakeDown();
+    DynamicCast<QbbNetDevice>(b->GetDevice(nbr2if[bId][aId].idx))->TakeDown();
+    UpdateRoutes(n, aId, bId, false);
+}
 
-    // redistribute qp on each host
-    for (uint32_t i = 0; i < n.GetN(); i++) {
-        if (n.Get(i)->GetNodeType() == 0)
-            n.Get(i)->GetObject<RdmaDriver>()->m_rdma->RedistributeQp();
+/**
+ * @brief bring the link between a and b up again, and repair the routing
+ */
+void BringUpLink(NodeContainer n, Ptr<Node> a, Ptr<Node> b) {
+    uint32_t aId = a->GetId(), bId = b->GetId();
+    if (nbr2if[aId][bId].up) return;
+    nbr2if[aId][bId].up = nbr2if[bId][aId].up = true;
+    UpdateRoutes(n, aId, bId, true);
+    DynamicCast<QbbNetDevice>(a->GetDevice(nbr2if[aId][bId].idx))->BringUp();
+    DynamicCast<QbbNetDevice>(b->GetDevice(nbr2if[bId][aId].idx))->BringUp();
+}
+
+/**
+ * @brief Output file of this MPI rank: "x.txt" -> "x.rank<r>.txt" for ranks > 0
+ */
+std::string rank_path(const std::string &path, uint32_t rank = mpi_rank) {
+    if (rank == 0) return path;
+    size_t dot = path.rfind('.');
+    size_t slash = path.rfind('/');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) dot = path.size();
+    return path.substr(0, dot) + ".rank" + std::to_string(rank) + path.substr(dot);
+}
+
+/**
+ * @brief Write the performance report (PERF_OUTPUT_FILE) at the end of Simulator::Run. The
+ * simulated time counts from FLOWGEN_START_TIME, as there is no traffic before.
+ */
+void write_perf_output(const std::string &topology) {
+    double wall_setup = std::chrono::duration<double>(wall_run_start - wall_start).count();
+    double wall_run =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_run_start).count();
+    int64_t sim_ns = Simulator::Now().GetNanoSeconds() - llround(flowgen_start_time * 1e9);
+    if (sim_ns < 0) sim_ns = 0;
+    uint64_t events = Simulator::GetEventCount();
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    FILE *f = fopen(rank_path(perf_output_file).c_str(), "w");
+    if (f == NULL) {
+        std::cerr << "cannot write " << perf_output_file << std::endl;
+        return;
+    }
+    fprintf(f, "{\n  \"topology\": \"%s\",\n", topology.c_str());
+    fprintf(f, "  \"lb_mode\": %u, \"cc_mode\": %u, \"irn\": %d, \"pfc\": %d,\n", lb_mode,
+            cc_mode, enable_irn, enable_pfc ? 1 : 0);
+    fprintf(f, "  \"rank\": %u, \"ranks\": %u,\n", mpi_rank, mpi_size);
+    fprintf(f, "  \"finished_flows\": %lu,\n", Settings::cnt_finished_flows);
+    fprintf(f, "  \"wall_setup_s\": %.6f,\n  \"wall_run_s\": %.6f,\n", wall_setup, wall_run);
+    fprintf(f, "  \"sim_ns\": %ld,\n  \"sim_ns_per_wall_s\": %.1f,\n", sim_ns, sim_ns / wall_run);
+    fprintf(f, "  \"events\": %lu,\n  \"events_per_s\": %.1f,\n", events, events / wall_run);
+    fprintf(f, "  \"fwd_pkts\": %lu,\n  \"fwd_pkts_per_s\": %.1f,\n", Settings::fwd_pkt_sw,
+            Settings::fwd_pkt_sw / wall_run);
+    fprintf(f, "  \"nic_pkts\": %lu,\n", RdmaHw::nAllPkts);
+    fprintf(f, "  \"peak_rss_kb\": %ld", usage.ru_maxrss);
+    if (mem_stats.GetNSnapshots() > 0) {
+        fprintf(f, ",\n  \"mem_peak_bytes\": %lu", mem_stats.GetPeakTotalBytes());
+    }
+    if (AllocStats::IsEnabled()) {  // built with --enable-alloc-stats
+        uint64_t setup = 0;
+        for (uint32_t i = 0; i < AllocStats::N_SUBSYSTEMS; i++) setup += allocs_setup[i];
+        fprintf(f, ",\n  \"allocs_setup\": %lu,\n  \"allocs_run\": {", setup);
+        for (uint32_t i = 0; i < AllocStats::N_SUBSYSTEMS; i++) {
+            AllocStats::Subsystem sub = (AllocStats::Subsystem)i;
+            fprintf(f, "%s\"%s\": %lu", i == 0 ? "" : ", ", AllocStats::GetName(sub),
+                    AllocStats::Get(sub) - allocs_setup[i]);
+        }
+        fprintf(f, "}");
+    }
+    fprintf(f, "\n}\n");
+    fclose(f);
+}
+
+/**
+ * @brief Assign the nodes to MPI ranks by pod. Switches are leveled by their hop distance to the
+ * hosts; without the top level (spines, cores), the topology falls apart into pods (a ToR and its
+ * hosts in a leaf-spine, the edge and aggregation switches of a pod in a fat-tree), which go to
+ * the ranks in contiguous blocks. The top-level switches are dealt to the ranks round-robin.
+ */
+std::vector<uint32_t> partition_by_pod(uint32_t nRank, const std::vector<uint32_t> &node_type,
+                                       const std::vector<std::pair<uint32_t, uint32_t>> &links) {
+    uint32_t nNode = node_type.size();
+    std::vector<std::vector<uint32_t>> adj(nNode);
+    for (const auto &l : links) {
+        adj[l.first].push_back(l.second);
+        adj[l.second].push_back(l.first);
+    }
+    std::vector<uint32_t> level(nNode, UINT32_MAX), bfs;
+    for (uint32_t i = 0; i < nNode; i++) {
+        if (node_type[i] == 0) {
+            level[i] = 0;
+            bfs.push_back(i);
+        }
+    }
+    for (size_t h = 0; h < bfs.size(); h++) {
+        for (uint32_t j : adj[bfs[h]]) {
+            if (level[j] == UINT32_MAX) {
+                level[j] = level[bfs[h]] + 1;
+                bfs.push_back(j);
+            }
+        }
+    }
+    uint32_t top = 1;
+    for (uint32_t i = 0; i < nNode; i++) {
+        if (level[i] != UINT32_MAX) top = std::max(top, level[i]);
+    }
+    // with a single switch level, a pod is a ToR and its hosts
+    auto in_pod = [&](uint32_t i) { return level[i] != UINT32_MAX && (top == 1 || level[i] < top); };
+    auto pod_link = [&](uint32_t i, uint32_t j) {
+        return top > 1 || node_type[i] == 0 || node_type[j] == 0;
+    };
+
+    std::vector<uint32_t> pod(nNode, UINT32_MAX);
+    uint32_t nPod = 0;
+    for (uint32_t i = 0; i < nNode; i++) {
+        if (pod[i] != UINT32_MAX || !in_pod(i)) continue;
+        std::vector<uint32_t> stack(1, i);
+        pod[i] = nPod;
+        while (!stack.empty()) {
+            uint32_t u = stack.back();
+            stack.pop_back();
+            for (uint32_t v : adj[u]) {
+                if (pod[v] == UINT32_MAX && in_pod(v) && pod_link(u, v)) {
+                    pod[v] = nPod;
+                    stack.push_back(v);
+                }
+            }
+        }
+        nPod++;
+    }
+    if (nPod < nRank) {
+        std::cerr << "ENABLE_MPI: " << nRank << " ranks for only " << nPod << " pods" << std::endl;
+        exit(1);
+    }
+
+    std::vector<uint32_t> rank(nNode);
+    uint32_t nTop = 0;
+    for (uint32_t i = 0; i < nNode; i++) {
+        rank[i] = pod[i] != UINT32_MAX ? (uint64_t)pod[i] * nRank / nPod : nTop++ % nRank;
+    }
+    std::cout << "MPI: " << nPod << " pods and " << nTop << " top-level switches over " << nRank
+              << " ranks" << std::endl;
+    return rank;
+}
+
+/**
+ * @brief Merge the per-rank files of an output (rank_path) into path at rank 0, in the order of
+ * the time of each line (sum of the given columns, e.g. start + FCT).
+ */
+void gather_rank_outputs(const std::string &path, const std::vector<uint32_t> &timeColumns) {
+    std::vector<std::pair<uint64_t, std::string>> lines;
+    for (uint32_t r = 0; r < mpi_size; r++) {
+        std::string file = rank_path(path, r);
+        std::ifstream in(file.c_str());
+        std::string line;
+        while (std::getline(in, line)) {
+            std::istringstream is(line);
+            std::vector<uint64_t> col;
+            uint64_t v;
+            while (is >> v) col.push_back(v);
+            uint64_t t = 0;
+            for (uint32_t c : timeColumns) t += c < col.size() ? col[c] : 0;
+            lines.emplace_back(t, line);
+        }
+        in.close();
+        if (r > 0) remove(file.c_str());
     }
+    std::stable_sort(lines.begin(), lines.end(),
+                     [](const std::pair<uint64_t, std::string> &a,
+                        const std::pair<uint64_t, std::string> &b) { return a.first < b.first; });
+    FILE *f = fopen(path.c_str(), "w");
+    for (const auto &l : lines) fprintf(f, "%s\n", l.second.c_str());
+    fclose(f);
 }
 
 uint64_t get_nic_rate(NodeContainer &n) {
-    uint64_t avg_nic_rate;
+    uint64_t avg_nic_rate = 0;
     uint64_t n_servers = 0;
     for (uint32_t i = 0; i < n.GetN(); i++) {
         if (n.Get(i)->GetNodeType() == 0) {
@@ -725,6 +1690,7 @@ int main(int argc, char *argv[]) {
     uint32_t *workload_cdf = nullptr;
     clock_t begint, endt;
     begint = clock();
+    wall_start = std::chrono::steady_clock::now();
 #ifndef PGO_TRAINING
     if (argc > 1)
 #else
@@ -761,6 +1727,31 @@ int main(int argc, char *argv[]) {
                 conf >> v;
                 lb_mode = v;
                 std::cerr << "LB_MODE\t\t\t" << lb_mode << "\n";
+            } else if (key.compare("FLOWLET_TABLE_MODE") == 0) {
+                uint32_t v;
+                conf >> v;
+                flowlet_table_mode = v;
+                std::cerr << "FLOWLET_TABLE_MODE\t\t\t" << flowlet_table_mode << "\n";
+            } else if (key.compare("FLOWLET_TABLE_SIZE") == 0) {
+                uint32_t v;
+                conf >> v;
+                flowlet_table_size = v;
+                std::cerr << "FLOWLET_TABLE_SIZE\t\t\t" << flowlet_table_size << "\n";
+            } else if (key.compare("DRILL_SAMPLE_NUM") == 0) {
+                uint32_t v;
+                conf >> v;
+                drill_sample_num = v;
+                std::cerr << "DRILL_SAMPLE_NUM\t\t\t" << drill_sample_num << "\n";
+            } else if (key.compare("DRILL_MEMORY_NUM") == 0) {
+                uint32_t v;
+                conf >> v;
+                drill_memory_num = v;
+                std::cerr << "DRILL_MEMORY_NUM\t\t\t" << drill_memory_num << "\n";
+            } else if (key.compare("DRILL_MEMORY_PER_TOR") == 0) {
+                uint32_t v;
+                conf >> v;
+                drill_memory_per_tor = v;
+                std::cerr << "DRILL_MEMORY_PER_TOR\t\t" << drill_memory_per_tor << "\n";
             } else if (key.compare("SW_MONITORING_INTERVAL") == 0) {
                 uint32_t v;
                 conf >> v;
@@ -889,11 +1880,36 @@ int main(int argc, char *argv[]) {
                 conf >> v;
                 topology_file = v;
                 std::cerr << "TOPOLOGY_FILE\t\t\t" << topology_file << "\n";
+            } else if (key.compare("TOPOLOGY_GEN") == 0) {
+                conf >> topology_gen;
+                std::cerr << "TOPOLOGY_GEN\t\t\t" << topology_gen << "\n";
             } else if (key.compare("FLOW_FILE") == 0) {
                 std::string v;
                 conf >> v;
                 flow_file = v;
                 std::cerr << "FLOW_FILE\t\t\t" << flow_file << "\n";
+            } else if (key.compare("FLOW_TRACE_FILE") == 0) {
+                conf >> flow_trace_file;
+                std::cerr << "FLOW_TRACE_FILE\t\t\t" << flow_trace_file << "\n";
+            } else if (key.compare("FLOW_TRACE_WINDOW") == 0) {
+                // only the trace's flows starting in [start, stop] (seconds)
+                double start, stop;
+                conf >> start >> stop;
+                flow_trace_window_start = (uint64_t)(start * 1e9 + 0.5);
+                flow_trace_window_stop = (uint64_t)(stop * 1e9 + 0.5);
+                std::cerr << "FLOW_TRACE_WINDOW\t\t" << start << " " << stop << "\n";
+            } else if (key.compare("FLOWGEN_CDF_FILE") == 0) {
+                conf >> flowgen_cdf_file;
+                std::cerr << "FLOWGEN_CDF_FILE\t\t" << flowgen_cdf_file << "\n";
+            } else if (key.compare("FLOWGEN_PATTERN") == 0) {
+                conf >> flowgen_pattern;
+                std::cerr << "FLOWGEN_PATTERN\t\t" << flowgen_pattern << "\n";
+            } else if (key.compare("FLOWGEN_LOAD") == 0) {
+                conf >> flowgen_load;
+                std::cerr << "FLOWGEN_LOAD\t\t" << flowgen_load << "\n";
+            } else if (key.compare("FLOWGEN_INCAST_FANIN") == 0) {
+                conf >> flowgen_incast_fanin;
+                std::cerr << "FLOWGEN_INCAST_FANIN\t\t" << flowgen_incast_fanin << "\n";
             } else if (key.compare("FLOWGEN_START_TIME") == 0) {
                 double v;
                 conf >> v;
@@ -908,6 +1924,36 @@ int main(int argc, char *argv[]) {
                 conf >> v;
                 flowgen_stop_time = v;
                 std::cerr << "FLOWGEN_STOP_TIME\t\t" << flowgen_stop_time << "\n";
+            } else if (key.compare("STOP_FLOW_WATERMARK") == 0) {
+                conf >> stop_flow_watermark;
+                std::cerr << "STOP_FLOW_WATERMARK\t\t" << stop_flow_watermark << "\n";
+            } else if (key.compare("STOP_TIME") == 0) {
+                conf >> stop_time;
+                std::cerr << "STOP_TIME\t\t" << stop_time << "\n";
+            } else if (key.compare("PERF_OUTPUT_FILE") == 0) {
+                conf >> perf_output_file;
+                std::cerr << "PERF_OUTPUT_FILE\t\t\t" << perf_output_file << "\n";
+            } else if (key.compare("STOP_WALLCLOCK") == 0) {
+                conf >> stop_wallclock;
+                std::cerr << "STOP_WALLCLOCK\t\t" << stop_wallclock << "\n";
+            } else if (key.compare("FLUID_MIN_SIZE") == 0) {
+                conf >> fluid_min_size;
+                std::cerr << "FLUID_MIN_SIZE\t\t" << fluid_min_size << "\n";
+            } else if (key.compare("FLUID_PG") == 0) {
+                conf >> fluid_pg;
+                std::cerr << "FLUID_PG\t\t\t" << fluid_pg << "\n";
+            } else if (key.compare("FLUID_MAX_SHARE") == 0) {
+                conf >> fluid_max_share;
+                std::cerr << "FLUID_MAX_SHARE\t\t" << fluid_max_share << "\n";
+            } else if (key.compare("FLUID_CONVERGENCE") == 0) {
+                conf >> fluid_convergence;
+                std::cerr << "FLUID_CONVERGENCE\t\t" << fluid_convergence << "\n";
+            } else if (key.compare("FAST_FORWARD") == 0) {
+                conf >> fast_forward;
+                std::cerr << "FAST_FORWARD\t\t" << fast_forward << "\n";
+            } else if (key.compare("ENABLE_MPI") == 0) {
+                conf >> enable_mpi;
+                std::cerr << "ENABLE_MPI\t\t" << enable_mpi << "\n";
             } else if (key.compare("ALPHA_RESUME_INTERVAL") == 0) {
                 double v;
                 conf >> v;
@@ -957,6 +2003,66 @@ int main(int argc, char *argv[]) {
             } else if (key.compare("FCT_OUTPUT_FILE") == 0) {
                 conf >> fct_output_file;
                 std::cerr << "FCT_OUTPUT_FILE\t\t" << fct_output_file << '\n';
+            } else if (key.compare("FCT_SKETCH_FILE") == 0) {
+                conf >> fct_sketch_file;
+                std::cerr << "FCT_SKETCH_FILE\t\t" << fct_sketch_file << '\n';
+            } else if (key.compare("FCT_SKETCH_INTERVAL") == 0) {
+                conf >> fct_sketch_interval;
+                std::cerr << "FCT_SKETCH_INTERVAL\t\t" << fct_sketch_interval << '\n';
+            } else if (key.compare("FCT_SKETCH_ACCURACY") == 0) {
+                conf >> fct_sketch_accuracy;
+                std::cerr << "FCT_SKETCH_ACCURACY\t\t" << fct_sketch_accuracy << '\n';
+            } else if (key.compare("FCT_SKETCH_BUCKETS") == 0) {
+                // <#bounds> <bound 1> ... (bytes, increasing)
+                int n_b;
+                conf >> n_b;
+                std::cerr << "FCT_SKETCH_BUCKETS\t\t";
+                fct_sketch_bounds.resize(n_b);
+                for (int i = 0; i < n_b; i++) {
+                    conf >> fct_sketch_bounds[i];
+                    std::cerr << ' ' << fct_sketch_bounds[i];
+                }
+                std::cerr << '\n';
+            } else if (key.compare("FCT_SKETCH_WINDOW") == 0) {
+                double start_s, end_s;
+                conf >> start_s >> end_s;
+                fct_sketch_window_start = llround(start_s * 1e9);
+                fct_sketch_window_end = llround(end_s * 1e9);
+                std::cerr << "FCT_SKETCH_WINDOW\t\t" << start_s << " " << end_s << '\n';
+            } else if (key.compare("CI_STOP_PRECISION") == 0) {
+                conf >> ci_stop_precision;
+                std::cerr << "CI_STOP_PRECISION\t\t" << ci_stop_precision << '\n';
+            } else if (key.compare("CI_STOP_BATCH") == 0) {
+                conf >> ci_stop_batch;
+                std::cerr << "CI_STOP_BATCH\t\t" << ci_stop_batch << '\n';
+            } else if (key.compare("CI_STOP_MIN_BATCHES") == 0) {
+                conf >> ci_stop_min_batches;
+                std::cerr << "CI_STOP_MIN_BATCHES\t\t" << ci_stop_min_batches << '\n';
+            } else if (key.compare("CI_STOP_WARMUP") == 0) {
+                conf >> ci_stop_warmup;
+                std::cerr << "CI_STOP_WARMUP\t\t" << ci_stop_warmup << '\n';
+            } else if (key.compare("FCT_PER_FLOW") == 0) {
+                uint32_t v;
+                conf >> v;
+                fct_per_flow = v;
+                std::cerr << "FCT_PER_FLOW\t\t" << fct_per_flow << '\n';
+            } else if (key.compare("ASYNC_OUTPUT") == 0) {
+                uint32_t v;
+                conf >> v;
+                async_output = v;
+                std::cerr << "ASYNC_OUTPUT\t\t" << async_output << '\n';
+            } else if (key.compare("MONITOR_FORMAT") == 0) {
+                std::string v;
+                conf >> v;
+                if (v != "text" && v != "columnar") {
+                    std::cerr << "MONITOR_FORMAT must be text or columnar" << std::endl;
+                    exit(1);
+                }
+                monitor_columnar = v == "columnar";
+                std::cerr << "MONITOR_FORMAT\t\t" << v << '\n';
+            } else if (key.compare("ASYNC_OUTPUT_RING") == 0) {
+                conf >> async_output_ring;
+                std::cerr << "ASYNC_OUTPUT_RING\t\t" << async_output_ring << '\n';
             } else if (key.compare("HAS_WIN") == 0) {
                 conf >> has_win;
                 std::cerr << "HAS_WIN\t\t" << has_win << "\n";
@@ -994,9 +2100,40 @@ int main(int argc, char *argv[]) {
                 conf >> pfc_output_file;
                 std::cerr << "PFC_OUTPUT_FILE\t\t\t\t" << pfc_output_file << '\n';
             } else if (key.compare("LINK_DOWN") == 0) {
-                conf >> link_down_time >> link_down_A >> link_down_B;
-                std::cerr << "LINK_DOWN\t\t\t\t" << link_down_time << ' ' << link_down_A << ' '
-                          << link_down_B << '\n';
+                LinkEvent ev;
+                conf >> ev.time >> ev.a >> ev.b;
+                ev.up = false;
+                ev.line = "LINK_DOWN " + std::to_string(ev.time) + ' ' + std::to_string(ev.a) + ' ' +
+                          std::to_string(ev.b);
+                if (ev.time > 0) link_events.push_back(ev);
+                std::cerr << "LINK_DOWN\t\t\t\t" << ev.time << ' ' << ev.a << ' ' << ev.b << '\n';
+            } else if (key.compare("LINK_EVENT_FILE") == 0) {
+                // one event per line: <time (us after FLOWGEN_START_TIME)> <down|up> <A> <B>
+                std::string link_event_file, action;
+                conf >> link_event_file;
+                std::ifstream evf(link_event_file.c_str());
+                if (!evf.is_open()) {
+                    std::cerr << "LINK_EVENT_FILE: cannot open " << link_event_file << std::endl;
+                    exit(1);
+                }
+                LinkEvent ev;
+                std::string line;
+                while (std::getline(evf, line)) {
+                    if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+                    std::istringstream is(line);
+                    std::string extra;
+                    if (!(is >> ev.time >> action >> ev.a >> ev.b) || (is >> extra) ||
+                        (action != "down" && action != "up")) {
+                        std::cerr << "LINK_EVENT_FILE: expected <time> <down|up> <A> <B>, got: "
+                                  << line << std::endl;
+                        exit(1);
+                    }
+                    ev.up = (action == "up");
+                    ev.line = link_event_file + ": " + line;
+                    link_events.push_back(ev);
+                }
+                std::cerr << "LINK_EVENT_FILE\t\t\t\t" << link_event_file << " ("
+                          << link_events.size() << " link events)\n";
             } else if (key.compare("KMAX_MAP") == 0) {
                 int n_k;
                 conf >> n_k;
@@ -1051,6 +2188,12 @@ int main(int argc, char *argv[]) {
             } else if (key.compare("CONN_MON_FILE") == 0) {
                 conf >> conn_mon_file;
                 std::cerr << "CONN_MON_FILE\t\t\t\t" << conn_mon_file << '\n';
+            } else if (key.compare("MEM_MON_FILE") == 0) {
+                conf >> mem_mon_file;
+                std::cerr << "MEM_MON_FILE\t\t\t\t" << mem_mon_file << '\n';
+            } else if (key.compare("MEM_MON_INTERVAL") == 0) {
+                conf >> mem_mon_interval;
+                std::cerr << "MEM_MON_INTERVAL\t\t\t" << mem_mon_interval << '\n';
             } else if (key.compare("QLEN_MON_START") == 0) {
                 conf >> qlen_mon_start;
                 std::cerr << "QLEN_MON_START\t\t\t\t" << qlen_mon_start << '\n';
@@ -1077,6 +2220,21 @@ int main(int argc, char *argv[]) {
                 conf >> v;
                 enable_irn = v;
                 std::cerr << "ENABLE_IRN\t\t" << enable_irn << "\n";
+            } else if (key.compare("POPULATE_IPV4_ROUTES") == 0) {
+                bool v;
+                conf >> v;
+                populate_ipv4_routes = v;
+                std::cerr << "POPULATE_IPV4_ROUTES\t\t" << populate_ipv4_routes << "\n";
+            } else if (key.compare("ROUTE_CALC_THREADS") == 0) {
+                uint32_t v;
+                conf >> v;
+                route_calc_threads = v;
+                std::cerr << "ROUTE_CALC_THREADS\t\t" << route_calc_threads << "\n";
+            } else if (key.compare("PAUSE_TIME_ACCOUNTING") == 0) {
+                bool v;
+                conf >> v;
+                pause_time_accounting = v;
+                std::cerr << "PAUSE_TIME_ACCOUNTING\t\t" << pause_time_accounting << "\n";
             } else if (key.compare("RANDOM_SEED") == 0) {
                 int v;
                 conf >> v;
@@ -1096,6 +2254,66 @@ int main(int argc, char *argv[]) {
 
     /******************* READING CONFIG FILE IS DONE ***********************/
 
+    bool enable_fluid = fluid_min_size > 0 || fluid_pg >= 0;
+    if (enable_fluid && (fluid_max_share <= 0 || fluid_max_share >= 1)) {
+        std::cerr << "FLUID_MAX_SHARE must be in (0, 1), packets keep the rest of each link"
+                  << std::endl;
+        exit(1);
+    }
+    if (enable_fluid && enable_mpi) {
+        std::cerr << "ENABLE_MPI: the fluid mode (FLUID_MIN_SIZE, FLUID_PG) is not supported"
+                  << std::endl;
+        exit(1);
+    }
+    if (fast_forward > 2) {
+        std::cerr << "FAST_FORWARD must be 0 (off), 1 (on) or 2 (only check the FCTs)" << std::endl;
+        exit(1);
+    }
+    // a lone flow of these CCs runs at line rate, so its FCT is the packet-free one
+    if (fast_forward && (enable_mpi || enable_fluid || (cc_mode != 1 && cc_mode != 8))) {
+        std::cerr << "FAST_FORWARD needs CC_MODE 1 (DCQCN) or 8 (DCTCP), and no MPI or fluid "
+                     "mode"
+                  << std::endl;
+        exit(1);
+    }
+
+    /**
+     * @brief Distributed simulation, before anything is scheduled
+     */
+    if (enable_mpi) {
+#ifdef NS3_MPI
+        // orders same-time events independently of the partition (see NextUid), so that any
+        // number of ranks gives the results of the run on one, the reference, which differs
+        // from the DefaultSimulatorImpl run only in the order of the same-time events
+        GlobalValue::Bind("SimulatorImplementationType",
+                          StringValue("ns3::DistributedSimulatorImpl"));
+        MpiInterface::Enable(&argc, &argv);
+        mpi_rank = MpiInterface::GetSystemId();
+        mpi_size = MpiInterface::GetSize();
+        // global stop criteria would need the counts of all ranks
+        if (stop_flow_watermark > 0 || ci_stop_precision > 0 || stop_wallclock > 0) {
+            std::cerr << "ENABLE_MPI: STOP_FLOW_WATERMARK, CI_STOP_PRECISION and STOP_WALLCLOCK "
+                         "are not supported"
+                      << std::endl;
+            exit(1);
+        }
+        // a packet with its headers and tags must fit in one MPI message
+        if (packet_payload_size + 500 > MAX_MPI_MSG_SIZE) {
+            std::cerr << "ENABLE_MPI: PACKET_PAYLOAD_SIZE must be below "
+                      << MAX_MPI_MSG_SIZE - 500 << std::endl;
+            exit(1);
+        }
+#else
+        std::cerr << "ENABLE_MPI: ns-3 is not built with MPI (./waf configure --enable-mpi)"
+                  << std::endl;
+        exit(1);
+#endif
+    }
+
+#ifdef NS3_ALLOC_STATS
+    count_allocs = !perf_output_file.empty();
+#endif
+
     /**
      * Activate ns3 logging
      */
@@ -1116,6 +2334,17 @@ int main(int argc, char *argv[]) {
     Config::SetDefault("ns3::QbbNetDevice::QcnEnabled", BooleanValue(enable_qcn));
     Config::SetDefault("ns3::QbbNetDevice::DynamicThreshold", BooleanValue(dynamicth));
     Config::SetDefault("ns3::QbbNetDevice::QbbEnabled", BooleanValue(enable_pfc));
+    Config::SetDefault("ns3::BEgressQueue::PauseTimeAccounting",
+                       BooleanValue(pause_time_accounting));
+    Config::SetDefault("ns3::RdmaEgressQueue::PauseTimeAccounting",
+                       BooleanValue(pause_time_accounting));
+
+    /**
+     * @brief Load balancer setup
+     */
+    Config::SetDefault("ns3::DrillRouting::SampleNum", UintegerValue(drill_sample_num));
+    Config::SetDefault("ns3::DrillRouting::MemoryNum", UintegerValue(drill_memory_num));
+    Config::SetDefault("ns3::DrillRouting::MemoryPerToR", BooleanValue(drill_memory_per_tor));
 
     if (cc_mode != 1 && lb_mode == 9) {
         std::cout << "Currently, ConWeave supports only DCQCN congestion control for RDMA. \nIf "
@@ -1137,13 +2366,54 @@ int main(int argc, char *argv[]) {
         IntHeader::mode = 5;
 
     /**
-     * @brief open topology config, input-flows config.
+     * @brief load or build the topology, open input-flows config.
      */
-    topof.open(topology_file.c_str());
-    flowf.open(flow_file.c_str());
-    uint32_t node_num, switch_num, link_num;
-    topof >> node_num >> switch_num >> link_num;
-    flowf >> flow_num;
+    DcTopology topo;
+    if (!(topology_gen.empty() ? topo.Load(topology_file) : topo.Build(topology_gen)) ||
+        !topo.Validate()) {
+        std::cerr << "invalid topology " << (topology_gen.empty() ? topology_file : topology_gen)
+                  << std::endl;
+        exit(1);
+    }
+    uint32_t node_num = topo.GetNNodes(), switch_num = topo.GetNSwitches();
+    uint32_t link_num = topo.GetLinks().size();
+    if (!flow_trace_file.empty()) {
+        if (!flow_trace.Open(flow_trace_file)) exit(1);
+        if (flow_trace.GetHeader().hostCount != node_num - switch_num) {
+            std::cerr << "WARNING: FLOW_TRACE_FILE is made for " << flow_trace.GetHeader().hostCount
+                      << " hosts, the topology has " << node_num - switch_num << std::endl;
+        }
+        if (flow_trace_window_start > 0 || flow_trace_window_stop < UINT64_MAX) {
+            flow_trace.SetWindow(flow_trace_window_start, flow_trace_window_stop);
+        }
+        if (flow_trace.GetNRemaining() >= UINT32_MAX) {
+            std::cerr << "FLOW_TRACE_FILE: " << flow_trace.GetNRemaining() << " flows, at most "
+                      << UINT32_MAX - 1 << " per run; narrow it with FLOW_TRACE_WINDOW" << std::endl;
+            exit(1);
+        }
+        flow_num = flow_trace.GetNRemaining();
+    } else if (flowgen_cdf_file.empty()) {
+        flowf.open(flow_file.c_str());
+        flowf >> flow_num;
+    } else {
+        if (!flowgen.LoadCdf(flowgen_cdf_file)) {
+            std::cerr << "FLOWGEN_CDF_FILE: cannot read a valid CDF from " << flowgen_cdf_file
+                      << std::endl;
+            exit(1);
+        }
+        // as for flow traces: the simulated flows have 32-bit sequence numbers
+        if (flowgen.GetMaxSize() > FlowTraceRecord::MAX_SIZE) {
+            std::cerr << "FLOWGEN_CDF_FILE: sizes up to " << (uint64_t)flowgen.GetMaxSize()
+                      << " bytes, above " << FlowTraceRecord::MAX_SIZE << std::endl;
+            exit(1);
+        }
+        if (!(flowgen_load > 0)) {
+            std::cerr << "FLOWGEN_LOAD (fraction of host bandwidth) must be set and positive, got "
+                      << flowgen_load << std::endl;
+            exit(1);
+        }
+        flow_num = UINT32_MAX;  // known when flowgen runs out of flows
+    }
 
     /*-------Parameter of Settings-------*/
     Settings::node_num = node_num;
@@ -1154,26 +2424,47 @@ int main(int argc, char *argv[]) {
     // Settings::MTU = packet_payload_size + 48;  // for simplicity
     /*------------------------------------*/
 
-    std::vector<uint32_t> node_type(node_num, 0);
-    for (uint32_t i = 0; i < switch_num; i++) {
-        uint32_t sid;
-        topof >> sid;
-        node_type[sid] = 1;
+    std::vector<uint32_t> node_type(topo.GetNodeTypes().begin(), topo.GetNodeTypes().end());
+    const std::vector<DcTopology::Link> &topo_links = topo.GetLinks();
+    std::vector<std::pair<uint32_t, uint32_t>> link_pairs;  // src, dst link pairs
+    for (const auto &l : topo_links) link_pairs.push_back(std::make_pair(l.src, l.dst));
+
+    /** ASSUME: fixed one-hop delay across network (paths are ranked by their hop count) */
+    one_hop_delay = Time(topo_links[0].delay).GetNanoSeconds();
+    for (const auto &l : topo_links) {
+        if (Time(l.delay).GetNanoSeconds() != (int64_t)one_hop_delay) {
+            std::cerr << "topology: links " << topo_links[0].delay << " and " << l.delay
+                      << ", all links must have the same delay" << std::endl;
+            exit(1);
+        }
     }
+    if (mpi_rank == 0) {
+        fprintf(stderr, "Topology: %u hosts, %u switches, %u links, up to %u ports per switch\n",
+                node_num - switch_num, switch_num, link_num, topo.GetMaxSwitchPorts());
+    }
+    if (enable_mpi) node_rank = partition_by_pod(mpi_size, node_type, link_pairs);
+
     for (uint32_t i = 0; i < node_num; i++) {
+        uint32_t rank = node_rank.empty() ? 0 : node_rank[i];
         if (node_type[i] == 0)
-            n.Add(CreateObject<Node>());
+            n.Add(CreateObject<Node>(rank));
         else {
-            Ptr<SwitchNode> sw = CreateObject<SwitchNode>();
+            Ptr<SwitchNode> sw = CreateObject<SwitchNode>(rank);
             n.Add(sw);
             sw->SetAttribute("EcnEnabled", BooleanValue(enable_qcn));
+            LoadBalancer::CreateByLbMode(lb_mode)->InstallTo(sw);  // switch's load balancer
         }
     }
     NS_LOG_INFO("Create nodes.");
+    nbr2if.resize(node_num);
 
     /*----------------------------------------*/
 
     InternetStackHelper internet;
+    if (!populate_ipv4_routes) {
+        Ipv4StaticRoutingHelper staticRouting;  // no GlobalRouter per node
+        internet.SetRoutingHelper(staticRouting);
+    }
     internet.Install(n);  // aggregate ipv4, ipv6, udp, tcp, etc
 
     //
@@ -1198,21 +2489,17 @@ int main(int argc, char *argv[]) {
     rem->SetAttribute("ErrorRate", DoubleValue(error_rate_per_link));
     rem->SetAttribute("ErrorUnit", StringValue("ERROR_UNIT_PACKET"));
 
-    pfc_file = fopen(pfc_output_file.c_str(), "w");
+    pfc_file = fopen(rank_path(pfc_output_file).c_str(), "w");
+    pfc_channel = monitor_output.OpenChannel(pfc_file, ' ');
 
     QbbHelper qbb;
     Ipv4AddressHelper ipv4;
-    std::vector<std::pair<uint32_t, uint32_t>> link_pairs;  // src, dst link pairs
     for (uint32_t i = 0; i < link_num; i++) {
-        uint32_t src, dst;
-        std::string data_rate, link_delay;
-        double error_rate;
-        topof >> src >> dst >> data_rate >> link_delay >> error_rate;
-
-        /** ASSUME: fixed one-hop delay across network */
-        assert(std::to_string(one_hop_delay) + "ns" == link_delay);
+        uint32_t src = topo_links[i].src, dst = topo_links[i].dst;
+        const std::string &data_rate = topo_links[i].rate;
+        const std::string &link_delay = topo_links[i].delay;
+        double error_rate = topo_links[i].errorRate;
 
-        link_pairs.push_back(std::make_pair(src, dst));
         Ptr<Node> snode = n.Get(src), dnode = n.Get(dst);
 
         qbb.SetDeviceAttribute("DataRate", StringValue(data_rate));
@@ -1249,20 +2536,20 @@ int main(int argc, char *argv[]) {
         }
 
         // used to create a graph of the topology
-        nbr2if[snode][dnode].idx = DynamicCast<QbbNetDevice>(d.Get(0))->GetIfIndex();
-        nbr2if[snode][dnode].up = true;
-        nbr2if[snode][dnode].delay =
+        nbr2if[src][dst].idx = DynamicCast<QbbNetDevice>(d.Get(0))->GetIfIndex();
+        nbr2if[src][dst].up = true;
+        nbr2if[src][dst].delay =
             DynamicCast<QbbChannel>(DynamicCast<QbbNetDevice>(d.Get(0))->GetChannel())
                 ->GetDelay()
                 .GetTimeStep();
-        nbr2if[snode][dnode].bw = DynamicCast<QbbNetDevice>(d.Get(0))->GetDataRate().GetBitRate();
-        nbr2if[dnode][snode].idx = DynamicCast<QbbNetDevice>(d.Get(1))->GetIfIndex();
-        nbr2if[dnode][snode].up = true;
-        nbr2if[dnode][snode].delay =
+        nbr2if[src][dst].bw = DynamicCast<QbbNetDevice>(d.Get(0))->GetDataRate().GetBitRate();
+        nbr2if[dst][src].idx = DynamicCast<QbbNetDevice>(d.Get(1))->GetIfIndex();
+        nbr2if[dst][src].up = true;
+        nbr2if[dst][src].delay =
             DynamicCast<QbbChannel>(DynamicCast<QbbNetDevice>(d.Get(1))->GetChannel())
                 ->GetDelay()
                 .GetTimeStep();
-        nbr2if[dnode][snode].bw = DynamicCast<QbbNetDevice>(d.Get(1))->GetDataRate().GetBitRate();
+        nbr2if[dst][src].bw = DynamicCast<QbbNetDevice>(d.Get(1))->GetDataRate().GetBitRate();
 
         // This is just to set up the connectivity between nodes. The IP addresses are useless
         char ipstring[16];
@@ -1273,9 +2560,9 @@ int main(int argc, char *argv[]) {
 
         // setup PFC trace
         DynamicCast<QbbNetDevice>(d.Get(0))->TraceConnectWithoutContext(
-            "QbbPfc", MakeBoundCallback(&get_pfc, pfc_file, DynamicCast<QbbNetDevice>(d.Get(0))));
+            "QbbPfc", MakeBoundCallback(&get_pfc, pfc_channel, DynamicCast<QbbNetDevice>(d.Get(0))));
         DynamicCast<QbbNetDevice>(d.Get(1))->TraceConnectWithoutContext(
-            "QbbPfc", MakeBoundCallback(&get_pfc, pfc_file, DynamicCast<QbbNetDevice>(d.Get(1))));
+            "QbbPfc", MakeBoundCallback(&get_pfc, pfc_channel, DynamicCast<QbbNetDevice>(d.Get(1))));
     }
 
     std::cout << "(AVG) NIC RATE: " << get_nic_rate(n) << std::endl;
@@ -1323,15 +2610,24 @@ int main(int argc, char *argv[]) {
             sw->m_mmu->ConfigBufferSize(buffer_size * 1024 *
                                         1024);  // default 0, specify in run.py!!
             sw->m_mmu->node_id = sw->GetId();
+            if (sw->m_mmu->GetReservedBytes() >= sw->m_mmu->GetMmuBufferBytes()) {
+                NS_FATAL_ERROR("switch " << i << ": " << sw->GetNDevices() - 1 << " ports reserve "
+                                         << sw->m_mmu->GetReservedBytes()
+                                         << "B of PFC headroom and guarantees, the buffer is "
+                                         << sw->m_mmu->GetMmuBufferBytes()
+                                         << "B; raise BUFFER_SIZE");
+            }
             NS_LOG_INFO("Node %u : Broadcom switch (%u ports / %gMB MMU)\n" %
                         (i, sw->GetNDevices() - 1, sw->m_mmu->GetMmuBufferBytes() / 1000000.));
         }
     }
 
-    fct_output = fopen(fct_output_file.c_str(), "w");
+    fct_output = fopen(rank_path(fct_output_file).c_str(), "w");
+    fct_channel = monitor_output.OpenChannel(fct_output, ' ');
     flow_input_stream = fopen(flow_input_file.c_str(), "w");
     if (cc_mode == 1) {
-        cnp_output = fopen(cnp_output_file.c_str(), "w");
+        cnp_output = fopen(rank_path(cnp_output_file).c_str(), "w");
+        cnp_channel = monitor_output.OpenChannel(cnp_output, ' ');
     }
 
     /**
@@ -1362,28 +2658,6 @@ int main(int argc, char *argv[]) {
      *new rate can be divided by 2 at maximum)
      */
 
-    // manually type BDP
-    std::map<std::string, uint32_t> topo2bdpMap;
-    topo2bdpMap[std::string("leaf_spine_128_100G_OS2")] = 104000;  // RTT=8320
-    topo2bdpMap[std::string("fat_k8_100G_OS2")] = 156000;      // RTT=12480 --> all 100G links
-
-    // topology_file
-    bool found_topo2bdpMap = false;
-    uint32_t irn_bdp_lookup = 0;
-    for (auto pair : topo2bdpMap) {
-        if (topology_file.find(pair.first) !=
-            std::string::npos) {  // if topology file string includes the word
-            irn_bdp_lookup = pair.second;
-            found_topo2bdpMap = true;
-            break;
-        }
-    }
-    if (found_topo2bdpMap == false) {
-        std::cout << __FILE__ << "(" << __LINE__ << ")"
-                  << " ERROR - topo2bdpMap has no matched item with " << topology_file << std::endl;
-        assert(false);
-    }
-
     // rdmaHw config
     for (uint32_t i = 0; i < node_num; i++) {
         if (n.Get(i)->GetNodeType() == 0) {  // is server
@@ -1412,13 +2686,11 @@ int main(int argc, char *argv[]) {
             rdmaHw->SetAttribute("RateBound", BooleanValue(rate_bound));
             rdmaHw->SetAttribute("DctcpRateAI", DataRateValue(DataRate(dctcp_rate_ai)));
             rdmaHw->SetAttribute("IrnEnable", BooleanValue(enable_irn));
-            // topo2bdpMap (e.g., longest BDP 25000: 8us * 25Gbps)
             rdmaHw->SetAttribute("IrnRtoHigh", TimeValue(MicroSeconds(320)));  // 1930
             rdmaHw->SetAttribute("IrnRtoLow", TimeValue(MicroSeconds(100)));   // 454
-            rdmaHw->SetAttribute("IrnBdp", UintegerValue(irn_bdp_lookup));
             // Monitoring CNP Marking frequency of DCQCN
-            if (cc_mode == 1) {
-                Simulator::Schedule(NanoSeconds(cnp_mon_start), &cnp_freq_monitoring, cnp_output,
+            if (cc_mode == 1 && is_local_node(i)) {
+                Simulator::Schedule(NanoSeconds(cnp_mon_start), &cnp_freq_monitoring, cnp_channel,
                                     rdmaHw);
             }
 
@@ -1431,7 +2703,7 @@ int main(int argc, char *argv[]) {
             node->AggregateObject(rdma);
             rdma->Init();
             rdma->TraceConnectWithoutContext("QpComplete",
-                                             MakeBoundCallback(qp_finish, fct_output));
+                                             MakeBoundCallback(qp_finish, fct_channel));
         }
     }
 
@@ -1457,26 +2729,34 @@ int main(int argc, char *argv[]) {
      */
     maxRtt = maxBdp = 0;
     fprintf(stderr, "node_num=%d\n", node_num);
-    for (uint32_t i = 0; i < node_num; i++) {
-        if (n.Get(i)->GetNodeType() != 0) continue;
-        for (uint32_t j = i + 1; j < node_num; j++) {
-            if (n.Get(j)->GetNodeType() != 0) continue;
-            uint64_t delay = pairDelay[n.Get(i)][n.Get(j)];
-            uint64_t txDelay = pairTxDelay[n.Get(i)][n.Get(j)];
+    size_t hostNum = hostIds.size();
+    pairBdp.assign(hostNum * hostNum, 0);
+    pairRtt.assign(hostNum * hostNum, 0);
+    for (uint32_t i = 0; i < hostNum; i++) {
+        for (uint32_t j = i + 1; j < hostNum; j++) {
+            const HostRoute &route = hostRoutes[j];  // towards host j
+            uint64_t delay = route.delay[hostIds[i]];
+            uint64_t txDelay = route.txDelay[hostIds[i]];
             uint64_t rtt = delay * 2 + txDelay;
-            uint64_t bw = pairBw[n.Get(i)][n.Get(j)];
+            uint64_t bw = pairBw[i * hostNum + j];
             uint64_t bdp = rtt * bw / 1000000000 / 8;
-            pairBdp[n.Get(i)][n.Get(j)] = bdp;
-            pairBdp[n.Get(j)][n.Get(i)] = bdp;
-            pairRtt[n.Get(i)][n.Get(j)] = rtt;
-            pairRtt[n.Get(j)][n.Get(i)] = rtt;
+            pairBdp[i * hostNum + j] = bdp;
+            pairBdp[j * hostNum + i] = bdp;
+            pairRtt[i * hostNum + j] = rtt;
+            pairRtt[j * hostNum + i] = rtt;
 
             if (bdp > maxBdp) maxBdp = bdp;
             if (rtt > maxRtt) maxRtt = rtt;
         }
     }
     fprintf(stderr, "maxRtt: %lu, maxBdp: %lu\n", maxRtt, maxBdp);
-    assert(maxBdp == irn_bdp_lookup);
+    // IRN's window is the longest BDP (e.g., 104000: 8320ns * 100Gbps in leaf_spine_128_100G)
+    for (uint32_t i = 0; i < node_num; i++) {
+        if (n.Get(i)->GetNodeType() == 0) {
+            n.Get(i)->GetObject<RdmaDriver>()->m_rdma->SetAttribute("IrnBdp",
+                                                                    UintegerValue(maxBdp));
+        }
+    }
 
     std::cout << "Configuring switches" << std::endl;
     /* config ToR Switch */
@@ -1490,217 +2770,95 @@ int main(int argc, char *argv[]) {
             sw->m_isToR = true;
             uint32_t hostIP = serverAddress[pair.first].Get();
             sw->m_isToR_hostIP.insert(hostIP);
+            Settings::hostIp2SwitchId[hostIP] = sw->GetId();  // hostIP -> connected switch's ID
             if (idxNodeToR.find(sw->GetId()) == idxNodeToR.end()) {
                 idxNodeToR[sw->GetId()] = sw;
             };
         }
     }
 
-    /* config load balancer's switches using ToR-to-ToR routing */
-    if (lb_mode == 3 || lb_mode == 6 || lb_mode == 9) {  // Conga, Letflow, Conweave
-        NS_LOG_INFO("Configuring Load Balancer's Switches");
-        for (auto &pair : link_pairs) {
-            Ptr<Node> probably_host = n.Get(pair.first);
-            Ptr<Node> probably_switch = n.Get(pair.second);
-
-            // host-switch link
-            if (probably_host->GetNodeType() == 0 && probably_switch->GetNodeType() == 1) {
-                Ptr<SwitchNode> sw = DynamicCast<SwitchNode>(probably_switch);
-                uint32_t hostIP = serverAddress[pair.first].Get();
-                Settings::hostIp2SwitchId[hostIP] = sw->GetId();  // hostIP -> connected switch's ID
-            }
+    /* config load balancer's switches using ToR-to-ToR routing (e.g., Conga, Letflow, Conweave) */
+    for (uint32_t i = 0; i < node_num; i++) {
+        if (n.Get(i)->GetNodeType() == 1) {
+            Ptr<SwitchNode> sw = DynamicCast<SwitchNode>(n.Get(i));
+            lb_uses_path_table |= sw->GetLoadBalancer()->UsesPathTable();
         }
-
+    }
+    if (lb_uses_path_table) {
+        NS_LOG_INFO("Configuring Load Balancer's Switches");
         // Conga: m_congaFromLeafTable, m_congaToLeafTable, m_congaRoutingTable
         // Letflow: m_letflowRoutingTable
         // Conweave: m_ConWeaveRoutingTable, m_rxToRId2BaseRTT
-        for (auto i = nextHop.begin(); i != nextHop.end(); i++) {  // every node
-            if (i->first->GetNodeType() == 1) {                    // switch
-                Ptr<Node> nodeSrc = i->first;
-                Ptr<SwitchNode> swSrc = DynamicCast<SwitchNode>(nodeSrc);  // switch
-                uint32_t swSrcId = swSrc->GetId();
-
-                if (swSrc->m_isToR) {
-                    // printf("--- ToR Switch %d\n", swSrcId);
-
-                    auto table1 = i->second;
-                    for (auto j = table1.begin(); j != table1.end(); j++) {
-                        Ptr<Node> dst = j->first;  // dst
-                        uint32_t dstIP = Settings::hostId2IpMap[dst->GetId()];
-                        uint32_t swDstId = Settings::hostIp2SwitchId[dstIP];  // Rx(dst)ToR
-
-                        if (swSrcId == swDstId) {
-                            continue;  // if in the same pod, then skip
-                        }
-
-                        if (lb_mode == 3) {
-                            // initialize `m_congaFromLeafTable` and `m_congaToLeafTable`
-                            swSrc->m_mmu->m_congaRouting
-                                .m_congaFromLeafTable[swDstId];  // dynamically will be added in
-                                                                 // conga
-                            swSrc->m_mmu->m_congaRouting.m_congaToLeafTable[swDstId];
-                        }
-
-                        // construct paths
-                        uint32_t pathId;
-                        uint8_t path_ports[4] = {0, 0, 0, 0};  // interface is always large than 0
-                        vector<Ptr<Node>> nexts1 = j->second;
-                        for (auto next1 : nexts1) {
-                            uint32_t outPort1 = nbr2if[nodeSrc][next1].idx;
-                            auto nexts2 = nextHop[next1][dst];
-                            if (nexts2.size() == 1 && nexts2[0]->GetId() == swDstId) {
-                                // this destination has 2-hop distance
-                                uint32_t outPort2 = nbr2if[next1][nexts2[0]].idx;
-                                // printf("[IntraPod-2hop] %d (%d)-> %d (%d) -> %d -> %d\n",
-                                // nodeSrc->GetId(), outPort1, next1->GetId(), outPort2,
-                                // nexts2[0]->GetId(), dst->GetId());
-                                path_ports[0] = (uint8_t)outPort1;
-                                path_ports[1] = (uint8_t)outPort2;
-                                pathId = *((uint32_t *)path_ports);
-                                if (lb_mode == 3) {
-                                    swSrc->m_mmu->m_congaRouting.m_congaRoutingTable[swDstId]
-                                        .insert(pathId);
-                                }
-                                if (lb_mode == 6) {
-                                    swSrc->m_mmu->m_letflowRouting.m_letflowRoutingTable[swDstId]
-                                        .insert(pathId);
-                                }
-                                if (lb_mode == 9) {
-                                    swSrc->m_mmu->m_conweaveRouting.m_ConWeaveRoutingTable[swDstId]
-                                        .insert(pathId);
-                                    swSrc->m_mmu->m_conweaveRouting.m_rxToRId2BaseRTT[swDstId] =
-                                        one_hop_delay * 4;
-                                }
-                                continue;
-                            }
-
-                            for (auto next2 : nexts2) {
-                                uint32_t outPort2 = nbr2if[next1][next2].idx;
-                                auto nexts3 = nextHop[next2][dst];
-                                if (nexts3.size() == 1 && nexts3[0]->GetId() == swDstId) {
-                                    // this destination has 3-hop distance
-                                    uint32_t outPort3 = nbr2if[next2][nexts3[0]].idx;
-                                    // printf("[IntraPod-3hop] %d (%d)-> %d (%d) -> %d (%d) -> %d ->
-                                    // %d\n", nodeSrc->GetId(), outPort1, next1->GetId(), outPort2,
-                                    // next2->GetId(), outPort3, nexts3[0]->GetId(), dst->GetId());
-                                    path_ports[0] = (uint8_t)outPort1;
-                                    path_ports[1] = (uint8_t)outPort2;
-                                    path_ports[2] = (uint8_t)outPort3;
-                                    pathId = *((uint32_t *)path_ports);
-                                    if (lb_mode == 3) {
-                                        swSrc->m_mmu->m_congaRouting.m_congaRoutingTable[swDstId]
-                                            .insert(pathId);
-                                    }
-                                    if (lb_mode == 6) {
-                                        swSrc->m_mmu->m_letflowRouting
-                                            .m_letflowRoutingTable[swDstId]
-                                            .insert(pathId);
-                                    }
-                                    if (lb_mode == 9) {
-                                        swSrc->m_mmu->m_conweaveRouting
-                                            .m_ConWeaveRoutingTable[swDstId]
-                                            .insert(pathId);
-                                        swSrc->m_mmu->m_conweaveRouting.m_rxToRId2BaseRTT[swDstId] =
-                                            one_hop_delay * 6;
-                                    }
-                                    continue;
-                                }
-
-                                for (auto next3 : nexts3) {
-                                    uint32_t outPort3 = nbr2if[next2][next3].idx;
-                                    auto nexts4 = nextHop[next3][dst];
-                                    if (nexts4.size() == 1 && nexts4[0]->GetId() == swDstId) {
-                                        // this destination has 4-hop distance
-                                        uint32_t outPort4 = nbr2if[next3][nexts4[0]].idx;
-                                        // printf("[IntraPod-4hop] %d (%d)-> %d (%d) -> %d (%d) ->
-                                        // %d (%d) -> %d -> %d\n", nodeSrc->GetId(), outPort1,
-                                        // next1->GetId(), outPort2, next2->GetId(), outPort3,
-                                        // next3->GetId(), outPort4, nexts4[0]->GetId(),
-                                        // dst->GetId());
-                                        path_ports[0] = (uint8_t)outPort1;
-                                        path_ports[1] = (uint8_t)outPort2;
-                                        path_ports[2] = (uint8_t)outPort3;
-                                        path_ports[3] = (uint8_t)outPort4;
-                                        pathId = *((uint32_t *)path_ports);
-                                        if (lb_mode == 3) {
-                                            swSrc->m_mmu->m_congaRouting
-                                                .m_congaRoutingTable[swDstId]
-                                                .insert(pathId);
-                                        }
-                                        if (lb_mode == 6) {
-                                            swSrc->m_mmu->m_letflowRouting
-                                                .m_letflowRoutingTable[swDstId]
-                                                .insert(pathId);
-                                        }
-                                        if (lb_mode == 9) {
-                                            swSrc->m_mmu->m_conweaveRouting
-                                                .m_ConWeaveRoutingTable[swDstId]
-                                                .insert(pathId);
-                                            swSrc->m_mmu->m_conweaveRouting
-                                                .m_rxToRId2BaseRTT[swDstId] = one_hop_delay * 8;
-                                        }
-                                        continue;
-                                    } else {
-                                        printf("Too large topology?\n");
-                                        assert(false);
-                                    }
-                                }
-                            }
-                        }
-                    }
-                }
-            }
-        }
-
-        // m_outPort2BitRateMap - only for Conga
-        for (auto i = nextHop.begin(); i != nextHop.end(); i++) {  // every node
-            if (i->first->GetNodeType() == 1) {                    // switch
-                Ptr<Node> node = i->first;
-                Ptr<SwitchNode> sw = DynamicCast<SwitchNode>(node);  // switch
-                uint32_t swId = sw->GetId();
-
-                auto table = i->second;
-                for (auto j = table.begin(); j != table.end(); j++) {
-                    Ptr<Node> dst = j->first;  // dst
-                    uint32_t dstIP = Settings::hostId2IpMap[dst->GetId()];
-                    uint32_t swDstId = Settings::hostIp2SwitchId[dstIP];
-
-                    for (auto next : j->second) {
+        ConfigurePathCodec();
+        set<uint32_t> allToRs;
+        for (auto &tor : idxNodeToR) allToRs.insert(tor.first);
+        UpdateLbPaths(allToRs);
+
+        // link capacity (e.g., Conga's m_outPort2BitRateMap)
+        for (uint32_t i = 0; i < node_num; i++) {  // every node
+            if (n.Get(i)->GetNodeType() == 1) {    // switch
+                uint32_t node = i;
+                Ptr<SwitchNode> sw = DynamicCast<SwitchNode>(n.Get(i));  // switch
+
+                for (uint32_t h = 0; h < hostIds.size(); h++) {  // dst
+                    for (auto next : hostRoutes[h].nextHop[node]) {
                         uint32_t outPort = nbr2if[node][next].idx;
                         uint64_t bw = nbr2if[node][next].bw;
-                        sw->m_mmu->m_congaRouting.SetLinkCapacity(outPort, bw);
-                        // printf("Node: %d, interface: %d, bw: %lu\n", swId, outPort, bw);
+                        sw->GetLoadBalancer()->SetLinkCapacity(outPort, bw);
+                        // printf("Node: %d, interface: %d, bw: %lu\n", node, outPort, bw);
                     }
                 }
             }
         }
 
         // Constant setup, and switchInfo
-        for (auto i = nextHop.begin(); i != nextHop.end(); i++) {  // every node
-            if (i->first->GetNodeType() == 1) {
-                Ptr<Node> node = i->first;
-                Ptr<SwitchNode> sw = DynamicCast<SwitchNode>(node);  // switch
+        for (uint32_t i = 0; i < node_num; i++) {  // every node
+            if (n.Get(i)->GetNodeType() == 1) {
+                Ptr<SwitchNode> sw = DynamicCast<SwitchNode>(n.Get(i));  // switch
                 NS_LOG_INFO("Switch Info - ID:%u, ToR:%d\n" % (sw->GetId(), sw->m_isToR));
                 if (lb_mode == 3) {
-                    sw->m_mmu->m_congaRouting.SetConstants(conga_dreTime, conga_agingTime,
-                                                           conga_flowletTimeout, conga_quantizeBit,
-                                                           conga_alpha);
-                    sw->m_mmu->m_congaRouting.SetSwitchInfo(sw->m_isToR, sw->GetId());
+                    Ptr<CongaRouting> conga = DynamicCast<CongaRouting>(sw->GetLoadBalancer());
+                    conga->SetConstants(conga_dreTime, conga_agingTime, conga_flowletTimeout,
+                                        conga_quantizeBit, conga_alpha);
+                    conga->SetFlowletTableMode((FlowletTable::Mode)flowlet_table_mode,
+                                               flowlet_table_size);
                 }
                 if (lb_mode == 6) {
-                    sw->m_mmu->m_letflowRouting.SetConstants(letflow_agingTime,
-                                                             letflow_flowletTimeout);
-                    sw->m_mmu->m_letflowRouting.SetSwitchInfo(sw->m_isToR, sw->GetId());
+                    Ptr<LetflowRouting> letflow =
+                        DynamicCast<LetflowRouting>(sw->GetLoadBalancer());
+                    letflow->SetConstants(letflow_agingTime, letflow_flowletTimeout);
+                    letflow->SetFlowletTableMode((FlowletTable::Mode)flowlet_table_mode,
+                                                 flowlet_table_size);
                 }
                 if (lb_mode == 9) {
-                    sw->m_mmu->m_conweaveRouting.SetConstants(
-                        conweave_extraReplyDeadline, conweave_extraVOQFlushTime,
-                        conweave_txExpiryTime, conweave_defaultVOQWaitingTime,
-                        conweave_pathPauseTime, conweave_pathAwareRerouting);
-                    sw->m_mmu->m_conweaveRouting.SetSwitchInfo(sw->m_isToR, sw->GetId());
+                    Ptr<ConWeaveRouting> conweave =
+                        DynamicCast<ConWeaveRouting>(sw->GetLoadBalancer());
+                    conweave->SetConstants(conweave_extraReplyDeadline, conweave_extraVOQFlushTime,
+                                           conweave_txExpiryTime, conweave_defaultVOQWaitingTime,
+                                           conweave_pathPauseTime, conweave_pathAwareRerouting);
                 }
+                sw->GetLoadBalancer()->SetSwitchInfo(sw->m_isToR, sw->GetId());
+            }
+        }
+
+        // path encoding, and what it costs per packet and per switch
+        uint64_t pathTableBytes = 0;
+        uint32_t tagSize = 0;
+        for (uint32_t i = 0; i < node_num; i++) {
+            if (n.Get(i)->GetNodeType() == 1) {
+                Ptr<LoadBalancer> lb = DynamicCast<SwitchNode>(n.Get(i))->GetLoadBalancer();
+                pathTableBytes += lb->GetPathTableBytes();
+                tagSize = lb->GetTagSize();
             }
         }
+        if (mpi_rank == 0) {
+            printf("PathId: %u-bit ports, up to %u hops, %u bytes in tags\n",
+                   PathCodec::GetPortBits(), PathCodec::GetMaxHops(),
+                   PathCodec::GetSerializedSize());
+            printf("LB(%u): %u-byte tag per data packet, path tables %.1f KB (%.1f KB per ToR)\n",
+                   lb_mode, tagSize, pathTableBytes / 1e3,
+                   pathTableBytes / 1e3 / idxNodeToR.size());
+        }
 
         // schedule conga timeout monitor
         if (lb_mode == 3) {  // CONGA
@@ -1718,7 +2876,9 @@ int main(int argc, char *argv[]) {
     }
 
     // populate routing tables (although we use our custom impl in switch_node.cc)
-    Ipv4GlobalRoutingHelper::PopulateRoutingTables();
+    if (populate_ipv4_routes) {
+        Ipv4GlobalRoutingHelper::PopulateRoutingTables();
+    }
 
     // maintain port number for each host
     for (uint32_t i = 0; i < node_num; i++) {
@@ -1728,29 +2888,114 @@ int main(int argc, char *argv[]) {
         }
     }
 
+    if (enable_fluid || fast_forward) {
+        for (uint32_t i = 0; i < node_num; i++) {
+            for (auto &nbr : nbr2if[i]) {
+                link_id[(uint64_t)i << 32 | nbr.first] = link_dev.size();
+                link_dev.push_back(std::make_pair(i, nbr.second.idx));
+            }
+        }
+    }
+
+    /**
+     * @brief hybrid fluid/packet mode: a fluid link per direction of each link, whose
+     * standing queue (while the fluid saturates it) is the ECN threshold of the port
+     */
+    if (enable_fluid) {
+        for (uint32_t i = 0; i < node_num; i++) {
+            for (auto &nbr : nbr2if[i]) {
+                uint32_t id = fluid.AddLink(nbr.second.bw);  // the IDs of link_id
+                if (n.Get(i)->GetNodeType() == 1) {
+                    fluid.SetQueueBytes(id, rate2kmin[nbr.second.bw] * 1000);
+                }
+            }
+        }
+        fluid.SetMaxShare(fluid_max_share);
+        fluid.SetConvergence(NanoSeconds(llround(fluid_convergence * 1000)));
+        fluid.SetLinkCallback(&fluid_link_update);
+        fluid.SetFinishCallback(&fluid_flow_sent);
+    }
+
+    /**
+     * @brief fast-forward: flows alone on idle links, back to packets when touched (another
+     * flow on a link, see ScheduleFlowInputs, PFC pauses and link failures)
+     */
+    if (fast_forward) {
+        ff.SetNLinks(link_dev.size());
+        ff.SetCheckOnly(fast_forward == 2);
+        ff.SetFinishCallback(&ff_finish);
+        ff.SetResumeCallback(&ff_resume);
+        for (uint32_t l = 0; l < link_dev.size(); l++) {
+            n.Get(link_dev[l].first)
+                ->GetDevice(link_dev[l].second)
+                ->TraceConnectWithoutContext("QbbPfc", MakeBoundCallback(&ff_pfc, l));
+        }
+    }
+
     flow_input.idx = 0;
     port_per_host = new uint16_t[node_num - switch_num];
+    if (!flowgen_cdf_file.empty()) {
+        FlowGenerator::Pattern pattern;
+        if (!FlowGenerator::ParsePattern(flowgen_pattern, pattern)) {
+            std::cerr << "FLOWGEN_PATTERN must be poisson, incast or alltoall" << std::endl;
+            exit(1);
+        }
+        if (hostIds.size() < 2) {
+            std::cerr << "the flow generator needs at least two hosts" << std::endl;
+            exit(1);
+        }
+        if (pattern == FlowGenerator::INCAST &&
+            (flowgen_incast_fanin < 1 || flowgen_incast_fanin >= hostIds.size())) {
+            std::cerr << "FLOWGEN_INCAST_FANIN must be in [1, " << hostIds.size() - 1 << "] ("
+                      << hostIds.size() << " hosts), got " << flowgen_incast_fanin << std::endl;
+            exit(1);
+        }
+        flowgen.Start(hostIds, get_nic_rate(n), flowgen_load,
+                      (uint64_t)(flowgen_start_time * 1e9), (uint64_t)(flowgen_stop_time * 1e9),
+                      random_seed, pattern, flowgen_incast_fanin);
+        std::cout << "Flow generator: " << flowgen_pattern << ", avg flow size "
+                  << flowgen.GetAvgSize() << "B, seed " << random_seed << std::endl;
+    }
     if (flow_num > 0) {
         // generate flows
         ReadFlowInput();
         Simulator::Schedule(Seconds(0), &ScheduleFlowInputs, flow_input_stream);
     }
 
-    topof.close();
 
-    // schedule link down
-    if (link_down_time > 0) {
-        Simulator::Schedule(Seconds(flowgen_start_time) + MicroSeconds(link_down_time),
-                            &TakeDownLink, n, n.Get(link_down_A), n.Get(link_down_B));
+    // schedule link failures/recoveries
+    for (auto &ev : link_events) {
+        if (ev.a >= node_num || ev.b >= node_num || nbr2if[ev.a].count(ev.b) == 0) {
+            std::cerr << "link event on a link that does not exist: " << ev.line << std::endl;
+            exit(1);
+        }
+        Simulator::Schedule(Seconds(flowgen_start_time) + MicroSeconds(ev.time),
+                            ev.up ? &BringUpLink : &TakeDownLink, n, n.Get(ev.a), n.Get(ev.b));
     }
 
-    if (lb_mode == 9) {
-        voq_output = fopen(voq_mon_file.c_str(), "w");                // specific to ConWeave
-        voq_detail_output = fopen(voq_mon_detail_file.c_str(), "w");  // specific to ConWeave
+    // text: CSV lines; columnar: <file>.col with the columns below
+    auto open_monitor = [](const std::string &file, FILE *&fout,
+                           const std::vector<std::string> &columns) {
+        if (!monitor_columnar) {
+            fout = fopen(rank_path(file).c_str(), "w");
+            return monitor_output.OpenChannel(fout, ',');
+        }
+        fout = fopen(GetColumnarPath(rank_path(file)).c_str(), "wb");
+        return monitor_output.OpenColumnarChannel(fout, columns);
+    };
+    if (lb_mode == 9) {  // specific to ConWeave
+        voq_channel = open_monitor(voq_mon_file, voq_output, {"time", "tor", "n_voq", "n_pkt"});
+        voq_detail_channel = open_monitor(voq_mon_detail_file, voq_detail_output,
+                                          {"time", "dip", "n_voq", "n_pkt"});
+    }
+    // common
+    uplink_channel =
+        open_monitor(uplink_mon_file, uplink_output, {"time", "tor", "outdev", "tx_bytes"});
+    conn_channel = open_monitor(conn_mon_file, conn_output, {"time", "host", "n_qp", "n_active_qp"});
+    if (!mem_mon_file.empty()) {
+        mem_channel = open_monitor(mem_mon_file, mem_output,
+                                   {"time", "component", "entries", "bytes"});
     }
-
-    uplink_output = fopen(uplink_mon_file.c_str(), "w");  // common
-    conn_output = fopen(conn_mon_file.c_str(), "w");      // common
 
     // update torId2UplinkIf, torId2DownlinkIf
     for (size_t ToRId = 0; ToRId < Settings::node_num; ToRId++) {
@@ -1758,8 +3003,8 @@ int main(int argc, char *argv[]) {
         if (node->GetNodeType() == 1) {  // switches
             auto swNode = DynamicCast<SwitchNode>(n.Get(ToRId));
             if (swNode->m_isToR) {  // TOR switch
-                for (auto &nextNodeIf : nbr2if[node]) {
-                    if (nextNodeIf.first->GetNodeType() ==
+                for (auto &nextNodeIf : nbr2if[ToRId]) {
+                    if (n.Get(nextNodeIf.first)->GetNodeType() ==
                         1) {  // nextNode is switch (i.e., uplink)
                         auto &vec = torId2UplinkIf[ToRId];
                         vec.push_back(
@@ -1777,25 +3022,128 @@ int main(int argc, char *argv[]) {
             }
         }
     }
-    Simulator::Schedule(Seconds(flowgen_start_time), &periodic_monitoring, voq_output,
-                        voq_detail_output, uplink_output, conn_output, &lb_mode);
+    Simulator::Schedule(Seconds(flowgen_start_time), &periodic_monitoring, &lb_mode);
+
+    // flow size buckets of the FCT sketches and CIs
+    if (fct_sketch_bounds.empty()) fct_sketch_bounds.push_back(maxBdp);  // <1BDP, >=1BDP
+    std::vector<std::pair<uint64_t, uint64_t>> size_buckets;
+    for (uint64_t b : fct_sketch_bounds) {
+        uint64_t lo = size_buckets.empty() ? 0 : size_buckets.back().second;
+        if (b <= lo) {
+            std::cerr << "FCT_SKETCH_BUCKETS must be positive and increasing, got " << b
+                      << " after " << lo << std::endl;
+            exit(1);
+        }
+        size_buckets.push_back(std::make_pair(lo, b));
+    }
+    size_buckets.push_back(std::make_pair(size_buckets.back().second, UINT64_MAX));
+
+    if (!fct_sketch_file.empty()) {
+        fct_sketch_output = fopen(rank_path(fct_sketch_file).c_str(), "w");
+        fct_sketches.emplace_back(0, UINT64_MAX, fct_sketch_accuracy);
+        for (const auto &b : size_buckets) {
+            fct_sketches.emplace_back(b.first, b.second, fct_sketch_accuracy);
+        }
+        fprintf(fct_sketch_output, "# time lb cc size_lo size_hi metric sketch\n");
+        if (fct_sketch_interval > 0) {
+            Simulator::Schedule(Seconds(flowgen_start_time) + MicroSeconds(fct_sketch_interval),
+                                &fct_sketch_periodic);
+        }
+    }
+
+    if (ci_stop_precision > 0) {
+        for (const auto &b : size_buckets) ci_buckets.emplace_back(b.first, b.second);
+        ci_stop_warmup_end = llround((flowgen_start_time + ci_stop_warmup) * 1e9);
+    }
+
+    // drained and flushed at Simulator::Destroy()
+    monitor_output.Start(async_output, async_output_ring);
 
     //
     // Now, do the actual simulation.
     //
+    std::cerr << "Setup CPU time: " << (double)(clock() - begint) / CLOCKS_PER_SEC << "s\n";
     std::cout << "------------------------------------------" << std::endl;
     std::cout << "Running Simulation.\n";
     fflush(stdout);
     NS_LOG_INFO("Run Simulation.");
-    Simulator::Schedule(Seconds(flowgen_start_time),
-                        &stop_simulation_middle);  // check every 100us
-    Simulator::Stop(Seconds(flowgen_stop_time + 10.0));
+    Simulator::Schedule(Seconds(flowgen_start_time), &check_flow_completion);
+    if (stop_time <= 0) stop_time = flowgen_stop_time + 10.0;
+    Simulator::Schedule(Seconds(stop_time), &finish_simulation, std::string("STOP_TIME reached"));
+    std::thread watchdog;
+    if (stop_wallclock > 0) watchdog = std::thread(wallclock_watchdog);
+    for (uint32_t i = 0; i < AllocStats::N_SUBSYSTEMS; i++) {
+        allocs_setup[i] = AllocStats::Get((AllocStats::Subsystem)i);
+    }
+    wall_run_start = std::chrono::steady_clock::now();
     Simulator::Run();
+    if (mem_output != NULL) {
+        mem_snapshot(Simulator::Now().GetNanoSeconds());  // e.g., with all the finished QPs
+    }
+    if (!perf_output_file.empty()) {
+        write_perf_output(topology_gen.empty() ? topology_file : topology_gen);
+    }
+    if (watchdog.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(wallclock_mutex);
+            wallclock_done = true;
+        }
+        wallclock_cv.notify_one();
+        watchdog.join();
+    }
+
+    if (fct_sketch_output != NULL) {
+        fct_sketch_snapshot();
+        fct_sketch_print_summary();
+    }
+    if (!ci_buckets.empty()) ci_print_report();
+    if (enable_fluid) {
+        std::cout << "Fluid flows: " << fluid.GetNFinished() << " finished, "
+                  << fluid.GetNActive() << " active" << std::endl;
+    }
+    if (mem_output != NULL) {
+        std::cout << "Memory peaks of " << mem_stats.GetNSnapshots() << " snapshots";
+        if (enable_mpi) std::cout << " (rank " << mpi_rank << ")";
+        std::cout << ":" << std::endl;
+        for (uint32_t c = 0; c < MemStats::N_COMPONENTS; c++) {
+            MemStats::Component comp = (MemStats::Component)c;
+            printf("  %-14s %12lu entries %12.1f KB\n", MemStats::GetName(comp),
+                   mem_stats.GetPeakEntries(comp), mem_stats.GetPeakBytes(comp) / 1e3);
+        }
+        printf("  %-14s %33.1f KB\n", "total", mem_stats.GetPeakTotalBytes() / 1e3);
+    }
+    if (fast_forward) {
+        const FastForward::Stats &st = ff.GetStats();
+        std::cout << "Fast-forward: " << st.nForwarded << " flows started alone, "
+                  << st.nResumed << " back to packets";
+        uint64_t nBound = fast_forward == 1 ? st.nFinished : st.nChecked;
+        if (fast_forward == 1) {
+            std::cout << ", " << st.nFinished << " finished alone, " << st.bytesForwarded
+                      << " bytes without packets";
+        } else {
+            std::cout << ", FCT error of the " << st.nChecked << " alone all along: avg "
+                      << (st.nChecked ? st.errSum / st.nChecked * 100 : 0) << "%, max "
+                      << st.errMax * 100 << "%";
+        }
+        // base RTT + one packet: what the packet-free FCT may be off by
+        std::cout << ", FCT error bound: avg " << (nBound ? st.boundSum / nBound * 100 : 0)
+                  << "%, max " << st.boundMax * 100 << "%" << std::endl;
+    }
 
     /*-----------------------------------------------------------------------------*/
     /*----- we don't need below. Just we can enforce to close this simulation. -----*/
     /*-----------------------------------------------------------------------------*/
     Simulator::Destroy();
+#ifdef NS3_MPI
+    if (enable_mpi) {
+        MPI_Barrier(MPI_COMM_WORLD);  // all ranks have flushed their outputs
+        if (mpi_rank == 0) {
+            gather_rank_outputs(fct_output_file, {5, 6});  // by finish time
+            gather_rank_outputs(pfc_output_file, {0});
+        }
+        MpiInterface::Disable();
+    }
+#endif
     NS_LOG_INFO("Total number of packets: " << RdmaHw::nAllPkts);
     NS_LOG_INFO("Done.");
     endt = clock();
@@ -30,6 +30,7 @@
 #include "ns3/log.h"
 
 #include <math.h>
+#include <algorithm>
 
 #ifdef NS3_MPI
 #include <mpi.h>
@@ -41,6 +42,14 @@ namespace ns3 {
 
 NS_OBJECT_ENSURE_REGISTERED (DistributedSimulatorImpl);
 
+// Layout of the event uids, which order the events of a timestamp (see NextUid):
+// | zero-delay depth (8 bits) | scheduling context (20 bits) | sequence number (36 bits) |
+static const uint32_t UID_SEQ_BITS = 36;
+static const uint32_t UID_CONTEXT_BITS = 20;
+static const uint32_t UID_DEPTH_SHIFT = UID_SEQ_BITS + UID_CONTEXT_BITS;
+static const uint64_t UID_MAX_DEPTH = 0xff;
+static const uint32_t UID_GLOBAL_CONTEXT = (1 << UID_CONTEXT_BITS) - 1; // for context 0xffffffff
+
 LbtsMessage::~LbtsMessage ()
 {
 }
@@ -68,6 +77,12 @@ LbtsMessage::GetMyId ()
   return m_myId;
 }
 
+bool
+LbtsMessage::IsFinished ()
+{
+  return m_isFinished;
+}
+
 Time DistributedSimulatorImpl::m_lookAhead = Seconds (0);
 
 TypeId
@@ -94,15 +109,17 @@ DistributedSimulatorImpl::DistributedSimulatorImpl ()
 #endif
 
   m_stop = false;
-  // uids are allocated from 4.
+  m_globalFinished = false;
+  // sequence numbers, hence uids, are allocated from 4.
   // uid 0 is "invalid" events
   // uid 1 is "now" events
   // uid 2 is "destroy" events
-  m_uid = 4;
+  m_globalSeq = 4;
   // before ::Run is entered, the m_currentUid will be zero
   m_currentUid = 0;
   m_currentTs = 0;
   m_currentContext = 0xffffffff;
+  m_eventCount = 0;
   m_unscheduledEvents = 0;
   m_events = 0;
 }
@@ -243,6 +260,7 @@ DistributedSimulatorImpl::ProcessOneEvent (void)
   m_currentTs = next.key.m_ts;
   m_currentContext = next.key.m_context;
   m_currentUid = next.key.m_uid;
+  m_eventCount++;
   next.impl->Invoke ();
   next.impl->Unref ();
 }
@@ -264,6 +282,10 @@ DistributedSimulatorImpl::NextTs (void) const
 Time
 DistributedSimulatorImpl::Next (void) const
 {
+  if (m_events->IsEmpty ())
+    {
+      return GetMaximumSimulationTime ();
+    }
   return TimeStep (NextTs ());
 }
 
@@ -273,9 +295,13 @@ DistributedSimulatorImpl::Run (void)
 #ifdef NS3_MPI
   CalculateLookAhead ();
   m_stop = false;
-  while (!m_events->IsEmpty () && !m_stop)
+  m_globalFinished = false;
+  while (!m_globalFinished)
     {
       Time nextTime = Next ();
+      // A rank that has stopped or has no event left still takes part in
+      // the synchronizations, and processes the events it receives, until
+      // all ranks are finished.
       if (nextTime > m_grantedTime)
         { // Can't process, calculate a new LBTS
           // First receive any pending messages
@@ -285,7 +311,8 @@ DistributedSimulatorImpl::Run (void)
           // And check for send completes
           MpiInterface::TestSendComplete ();
           // Finally calculate the lbts
-          LbtsMessage lMsg (MpiInterface::GetRxCount (), MpiInterface::GetTxCount (), m_myId, nextTime);
+          LbtsMessage lMsg (MpiInterface::GetRxCount (), MpiInterface::GetTxCount (), m_myId,
+                            IsFinished (), nextTime);
           m_pLBTS[m_myId] = lMsg;
           MPI_Allgather (&lMsg, sizeof (LbtsMessage), MPI_BYTE, m_pLBTS,
                          sizeof (LbtsMessage), MPI_BYTE, MPI_COMM_WORLD);
@@ -295,6 +322,7 @@ DistributedSimulatorImpl::Run (void)
           // so we don't update the granted time.
           uint32_t totRx = m_pLBTS[0].GetRxCount ();
           uint32_t totTx = m_pLBTS[0].GetTxCount ();
+          bool allFinished = m_pLBTS[0].IsFinished ();
 
           for (uint32_t i = 1; i < m_systemCount; ++i)
             {
@@ -304,14 +332,19 @@ DistributedSimulatorImpl::Run (void)
                 }
               totRx += m_pLBTS[i].GetRxCount ();
               totTx += m_pLBTS[i].GetTxCount ();
+              allFinished = allFinished && m_pLBTS[i].IsFinished ();
 
             }
           if (totRx == totTx)
             {
-              m_grantedTime = smallestTime + DistributedSimulatorImpl::m_lookAhead;
+              m_globalFinished = allFinished;
+              if (!m_globalFinished)
+                {
+                  m_grantedTime = smallestTime + DistributedSimulatorImpl::m_lookAhead;
+                }
             }
         }
-      if (nextTime <= m_grantedTime)
+      if (!m_globalFinished && !m_events->IsEmpty () && nextTime <= m_grantedTime)
         { // Save to process
           ProcessOneEvent ();
         }
@@ -341,6 +374,58 @@ DistributedSimulatorImpl::Stop (Time const &time)
 {
   Simulator::Schedule (time, &Simulator::Stop);
 }
+uint64_t
+DistributedSimulatorImpl::NextUid (uint64_t ts)
+{
+  // The uid of an event ranks it among the events of its timestamp. It is
+  // built from what the scheduling node knows, rather than from a counter of
+  // the rank, so that same-time events run in the same order whatever the
+  // partition of the nodes over the ranks (and a run on N ranks gives the
+  // results of a run on one): an event scheduled for the current time comes
+  // after the event that schedules it (depth), then the events are ordered by
+  // scheduling context and by a sequence number of that context.
+  uint64_t depth = 0;
+  if (ts == m_currentTs)
+    {
+      depth = std::min ((m_currentUid >> UID_DEPTH_SHIFT) + 1, UID_MAX_DEPTH);
+    }
+  uint64_t seq;
+  uint32_t context;
+  if (m_currentContext == 0xffffffff)
+    {
+      context = UID_GLOBAL_CONTEXT;
+      seq = m_globalSeq++;
+    }
+  else
+    {
+      context = m_currentContext;
+      NS_ASSERT_MSG (context < UID_GLOBAL_CONTEXT, "too many contexts for the event uids");
+      if (context >= m_contextSeq.size ())
+        {
+          m_contextSeq.resize (context + 1, 4);
+        }
+      seq = m_contextSeq[context]++;
+    }
+  NS_ASSERT_MSG (seq < (uint64_t (1) << UID_SEQ_BITS), "event sequence number overflow");
+  return depth << UID_DEPTH_SHIFT | uint64_t (context) << UID_SEQ_BITS | seq;
+}
+
+void
+DistributedSimulatorImpl::ScheduleRemote (uint32_t context, uint64_t ts, uint64_t uid,
+                                          EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << context << ts << uid << event);
+  NS_ASSERT (ts >= m_currentTs);
+
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = ts;
+  ev.key.m_context = context;
+  ev.key.m_uid = uid;
+  m_unscheduledEvents++;
+  m_events->Insert (ev);
+}
+
 
 //
 // Schedule an event for a _relative_ time in the future.
@@ -356,8 +441,7 @@ DistributedSimulatorImpl::Schedule (Time const &time, EventImpl *event)
   ev.impl = event;
   ev.key.m_ts = static_cast<uint64_t> (tAbsolute.GetTimeStep ());
   ev.key.m_context = GetContext ();
-  ev.key.m_uid = m_uid;
-  m_uid++;
+  ev.key.m_uid = NextUid (ev.key.m_ts);
   m_unscheduledEvents++;
   m_events->Insert (ev);
   return EventId (event, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
@@ -372,8 +456,7 @@ DistributedSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &tim
   ev.impl = event;
   ev.key.m_ts = m_currentTs + time.GetTimeStep ();
   ev.key.m_context = context;
-  ev.key.m_uid = m_uid;
-  m_uid++;
+  ev.key.m_uid = NextUid (ev.key.m_ts);
   m_unscheduledEvents++;
   m_events->Insert (ev);
 }
@@ -385,8 +468,7 @@ DistributedSimulatorImpl::ScheduleNow (EventImpl *event)
   ev.impl = event;
   ev.key.m_ts = m_currentTs;
   ev.key.m_context = GetContext ();
-  ev.key.m_uid = m_uid;
-  m_uid++;
+  ev.key.m_uid = NextUid (ev.key.m_ts);
   m_unscheduledEvents++;
   m_events->Insert (ev);
   return EventId (event, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
@@ -397,7 +479,6 @@ DistributedSimulatorImpl::ScheduleDestroy (EventImpl *event)
 {
   EventId id (Ptr<EventImpl> (event, false), m_currentTs, 0xffffffff, 2);
   m_destroyEvents.push_back (id);
-  m_uid++;
   return id;
 }
 
@@ -510,4 +591,10 @@ DistributedSimulatorImpl::GetContext (void) const
   return m_currentContext;
 }
 
+uint64_t
+DistributedSimulatorImpl::GetEventCount (void) const
+{
+  return m_eventCount;
+}
+
 } // namespace ns3
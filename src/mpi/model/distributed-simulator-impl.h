@@ -25,6 +25,7 @@
 #include "ns3/ptr.h"
 
 #include <list>
+#include <vector>
 
 namespace ns3 {
 
@@ -39,7 +40,8 @@ public:
   LbtsMessage ()
     : m_txCount (0),
       m_rxCount (0),
-      m_myId (0)
+      m_myId (0),
+      m_isFinished (false)
   {
   }
 
@@ -47,12 +49,14 @@ public:
    * \param rxc received count
    * \param txc transmitted count
    * \param id mpi rank
+   * \param isFinished whether the rank has stopped (or run out of events)
    * \param t smallest time
    */
-  LbtsMessage (uint32_t rxc, uint32_t txc, uint32_t id, const Time& t)
+  LbtsMessage (uint32_t rxc, uint32_t txc, uint32_t id, bool isFinished, const Time& t)
     : m_txCount (txc),
       m_rxCount (rxc),
       m_myId (id),
+      m_isFinished (isFinished),
       m_smallestTime (t)
   {
   }
@@ -75,11 +79,16 @@ public:
    * \return id which corresponds to mpi rank
    */
   uint32_t GetMyId ();
+  /**
+   * \return whether the rank has stopped (or run out of events)
+   */
+  bool IsFinished ();
 
 private:
   uint32_t m_txCount;
   uint32_t m_rxCount;
   uint32_t m_myId;
+  bool     m_isFinished;
   Time     m_smallestTime;
 };
 
@@ -87,6 +96,11 @@ private:
  * \ingroup mpi
  *
  * \brief distributed simulator implementation using lookahead
+ *
+ * The ranks stop together: Stop () only marks this rank as finished, and it
+ * keeps processing its events (e.g. packets it forwards for the other ranks)
+ * until every rank has stopped or run out of events, which is checked at the
+ * next LBTS synchronization.
  */
 class DistributedSimulatorImpl : public SimulatorImpl
 {
@@ -115,6 +129,19 @@ public:
   virtual void SetScheduler (ObjectFactory schedulerFactory);
   virtual uint32_t GetSystemId (void) const;
   virtual uint32_t GetContext (void) const;
+  virtual uint64_t GetEventCount (void) const;
+
+  /**
+   * \param ts the timestamp of an event scheduled now
+   * \return the uid of the event, which orders it among the events of its
+   * timestamp independently of the partition of the nodes over the ranks
+   */
+  uint64_t NextUid (uint64_t ts);
+  /**
+   * \brief Insert an event received from another rank, with the uid that its
+   * sender allocated with NextUid
+   */
+  void ScheduleRemote (uint32_t context, uint64_t ts, uint64_t uid, EventImpl *event);
 
 private:
   virtual void DoDispose (void);
@@ -127,11 +154,14 @@ private:
 
   DestroyEvents m_destroyEvents;
   bool m_stop;
+  bool m_globalFinished;      // all ranks have stopped
   Ptr<Scheduler> m_events;
-  uint32_t m_uid;
-  uint32_t m_currentUid;
+  uint64_t m_globalSeq;                // sequence of the events scheduled out of any node
+  std::vector<uint64_t> m_contextSeq;  // sequence of the events scheduled per context
+  uint64_t m_currentUid;
   uint64_t m_currentTs;
   uint32_t m_currentContext;
+  uint64_t m_eventCount;               // number of events executed
   // number of events that have been inserted but not yet scheduled,
   // not counting the "destroy" events; this is used for validation
   int m_unscheduledEvents;
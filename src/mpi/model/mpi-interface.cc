@@ -25,6 +25,7 @@
 
 #include "mpi-interface.h"
 #include "mpi-receiver.h"
+#include "distributed-simulator-impl.h"
 
 #include "ns3/node.h"
 #include "ns3/node-list.h"
@@ -32,6 +33,8 @@
 #include "ns3/simulator.h"
 #include "ns3/simulator-impl.h"
 #include "ns3/nstime.h"
+#include "ns3/make-event.h"
+#include "ns3/abort.h"
 
 #ifdef NS3_MPI
 #include <mpi.h>
@@ -39,6 +42,11 @@
 
 namespace ns3 {
 
+// a message is the rx time and event uid (64 bits each), the destination
+// node and device and the size of the packet tags (32 bits each), then the
+// serialized packet tags and the serialized packet
+static const uint32_t MSG_HEADER_SIZE = 28;
+
 SentBuffer::SentBuffer ()
 {
   m_buffer = 0;
@@ -176,25 +184,41 @@ MpiInterface::SendPacket (Ptr<Packet> p, const Time& rxTime, uint32_t node, uint
   m_pendingTx.push_back (sendBuf);
   std::list<SentBuffer>::reverse_iterator i = m_pendingTx.rbegin (); // Points to the last element
 
-  uint32_t serializedSize = p->GetSerializedSize ();
-  uint8_t* buffer =  new uint8_t[serializedSize + 16];
+  // The receive event gets its uid here, as a local one would, so that it is
+  // ordered like in a run on one rank (see DistributedSimulatorImpl::NextUid)
+  Ptr<DistributedSimulatorImpl> impl =
+    DynamicCast<DistributedSimulatorImpl> (Simulator::GetImplementation ());
+  NS_ASSERT (impl != 0);
+  uint64_t t = rxTime.GetTimeStep ();
+  uint64_t uid = impl->NextUid (t);
+
+  // Packet::Serialize leaves out the packet tags, which the models on the
+  // other side may need (as they would on a local channel)
+  uint32_t tagSize = p->GetPacketTagsSerializedSize ();
+  uint32_t serializedSize = tagSize + p->GetSerializedSize ();
+  NS_ABORT_MSG_IF (serializedSize + MSG_HEADER_SIZE > MAX_MPI_MSG_SIZE,
+                   "packet of " << serializedSize << " bytes too large for an MPI message");
+  uint8_t* buffer =  new uint8_t[serializedSize + MSG_HEADER_SIZE];
   i->SetBuffer (buffer);
-  // Add the time, dest node and dest device
-  uint64_t t = rxTime.GetNanoSeconds ();
+  // Add the time, uid, dest node, dest device and size of the tags
   uint64_t* pTime = reinterpret_cast <uint64_t *> (buffer);
   *pTime++ = t;
+  *pTime++ = uid;
   uint32_t* pData = reinterpret_cast<uint32_t *> (pTime);
   *pData++ = node;
   *pData++ = dev;
-  // Serialize the packet
-  p->Serialize (reinterpret_cast<uint8_t *> (pData), serializedSize);
+  *pData++ = tagSize;
+  // Serialize the packet tags and the packet
+  uint8_t* pPacket = reinterpret_cast<uint8_t *> (pData);
+  p->SerializePacketTags (pPacket, tagSize);
+  p->Serialize (pPacket + tagSize, serializedSize - tagSize);
 
   // Find the system id for the destination node
   Ptr<Node> destNode = NodeList::GetNode (node);
   uint32_t nodeSysId = destNode->GetSystemId ();
 
-  MPI_Isend (reinterpret_cast<void *> (i->GetBuffer ()), serializedSize + 16, MPI_CHAR, nodeSysId,
-             0, MPI_COMM_WORLD, (i->GetRequest ()));
+  MPI_Isend (reinterpret_cast<void *> (i->GetBuffer ()), serializedSize + MSG_HEADER_SIZE, MPI_CHAR,
+             nodeSysId, 0, MPI_COMM_WORLD, (i->GetRequest ()));
   m_txCount++;
 #else
   NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
@@ -222,16 +246,19 @@ MpiInterface::ReceiveMessages ()
 
       // Get the meta data first
       uint64_t* pTime = reinterpret_cast<uint64_t *> (m_pRxBuffers[index]);
-      uint64_t nanoSeconds = *pTime++;
+      uint64_t ts = *pTime++;
+      uint64_t uid = *pTime++;
       uint32_t* pData = reinterpret_cast<uint32_t *> (pTime);
       uint32_t node = *pData++;
       uint32_t dev  = *pData++;
+      uint32_t tagSize = *pData++;
 
-      Time rxTime = NanoSeconds (nanoSeconds);
-
-      count -= sizeof (nanoSeconds) + sizeof (node) + sizeof (dev);
+      count -= MSG_HEADER_SIZE + tagSize;
 
-      Ptr<Packet> p = Create<Packet> (reinterpret_cast<uint8_t *> (pData), count, true);
+      uint8_t* pTags = reinterpret_cast<uint8_t *> (pData);
+      Ptr<Packet> p = Create<Packet> (pTags + tagSize, count, true);
+      bool tagsOk = p->DeserializePacketTags (pTags, tagSize);
+      NS_ABORT_MSG_IF (!tagsOk, "malformed packet tags in an MPI message");
 
       // Find the correct node/device to schedule receive event
       Ptr<Node> pNode = NodeList::GetNode (node);
@@ -249,9 +276,12 @@ MpiInterface::ReceiveMessages ()
 
       NS_ASSERT (pNode && pMpiRec);
 
-      // Schedule the rx event
-      Simulator::ScheduleWithContext (pNode->GetId (), rxTime - Simulator::Now (),
-                                      &MpiReceiver::Receive, pMpiRec, p);
+      // Schedule the rx event, with the uid of its sender
+      Ptr<DistributedSimulatorImpl> impl =
+        DynamicCast<DistributedSimulatorImpl> (Simulator::GetImplementation ());
+      NS_ASSERT (impl != 0);
+      impl->ScheduleRemote (pNode->GetId (), ts, uid,
+                            MakeEvent (&MpiReceiver::Receive, pMpiRec, p));
 
       // Re-queue the next read
       MPI_Irecv (m_pRxBuffers[index], MAX_MPI_MSG_SIZE, MPI_CHAR, MPI_ANY_SOURCE, 0,
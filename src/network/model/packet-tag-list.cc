@@ -118,6 +118,7 @@ PacketTagList::Remove (Tag &tag)
       struct TagData *copy = AllocData ();
       copy->tid = cur->tid;
       copy->count = 1;
+      copy->size = cur->size;
       copy->next = 0;
       memcpy (copy->data, cur->data, PACKET_TAG_MAX_SIZE);
       *prevNext = copy;
@@ -143,8 +144,9 @@ PacketTagList::Add (const Tag &tag) const
   head->next = 0;
   head->tid = tag.GetInstanceTypeId ();
   head->next = m_next;
-  NS_ASSERT (tag.GetSerializedSize () <= PACKET_TAG_MAX_SIZE);
-  tag.Serialize (TagBuffer (head->data, head->data+tag.GetSerializedSize ()));
+  head->size = tag.GetSerializedSize ();
+  NS_ASSERT (head->size <= PACKET_TAG_MAX_SIZE);
+  tag.Serialize (TagBuffer (head->data, head->data+head->size));
 
   const_cast<PacketTagList *> (this)->m_next = head;
 }
@@ -173,5 +175,97 @@ PacketTagList::Head (void) const
   return m_next;
 }
 
+/*
+ * Serialized form, in 32-bit words: the number of tags, then for each tag
+ * (from the head) the hash of its TypeId, its size in bytes and its data,
+ * padded to a 4-byte boundary.
+ */
+uint32_t
+PacketTagList::GetSerializedSize (void) const
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t size = 4;
+  for (struct TagData *cur = m_next; cur != 0; cur = cur->next)
+    {
+      size += 8 + ((cur->size + 3) & (~3));
+    }
+  return size;
+}
+
+uint32_t
+PacketTagList::Serialize (uint32_t* buffer, uint32_t maxSize) const
+{
+  NS_LOG_FUNCTION (this << buffer << maxSize);
+  uint32_t* p = buffer;
+  uint32_t size = 4;
+  if (size > maxSize)
+    {
+      return 0;
+    }
+  uint32_t* nTags = p++;
+  *nTags = 0;
+  for (struct TagData *cur = m_next; cur != 0; cur = cur->next)
+    {
+      uint32_t dataSize = (cur->size + 3) & (~3);
+      if (size + 8 + dataSize > maxSize)
+        {
+          return 0;
+        }
+      *p++ = cur->tid.GetHash ();
+      *p++ = cur->size;
+      memset (p, 0, dataSize);
+      memcpy (p, cur->data, cur->size);
+      p += dataSize / 4;
+      size += 8 + dataSize;
+      (*nTags)++;
+    }
+  return size;
+}
+
+uint32_t
+PacketTagList::Deserialize (const uint32_t* buffer, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << buffer << size);
+  NS_ASSERT (m_next == 0);
+  const uint32_t* p = buffer;
+  if (size < 4)
+    {
+      return 0;
+    }
+  uint32_t nTags = *p++;
+  uint32_t read = 4;
+  struct TagData **prevNext = &m_next;
+  for (uint32_t i = 0; i < nTags; i++)
+    {
+      if (read + 8 > size)
+        {
+          return 0;
+        }
+      TypeId tid;
+      if (!TypeId::LookupByHashFailSafe (p[0], &tid) || p[1] > PACKET_TAG_MAX_SIZE)
+        {
+          return 0;
+        }
+      uint32_t tagSize = p[1];
+      uint32_t dataSize = (tagSize + 3) & (~3);
+      p += 2;
+      if (read + 8 + dataSize > size)
+        {
+          return 0;
+        }
+      struct TagData *data = AllocData ();
+      data->tid = tid;
+      data->count = 1;
+      data->size = tagSize;
+      data->next = 0;
+      memcpy (data->data, p, tagSize);
+      *prevNext = data;
+      prevNext = &data->next;
+      p += dataSize / 4;
+      read += 8 + dataSize;
+    }
+  return read;
+}
+
 } // namespace ns3
 
@@ -44,6 +44,7 @@ public:
     struct TagData *next;
     TypeId tid;
     uint32_t count;
+    uint32_t size;  // serialized size of the tag in data
   };
 
   inline PacketTagList ();
@@ -58,6 +59,22 @@ public:
 
   const struct PacketTagList::TagData *Head (void) const;
 
+  /**
+   * \returns the number of bytes needed by Serialize
+   */
+  uint32_t GetSerializedSize (void) const;
+  /**
+   * \brief Serialize the tags (type and data) into a 4-byte aligned buffer,
+   *        e.g. to send the packet to another rank of a distributed simulation
+   * \returns the number of bytes written, 0 if maxSize is too small
+   */
+  uint32_t Serialize (uint32_t* buffer, uint32_t maxSize) const;
+  /**
+   * \brief Add the tags serialized in buffer, in the same order
+   * \returns the number of bytes read, 0 on a malformed buffer
+   */
+  uint32_t Deserialize (const uint32_t* buffer, uint32_t size);
+
 private:
 
   bool Remove (TypeId tid);
@@ -803,6 +803,26 @@ Packet::Deserialize (const uint8_t* buffer, uint32_t size)
   return (size == 0);
 }
 
+uint32_t
+Packet::GetPacketTagsSerializedSize (void) const
+{
+  return m_packetTagList.GetSerializedSize ();
+}
+
+uint32_t
+Packet::SerializePacketTags (uint8_t* buffer, uint32_t maxSize) const
+{
+  NS_LOG_FUNCTION (this << static_cast<void*> (buffer) << maxSize);
+  return m_packetTagList.Serialize (reinterpret_cast<uint32_t*> (buffer), maxSize);
+}
+
+bool
+Packet::DeserializePacketTags (const uint8_t* buffer, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << static_cast<const void*> (buffer) << size);
+  return m_packetTagList.Deserialize (reinterpret_cast<const uint32_t*> (buffer), size) == size;
+}
+
 void 
 Packet::AddByteTag (const Tag &tag) const
 {
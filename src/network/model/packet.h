@@ -470,6 +470,32 @@ public:
    */
   uint32_t Serialize (uint8_t* buffer, uint32_t maxSize) const;
 
+  /**
+   * \returns number of bytes required by SerializePacketTags
+   */
+  uint32_t GetPacketTagsSerializedSize (void) const;
+  /**
+   * \param buffer a raw, 4-byte aligned, byte buffer to which the packet tags
+   *        will be serialized
+   * \param maxSize the max size of the buffer for bounds checking
+   *
+   * Serialize does not include the packet tags. This serializes them
+   * separately, for the users that need them on the other side, e.g. the
+   * MPI transport of a distributed simulation.
+   *
+   * \returns number of bytes written, zero if buffer size was too small
+   */
+  uint32_t SerializePacketTags (uint8_t* buffer, uint32_t maxSize) const;
+  /**
+   * \param buffer the packet tags serialized by SerializePacketTags
+   * \param size the size of the serialized packet tags
+   *
+   * Add the serialized packet tags to this packet, which must have none.
+   *
+   * \returns true if the packet tags were deserialized completely
+   */
+  bool DeserializePacketTags (const uint8_t* buffer, uint32_t size);
+
   /**
    * \param tag the new tag to add to this packet
    *
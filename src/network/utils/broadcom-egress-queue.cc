@@ -23,6 +23,7 @@
 #include <unordered_map>
 
 #include "drop-tail-queue.h"
+#include "ns3/boolean.h"
 #include "ns3/double.h"
 #include "ns3/enum.h"
 #include "ns3/flow-id-num-tag.h"
@@ -36,7 +37,7 @@ NS_LOG_COMPONENT_DEFINE("BEgressQueue");
 
 namespace ns3 {
 
-std::unordered_map<unsigned, Time> acc_pause_time;  // global
+std::unordered_map<unsigned, Time> acc_pause_time;  // global, see PauseTimeAccounting
 
 NS_OBJECT_ENSURE_REGISTERED(BEgressQueue);
 
@@ -49,6 +50,12 @@ TypeId BEgressQueue::GetTypeId(void) {
                                           DoubleValue(1000.0 * 1024 * 1024),
                                           MakeDoubleAccessor(&BEgressQueue::m_maxBytes),
                                           MakeDoubleChecker<double>())
+                            .AddAttribute("PauseTimeAccounting",
+                                          "Accumulate per-flow PFC pause time into acc_pause_time "
+                                          "(instrumentation, costs a map lookup per dequeue)",
+                                          BooleanValue(false),
+                                          MakeBooleanAccessor(&BEgressQueue::m_pauseTimeAccounting),
+                                          MakeBooleanChecker())
                             .AddTraceSource("BeqEnqueue", "Enqueue a packet in the BEgressQueue. Multiple queue",
                                             MakeTraceSourceAccessor(&BEgressQueue::m_traceBeqEnqueue))
                             .AddTraceSource("BeqDequeue", "Dequeue a packet in the BEgressQueue. Multiple queue",
@@ -61,6 +68,8 @@ BEgressQueue::BEgressQueue() : Queue() {
     NS_LOG_FUNCTION_NOARGS();
     m_bytesInQueueTotal = 0;
     m_rrlast = 0;
+    m_nonEmptyMask = 0;
+    m_pauseTimeAccounting = false;
     for (uint32_t i = 0; i < fCnt; i++) {
         m_bytesInQueue[i] = 0;
         m_queues.push_back(CreateObject<DropTailQueue>());
@@ -79,6 +88,7 @@ bool BEgressQueue::DoEnqueue(Ptr<Packet> p, uint32_t qIndex) {
         m_queues[qIndex]->Enqueue(p);
         m_bytesInQueueTotal += p->GetSize();
         m_bytesInQueue[qIndex] += p->GetSize();
+        if (qIndex < qCnt) m_nonEmptyMask |= 1u << qIndex;
     } else {
         std::cout << "Warning: BEgressQueue::DoEnqueue failes to enqueue and drop a packet" << std::endl;
         return false;
@@ -86,6 +96,61 @@ bool BEgressQueue::DoEnqueue(Ptr<Packet> p, uint32_t qIndex) {
     return true;
 }
 
+uint32_t
+BEgressQueue::SelectQueueRR(bool paused[]) const {
+    if (m_nonEmptyMask & 1) return 0;  // 0 is the highest priority
+
+    uint32_t pausedMask = 0;
+    for (uint32_t i = 0; i < qCnt; i++) pausedMask |= (uint32_t)paused[i] << i;
+    uint32_t ready = m_nonEmptyMask & ~pausedMask;
+    if (ready == 0) return qCnt;
+
+    // round robin starting after m_rrlast: rotate the mask so that bit 0 is m_rrlast + 1
+    uint32_t start = (m_rrlast + 1) % qCnt;
+    uint32_t rotated = ((ready >> start) | (ready << (qCnt - start))) & ((1u << qCnt) - 1);
+    return (start + __builtin_ctz(rotated)) % qCnt;
+}
+
+uint32_t
+BEgressQueue::SelectQueueRRAndAccountPause(bool paused[]) {
+    if (m_queues[0]->GetNPackets() > 0) return 0;  // 0 is the highest priority
+
+    for (uint32_t i = 1; i <= qCnt; i++) {
+        uint32_t qIndex = (i + m_rrlast) % qCnt;
+        bool cond1 = !paused[qIndex];
+        bool cond2 = m_queues[qIndex]->GetNPackets() > 0;  // round robin
+
+        if (!cond1 && cond2) {
+            // Packet could be scheduled by RR, but could not be scheduled because of PAUSE
+            FlowIDNUMTag fit;
+            Ptr<const Packet> p = m_queues[qIndex]->Peek();
+            if (p->PeekPacketTag(fit)) {
+                unsigned flowid = static_cast<unsigned>(fit.GetId());
+                if (!MAP_KEY_EXISTS(current_pause_time, flowid))
+                    current_pause_time[flowid] = Simulator::Now();
+            }
+        } else if (cond1 && cond2) {
+            return qIndex;
+        }
+    }
+    return qCnt;
+}
+
+void BEgressQueue::AccountResume(Ptr<const Packet> p) {
+    // Check if the flow has been blocked by PFC
+    FlowIDNUMTag fit;
+    if (p->PeekPacketTag(fit)) {
+        unsigned flowid = static_cast<unsigned>(fit.GetId());
+        if (MAP_KEY_EXISTS(current_pause_time, flowid)) {
+            Time tdiff = Simulator::Now() - current_pause_time[flowid];
+            if (!MAP_KEY_EXISTS(acc_pause_time, flowid))
+                acc_pause_time[flowid] = Seconds(0);
+            acc_pause_time[flowid] = acc_pause_time[flowid] + tdiff;
+            current_pause_time.erase(flowid);
+        }
+    }
+}
+
 Ptr<Packet>
 BEgressQueue::DoDequeueRR(bool paused[])  // this is for switch only
 {
@@ -95,53 +160,14 @@ BEgressQueue::DoDequeueRR(bool paused[])  // this is for switch only
         NS_LOG_LOGIC("Queue empty");
         return 0;
     }
-    bool found = false;
-    uint32_t qIndex;
 
-    if (m_queues[0]->GetNPackets() > 0)  // 0 is the highest priority
-    {
-        found = true;
-        qIndex = 0;
-    } else {
-        if (!found) {
-            for (qIndex = 1; qIndex <= qCnt; qIndex++) {
-                bool cond1 = !paused[(qIndex + m_rrlast) % qCnt];
-                bool cond2 = m_queues[(qIndex + m_rrlast) % qCnt]->GetNPackets() > 0;  // round robin
-
-                if (!cond1 && cond2) {
-                    // Packet could be scheduled by RR, but could not be scheduled because of PAUSE
-                    FlowIDNUMTag fit;
-                    Ptr<Packet> p = ConstCast<Packet, const Packet>(m_queues[(qIndex + m_rrlast) % qCnt]->Peek());
-                    if (p->PeekPacketTag(fit)) {
-                        unsigned flowid = static_cast<unsigned>(fit.GetId());
-                        if (!MAP_KEY_EXISTS(current_pause_time, flowid))
-                            current_pause_time[flowid] = Simulator::Now();
-                    }
-                } else if (cond1 && cond2) {
-                    found = true;
-                    break;
-                }
-            }
-            qIndex = (qIndex + m_rrlast) % qCnt;
-        }
-    }
-    if (found) {
+    uint32_t qIndex =
+        m_pauseTimeAccounting ? SelectQueueRRAndAccountPause(paused) : SelectQueueRR(paused);
+    if (qIndex < qCnt) {
         Ptr<Packet> p = m_queues[qIndex]->Dequeue();
+        if (m_queues[qIndex]->GetNPackets() == 0) m_nonEmptyMask &= ~(1u << qIndex);
 
-        // Check if the flow has been blocked by PFC
-        if (p) {
-            FlowIDNUMTag fit;
-            if (p->PeekPacketTag(fit)) {
-                unsigned flowid = static_cast<unsigned>(fit.GetId());
-                if (MAP_KEY_EXISTS(current_pause_time, flowid)) {
-                    Time tdiff = Simulator::Now() - current_pause_time[flowid];
-                    if (!MAP_KEY_EXISTS(acc_pause_time, flowid))
-                        acc_pause_time[flowid] = Seconds(0);
-                    acc_pause_time[flowid] = acc_pause_time[flowid] + tdiff;
-                    current_pause_time.erase(flowid);
-                }
-            }
-        }
+        if (m_pauseTimeAccounting && p) AccountResume(p);
 
         m_traceBeqDequeue(p, qIndex);
         m_bytesInQueueTotal -= p->GetSize();
@@ -203,6 +229,7 @@ bool BEgressQueue::DoEnqueue(Ptr<Packet> p)  // for compatiability
         m_queues[qIndex]->Enqueue(p);
         m_bytesInQueueTotal += p->GetSize();
         m_bytesInQueue[qIndex] += p->GetSize();
+        m_nonEmptyMask |= 1u << qIndex;
     } else {
         return false;
     }
@@ -47,11 +47,15 @@ namespace ns3 {
 		TracedCallback<Ptr<const Packet>, uint32_t> m_traceBeqEnqueue;
 		TracedCallback<Ptr<const Packet>, uint32_t> m_traceBeqDequeue;
 		
+		// per-flow PFC pause time (acc_pause_time), only if PauseTimeAccounting is set
 		std::unordered_map<int32_t, Time> current_pause_time;
 
 	private:
 		bool DoEnqueue(Ptr<Packet> p, uint32_t qIndex);
 		Ptr<Packet> DoDequeueRR(bool paused[]);
+		uint32_t SelectQueueRR(bool paused[]) const; // qCnt if nothing can be sent
+		uint32_t SelectQueueRRAndAccountPause(bool paused[]);
+		void AccountResume(Ptr<const Packet> p);
 		//for compatibility
 		virtual bool DoEnqueue(Ptr<Packet> p);
 		virtual Ptr<Packet> DoDequeue(void);
@@ -61,6 +65,8 @@ namespace ns3 {
 		uint32_t m_bytesInQueueTotal;
 		uint32_t m_rrlast;
 		uint32_t m_qlast;
+		uint32_t m_nonEmptyMask; // bit i set if m_queues[i] (i < qCnt) has packets
+		bool m_pauseTimeAccounting;
 		std::vector<Ptr<Queue> > m_queues; // uc queues
 	};
 
@@ -0,0 +1,34 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2023 NUS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Chahwan Song <songch@comp.nus.edu.sg>
+ */
+
+
+#include "ns3/alloc-stats.h"
+
+namespace ns3 {
+
+AllocStats::Subsystem AllocStats::m_current = AllocStats::CORE;
+uint64_t AllocStats::m_count[AllocStats::N_SUBSYSTEMS];
+
+const char* AllocStats::GetName(Subsystem s) {
+    static const char* names[N_SUBSYSTEMS] = {"core", "link", "lb", "switch", "rdma", "monitor"};
+    return names[s];
+}
+
+}  // namespace ns3
@@ -0,0 +1,80 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2023 NUS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Chahwan Song <songch@comp.nus.edu.sg>
+ */
+
+
+#pragma once
+
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * @brief Heap allocations per simulator subsystem, for the performance report of the
+ * simulation (PERF_OUTPUT_FILE).
+ *
+ * The subsystems mark their entry points with a Scope; the program's replacement
+ * operator new calls Count(), which charges the allocation to the innermost Scope (CORE,
+ * i.e., the simulator and the program itself, outside of any). Only the simulation
+ * thread may enter Scopes and Count().
+ *
+ * The counting is compiled in only by ./waf configure --enable-alloc-stats
+ * (NS3_ALLOC_STATS); otherwise Scopes are empty, the program keeps the default
+ * allocator, and IsEnabled() is false.
+ */
+class AllocStats {
+   public:
+    enum Subsystem {
+        CORE = 0,
+        LINK,     // QbbNetDevice: queues, transmission, PFC
+        LB,       // switch ingress: routing and load balancing
+        SWITCH,   // switch egress: MMU admission, PFC/ECN marking
+        RDMA,     // RdmaHw: QPs, transport, congestion control
+        MONITOR,  // the monitors and outputs of the program
+        N_SUBSYSTEMS
+    };
+
+#ifdef NS3_ALLOC_STATS
+    class Scope {
+       public:
+        explicit Scope(Subsystem s) : m_prev(m_current) { m_current = s; }
+        ~Scope() { m_current = m_prev; }
+
+       private:
+        Subsystem m_prev;
+    };
+    static bool IsEnabled() { return true; }
+#else
+    class Scope {
+       public:
+        explicit Scope(Subsystem) {}
+    };
+    static bool IsEnabled() { return false; }
+#endif
+
+    static void Count() { m_count[m_current]++; }
+    static uint64_t Get(Subsystem s) { return m_count[s]; }
+    static const char* GetName(Subsystem s);
+
+   private:
+    static Subsystem m_current;
+    static uint64_t m_count[N_SUBSYSTEMS];
+};
+
+}  // namespace ns3
@@ -0,0 +1,214 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2023 NUS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Chahwan Song <songch@comp.nus.edu.sg>
+ */
+
+#include "ns3/async-output.h"
+
+#include <chrono>
+#include <iostream>
+
+#include "ns3/assert.h"
+#include "ns3/simulator.h"
+
+namespace ns3 {
+
+static const size_t WRITE_BLOCK = 1 << 16;  // bytes formatted before an fwrite
+static const uint64_t RELEASE_BATCH = 256;  // records formatted before the ring space is released
+
+AsyncOutput::AsyncOutput() : m_async(false), m_started(false), m_stop(false) {}
+
+AsyncOutput::~AsyncOutput() { Close(); }
+
+uint32_t AsyncOutput::OpenChannel(FILE* file, char separator) {
+    NS_ASSERT_MSG(!m_started, "AsyncOutput: channels must be opened before Start()");
+    NS_ASSERT_MSG(file != NULL, "AsyncOutput: no file");
+    std::unique_ptr<Channel> ch(new Channel);
+    ch->file = file;
+    ch->separator = separator;
+    ch->mask = 0;
+    ch->head.store(0);
+    ch->cachedTail = 0;
+    ch->nRecords = 0;
+    ch->nStalls = 0;
+    ch->maxOccupancy = 0;
+    ch->tail.store(0);
+    m_channels.push_back(std::move(ch));
+    return m_channels.size() - 1;
+}
+
+uint32_t AsyncOutput::OpenColumnarChannel(FILE* file, const std::vector<std::string>& columns) {
+    NS_ASSERT_MSG(columns.size() <= MAX_FIELDS, "AsyncOutput: too many columns");
+    uint32_t channel = OpenChannel(file, ',');
+    m_channels[channel]->columnar.reset(new ColumnarWriter);
+    m_channels[channel]->columnar->Open(file, columns);
+    return channel;
+}
+
+void AsyncOutput::Start(bool async, uint32_t ringCapacity) {
+    NS_ASSERT_MSG(!m_started, "AsyncOutput: already started");
+    m_async = async;
+    m_started = true;
+    for (auto& ch : m_channels) {
+        ch->buf.reserve(WRITE_BLOCK + MAX_FIELDS * 21);
+        if (m_async) {
+            uint64_t cap = 1;
+            while (cap < ringCapacity) cap <<= 1;
+            ch->ring.resize(cap);
+            ch->mask = cap - 1;
+        }
+    }
+    if (m_async) {
+        m_stop.store(false);
+        m_thread = std::thread(&AsyncOutput::Run, this);
+    }
+    Simulator::ScheduleDestroy(&AsyncOutput::Close, this);
+}
+
+void AsyncOutput::Write(uint32_t channel, const uint64_t* fields, uint32_t nField) {
+    NS_ASSERT_MSG(m_started, "AsyncOutput: not started");
+    NS_ASSERT_MSG(channel < m_channels.size() && nField <= MAX_FIELDS,
+                  "AsyncOutput: bad channel or too many fields");
+    Channel& ch = *m_channels[channel];
+    NS_ASSERT_MSG(!ch.columnar || nField == ch.columnar->GetNColumn(),
+                  "AsyncOutput: record does not match the columns");
+    ch.nRecords++;
+    if (!m_async) {
+        Record r;
+        r.nField = nField;
+        std::copy(fields, fields + nField, r.field);
+        Format(ch, r);
+        if (ch.buf.size() >= WRITE_BLOCK) WriteOut(ch, false);
+        return;
+    }
+
+    uint64_t h = ch.head.load(std::memory_order_relaxed);
+    if (h - ch.cachedTail > ch.mask) {
+        ch.cachedTail = ch.tail.load(std::memory_order_acquire);
+        if (h - ch.cachedTail > ch.mask) {
+            // full: wait for the writer (backpressure)
+            ch.nStalls++;
+            do {
+                std::this_thread::yield();
+                ch.cachedTail = ch.tail.load(std::memory_order_acquire);
+            } while (h - ch.cachedTail > ch.mask);
+        }
+    }
+    Record& r = ch.ring[h & ch.mask];
+    r.nField = nField;
+    std::copy(fields, fields + nField, r.field);
+    ch.head.store(h + 1, std::memory_order_release);
+    if (h + 1 - ch.cachedTail > ch.maxOccupancy) ch.maxOccupancy = h + 1 - ch.cachedTail;
+}
+
+void AsyncOutput::Format(Channel& ch, const Record& r) {
+    if (ch.columnar) {
+        ch.columnar->Append(r.field);  // writes a block to the file when it is full
+        return;
+    }
+    char tmp[20];
+    for (uint32_t i = 0; i < r.nField; i++) {
+        if (i > 0) ch.buf.push_back(ch.separator);
+        uint64_t v = r.field[i];
+        int n = 0;
+        do {
+            tmp[n++] = '0' + v % 10;
+            v /= 10;
+        } while (v > 0);
+        while (n > 0) ch.buf.push_back(tmp[--n]);
+    }
+    ch.buf.push_back('\n');
+}
+
+void AsyncOutput::WriteOut(Channel& ch, bool flush) {
+    if (!ch.buf.empty()) {
+        fwrite(ch.buf.data(), 1, ch.buf.size(), ch.file);
+        ch.buf.clear();
+    }
+    if (flush) fflush(ch.file);
+}
+
+uint64_t AsyncOutput::Drain(Channel& ch) {
+    uint64_t t = ch.tail.load(std::memory_order_relaxed);
+    uint64_t h = ch.head.load(std::memory_order_acquire);
+    uint64_t n = h - t;
+    while (t < h) {
+        uint64_t end = std::min(h, t + RELEASE_BATCH);
+        for (; t < end; t++) Format(ch, ch.ring[t & ch.mask]);
+        ch.tail.store(t, std::memory_order_release);
+        if (ch.buf.size() >= WRITE_BLOCK) WriteOut(ch, false);
+    }
+    return n;
+}
+
+void AsyncOutput::Run() {
+    uint32_t idleUs = 1;
+    while (true) {
+        // read the stop flag before draining, so that the last pass sees every record
+        bool stop = m_stop.load(std::memory_order_acquire);
+        uint64_t n = 0;
+        for (auto& ch : m_channels) n += Drain(*ch);
+        if (n > 0) {
+            idleUs = 1;
+            continue;
+        }
+        if (stop) break;
+        // idle: hand what we have to the files, then back off
+        if (idleUs == 1) {
+            for (auto& ch : m_channels) WriteOut(*ch, true);
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(idleUs));
+        idleUs = std::min<uint32_t>(idleUs * 2, 1000);
+    }
+}
+
+void AsyncOutput::Close() {
+    if (!m_started) return;
+    if (m_async) {
+        m_stop.store(true, std::memory_order_release);
+        m_thread.join();
+    }
+    // channels in the order they were opened
+    for (auto& ch : m_channels) {
+        if (ch->columnar) ch->columnar->Flush();
+        WriteOut(*ch, true);
+    }
+    m_started = false;
+
+    if (m_async && GetNRecords() > 0) {
+        uint64_t maxOccupancy = 0;
+        for (auto& ch : m_channels) maxOccupancy = std::max(maxOccupancy, ch->maxOccupancy);
+        std::cout << "AsyncOutput: " << GetNRecords() << " records, " << GetNStalls()
+                  << " stalls on a full ring, max ring occupancy " << maxOccupancy << "/"
+                  << m_channels[0]->ring.size() << std::endl;
+    }
+}
+
+uint64_t AsyncOutput::GetNRecords() const {
+    uint64_t n = 0;
+    for (auto& ch : m_channels) n += ch->nRecords;
+    return n;
+}
+
+uint64_t AsyncOutput::GetNStalls() const {
+    uint64_t n = 0;
+    for (auto& ch : m_channels) n += ch->nStalls;
+    return n;
+}
+
+}  // namespace ns3
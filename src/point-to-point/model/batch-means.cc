@@ -0,0 +1,87 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2023 NUS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Chahwan Song <songch@comp.nus.edu.sg>
+ */
+
+#include "ns3/batch-means.h"
+
+#include <math.h>
+
+#include <algorithm>
+
+#include "ns3/assert.h"
+
+namespace ns3 {
+
+// two-sided 95% Student-t critical values, for 1..30 degrees of freedom
+static const double T_975[30] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306,
+                                 2.262,  2.228, 2.201, 2.179, 2.160, 2.145, 2.131, 2.120,
+                                 2.110,  2.101, 2.093, 2.086, 2.080, 2.074, 2.069, 2.064,
+                                 2.060,  2.056, 2.052, 2.048, 2.045, 2.042};
+
+static double GetT975(uint32_t df) {
+    if (df == 0) return INFINITY;
+    if (df <= 30) return T_975[df - 1];
+    return 1.960 + 2.4 / df;  // within 0.1% of the exact value above 30
+}
+
+BatchMeansCi::BatchMeansCi(uint32_t batchSize, const std::vector<double>& quantiles)
+    : m_batchSize(batchSize),
+      m_quantiles(quantiles),
+      m_sum(quantiles.size(), 0),
+      m_sumSq(quantiles.size(), 0),
+      m_nBatch(0) {
+    NS_ASSERT_MSG(batchSize >= 2, "BatchMeansCi: batches need at least two values");
+    m_batch.reserve(batchSize);
+}
+
+bool BatchMeansCi::Add(double v) {
+    m_batch.push_back(v);
+    if (m_batch.size() < m_batchSize) return false;
+    for (uint32_t i = 0; i < m_quantiles.size(); i++) {
+        auto nth = m_batch.begin() + (size_t)(m_quantiles[i] * (m_batch.size() - 1));
+        std::nth_element(m_batch.begin(), nth, m_batch.end());
+        m_sum[i] += *nth;
+        m_sumSq[i] += *nth * *nth;
+    }
+    m_batch.clear();
+    m_nBatch++;
+    return true;
+}
+
+void BatchMeansCi::GetCi(uint32_t i, double& mean, double& halfWidth) const {
+    mean = m_nBatch > 0 ? m_sum[i] / m_nBatch : 0;
+    if (m_nBatch < 2) {
+        halfWidth = INFINITY;
+        return;
+    }
+    double var = std::max(0.0, (m_sumSq[i] - m_nBatch * mean * mean) / (m_nBatch - 1));
+    halfWidth = GetT975(m_nBatch - 1) * sqrt(var / m_nBatch);
+}
+
+bool BatchMeansCi::IsPrecise(double relPrecision, uint32_t minBatches) const {
+    if (m_nBatch < std::max<uint32_t>(minBatches, 2)) return false;
+    for (uint32_t i = 0; i < m_quantiles.size(); i++) {
+        double mean, halfWidth;
+        GetCi(i, mean, halfWidth);
+        if (halfWidth > relPrecision * mean) return false;
+    }
+    return true;
+}
+
+}  // namespace ns3
@@ -0,0 +1,59 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2023 NUS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Chahwan Song <songch@comp.nus.edu.sg>
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * @brief Confidence intervals of quantiles of a steady-state output (e.g. the p50/p99
+ * FCT slowdown) by batch means. Consecutive values are cut into batches of batchSize;
+ * each quantile is computed exactly within a batch, and the batch quantiles, which
+ * are close to independent for large enough batches, give a mean and a 95% Student-t
+ * confidence interval.
+ */
+class BatchMeansCi {
+   public:
+    BatchMeansCi(uint32_t batchSize, const std::vector<double>& quantiles);
+
+    /** @brief Returns true if v completed a batch */
+    bool Add(double v);
+
+    uint32_t GetNBatches() const { return m_nBatch; }
+    const std::vector<double>& GetQuantiles() const { return m_quantiles; }
+    /** @brief Mean of the batch values of quantile i, and the half-width of its 95% CI */
+    void GetCi(uint32_t i, double& mean, double& halfWidth) const;
+    /** @brief All quantiles have a CI half-width <= relPrecision * mean, over >= minBatches */
+    bool IsPrecise(double relPrecision, uint32_t minBatches) const;
+
+   private:
+    uint32_t m_batchSize;
+    std::vector<double> m_quantiles;
+    std::vector<double> m_batch;  // values of the current batch
+    std::vector<double> m_sum;    // per quantile, over the batches
+    std::vector<double> m_sumSq;
+    uint32_t m_nBatch;
+};
+
+}  // namespace ns3
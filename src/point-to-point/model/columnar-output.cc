@@ -0,0 +1,231 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2023 NUS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Chahwan Song <songch@comp.nus.edu.sg>
+ */
+
+#include "ns3/columnar-output.h"
+
+#include <string.h>
+
+#include <iostream>
+
+#include "ns3/assert.h"
+
+#ifdef NS3_ZLIB
+#include <zlib.h>
+#endif
+
+namespace ns3 {
+
+static const char COLUMNAR_MAGIC[8] = {'M', 'O', 'N', 'C', 'O', 'L', '\0', '\0'};
+static const uint32_t COLUMNAR_VERSION = 1;
+static const uint32_t MAX_VARINT = 10;  // bytes of a 64-bit varint
+
+/*----- ColumnarWriter ------*/
+ColumnarWriter::ColumnarWriter()
+    : m_file(NULL), m_nColumn(0), m_blockRows(0), m_nRow(0), m_nTotalRow(0), m_nByte(0) {}
+
+void ColumnarWriter::Open(FILE* file, const std::vector<std::string>& columns,
+                          uint32_t blockRows) {
+    NS_ASSERT_MSG(file != NULL && !columns.empty() && blockRows > 0,
+                  "Columnar: needs a file, columns and a block size");
+    m_file = file;
+    m_nColumn = columns.size();
+    m_blockRows = blockRows;
+    m_nRow = 0;
+    m_values.assign((size_t)m_nColumn * m_blockRows, 0);
+    m_raw.resize((size_t)m_nColumn * m_blockRows * MAX_VARINT);
+    m_nTotalRow = 0;
+
+    std::string names;
+    for (const auto& c : columns) names.append(c.c_str(), c.size() + 1);
+    ColumnarHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, COLUMNAR_MAGIC, sizeof(COLUMNAR_MAGIC));
+    h.version = COLUMNAR_VERSION;
+    h.nColumn = m_nColumn;
+    h.blockRows = m_blockRows;
+    h.namesSize = names.size();
+    fwrite(&h, sizeof(h), 1, m_file);
+    fwrite(names.data(), 1, names.size(), m_file);
+    m_nByte = sizeof(h) + names.size();
+}
+
+void ColumnarWriter::Append(const uint64_t* row) {
+    NS_ASSERT_MSG(m_file != NULL, "Columnar: writer is not open");
+    for (uint32_t c = 0; c < m_nColumn; c++) m_values[(size_t)c * m_blockRows + m_nRow] = row[c];
+    m_nTotalRow++;
+    if (++m_nRow == m_blockRows) Flush();
+}
+
+void ColumnarWriter::Flush() {
+    if (m_file == NULL || m_nRow == 0) return;
+
+    // delta + zigzag + varint, column by column
+    uint8_t* p = m_raw.data();
+    for (uint32_t c = 0; c < m_nColumn; c++) {
+        const uint64_t* v = &m_values[(size_t)c * m_blockRows];
+        uint64_t prev = 0;
+        for (uint32_t r = 0; r < m_nRow; r++) {
+            int64_t d = (int64_t)(v[r] - prev);
+            uint64_t z = ((uint64_t)d << 1) ^ (uint64_t)(d >> 63);
+            prev = v[r];
+            while (z >= 0x80) {
+                *p++ = (uint8_t)(z | 0x80);
+                z >>= 7;
+            }
+            *p++ = (uint8_t)z;
+        }
+    }
+
+    ColumnarBlockHeader b;
+    b.nRow = m_nRow;
+    b.rawSize = p - m_raw.data();
+    b.codec = ColumnarBlockHeader::RAW;
+    b.storedSize = b.rawSize;
+    const uint8_t* stored = m_raw.data();
+#ifdef NS3_ZLIB
+    uLongf size = compressBound(b.rawSize);
+    m_stored.resize(size);
+    if (compress2(m_stored.data(), &size, m_raw.data(), b.rawSize, Z_BEST_SPEED) == Z_OK &&
+        size < b.rawSize) {
+        b.codec = ColumnarBlockHeader::ZLIB;
+        b.storedSize = size;
+        stored = m_stored.data();
+    }
+#endif
+    fwrite(&b, sizeof(b), 1, m_file);
+    fwrite(stored, 1, b.storedSize, m_file);
+    m_nByte += sizeof(b) + b.storedSize;
+    m_nRow = 0;
+}
+
+/*----- ColumnarReader ------*/
+ColumnarReader::ColumnarReader() : m_file(NULL), m_nRow(0), m_cur(0) {}
+
+ColumnarReader::~ColumnarReader() { Close(); }
+
+bool ColumnarReader::Open(const std::string& file) {
+    Close();
+    m_file = fopen(file.c_str(), "rb");
+    if (m_file == NULL) {
+        std::cerr << "Columnar: cannot open " << file << std::endl;
+        return false;
+    }
+    ColumnarHeader h;
+    std::vector<char> names;
+    bool ok = fread(&h, sizeof(h), 1, m_file) == 1 &&
+              memcmp(h.magic, COLUMNAR_MAGIC, sizeof(COLUMNAR_MAGIC)) == 0 &&
+              h.version == COLUMNAR_VERSION && h.nColumn > 0;
+    if (ok) {
+        names.resize(h.namesSize);
+        ok = fread(names.data(), 1, names.size(), m_file) == names.size();
+    }
+    for (size_t i = 0; ok && i < names.size() && m_columns.size() < h.nColumn;) {
+        m_columns.push_back(std::string(&names[i]));
+        i += m_columns.back().size() + 1;
+    }
+    if (!ok || m_columns.size() != h.nColumn) {
+        std::cerr << "Columnar: " << file << " is not a (version " << COLUMNAR_VERSION
+                  << ") columnar file" << std::endl;
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void ColumnarReader::Close() {
+    if (m_file != NULL) fclose(m_file);
+    m_file = NULL;
+    m_columns.clear();
+    m_nRow = m_cur = 0;
+}
+
+int ColumnarReader::GetColumnIndex(const std::string& name) const {
+    for (uint32_t i = 0; i < m_columns.size(); i++) {
+        if (m_columns[i] == name) return i;
+    }
+    return -1;
+}
+
+bool ColumnarReader::NextBlock() {
+    m_nRow = m_cur = 0;
+    ColumnarBlockHeader b;
+    if (m_file == NULL || fread(&b, sizeof(b), 1, m_file) != 1) return false;
+    m_stored.resize(b.storedSize);
+    if (fread(m_stored.data(), 1, b.storedSize, m_file) != b.storedSize) {
+        std::cerr << "Columnar: truncated block" << std::endl;
+        return false;
+    }
+    const uint8_t* raw = m_stored.data();
+    if (b.codec == ColumnarBlockHeader::ZLIB) {
+#ifdef NS3_ZLIB
+        m_raw.resize(b.rawSize);
+        uLongf size = b.rawSize;
+        if (uncompress(m_raw.data(), &size, m_stored.data(), b.storedSize) != Z_OK ||
+            size != b.rawSize) {
+            std::cerr << "Columnar: corrupt block" << std::endl;
+            return false;
+        }
+        raw = m_raw.data();
+#else
+        std::cerr << "Columnar: the file is zlib-compressed, but this build has no zlib"
+                  << std::endl;
+        return false;
+#endif
+    } else if (b.codec != ColumnarBlockHeader::RAW) {
+        std::cerr << "Columnar: unknown codec " << b.codec << std::endl;
+        return false;
+    }
+
+    uint32_t nColumn = m_columns.size();
+    m_values.resize((size_t)nColumn * b.nRow);
+    const uint8_t* p = raw;
+    const uint8_t* end = raw + b.rawSize;
+    for (size_t i = 0; i < m_values.size(); i++) {
+        uint64_t z = 0;
+        for (uint32_t shift = 0; p < end; shift += 7) {
+            z |= (uint64_t)(*p & 0x7f) << shift;
+            if (*p++ < 0x80) break;
+        }
+        uint64_t d = (z >> 1) ^ -(z & 1);
+        m_values[i] = (i % b.nRow == 0 ? 0 : m_values[i - 1]) + d;
+    }
+    m_nRow = b.nRow;
+    return true;
+}
+
+bool ColumnarReader::Next(uint64_t* row) {
+    while (m_cur == m_nRow) {
+        if (!NextBlock()) return false;
+    }
+    for (uint32_t c = 0; c < m_columns.size(); c++) row[c] = m_values[(size_t)c * m_nRow + m_cur];
+    m_cur++;
+    return true;
+}
+
+std::string GetColumnarPath(const std::string& textPath) {
+    const std::string ext = ".txt";
+    if (textPath.size() >= ext.size() &&
+        textPath.compare(textPath.size() - ext.size(), ext.size(), ext) == 0) {
+        return textPath.substr(0, textPath.size() - ext.size()) + ".col";
+    }
+    return textPath + ".col";
+}
+
+}  // namespace ns3
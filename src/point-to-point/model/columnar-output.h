@@ -0,0 +1,130 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2023 NUS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Chahwan Song <songch@comp.nus.edu.sg>
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * @brief Columnar time-series file for the periodic monitoring outputs
+ * (VOQ, uplink, connections). Rows of nColumn unsigned integers are cut into
+ * blocks of up to blockRows rows. In a block, each column is stored as the
+ * zigzag-varint deltas to the previous row (the first row against 0), columns
+ * one after another, and the block is then zlib-compressed (if the build has
+ * zlib). Blocks decode independently. All integers are little-endian.
+ *
+ *   ColumnarHeader, nColumn '\0'-terminated column names (namesSize bytes),
+ *   then per block: ColumnarBlockHeader, storedSize bytes
+ *
+ * analysis/columnar.py reads the same format.
+ */
+struct ColumnarHeader {
+    char magic[8];       // "MONCOL\0\0"
+    uint32_t version;    // 1
+    uint32_t nColumn;
+    uint32_t blockRows;  // rows per block (the last one may be shorter)
+    uint32_t namesSize;
+};
+
+struct ColumnarBlockHeader {
+    static const uint32_t RAW = 0;
+    static const uint32_t ZLIB = 1;
+
+    uint32_t nRow;
+    uint32_t codec;
+    uint32_t rawSize;     // size of the encoded columns
+    uint32_t storedSize;  // size after the codec
+};
+
+/**
+ * @brief Writes a columnar file into a FILE it does not own. Rows are buffered
+ * and a block is encoded when it is full; Flush() writes a partial one.
+ */
+class ColumnarWriter {
+   public:
+    ColumnarWriter();
+
+    void Open(FILE* file, const std::vector<std::string>& columns, uint32_t blockRows = 4096);
+    uint32_t GetNColumn() const { return m_nColumn; }
+
+    /** @brief Append a row of GetNColumn() values */
+    void Append(const uint64_t* row);
+    /** @brief Write the buffered rows as a (short) block */
+    void Flush();
+
+    uint64_t GetNRows() const { return m_nTotalRow; }
+    uint64_t GetBytes() const { return m_nByte; }  // written so far
+
+   private:
+    FILE* m_file;
+    uint32_t m_nColumn;
+    uint32_t m_blockRows;
+    uint32_t m_nRow;                // rows in the current block
+    std::vector<uint64_t> m_values;  // current block, column-major
+    std::vector<uint8_t> m_raw;
+    std::vector<uint8_t> m_stored;
+    uint64_t m_nTotalRow;
+    uint64_t m_nByte;
+};
+
+/**
+ * @brief Reads a columnar file block by block, or row by row with Next().
+ */
+class ColumnarReader {
+   public:
+    ColumnarReader();
+    ~ColumnarReader();
+
+    /** @brief Returns false (with a message) if the file is not a columnar file */
+    bool Open(const std::string& file);
+    void Close();
+
+    const std::vector<std::string>& GetColumns() const { return m_columns; }
+    /** @brief Index of a column by name, or -1 */
+    int GetColumnIndex(const std::string& name) const;
+
+    /** @brief Decode the next block; false at the end of the file (or on a corrupt block) */
+    bool NextBlock();
+    uint32_t GetNRows() const { return m_nRow; }  // of the current block
+    const uint64_t* GetColumn(uint32_t i) const { return &m_values[(size_t)i * m_nRow]; }
+
+    /** @brief Copy the next row (GetColumns().size() values); false at the end */
+    bool Next(uint64_t* row);
+
+   private:
+    FILE* m_file;
+    std::vector<std::string> m_columns;
+    uint32_t m_nRow;
+    uint32_t m_cur;  // row cursor of Next() in the current block
+    std::vector<uint64_t> m_values;
+    std::vector<uint8_t> m_raw;
+    std::vector<uint8_t> m_stored;
+};
+
+/** @brief "out_uplink.txt" -> "out_uplink.col": where a text monitoring file goes in columnar format */
+std::string GetColumnarPath(const std::string& textPath);
+
+}  // namespace ns3
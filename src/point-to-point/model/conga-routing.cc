@@ -25,11 +25,13 @@
 #include "ns3/event-id.h"
 #include "ns3/ipv4-header.h"
 #include "ns3/log.h"
+#include "ns3/mem-stats.h"
 #include "ns3/nstime.h"
 #include "ns3/object.h"
 #include "ns3/packet.h"
 #include "ns3/settings.h"
 #include "ns3/simulator.h"
+#include "ns3/switch-node.h"
 
 NS_LOG_COMPONENT_DEFINE("CongaRouting");
 
@@ -37,18 +39,20 @@ namespace ns3 {
 
 /*---- Conga-Tag -----*/
 
+NS_OBJECT_ENSURE_REGISTERED(CongaTag);
+
 CongaTag::CongaTag() {}
 CongaTag::~CongaTag() {}
 TypeId CongaTag::GetTypeId(void) {
     static TypeId tid = TypeId("ns3::CongaTag").SetParent<Tag>().AddConstructor<CongaTag>();
     return tid;
 }
-void CongaTag::SetPathId(uint32_t pathId) { m_pathId = pathId; }
-uint32_t CongaTag::GetPathId(void) const { return m_pathId; }
+void CongaTag::SetPathId(PathId pathId) { m_pathId = pathId; }
+PathId CongaTag::GetPathId(void) const { return m_pathId; }
 void CongaTag::SetCe(uint32_t ce) { m_ce = ce; }
 uint32_t CongaTag::GetCe(void) const { return m_ce; }
-void CongaTag::SetFbPathId(uint32_t fbPathId) { m_fbPathId = fbPathId; }
-uint32_t CongaTag::GetFbPathId(void) const { return m_fbPathId; }
+void CongaTag::SetFbPathId(PathId fbPathId) { m_fbPathId = fbPathId; }
+PathId CongaTag::GetFbPathId(void) const { return m_fbPathId; }
 void CongaTag::SetFbMetric(uint32_t fbMetric) { m_fbMetric = fbMetric; }
 uint32_t CongaTag::GetFbMetric(void) const { return m_fbMetric; }
 
@@ -56,21 +60,21 @@ void CongaTag::SetHopCount(uint32_t hopCount) { m_hopCount = hopCount; }
 uint32_t CongaTag::GetHopCount(void) const { return m_hopCount; }
 TypeId CongaTag::GetInstanceTypeId(void) const { return GetTypeId(); }
 uint32_t CongaTag::GetSerializedSize(void) const {
-    return sizeof(uint32_t) + sizeof(uint32_t) + sizeof(uint32_t) + sizeof(uint32_t) +
-           sizeof(uint32_t);
+    return PathCodec::GetSerializedSize() + sizeof(uint32_t) + sizeof(uint32_t) +
+           PathCodec::GetSerializedSize() + sizeof(uint32_t);
 }
 void CongaTag::Serialize(TagBuffer i) const {
-    i.WriteU32(m_pathId);
+    PathCodec::Serialize(i, m_pathId);
     i.WriteU32(m_ce);
     i.WriteU32(m_hopCount);
-    i.WriteU32(m_fbPathId);
+    PathCodec::Serialize(i, m_fbPathId);
     i.WriteU32(m_fbMetric);
 }
 void CongaTag::Deserialize(TagBuffer i) {
-    m_pathId = i.ReadU32();
+    m_pathId = PathCodec::Deserialize(i);
     m_ce = i.ReadU32();
     m_hopCount = i.ReadU32();
-    m_fbPathId = i.ReadU32();
+    m_fbPathId = PathCodec::Deserialize(i);
     m_fbMetric = i.ReadU32();
 }
 void CongaTag::Print(std::ostream& os) const {
@@ -83,6 +87,7 @@ void CongaTag::Print(std::ostream& os) const {
 
 /*----- Conga-Route ------*/
 uint32_t CongaRouting::nFlowletTimeout = 0;
+HdrHistogram CongaRouting::m_flowletGapHist;
 CongaRouting::CongaRouting() {
     m_isToR = false;
     m_switch_id = (uint32_t)-1;
@@ -100,9 +105,11 @@ uint64_t CongaRouting::GetQpKey(uint32_t dip, uint16_t sport, uint16_t dport, ui
     return ((uint64_t)dip << 32) | ((uint64_t)sport << 16) | (uint64_t)pg | (uint64_t)dport;
 }
 
+NS_LOAD_BALANCER_REGISTER(CongaRouting, 3);
+
 TypeId CongaRouting::GetTypeId(void) {
     static TypeId tid =
-        TypeId("ns3::CongaRouting").SetParent<Object>().AddConstructor<CongaRouting>();
+        TypeId("ns3::CongaRouting").SetParent<LoadBalancer>().AddConstructor<CongaRouting>();
 
     return tid;
 }
@@ -124,10 +131,60 @@ void CongaRouting::SetSwitchSendToDevCallback(SwitchSendToDevCallback switchSend
 }
 
 void CongaRouting::SetSwitchInfo(bool isToR, uint32_t switch_id) {
+    LoadBalancer::SetSwitchInfo(isToR, switch_id);
     m_isToR = isToR;
     m_switch_id = switch_id;
 }
 
+void CongaRouting::InstallTo(Ptr<SwitchNode> sw) {
+    m_switch = PeekPointer(sw);
+    // Conga's Callback for switch functions
+    SetSwitchSendCallback(MakeCallback(&SwitchNode::DoSwitchSend, m_switch));
+    SetSwitchSendToDevCallback(MakeCallback(&SwitchNode::SendToDevContinue, m_switch));
+    sw->SetLoadBalancer(this, &SwitchNode::SendToDevHijack<CongaRouting>);
+}
+
+void CongaRouting::AddPath(uint32_t dstToRId, PathId pathId, Time baseRtt) {
+    // feedback tables are dynamically filled in RouteInput
+    m_congaFromLeafTable[dstToRId];
+    m_congaToLeafTable[dstToRId];
+    m_congaRoutingTable[dstToRId].insert(pathId);
+}
+
+void CongaRouting::RemovePath(uint32_t dstToRId, PathId pathId) {
+    m_congaRoutingTable[dstToRId].erase(pathId);
+    m_congaToLeafTable[dstToRId].erase(pathId);  // its remote congestion is stale
+}
+
+uint64_t CongaRouting::GetPathTableBytes() const {
+    uint64_t bytes = TreeBytes(m_congaRoutingTable.size(),
+                               sizeof(uint32_t) + sizeof(std::set<PathId>));
+    for (const auto& dst : m_congaRoutingTable) {
+        bytes += TreeBytes(dst.second.size(), sizeof(PathId));
+    }
+    bytes += TreeBytes(m_congaFromLeafTable.size(),
+                       sizeof(uint32_t) + sizeof(std::map<PathId, FeedbackInfo>));
+    for (const auto& src : m_congaFromLeafTable) {
+        bytes += TreeBytes(src.second.size(), sizeof(PathId) + sizeof(FeedbackInfo));
+    }
+    bytes += TreeBytes(m_congaToLeafTable.size(),
+                       sizeof(uint32_t) + sizeof(std::map<PathId, OutpathInfo>));
+    for (const auto& dst : m_congaToLeafTable) {
+        bytes += TreeBytes(dst.second.size(), sizeof(PathId) + sizeof(OutpathInfo));
+    }
+    return bytes;
+}
+
+void CongaRouting::ReportMemory(MemStats& stats) const {
+    uint64_t nPaths = 0;
+    for (const auto& dst : m_congaRoutingTable) nPaths += dst.second.size();
+    stats.Add(MemStats::LB_PATH, nPaths, GetPathTableBytes());
+    stats.Add(MemStats::LB_FLOWLET, m_flowletTable.GetNOccupied(),
+              m_flowletTable.GetMemoryUsage());
+    stats.Add(MemStats::LB_STATE, m_DreMap.size() + m_outPort2BitRateMap.size(),
+              MemStats::TreeBytes(m_DreMap) + MemStats::TreeBytes(m_outPort2BitRateMap));
+}
+
 void CongaRouting::SetLinkCapacity(uint32_t outPort, uint64_t bitRate) {
     auto it = m_outPort2BitRateMap.find(outPort);
     if (it != m_outPort2BitRateMap.end()) {
@@ -200,7 +257,7 @@ void CongaRouting::RouteInput(Ptr<Packet> p, CustomHeader ch) {
             auto innerFbItr = (fbItr->second).begin();
             if (!(fbItr->second).empty()) {
                 std::advance(innerFbItr,
-                             rand() % (fbItr->second).size());  // uniformly-random feedback
+                             GetRandom((fbItr->second).size()));  // uniformly-random feedback
                 // set values to new CongaTag
                 congaTag.SetHopCount(0);                       // hopCount
                 congaTag.SetFbPathId(innerFbItr->first);       // path
@@ -208,22 +265,18 @@ void CongaRouting::RouteInput(Ptr<Packet> p, CustomHeader ch) {
             } else {
                 // empty (nothing to feedback) then set a dummy
                 congaTag.SetHopCount(0);           // hopCount
-                congaTag.SetFbPathId(CONGA_NULL);  // path
+                congaTag.SetFbPathId(PATH_ID_NULL);  // path
                 congaTag.SetFbMetric(CONGA_NULL);  // ce
             }
 
             /*---- choosing outPort ----*/
-            struct Flowlet* flowlet = NULL;
-            auto flowletItr = m_flowletTable.find(qpkey);
-            uint32_t selectedPath;
+            struct Flowlet* flowlet = m_flowletTable.Find(qpkey, now);
+            PathId selectedPath;
 
             // 1) when flowlet already exists
-            if (flowletItr != m_flowletTable.end()) {
-                flowlet = flowletItr->second;
-                assert(flowlet != NULL &&
-                       "Impossible in normal cases - flowlet is not correctly registered");
-
-                if (now - flowlet->_activeTime <= m_flowletTimeout) {  // no timeout
+            if (flowlet != NULL) {
+                if (now - flowlet->_activeTime <= m_flowletTimeout &&
+                    HasPath(dstToRId, flowlet->_PathId)) {  // no timeout, path is not removed
                     // update flowlet info
                     flowlet->_activeTime = now;
                     flowlet->_nPackets++;
@@ -231,7 +284,7 @@ void CongaRouting::RouteInput(Ptr<Packet> p, CustomHeader ch) {
                     // update/measure CE of this outPort and add CongaTag
                     selectedPath = flowlet->_PathId;
                     uint32_t outPort =
-                        GetOutPortFromPath(selectedPath, 0);      // sender switch is 0th hop
+                        PathCodec::GetOutPort(selectedPath, 0);   // sender switch is 0th hop
                     uint32_t X = UpdateLocalDre(p, ch, outPort);  // update
                     uint32_t localCe = QuantizingX(outPort, X);   // quantize
                     congaTag.SetCe(localCe);
@@ -243,9 +296,10 @@ void CongaRouting::RouteInput(Ptr<Packet> p, CustomHeader ch) {
                                                 << congaTag.GetCe() << outPort << "FbPath/Metric"
                                                 << congaTag.GetFbPathId() << congaTag.GetFbMetric()
                                                 << now);
-                    DoSwitchSend(p, ch, GetOutPortFromPath(selectedPath, congaTag.GetHopCount()),
+                    DoSwitchSend(p, ch,
+                                 PathCodec::GetOutPort(selectedPath, congaTag.GetHopCount()),
                                  ch.udp.pg);
-                    // return GetOutPortFromPath(selectedPath, congaTag.GetHopCount());
+                    // return PathCodec::GetOutPort(selectedPath, congaTag.GetHopCount());
                     return;
                 }
 
@@ -253,6 +307,7 @@ void CongaRouting::RouteInput(Ptr<Packet> p, CustomHeader ch) {
                 // NS_LOG_FUNCTION("Flowlet expires, calculate the new port");
                 selectedPath = GetBestPath(dstToRId, 4);
                 CongaRouting::nFlowletTimeout++;
+                m_flowletGapHist.Record((now - flowlet->_activeTime).GetNanoSeconds());
 
                 // update flowlet info
                 flowlet->_activatedTime = now;
@@ -261,7 +316,7 @@ void CongaRouting::RouteInput(Ptr<Packet> p, CustomHeader ch) {
                 flowlet->_PathId = selectedPath;
 
                 // update/add CongaTag
-                uint32_t outPort = GetOutPortFromPath(selectedPath, 0);
+                uint32_t outPort = PathCodec::GetOutPort(selectedPath, 0);
                 uint32_t X = UpdateLocalDre(p, ch, outPort);  // update
                 uint32_t localCe = QuantizingX(outPort, X);   // quantize
                 congaTag.SetCe(localCe);
@@ -279,15 +334,14 @@ void CongaRouting::RouteInput(Ptr<Packet> p, CustomHeader ch) {
             }
             // 2) flowlet does not exist, e.g., first packet of flow
             selectedPath = GetBestPath(dstToRId, 4);
-            struct Flowlet* newFlowlet = new Flowlet;
+            struct Flowlet* newFlowlet = m_flowletTable.Insert(qpkey, now);
             newFlowlet->_activeTime = now;
             newFlowlet->_activatedTime = now;
             newFlowlet->_nPackets = 1;
             newFlowlet->_PathId = selectedPath;
-            m_flowletTable[qpkey] = newFlowlet;
 
             // update/add CongaTag
-            uint32_t outPort = GetOutPortFromPath(selectedPath, 0);
+            uint32_t outPort = PathCodec::GetOutPort(selectedPath, 0);
             uint32_t X = UpdateLocalDre(p, ch, outPort);  // update
             uint32_t localCe = QuantizingX(outPort, X);   // quantize
             congaTag.SetCe(localCe);
@@ -298,9 +352,9 @@ void CongaRouting::RouteInput(Ptr<Packet> p, CustomHeader ch) {
                                         << "Path/CE/outPort" << selectedPath << congaTag.GetCe()
                                         << outPort << "FbPath/Metric" << congaTag.GetFbPathId()
                                         << congaTag.GetFbMetric() << now);
-            DoSwitchSend(p, ch, GetOutPortFromPath(selectedPath, congaTag.GetHopCount()),
+            DoSwitchSend(p, ch, PathCodec::GetOutPort(selectedPath, congaTag.GetHopCount()),
                          ch.udp.pg);
-            // return GetOutPortFromPath(selectedPath, congaTag.GetHopCount());
+            // return PathCodec::GetOutPort(selectedPath, congaTag.GetHopCount());
             return;
         }
         /*---- receiver-side ----*/
@@ -308,7 +362,7 @@ void CongaRouting::RouteInput(Ptr<Packet> p, CustomHeader ch) {
         auto toLeafItr = m_congaToLeafTable.find(srcToRId);
         assert(toLeafItr != m_congaToLeafTable.end() && "Cannot find srcToRId from ToLeafTable");
         auto innerToLeafItr = (toLeafItr->second).find(congaTag.GetFbPathId());
-        if (congaTag.GetFbPathId() != CONGA_NULL &&
+        if (congaTag.GetFbPathId() != PATH_ID_NULL &&
             congaTag.GetFbMetric() != CONGA_NULL) {             // if valid feedback
             if (innerToLeafItr == (toLeafItr->second).end()) {  // no feedback so far, then create
                 OutpathInfo outpathInfo;
@@ -353,7 +407,7 @@ void CongaRouting::RouteInput(Ptr<Packet> p, CustomHeader ch) {
         congaTag.SetHopCount(hopCount);
 
         // get outPort
-        uint32_t outPort = GetOutPortFromPath(congaTag.GetPathId(), hopCount);
+        uint32_t outPort = PathCodec::GetOutPort(congaTag.GetPathId(), hopCount);
         uint32_t X = UpdateLocalDre(p, ch, outPort);                 // update
         uint32_t localCe = QuantizingX(outPort, X);                  // quantize
         uint32_t congestedCe = std::max(localCe, congaTag.GetCe());  // get more congested link's CE
@@ -373,13 +427,18 @@ void CongaRouting::RouteInput(Ptr<Packet> p, CustomHeader ch) {
     assert(false && "This should not be occured");
 }
 
+bool CongaRouting::HasPath(uint32_t dstToRId, PathId pathId) {
+    auto pathItr = m_congaRoutingTable.find(dstToRId);
+    return pathItr != m_congaRoutingTable.end() && pathItr->second.count(pathId);
+}
+
 // minimize the maximum link utilization
-uint32_t CongaRouting::GetBestPath(uint32_t dstToRId, uint32_t nSample) {
+PathId CongaRouting::GetBestPath(uint32_t dstToRId, uint32_t nSample) {
     auto pathItr = m_congaRoutingTable.find(dstToRId);
     assert(pathItr != m_congaRoutingTable.end() && "Cannot find dstToRId from ToLeafTable");
-    std::set<uint32_t>::iterator innerPathItr = pathItr->second.begin();
+    std::set<PathId>::iterator innerPathItr = pathItr->second.begin();
     if (pathItr->second.size() >= nSample) {  // exception handling
-        std::advance(innerPathItr, rand() % (pathItr->second.size() - nSample + 1));
+        std::advance(innerPathItr, GetRandom(pathItr->second.size() - nSample + 1));
     } else {
         nSample = pathItr->second.size();
         // std::cout << "WARNING - Conga's number of path sampling is higher than available paths.
@@ -390,18 +449,18 @@ uint32_t CongaRouting::GetBestPath(uint32_t dstToRId, uint32_t nSample) {
     auto pathInfoMap = m_congaToLeafTable[dstToRId];
 
     // get min-max path
-    std::vector<uint32_t> candidatePaths;
+    std::vector<PathId> candidatePaths;
     uint32_t minCongestion = CONGA_NULL;
     for (uint32_t i = 0; i < nSample; i++) {
         // get info of path
-        uint32_t pathId = *innerPathItr;
+        PathId pathId = *innerPathItr;
         auto innerPathInfo = pathInfoMap.find(pathId);
 
         // no info means good
         uint32_t localCongestion = 0;
         uint32_t remoteCongestion = 0;
 
-        auto outPort = GetOutPortFromPath(pathId, 0);  // outPort from pathId (TxToR)
+        auto outPort = PathCodec::GetOutPort(pathId, 0);  // outPort from pathId (TxToR)
 
         // local congestion -> get Port Util and quantize it
         auto innerDre = m_DreMap.find(outPort);
@@ -428,7 +487,7 @@ uint32_t CongaRouting::GetBestPath(uint32_t dstToRId, uint32_t nSample) {
         std::advance(innerPathItr, 1);
     }
     assert(candidatePaths.size() > 0 && "candidatePaths has no entry");
-    return candidatePaths[rand() % candidatePaths.size()];  // randomly choose the best path
+    return candidatePaths[GetRandom(candidatePaths.size())];  // randomly choose the best path
 }
 
 uint32_t CongaRouting::UpdateLocalDre(Ptr<Packet> p, CustomHeader ch, uint32_t outPort) {
@@ -440,15 +499,6 @@ uint32_t CongaRouting::UpdateLocalDre(Ptr<Packet> p, CustomHeader ch, uint32_t o
     return newX;
 }
 
-uint32_t CongaRouting::GetOutPortFromPath(const uint32_t& path, const uint32_t& hopCount) {
-    return ((uint8_t*)&path)[hopCount];
-}
-
-void CongaRouting::SetOutPortToPath(uint32_t& path, const uint32_t& hopCount,
-                                    const uint32_t& outPort) {
-    ((uint8_t*)&path)[hopCount] = outPort;
-}
-
 uint32_t CongaRouting::QuantizingX(uint32_t outPort, uint32_t X) {
     auto it = m_outPort2BitRateMap.find(outPort);
     assert(it != m_outPort2BitRateMap.end() && "Cannot find bitrate of interface");
@@ -468,14 +518,18 @@ void CongaRouting::SetConstants(Time dreTime, Time agingTime, Time flowletTimeou
     m_flowletTimeout = flowletTimeout;
     m_quantizeBit = quantizeBit;
     m_alpha = alpha;
+    m_flowletTable.SetAgingTime(agingTime);
+}
+
+void CongaRouting::SetFlowletTableMode(FlowletTable::Mode mode, uint32_t capacity) {
+    m_flowletTable.Configure(mode, capacity, m_agingTime);
 }
 
 void CongaRouting::DoDispose() {
-    for (auto i : m_flowletTable) {
-        delete (i.second);
-    }
+    m_flowletTable.Clear();
     m_dreEvent.Cancel();
     m_agingEvent.Cancel();
+    LoadBalancer::DoDispose();
 }
 
 void CongaRouting::DreEvent() {
@@ -513,15 +567,7 @@ void CongaRouting::AgingEvent() {
         ++itr2;
     }
 
-    auto itr3 = m_flowletTable.begin();
-    while (itr3 != m_flowletTable.end()) {
-        if (now - ((itr3->second)->_activeTime) > m_agingTime) {
-            // delete(itr3->second); // delete pointer
-            itr3 = m_flowletTable.erase(itr3);
-        } else {
-            ++itr3;
-        }
-    }
+    // flowlet entries are expired lazily by m_flowletTable
     NS_LOG_FUNCTION(Simulator::Now());
     m_agingEvent = Simulator::Schedule(m_agingTime, &CongaRouting::AgingEvent, this);
 }
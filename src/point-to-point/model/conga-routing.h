@@ -31,6 +31,9 @@
 #include "ns3/address.h"
 #include "ns3/callback.h"
 #include "ns3/event-id.h"
+#include "ns3/flowlet-table.h"
+#include "ns3/hdr-histogram.h"
+#include "ns3/load-balancer.h"
 #include "ns3/net-device.h"
 #include "ns3/object.h"
 #include "ns3/packet.h"
@@ -59,12 +62,12 @@ class CongaTag : public Tag {
     CongaTag();
     ~CongaTag();
     static TypeId GetTypeId(void);
-    void SetPathId(uint32_t pathId);
-    uint32_t GetPathId(void) const;
+    void SetPathId(PathId pathId);
+    PathId GetPathId(void) const;
     void SetCe(uint32_t ce);
     uint32_t GetCe(void) const;
-    void SetFbPathId(uint32_t fbPathId);
-    uint32_t GetFbPathId(void) const;
+    void SetFbPathId(PathId fbPathId);
+    PathId GetFbPathId(void) const;
     void SetFbMetric(uint32_t fbMetric);
     uint32_t GetFbMetric(void) const;
     void SetHopCount(uint32_t hopCount);
@@ -76,46 +79,51 @@ class CongaTag : public Tag {
     virtual void Print(std::ostream& os) const;
 
    private:
-    uint32_t m_pathId;    // forward
+    PathId m_pathId;      // forward
     uint32_t m_ce;        // forward
     uint32_t m_hopCount;  // hopCount to get outPort
-    uint32_t m_fbPathId;  // feedback
+    PathId m_fbPathId;    // feedback
     uint32_t m_fbMetric;  // feedback
 };
 
 /**
  * @brief Conga object is created for each ToR Switch
  */
-class CongaRouting : public Object {
-    friend class SwitchMmu;
+class CongaRouting : public LoadBalancer {
     friend class SwitchNode;
 
    public:
     CongaRouting();
 
-    /** path <-> outPort **/
-    // uint8_t pathp[4] = {uint8_t[port0], uint8_t[port1], uint8_t[port2], uint8_t[port3]}
-    // uint32_t path = *((uint32_t*) pathp);
-    // (uint8_t*)&path[0] -> port0
+    /** path <-> outPort: PathCodec (path-id.h) **/
 
     /* static */
     static TypeId GetTypeId(void);
     static uint64_t GetQpKey(uint32_t dip, uint16_t sport, uint16_t dport, uint16_t pg);              // same as in rdma_hw.cc
-    static uint32_t GetOutPortFromPath(const uint32_t& path, const uint32_t& hopCount);               // decode outPort from path, given a hop's order
-    static void SetOutPortToPath(uint32_t& path, const uint32_t& hopCount, const uint32_t& outPort);  // encode outPort to path
     static uint32_t nFlowletTimeout;                                                                  // number of flowlet's timeout
+    static HdrHistogram m_flowletGapHist;                                                             // idle time (ns) before a new flowlet
 
     /* main function */
     void RouteInput(Ptr<Packet> p, CustomHeader ch);
     uint32_t UpdateLocalDre(Ptr<Packet> p, CustomHeader ch, uint32_t outPort);
     uint32_t QuantizingX(uint32_t outPort, uint32_t X);  // X is bytes here and we quantizing it to 0 - 2^Q
-    uint32_t GetBestPath(uint32_t dstTorId, uint32_t nSample);
+    PathId GetBestPath(uint32_t dstTorId, uint32_t nSample);
+    bool HasPath(uint32_t dstToRId, PathId pathId);  // false once removed by RemovePath
+    virtual void InstallTo(Ptr<SwitchNode> sw);
     virtual void DoDispose();
 
     /* SET functions */
     void SetConstants(Time dreTime, Time agingTime, Time flowletTimeout, uint32_t quantizeBit, double alpha);
-    void SetSwitchInfo(bool isToR, uint32_t switch_id);
-    void SetLinkCapacity(uint32_t outPort, uint64_t bitRate);
+    virtual void SetSwitchInfo(bool isToR, uint32_t switch_id);
+    virtual void SetLinkCapacity(uint32_t outPort, uint64_t bitRate);
+    virtual bool UsesPathTable() const { return true; }
+    virtual void AddPath(uint32_t dstToRId, PathId pathId, Time baseRtt);
+    virtual void RemovePath(uint32_t dstToRId, PathId pathId);
+    virtual uint32_t GetTagSize() const { return CongaTag().GetSerializedSize(); }
+    virtual uint64_t GetPathTableBytes() const;
+    virtual void ReportMemory(MemStats& stats) const;
+    void SetFlowletTableMode(FlowletTable::Mode mode, uint32_t capacity);  // e.g., HARDWARE, 64K
+    const FlowletTable& GetFlowletTable() const { return m_flowletTable; }
 
     // periodic events
     EventId m_dreEvent;
@@ -124,9 +132,9 @@ class CongaRouting : public Object {
     void AgingEvent();
 
     // topological info (should be initialized in the beginning)
-    std::map<uint32_t, std::set<uint32_t> > m_congaRoutingTable;                 // routing table (ToRId -> pathId) (stable)
-    std::map<uint32_t, std::map<uint32_t, FeedbackInfo> > m_congaFromLeafTable;  // ToRId -> <pathId -> FeedbackInfo> (aged)
-    std::map<uint32_t, std::map<uint32_t, OutpathInfo> > m_congaToLeafTable;     // ToRId -> <pathId -> OutpathInfo> (aged)
+    std::map<uint32_t, std::set<PathId> > m_congaRoutingTable;                 // routing table (ToRId -> pathId) (stable)
+    std::map<uint32_t, std::map<PathId, FeedbackInfo> > m_congaFromLeafTable;  // ToRId -> <pathId -> FeedbackInfo> (aged)
+    std::map<uint32_t, std::map<PathId, OutpathInfo> > m_congaToLeafTable;     // ToRId -> <pathId -> OutpathInfo> (aged)
     std::map<uint32_t, uint64_t> m_outPort2BitRateMap;                           // outPort -> link bitrate (bps) (stable)
 
     /*-----CALLBACK------*/
@@ -159,7 +167,7 @@ class CongaRouting : public Object {
 
     // local
     std::map<uint32_t, uint32_t> m_DreMap;        // outPort -> DRE (at SrcToR)
-    std::map<uint64_t, Flowlet*> m_flowletTable;  // QpKey -> Flowlet (at SrcToR)
+    FlowletTable m_flowletTable;                  // QpKey -> Flowlet (at SrcToR), expired lazily
 };
 
 }  // namespace ns3
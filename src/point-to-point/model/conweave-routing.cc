@@ -31,6 +31,7 @@
 #include "ns3/flow-id-tag.h"
 #include "ns3/ipv4-header.h"
 #include "ns3/log.h"
+#include "ns3/mem-stats.h"
 #include "ns3/nstime.h"
 #include "ns3/object.h"
 #include "ns3/packet.h"
@@ -39,10 +40,16 @@
 #include "ns3/random-variable.h"
 #include "ns3/settings.h"
 #include "ns3/simulator.h"
+#include "ns3/switch-node.h"
 #include "ns3/udp-header.h"
 
 namespace ns3 {
 
+// registered at load: an MPI rank may receive a tag before it has created one
+NS_OBJECT_ENSURE_REGISTERED(ConWeaveDataTag);
+NS_OBJECT_ENSURE_REGISTERED(ConWeaveReplyTag);
+NS_OBJECT_ENSURE_REGISTERED(ConWeaveNotifyTag);
+
 /**
  * @brief tag for DATA header
  */
@@ -52,8 +59,8 @@ TypeId ConWeaveDataTag::GetTypeId(void) {
         TypeId("ns3::ConWeaveDataTag").SetParent<Tag>().AddConstructor<ConWeaveDataTag>();
     return tid;
 }
-void ConWeaveDataTag::SetPathId(uint32_t pathId) { m_pathId = pathId; }
-uint32_t ConWeaveDataTag::GetPathId(void) const { return m_pathId; }
+void ConWeaveDataTag::SetPathId(PathId pathId) { m_pathId = pathId; }
+PathId ConWeaveDataTag::GetPathId(void) const { return m_pathId; }
 void ConWeaveDataTag::SetHopCount(uint32_t hopCount) { m_hopCount = hopCount; }
 uint32_t ConWeaveDataTag::GetHopCount(void) const { return m_hopCount; }
 void ConWeaveDataTag::SetEpoch(uint32_t epoch) { m_epoch = epoch; }
@@ -69,11 +76,11 @@ uint32_t ConWeaveDataTag::GetFlagData(void) const { return m_flagData; }
 
 TypeId ConWeaveDataTag::GetInstanceTypeId(void) const { return GetTypeId(); }
 uint32_t ConWeaveDataTag::GetSerializedSize(void) const {
-    return sizeof(uint32_t) + sizeof(uint32_t) + sizeof(uint32_t) + sizeof(uint32_t) +
-           sizeof(uint64_t) + sizeof(uint64_t) + sizeof(uint32_t);
+    return PathCodec::GetSerializedSize() + sizeof(uint32_t) + sizeof(uint32_t) +
+           sizeof(uint32_t) + sizeof(uint64_t) + sizeof(uint64_t) + sizeof(uint32_t);
 }
 void ConWeaveDataTag::Serialize(TagBuffer i) const {
-    i.WriteU32(m_pathId);
+    PathCodec::Serialize(i, m_pathId);
     i.WriteU32(m_hopCount);
     i.WriteU32(m_epoch);
     i.WriteU32(m_phase);
@@ -82,7 +89,7 @@ void ConWeaveDataTag::Serialize(TagBuffer i) const {
     i.WriteU32(m_flagData);
 }
 void ConWeaveDataTag::Deserialize(TagBuffer i) {
-    m_pathId = i.ReadU32();
+    m_pathId = PathCodec::Deserialize(i);
     m_hopCount = i.ReadU32();
     m_epoch = i.ReadU32();
     m_phase = i.ReadU32();
@@ -144,12 +151,14 @@ TypeId ConWeaveNotifyTag::GetTypeId(void) {
         TypeId("ns3::ConWeaveNotifyTag").SetParent<Tag>().AddConstructor<ConWeaveNotifyTag>();
     return tid;
 }
-void ConWeaveNotifyTag::SetPathId(uint32_t pathId) { m_pathId = pathId; }
-uint32_t ConWeaveNotifyTag::GetPathId(void) const { return m_pathId; }
+void ConWeaveNotifyTag::SetPathId(PathId pathId) { m_pathId = pathId; }
+PathId ConWeaveNotifyTag::GetPathId(void) const { return m_pathId; }
 TypeId ConWeaveNotifyTag::GetInstanceTypeId(void) const { return GetTypeId(); }
-uint32_t ConWeaveNotifyTag::GetSerializedSize(void) const { return sizeof(uint32_t); }
-void ConWeaveNotifyTag::Serialize(TagBuffer i) const { i.WriteU32(m_pathId); }
-void ConWeaveNotifyTag::Deserialize(TagBuffer i) { m_pathId = i.ReadU32(); }
+uint32_t ConWeaveNotifyTag::GetSerializedSize(void) const {
+    return PathCodec::GetSerializedSize();
+}
+void ConWeaveNotifyTag::Serialize(TagBuffer i) const { PathCodec::Serialize(i, m_pathId); }
+void ConWeaveNotifyTag::Deserialize(TagBuffer i) { m_pathId = PathCodec::Deserialize(i); }
 void ConWeaveNotifyTag::Print(std::ostream &os) const { os << "m_pathId=" << m_pathId; }
 
 /*---------------- ConWeaveRouting ---------------*/
@@ -166,7 +175,7 @@ uint64_t ConWeaveRouting::m_nReRoute = 0;
 uint64_t ConWeaveRouting::m_nOutOfOrderPkts = 0;
 uint64_t ConWeaveRouting::m_nFlushVOQTotal = 0;
 uint64_t ConWeaveRouting::m_nFlushVOQByTail = 0;
-std::vector<uint32_t> ConWeaveRouting::m_historyVOQSize;
+HdrHistogram ConWeaveRouting::m_voqSizeHist;
 
 // functions
 ConWeaveRouting::ConWeaveRouting() {
@@ -185,20 +194,17 @@ ConWeaveRouting::ConWeaveRouting() {
 }
 
 ConWeaveRouting::~ConWeaveRouting() {}
-void ConWeaveRouting::DoDispose() { m_agingEvent.Cancel(); }
-TypeId ConWeaveRouting::GetTypeId(void) {
-    static TypeId tid =
-        TypeId("ns3::ConWeaveRouting").SetParent<Object>().AddConstructor<ConWeaveRouting>();
-    return tid;
+void ConWeaveRouting::DoDispose() {
+    m_agingEvent.Cancel();
+    LoadBalancer::DoDispose();
 }
 
-uint32_t ConWeaveRouting::GetOutPortFromPath(const uint32_t &path, const uint32_t &hopCount) {
-    return ((uint8_t *)&path)[hopCount];
-}
+NS_LOAD_BALANCER_REGISTER(ConWeaveRouting, 9);
 
-void ConWeaveRouting::SetOutPortToPath(uint32_t &path, const uint32_t &hopCount,
-                                       const uint32_t &outPort) {
-    ((uint8_t *)&path)[hopCount] = outPort;
+TypeId ConWeaveRouting::GetTypeId(void) {
+    static TypeId tid =
+        TypeId("ns3::ConWeaveRouting").SetParent<LoadBalancer>().AddConstructor<ConWeaveRouting>();
+    return tid;
 }
 
 uint64_t ConWeaveRouting::GetFlowKey(uint32_t ip1, uint32_t ip2, uint16_t port1, uint16_t port2) {
@@ -312,7 +318,7 @@ void ConWeaveRouting::SendReply(Ptr<Packet> p, CustomHeader &ch, uint32_t flagRe
     return;
 }
 
-void ConWeaveRouting::SendNotify(Ptr<Packet> p, CustomHeader &ch, uint32_t pathId) {
+void ConWeaveRouting::SendNotify(Ptr<Packet> p, CustomHeader &ch, PathId pathId) {
     qbbHeader seqh;
     seqh.SetSeq(0);
     seqh.SetPG(ch.udp.pg);
@@ -422,8 +428,9 @@ void ConWeaveRouting::RouteInput(Ptr<Packet> p, CustomHeader &ch) {
             return;
         }
 
-        /** NOTE: ConWeave's control packets are forwarded with default flow-ECMP */
-        if (!m_isToR) {
+        /** NOTE: ConWeave's control packets are forwarded with default flow-ECMP until their
+         * destination ToR, also at ToRs in transit (after a link failure, routes may detour) */
+        if (!m_isToR || m_switch_id != dstToRId) {
             SLB_LOG(PARSE_FIVE_TUPLE(ch) << "ConWeave Ctrl Pkts use flow-ECMP at non-ToR switches");
             DoSwitchSendToDev(p, ch);
             return;
@@ -523,20 +530,22 @@ void ConWeaveRouting::RouteInput(Ptr<Packet> p, CustomHeader &ch) {
             /**
              * PATH: sample 2 ports and choose a good port
              */
-            std::set<uint32_t> pathSet = m_ConWeaveRoutingTable[dstToRId];  // pathSet to RxToR
-            uint32_t initPath =
+            std::set<PathId> pathSet = m_ConWeaveRoutingTable[dstToRId];  // pathSet to RxToR
+            PathId initPath =
                 *(std::next(pathSet.begin(),
-                            rand() % pathSet.size()));  // to initialize (empty: CW_DEFAULT_32BIT)
+                            GetRandom(pathSet.size())));  // to initialize (empty: PATH_ID_NULL)
 
             if (m_pathAwareRerouting) {
                 /* path-aware decision */
-                uint32_t randPath1 = *(std::next(pathSet.begin(), rand() % pathSet.size()));
-                uint32_t randPath2 = *(std::next(pathSet.begin(), rand() % pathSet.size()));
+                PathId randPath1 = *(std::next(pathSet.begin(), GetRandom(pathSet.size())));
+                PathId randPath2 = *(std::next(pathSet.begin(), GetRandom(pathSet.size())));
                 const auto pathEntry1 =
-                    m_conweavePathTable[DoHash((uint8_t *)&randPath1, 4, m_switch_id) %
+                    m_conweavePathTable[DoHash((uint8_t *)&randPath1,
+                                               PathCodec::GetSerializedSize(), m_switch_id) %
                                         m_conweavePathTable.size()];
                 const auto pathEntry2 =
-                    m_conweavePathTable[DoHash((uint8_t *)&randPath2, 4, m_switch_id) %
+                    m_conweavePathTable[DoHash((uint8_t *)&randPath2,
+                                               PathCodec::GetSerializedSize(), m_switch_id) %
                                         m_conweavePathTable.size()];
                 bool goodPath1 = true;
                 bool goodPath2 = true;
@@ -567,12 +576,12 @@ void ConWeaveRouting::RouteInput(Ptr<Packet> p, CustomHeader &ch) {
             } else {
                 /* random path selection */
                 tx_md.foundGoodPath = true;
-                tx_md.goodPath = *(std::next(pathSet.begin(), rand() % pathSet.size()));
+                tx_md.goodPath = *(std::next(pathSet.begin(), GetRandom(pathSet.size())));
             }
 
             /** PATH: update and get current path */
             /** NOTE: if new connection, set initial random path */
-            if (txEntry._pathId == CW_DEFAULT_32BIT) {
+            if (txEntry._pathId == PATH_ID_NULL) {
                 assert(tx_md.newConnection == true);
                 txEntry._pathId = tx_md.goodPath;
             }
@@ -630,7 +639,7 @@ void ConWeaveRouting::RouteInput(Ptr<Packet> p, CustomHeader &ch) {
             p->AddPacketTag(conweaveDataTag);
 
             uint32_t outDev =
-                GetOutPortFromPath(conweaveDataTag.GetPathId(), conweaveDataTag.GetHopCount());
+                PathCodec::GetOutPort(conweaveDataTag.GetPathId(), conweaveDataTag.GetHopCount());
             uint32_t qIndex = ch.udp.pg;
             SLB_LOG(PARSE_FIVE_TUPLE(ch)
                     << "\t--> outDev:" << outDev << ",qIndex:" << qIndex
@@ -993,7 +1002,8 @@ void ConWeaveRouting::RouteInput(Ptr<Packet> p, CustomHeader &ch) {
                     conweaveTxMeta tx_md;
                     auto congestedPathId = conweaveNotifyTag.GetPathId();
                     auto &pathEntry =
-                        m_conweavePathTable[DoHash((uint8_t *)&congestedPathId, 4, m_switch_id) %
+                        m_conweavePathTable[DoHash((uint8_t *)&congestedPathId,
+                                                   PathCodec::GetSerializedSize(), m_switch_id) %
                                             m_conweavePathTable.size()];
                     SLB_LOG(PARSE_REVERSE_FIVE_TUPLE(ch)
                             << "[TxToR/GotNOTIFY] Sw(" << m_switch_id
@@ -1038,7 +1048,7 @@ void ConWeaveRouting::RouteInput(Ptr<Packet> p, CustomHeader &ch) {
 
         // get outPort
         uint32_t outDev =
-            GetOutPortFromPath(conweaveDataTag.GetPathId(), conweaveDataTag.GetHopCount());
+            PathCodec::GetOutPort(conweaveDataTag.GetPathId(), conweaveDataTag.GetHopCount());
         uint32_t qIndex = ch.udp.pg;
 
         // re-serialize tag
@@ -1075,10 +1085,52 @@ void ConWeaveRouting::SetConstants(Time extraReplyDeadline, Time extraVOQFlushTi
 }
 
 void ConWeaveRouting::SetSwitchInfo(bool isToR, uint32_t switch_id) {
+    LoadBalancer::SetSwitchInfo(isToR, switch_id);
     m_isToR = isToR;
     m_switch_id = switch_id;
 }
 
+void ConWeaveRouting::InstallTo(Ptr<SwitchNode> sw) {
+    m_switch = PeekPointer(sw);
+    // ConWeave's Callback for switch functions
+    SetSwitchSendCallback(MakeCallback(&SwitchNode::DoSwitchSend, m_switch));
+    SetSwitchSendToDevCallback(MakeCallback(&SwitchNode::SendToDevContinue, m_switch));
+    sw->SetLoadBalancer(this, &SwitchNode::SendToDevHijack<ConWeaveRouting>);
+}
+
+void ConWeaveRouting::AddPath(uint32_t dstToRId, PathId pathId, Time baseRtt) {
+    m_ConWeaveRoutingTable[dstToRId].insert(pathId);
+    m_rxToRId2BaseRTT[dstToRId] = baseRtt.GetNanoSeconds();
+}
+
+void ConWeaveRouting::RemovePath(uint32_t dstToRId, PathId pathId) {
+    m_ConWeaveRoutingTable[dstToRId].erase(pathId);
+}
+
+uint64_t ConWeaveRouting::GetPathTableBytes() const {
+    uint64_t bytes = TreeBytes(m_ConWeaveRoutingTable.size(),
+                               sizeof(uint32_t) + sizeof(std::set<PathId>));
+    for (const auto &dst : m_ConWeaveRoutingTable) {
+        bytes += TreeBytes(dst.second.size(), sizeof(PathId));
+    }
+    bytes += TreeBytes(m_rxToRId2BaseRTT.size(), sizeof(uint32_t) + sizeof(uint64_t));
+    bytes += m_conweavePathTable.capacity() * sizeof(conweavePathInfo);
+    return bytes;
+}
+
+void ConWeaveRouting::ReportMemory(MemStats& stats) const {
+    uint64_t nPaths = 0;
+    for (const auto& dst : m_ConWeaveRoutingTable) nPaths += dst.second.size();
+    stats.Add(MemStats::LB_PATH, nPaths, GetPathTableBytes());
+    stats.Add(MemStats::LB_STATE, m_conweaveTxTable.size() + m_conweaveRxTable.size(),
+              MemStats::TreeBytes(m_conweaveTxTable) + MemStats::TreeBytes(m_conweaveRxTable));
+    // packets only: their payload is virtual, and the headers are small
+    uint64_t nPkts = 0;
+    for (const auto& voq : m_voqMap) nPkts += voq.second.m_FIFO.size();
+    stats.Add(MemStats::LB_VOQ, nPkts,
+              MemStats::HashBytes(m_voqMap) + nPkts * (sizeof(Ptr<Packet>) + sizeof(Packet)));
+}
+
 /** CALLBACK: callback functions  */
 void ConWeaveRouting::DoSwitchSend(Ptr<Packet> p, CustomHeader &ch, uint32_t outDev,
                                    uint32_t qIndex) {
@@ -1096,7 +1148,7 @@ void ConWeaveRouting::CallbackByVOQFlush(uint64_t flowkey, uint32_t voqSize) {
         "#################################################################### VOQ FLush, flowkey: "
         << flowkey << ",VOQ size:" << voqSize << "#################");  // debugging
 
-    m_historyVOQSize.push_back(voqSize);  // statistics - track VOQ size
+    m_voqSizeHist.Record(voqSize);  // statistics - track VOQ size
     // update RxEntry
     auto &rxEntry = m_conweaveRxTable[flowkey];  // flowcut entry
     assert(rxEntry._flowkey == flowkey);         // sanity check
@@ -32,6 +32,8 @@
 #include "ns3/callback.h"
 #include "ns3/conweave-voq.h"
 #include "ns3/event-id.h"
+#include "ns3/hdr-histogram.h"
+#include "ns3/load-balancer.h"
 #include "ns3/net-device.h"
 #include "ns3/object.h"
 #include "ns3/packet.h"
@@ -42,7 +44,6 @@
 
 namespace ns3 {
 
-#define CW_DEFAULT_32BIT (UINT32_MAX)
 #define CW_DEFAULT_64BIT (Seconds(100).GetNanoSeconds())
 #define CW_MAX_TIME (Seconds(100))
 #define CW_MIN_TIME (Seconds(0))
@@ -84,8 +85,8 @@ struct conweaveTxState {
     Time _replyTimer = CW_MIN_TIME;
     uint32_t _epoch = 0; /* by expiration at the beginning, the first packet begins with epoch 1 */
     uint32_t _phase = 0; /* 0: before rerouting, 1: after rerouting */
-    uint32_t _pathId = CW_DEFAULT_32BIT; /* encoded current path ID (composition of uplinks) */
-    Time _tailTime = CW_MIN_TIME;        /* TAIL packet of current epoch (if available) */
+    PathId _pathId = PATH_ID_NULL; /* encoded current path ID (composition of uplinks) */
+    Time _tailTime = CW_MIN_TIME;  /* TAIL packet of current epoch (if available) */
 };
 
 struct conweaveRxState {
@@ -102,13 +103,13 @@ struct conweaveRxState {
 };
 
 struct conweavePathInfo {
-    uint32_t _pathId = 0;
+    PathId _pathId = 0;
     Time _invalidTime = CW_MIN_TIME;
 };
 
 struct find_conweavePathInfo {
-    uint32_t _pathId;
-    find_conweavePathInfo(uint32_t pathId) : _pathId(pathId) {}
+    PathId _pathId;
+    find_conweavePathInfo(PathId pathId) : _pathId(pathId) {}
     bool operator()(const conweavePathInfo& p) const { return p._pathId == _pathId; }
 };
 // it = std::find_if( pathVec.begin(), pathVec.end(), conweavePathInfo(pathId));
@@ -122,9 +123,9 @@ struct conweaveTxMeta {
     bool flagStabilized = false;
     uint32_t epoch = 0;
     uint32_t phase = 0;
-    uint32_t goodPath = CW_DEFAULT_32BIT;
+    PathId goodPath = PATH_ID_NULL;
     bool foundGoodPath = false;
-    uint32_t currPath = CW_DEFAULT_32BIT;
+    PathId currPath = PATH_ID_NULL;
     uint64_t tailTime = 0;
 
     /*-- REPLY Metadata --*/
@@ -136,7 +137,7 @@ struct conweaveTxMeta {
 // follow PISA metadata concept
 struct conweaveRxMeta {
     uint64_t pkt_flowkey = 0;
-    uint32_t pkt_pathId = 0;
+    PathId pkt_pathId = 0;
     uint32_t pkt_epoch = 0;
     uint32_t pkt_phase = 0;
     uint64_t pkt_timestamp_Tx = 0;
@@ -160,8 +161,8 @@ struct conweaveRxMeta {
 class ConWeaveDataTag : public Tag {
    public:
     ConWeaveDataTag();
-    void SetPathId(uint32_t pathId);
-    uint32_t GetPathId(void) const;
+    void SetPathId(PathId pathId);
+    PathId GetPathId(void) const;
     void SetHopCount(uint32_t hopCount);
     uint32_t GetHopCount(void) const;
     void SetEpoch(uint32_t epoch);
@@ -201,7 +202,7 @@ class ConWeaveDataTag : public Tag {
     };
 
    private:
-    uint32_t m_pathId;
+    PathId m_pathId;
     uint32_t m_hopCount;
     uint32_t m_epoch;
     uint32_t m_phase;
@@ -251,8 +252,8 @@ class ConWeaveReplyTag : public Tag {
 class ConWeaveNotifyTag : public Tag {
    public:
     ConWeaveNotifyTag();
-    void SetPathId(uint32_t pathId);
-    uint32_t GetPathId(void) const;
+    void SetPathId(PathId pathId);
+    PathId GetPathId(void) const;
 
     static TypeId GetTypeId(void);
     virtual TypeId GetInstanceTypeId(void) const;
@@ -266,7 +267,7 @@ class ConWeaveNotifyTag : public Tag {
     }
 
    private:
-    uint32_t m_pathId;  // path of DATA
+    PathId m_pathId;  // path of DATA
 };
 
 /*----------------------------*/
@@ -279,22 +280,17 @@ class ConWeaveNotifyTag : public Tag {
  * (uint8_t*)&path[0] -> port0
  */
 
-class ConWeaveRouting : public Object {
-    friend class SwitchMmu;
+class ConWeaveRouting : public LoadBalancer {
     friend class SwitchNode;
 
    public:
     ConWeaveRouting();
     ~ConWeaveRouting();
+    virtual void InstallTo(Ptr<SwitchNode> sw);
     virtual void DoDispose();
 
     /* static */
     static TypeId GetTypeId(void);
-    static uint32_t GetOutPortFromPath(
-        const uint32_t& path,
-        const uint32_t& hopCount);  // decode outPort from path, given a hop's order
-    static void SetOutPortToPath(uint32_t& path, const uint32_t& hopCount,
-                                 const uint32_t& outPort);  // encode outPort to path
 
     /* key */
     static uint64_t GetFlowKey(uint32_t ip1, uint32_t ip2, uint16_t port1,
@@ -306,7 +302,7 @@ class ConWeaveRouting : public Object {
 
     /* main function */
     void SendReply(Ptr<Packet> p, CustomHeader& ch, uint32_t flagReply, uint32_t pkt_epoch);
-    void SendNotify(Ptr<Packet> p, CustomHeader& ch, uint32_t pathId);
+    void SendNotify(Ptr<Packet> p, CustomHeader& ch, PathId pathId);
     void RouteInput(Ptr<Packet> p, CustomHeader& ch);  // core function
 
     void DeleteVOQ(uint64_t flowkey);  // used for callback when reorder queue is flushed
@@ -316,7 +312,13 @@ class ConWeaveRouting : public Object {
     /* SET functions */
     void SetConstants(Time extraReplyDeadline, Time extraVOQFlushTime, Time txExpiryTime,
                       Time defaultVOQWaitingTime, Time pathPauseTime, bool pathAwareRerouting);
-    void SetSwitchInfo(bool isToR, uint32_t switch_id);
+    virtual void SetSwitchInfo(bool isToR, uint32_t switch_id);
+    virtual bool UsesPathTable() const { return true; }
+    virtual void AddPath(uint32_t dstToRId, PathId pathId, Time baseRtt);
+    virtual void RemovePath(uint32_t dstToRId, PathId pathId);
+    virtual uint32_t GetTagSize() const { return ConWeaveDataTag().GetSerializedSize(); }
+    virtual uint64_t GetPathTableBytes() const;
+    virtual void ReportMemory(MemStats& stats) const;
 
     // callback of SwitchSend
     void DoSwitchSend(Ptr<Packet> p, CustomHeader& ch, uint32_t outDev,
@@ -332,7 +334,7 @@ class ConWeaveRouting : public Object {
         SwitchSendToDevCallback switchSendToDevCallback);  // set callback
 
     /* topological info (should be initialized in the beginning) */
-    std::map<uint32_t, std::set<uint32_t> >
+    std::map<uint32_t, std::set<PathId> >
         m_ConWeaveRoutingTable;                      // <RxToRId -> set<pathId> > just for reference
     std::map<uint32_t, uint64_t> m_rxToRId2BaseRTT;  // RxToRId -> BaseRTT between TORs(fixed)
     std::vector<conweavePathInfo> m_conweavePathTable;  // pathInfo table
@@ -347,7 +349,7 @@ class ConWeaveRouting : public Object {
     static uint64_t m_nOutOfOrderPkts;     // number of OoO packets and queued at VOQ
     static uint64_t m_nFlushVOQTotal;   // number of VOQ flush by timeout (can cause out-of-order)
     static uint64_t m_nFlushVOQByTail;  // number of flushing VOQ natually (w/o out-of-order issue)
-    static std::vector<uint32_t> m_historyVOQSize;  // history of VOQ size
+    static HdrHistogram m_voqSizeHist;  // VOQ size (packets) at flush
 
    private:
     // callback
@@ -34,7 +34,7 @@ namespace ns3 {
 ConWeaveVOQ::ConWeaveVOQ() {}
 ConWeaveVOQ::~ConWeaveVOQ() {}
 
-std::vector<int> ConWeaveVOQ::m_flushEstErrorhistory; // instantiate static variable
+HdrHistogram ConWeaveVOQ::m_flushEstErrorHist; // instantiate static variable
 
 void ConWeaveVOQ::Set(uint64_t flowkey, uint32_t dip, Time timeToFlush, Time extraVOQFlushTime) {
     m_flowkey = flowkey;
@@ -80,8 +80,8 @@ void ConWeaveVOQ::RescheduleFlush(Time timeToFlush) {
             // std::cout << (int(prevEst - Simulator::Now().GetNanoSeconds()) -
             //               m_extraVOQFlushTime.GetNanoSeconds())
             //           << std::endl;
-            m_flushEstErrorhistory.push_back(int(prevEst - Simulator::Now().GetNanoSeconds()) -
-                                             m_extraVOQFlushTime.GetNanoSeconds());
+            m_flushEstErrorHist.Record(int(prevEst - Simulator::Now().GetNanoSeconds()) -
+                                       m_extraVOQFlushTime.GetNanoSeconds());
         }
 
         m_checkFlushEvent.Cancel();
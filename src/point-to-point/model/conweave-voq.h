@@ -30,6 +30,7 @@
 #include "ns3/callback.h"
 #include "ns3/custom-header.h"
 #include "ns3/event-id.h"
+#include "ns3/hdr-histogram.h"
 #include "ns3/log.h"
 #include "ns3/net-device.h"
 #include "ns3/object.h"
@@ -62,7 +63,7 @@ class ConWeaveVOQ {
     uint32_t getDIP() { return m_dip; };
 
     // logging
-    static std::vector<int> m_flushEstErrorhistory;
+    static HdrHistogram m_flushEstErrorHist;  // flush time estimation error (ns)
 
    private:
     uint64_t m_flowkey;               // flowkey (voqMap's key)
@@ -0,0 +1,302 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2023 NUS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Chahwan Song <songch@comp.nus.edu.sg>
+ */
+
+#include "ns3/dc-topology.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+
+namespace ns3 {
+
+static const uint32_t MAX_NODES = 1 << 24;  // a sanity bound for built topologies
+
+bool DcTopology::Load(const std::string& file) {
+    std::ifstream f(file.c_str());
+    if (!f.is_open()) {
+        std::cerr << "cannot open topology " << file << std::endl;
+        return false;
+    }
+    uint32_t nNode, nSwitch, nLink;
+    if (!(f >> nNode >> nSwitch >> nLink)) {
+        std::cerr << file << ": bad header" << std::endl;
+        return false;
+    }
+    m_nodeType.assign(nNode, 0);
+    for (uint32_t i = 0; i < nSwitch; i++) {
+        uint32_t id;
+        if (!(f >> id) || id >= nNode || m_nodeType[id] == 1) {
+            std::cerr << file << ": bad or duplicate switch ID" << std::endl;
+            return false;
+        }
+        m_nodeType[id] = 1;
+    }
+    m_links.resize(nLink);
+    for (uint32_t i = 0; i < nLink; i++) {
+        Link& l = m_links[i];
+        if (!(f >> l.src >> l.dst >> l.rate >> l.delay >> l.errorRate)) {
+            std::cerr << file << ": " << nLink << " links expected, read " << i << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+void DcTopology::AddLink(uint32_t src, uint32_t dst, const std::string& rate,
+                         const std::string& delay) {
+    Link l = {src, dst, rate, delay, 0};
+    m_links.push_back(l);
+}
+
+bool DcTopology::Build(const std::string& spec) {
+    size_t colon = spec.find(':');
+    std::string kind = spec.substr(0, colon);
+    std::map<std::string, std::string> params;
+    if (colon != std::string::npos) {
+        std::istringstream is(spec.substr(colon + 1));
+        std::string kv;
+        while (std::getline(is, kv, ',')) {
+            size_t eq = kv.find('=');
+            if (eq == std::string::npos) {
+                std::cerr << "topology spec: expected key=value, got " << kv << std::endl;
+                return false;
+            }
+            params[kv.substr(0, eq)] = kv.substr(eq + 1);
+        }
+    }
+    // takes a parameter out of params, so that the unknown ones are left
+    bool ok = true;
+    auto take = [&](const std::string& key, const std::string& def) {
+        auto it = params.find(key);
+        if (it == params.end()) return def;
+        std::string v = it->second;
+        params.erase(it);
+        return v;
+    };
+    auto takeCount = [&](const std::string& key, const std::string& def) -> uint32_t {
+        std::string v = take(key, def);
+        char* end;
+        unsigned long n = strtoul(v.c_str(), &end, 10);
+        if (v.empty() || *end != '\0' || n == 0 || n > MAX_NODES) {
+            std::cerr << "topology spec: " << key << " must be a positive count, got '" << v
+                      << "'" << std::endl;
+            ok = false;
+            return 1;
+        }
+        return n;
+    };
+    auto tooLarge = [&](uint64_t nNode) {
+        if (nNode <= MAX_NODES) return false;
+        std::cerr << "topology spec: " << nNode << " nodes, more than " << MAX_NODES << std::endl;
+        return true;
+    };
+    std::string rate = take("rate", "100Gbps");
+    std::string hostRate = take("host_rate", rate);
+    std::string fabricRate = take("fabric_rate", rate);
+    std::string delay = take("delay", "1000ns");
+
+    m_nodeType.clear();
+    m_links.clear();
+    if (kind == "fat_tree") {
+        uint32_t k = takeCount("k", "");
+        uint32_t os = takeCount("os", "1");
+        if (ok && k % 2 != 0) {
+            std::cerr << "topology spec: fat_tree needs an even k" << std::endl;
+            ok = false;
+        }
+        uint32_t half = k / 2;
+        if (!ok || tooLarge((uint64_t)k * half * (half * os + 2) + half * half)) return false;
+        uint32_t nTor = k * half, nAgg = k * half, nCore = half * half;
+        uint32_t hostsPerTor = half * os, nHost = nTor * hostsPerTor;
+        uint32_t tor0 = nHost, agg0 = tor0 + nTor, core0 = agg0 + nAgg;
+        m_nodeType.assign(core0 + nCore, 1);
+        std::fill(m_nodeType.begin(), m_nodeType.begin() + nHost, 0);
+        for (uint32_t t = 0; t < nTor; t++) {
+            for (uint32_t h = 0; h < hostsPerTor; h++) {
+                AddLink(t * hostsPerTor + h, tor0 + t, hostRate, delay);
+            }
+        }
+        for (uint32_t p = 0; p < k; p++) {
+            for (uint32_t t = 0; t < half; t++) {
+                for (uint32_t a = 0; a < half; a++) {
+                    AddLink(tor0 + p * half + t, agg0 + p * half + a, fabricRate, delay);
+                }
+            }
+        }
+        for (uint32_t p = 0; p < k; p++) {
+            for (uint32_t a = 0; a < half; a++) {
+                for (uint32_t c = 0; c < half; c++) {
+                    AddLink(agg0 + p * half + a, core0 + a * half + c, fabricRate, delay);
+                }
+            }
+        }
+    } else if (kind == "leaf_spine") {
+        uint32_t nLeaf = takeCount("leaves", "");
+        uint32_t nSpine = takeCount("spines", "");
+        uint32_t hostsPerLeaf = takeCount("hosts", "");
+        if (!ok || tooLarge((uint64_t)nLeaf * (hostsPerLeaf + 1) + nSpine)) return false;
+        uint32_t nHost = nLeaf * hostsPerLeaf, leaf0 = nHost, spine0 = leaf0 + nLeaf;
+        m_nodeType.assign(spine0 + nSpine, 1);
+        std::fill(m_nodeType.begin(), m_nodeType.begin() + nHost, 0);
+        for (uint32_t h = 0; h < nHost; h++) AddLink(h, leaf0 + h / hostsPerLeaf, hostRate, delay);
+        for (uint32_t l = 0; l < nLeaf; l++) {
+            for (uint32_t s = 0; s < nSpine; s++) {
+                AddLink(leaf0 + l, spine0 + s, fabricRate, delay);
+            }
+        }
+    } else if (kind == "clos") {
+        uint32_t nPod = takeCount("pods", "");
+        uint32_t torsPerPod = takeCount("tors", "");
+        uint32_t aggsPerPod = takeCount("aggs", "");
+        uint32_t spinesPerPlane = takeCount("spines", "");
+        uint32_t hostsPerTor = takeCount("hosts", "");
+        if (!ok || tooLarge((uint64_t)nPod * torsPerPod * (hostsPerTor + 1) +
+                            (uint64_t)nPod * aggsPerPod + (uint64_t)aggsPerPod * spinesPerPlane))
+            return false;
+        uint32_t nTor = nPod * torsPerPod, nAgg = nPod * aggsPerPod;
+        uint32_t nHost = nTor * hostsPerTor;
+        uint32_t tor0 = nHost, agg0 = tor0 + nTor, spine0 = agg0 + nAgg;
+        m_nodeType.assign(spine0 + aggsPerPod * spinesPerPlane, 1);
+        std::fill(m_nodeType.begin(), m_nodeType.begin() + nHost, 0);
+        for (uint32_t h = 0; h < nHost; h++) AddLink(h, tor0 + h / hostsPerTor, hostRate, delay);
+        for (uint32_t p = 0; p < nPod; p++) {
+            for (uint32_t t = 0; t < torsPerPod; t++) {
+                for (uint32_t a = 0; a < aggsPerPod; a++) {
+                    AddLink(tor0 + p * torsPerPod + t, agg0 + p * aggsPerPod + a, fabricRate,
+                            delay);
+                }
+            }
+        }
+        for (uint32_t p = 0; p < nPod; p++) {
+            for (uint32_t a = 0; a < aggsPerPod; a++) {
+                for (uint32_t s = 0; s < spinesPerPlane; s++) {
+                    AddLink(agg0 + p * aggsPerPod + a, spine0 + a * spinesPerPlane + s,
+                            fabricRate, delay);
+                }
+            }
+        }
+    } else {
+        std::cerr << "topology spec: unknown kind '" << kind
+                  << "' (fat_tree, leaf_spine or clos)" << std::endl;
+        return false;
+    }
+    for (auto& p : params) {
+        std::cerr << "topology spec: unknown parameter " << p.first << " for " << kind
+                  << std::endl;
+        ok = false;
+    }
+    return ok;
+}
+
+bool DcTopology::Save(const std::string& file) const {
+    FILE* f = fopen(file.c_str(), "w");
+    if (f == NULL) {
+        std::cerr << "cannot write " << file << std::endl;
+        return false;
+    }
+    fprintf(f, "%u %u %lu\n", GetNNodes(), GetNSwitches(), m_links.size());
+    bool first = true;
+    for (uint32_t i = 0; i < GetNNodes(); i++) {
+        if (!IsSwitch(i)) continue;
+        fprintf(f, first ? "%u" : " %u", i);
+        first = false;
+    }
+    fprintf(f, "\n");
+    for (const Link& l : m_links) {
+        fprintf(f, "%u %u %s %s %g\n", l.src, l.dst, l.rate.c_str(), l.delay.c_str(),
+                l.errorRate);
+    }
+    fclose(f);
+    return true;
+}
+
+uint32_t DcTopology::GetNSwitches() const {
+    return std::count(m_nodeType.begin(), m_nodeType.end(), 1);
+}
+
+uint32_t DcTopology::GetMaxSwitchPorts() const {
+    std::vector<uint32_t> degree(GetNNodes(), 0);
+    for (const Link& l : m_links) {
+        degree[l.src]++;
+        degree[l.dst]++;
+    }
+    uint32_t maxPorts = 0;
+    for (uint32_t i = 0; i < GetNNodes(); i++) {
+        if (IsSwitch(i)) maxPorts = std::max(maxPorts, degree[i]);
+    }
+    return maxPorts;
+}
+
+bool DcTopology::Validate() const {
+    uint32_t n = GetNNodes();
+    std::vector<std::vector<uint32_t>> adj(n);
+    std::set<std::pair<uint32_t, uint32_t>> pairs;
+    for (const Link& l : m_links) {
+        if (l.src >= n || l.dst >= n || l.src == l.dst) {
+            std::cerr << "topology: bad link " << l.src << "-" << l.dst << std::endl;
+            return false;
+        }
+        if (!pairs.insert(std::make_pair(std::min(l.src, l.dst), std::max(l.src, l.dst)))
+                 .second) {
+            std::cerr << "topology: parallel links " << l.src << "-" << l.dst
+                      << " are not supported" << std::endl;
+            return false;
+        }
+        adj[l.src].push_back(l.dst);
+        adj[l.dst].push_back(l.src);
+    }
+    for (uint32_t i = 0; i < n; i++) {
+        if (IsSwitch(i)) continue;
+        if (adj[i].size() != 1 || !IsSwitch(adj[i][0])) {
+            std::cerr << "topology: host " << i << " must have exactly one link, to a switch ("
+                      << adj[i].size() << " links)" << std::endl;
+            return false;
+        }
+    }
+    // connectivity
+    std::vector<bool> seen(n, false);
+    std::vector<uint32_t> stack(1, 0);
+    seen[0] = n > 0;
+    uint32_t nSeen = n > 0 ? 1 : 0;
+    while (n > 0 && !stack.empty()) {
+        uint32_t u = stack.back();
+        stack.pop_back();
+        for (uint32_t v : adj[u]) {
+            if (seen[v]) continue;
+            seen[v] = true;
+            nSeen++;
+            stack.push_back(v);
+        }
+    }
+    if (nSeen != n) {
+        std::cerr << "topology: " << n - nSeen << " of " << n << " nodes are disconnected"
+                  << std::endl;
+        return false;
+    }
+    return true;
+}
+
+}  // namespace ns3
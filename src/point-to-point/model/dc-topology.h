@@ -0,0 +1,81 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2023 NUS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Chahwan Song <songch@comp.nus.edu.sg>
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * @brief Datacenter topology: node types and links, either read from the text format
+ * of config/ (TOPOLOGY_FILE) or built from a spec (TOPOLOGY_GEN).
+ *
+ * Text format: "<#nodes> <#switches> <#links>", the switch node IDs, then one
+ * "<src> <dst> <rate> <delay> <error rate>" line per link.
+ *
+ * Spec: "<kind>:<key>=<value>,...". Built topologies number the hosts first, then the
+ * switches tier by tier from the ToRs up, like config/fat_topology_gen.py.
+ *  - fat_tree:k=8[,os=2]  3-tier fat-tree of k-port switches, k/2 * os hosts per ToR
+ *  - leaf_spine:leaves=8,spines=8,hosts=16  every leaf connects to every spine
+ *  - clos:pods=4,tors=4,aggs=4,spines=8,hosts=16  5-stage Clos: in each pod, ToRs and
+ *    aggs are fully connected, and agg i of every pod connects to the spines of plane i
+ * and, for all kinds, rate=100Gbps (every link), host_rate=, fabric_rate= (switch-switch
+ * links), delay=1000ns.
+ */
+class DcTopology {
+   public:
+    struct Link {
+        uint32_t src, dst;
+        std::string rate, delay;  // e.g., 100Gbps, 1000ns
+        double errorRate;
+    };
+
+    /** @brief Read a topology file. Returns false (with a message) on error */
+    bool Load(const std::string& file);
+    /** @brief Build from a spec. Returns false (with a message) on error */
+    bool Build(const std::string& spec);
+    bool Save(const std::string& file) const;
+
+    /**
+     * @brief Check node IDs, self/duplicate links, that each host has a single link, to a
+     * switch, and that the network is connected. Returns false (with a message) otherwise.
+     */
+    bool Validate() const;
+
+    uint32_t GetNNodes() const { return m_nodeType.size(); }
+    uint32_t GetNSwitches() const;
+    bool IsSwitch(uint32_t node) const { return m_nodeType[node] == 1; }
+    const std::vector<uint8_t>& GetNodeTypes() const { return m_nodeType; }  // 0: host, 1: switch
+    const std::vector<Link>& GetLinks() const { return m_links; }
+    /** @brief Largest number of links of a switch */
+    uint32_t GetMaxSwitchPorts() const;
+
+   private:
+    void AddLink(uint32_t src, uint32_t dst, const std::string& rate, const std::string& delay);
+
+    std::vector<uint8_t> m_nodeType;
+    std::vector<Link> m_links;
+};
+
+}  // namespace ns3
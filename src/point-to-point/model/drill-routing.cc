@@ -0,0 +1,182 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2023 NUS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Chahwan Song <songch@comp.nus.edu.sg>
+ */
+
+#include "ns3/drill-routing.h"
+
+#include <algorithm>
+#include <map>
+
+#include "ns3/assert.h"
+#include "ns3/boolean.h"
+#include "ns3/broadcom-egress-queue.h"
+#include "ns3/mem-stats.h"
+#include "ns3/qbb-net-device.h"
+#include "ns3/switch-node.h"
+#include "ns3/uinteger.h"
+
+namespace ns3 {
+
+NS_LOAD_BALANCER_REGISTER(DrillRouting, 2);
+
+TypeId DrillRouting::GetTypeId(void) {
+    static TypeId tid =
+        TypeId("ns3::DrillRouting")
+            .SetParent<LoadBalancer>()
+            .AddConstructor<DrillRouting>()
+            .AddAttribute("SampleNum", "Number of random samples (d) per decision",
+                          UintegerValue(2), MakeUintegerAccessor(&DrillRouting::m_drill_candidate),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("MemoryNum", "Number of remembered best ports (m) per destination",
+                          UintegerValue(1), MakeUintegerAccessor(&DrillRouting::m_drill_memory),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("MemoryPerToR",
+                          "Share the remembered ports among all hosts of a destination ToR "
+                          "(needs Settings::hostIp2SwitchId)",
+                          BooleanValue(false), MakeBooleanAccessor(&DrillRouting::m_memoryPerToR),
+                          MakeBooleanChecker());
+    return tid;
+}
+
+DrillRouting::DrillRouting() : m_drill_candidate(2), m_drill_memory(1), m_memoryPerToR(false) {}
+
+void DrillRouting::InstallTo(Ptr<SwitchNode> sw) {
+    m_switch = PeekPointer(sw);
+    sw->SetLoadBalancer(this, &SwitchNode::SendToDevSelect<DrillRouting>);
+}
+
+void DrillRouting::Init() {
+    // egress queue of each interface
+    m_portQueue.assign(m_switch->GetNDevices(), NULL);
+    for (uint32_t i = 0; i < m_switch->GetNDevices(); i++) {
+        Ptr<QbbNetDevice> device = DynamicCast<QbbNetDevice>(m_switch->GetDevice(i));
+        if (device && device->GetQueue()) {
+            m_portQueue[i] = PeekPointer(device->GetQueue());
+        }
+    }
+
+    // dense memory index of each destination host: itself, or its ToR
+    std::map<uint32_t, uint32_t> key2MemIdx;
+    std::map<uint32_t, uint32_t> hostId2Key;
+    if (m_memoryPerToR) {
+        for (auto& it : Settings::hostIp2SwitchId) {
+            hostId2Key[Settings::ip_to_node_id(Ipv4Address(it.first))] = it.second;
+        }
+    } else {
+        for (auto& it : Settings::hostIp2IdMap) {
+            hostId2Key[it.second] = it.second;
+        }
+    }
+    NS_ASSERT_MSG(!hostId2Key.empty(), "DRILL needs Settings::hostIp2IdMap (or hostIp2SwitchId)");
+    m_hostId2MemIdx.assign(hostId2Key.rbegin()->first + 1, UINT32_MAX);
+    for (auto& it : hostId2Key) {
+        auto idx = key2MemIdx.insert(std::make_pair(it.second, (uint32_t)key2MemIdx.size()));
+        m_hostId2MemIdx[it.first] = idx.first->second;
+    }
+    m_bestPorts.assign(key2MemIdx.size() * m_drill_memory, 0);
+    m_candPort.assign(m_drill_memory + m_drill_candidate, 0);
+    m_candLoad.assign(m_drill_memory + m_drill_candidate, 0);
+}
+
+void DrillRouting::ReportMemory(MemStats& stats) const {
+    stats.Add(MemStats::LB_STATE, m_bestPorts.size(),
+              MemStats::VectorBytes(m_portQueue) + MemStats::VectorBytes(m_hostId2MemIdx) +
+                  MemStats::VectorBytes(m_bestPorts) + MemStats::VectorBytes(m_candPort) +
+                  MemStats::VectorBytes(m_candLoad));
+}
+
+uint32_t DrillRouting::CalculateInterfaceLoad(uint32_t interface) const {
+    NS_ASSERT_MSG(interface < m_portQueue.size() && m_portQueue[interface] != NULL,
+                  "Error of getting a egress queue for calculating interface load");
+    return m_portQueue[interface]->GetNBytesTotal();  // also used in HPCC
+}
+
+uint32_t DrillRouting::GetMemoryIndex(uint32_t dip) const {
+    uint32_t hostId = Settings::ip_to_node_id(Ipv4Address(dip));
+    NS_ASSERT_MSG(hostId < m_hostId2MemIdx.size() && m_hostId2MemIdx[hostId] != UINT32_MAX,
+                  "DRILL: unknown destination host");
+    return m_hostId2MemIdx[hostId];
+}
+
+uint32_t DrillRouting::SelectOutPort(Ptr<Packet> p, CustomHeader& ch,
+                                     const std::vector<int>& nexthops) {
+    if (nexthops.size() == 1) {
+        return nexthops[0];  // no choice, e.g., to the receiver at its ToR
+    }
+    if (m_portQueue.empty()) {
+        Init();
+    }
+
+    // find the Egress (output) link with the smallest local Egress Queue length
+    uint32_t* best = &m_bestPorts[GetMemoryIndex(ch.dip) * m_drill_memory];
+    uint32_t nCand = 0;
+
+    // remembered ports first, so they win ties against the samples
+    for (uint32_t i = 0; i < m_drill_memory && best[i] != 0; i++) {
+        if (std::find(nexthops.begin(), nexthops.end(), (int)best[i]) != nexthops.end()) {
+            m_candPort[nCand] = best[i];
+            m_candLoad[nCand] = CalculateInterfaceLoad(best[i]);
+            nCand++;
+        }
+    }
+
+    // d random samples of the nexthops (reservoir sampling, in place)
+    uint32_t nHops = nexthops.size();
+    uint32_t nSample = std::min(m_drill_candidate, nHops);
+    uint32_t* samples = &m_candPort[nCand];
+    for (uint32_t i = 0; i < nSample; i++) {
+        samples[i] = nexthops[i];
+    }
+    for (uint32_t i = nSample; i < nHops; i++) {
+        uint32_t j = GetRandom(i + 1);
+        if (j < nSample) {
+            samples[j] = nexthops[i];
+        }
+    }
+    for (uint32_t i = 0; i < nSample; i++) {
+        m_candLoad[nCand + i] = CalculateInterfaceLoad(samples[i]);
+    }
+    nCand += nSample;
+
+    // remember the m least loaded distinct candidates, the first one is chosen
+    uint32_t nBest = 0;
+    for (; nBest < m_drill_memory; nBest++) {
+        uint32_t sel = nCand;
+        for (uint32_t c = 0; c < nCand; c++) {
+            if (m_candPort[c] != 0 && (sel == nCand || m_candLoad[c] < m_candLoad[sel])) {
+                sel = c;
+            }
+        }
+        if (sel == nCand) {
+            break;
+        }
+        best[nBest] = m_candPort[sel];
+        for (uint32_t c = 0; c < nCand; c++) {
+            if (m_candPort[c] == best[nBest]) {
+                m_candPort[c] = 0;  // drop duplicates
+            }
+        }
+    }
+    for (uint32_t i = nBest; i < m_drill_memory; i++) {
+        best[i] = 0;
+    }
+    return best[0];
+}
+
+}  // namespace ns3
@@ -0,0 +1,72 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2023 NUS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Chahwan Song <songch@comp.nus.edu.sg>
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "ns3/load-balancer.h"
+
+namespace ns3 {
+
+class BEgressQueue;
+
+/**
+ * @brief DRILL(d,m) (lb_mode = 2): per-packet, picks the least loaded egress port
+ * among m remembered best ports and d random samples of the nexthops.
+ *
+ * The memory is kept per destination host, or optionally per destination ToR,
+ * in a dense array. The samples are drawn in place by reservoir sampling and
+ * egress queues are cached per port, so a decision does not allocate, copy the
+ * nexthops or look up a map.
+ *
+ * NOTE: a memory shared per destination ToR makes all flows towards the ToR
+ * follow the same remembered port, which increases reordering (in our
+ * leaf-spine runs, the average FCT slowdown gets ~30% worse). So it is off by
+ * default.
+ */
+class DrillRouting : public LoadBalancer {
+   public:
+    static TypeId GetTypeId(void);
+    DrillRouting();
+
+    virtual void InstallTo(Ptr<SwitchNode> sw);
+    uint32_t SelectOutPort(Ptr<Packet> p, CustomHeader& ch, const std::vector<int>& nexthops);
+    virtual void ReportMemory(MemStats& stats) const;
+
+   private:
+    void Init();  // at the first packet, once the switch's devices exist
+    uint32_t CalculateInterfaceLoad(uint32_t interface) const;  // Get the load of a interface
+    uint32_t GetMemoryIndex(uint32_t dip) const;
+
+    // DRILL constants
+    uint32_t m_drill_candidate;  // d, number of random samples (e.g., 2)
+    uint32_t m_drill_memory;     // m, number of remembered best ports (e.g., 1)
+    bool m_memoryPerToR;         // memory per destination ToR instead of per destination host
+
+    // local
+    std::vector<BEgressQueue*> m_portQueue;  // interface -> egress queue (not owned)
+    std::vector<uint32_t> m_hostId2MemIdx;   // dst host's node id -> memory index
+    std::vector<uint32_t> m_bestPorts;       // memory index * m + i -> best interface (0: empty)
+    std::vector<uint32_t> m_candPort;        // candidates of a decision (memory + samples)
+    std::vector<uint32_t> m_candLoad;
+};
+
+}  // namespace ns3
@@ -0,0 +1,124 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2023 NUS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Chahwan Song <songch@comp.nus.edu.sg>
+ */
+
+
+#include "ns3/fast-forward.h"
+
+#include <math.h>
+
+#include <algorithm>
+
+#include "ns3/simulator.h"
+
+namespace ns3 {
+
+FastForward::FastForward() : m_checkOnly(false) { m_stats = Stats(); }
+
+void FastForward::SetNLinks(uint32_t n) {
+    m_users.assign(n, 0);
+    m_owner.assign(n, UINT32_MAX);
+}
+
+bool FastForward::AddFlow(const Flow &flow, const std::vector<uint32_t> &links, bool idle) {
+    bool alone = idle;
+    for (uint32_t l : links) {
+        if (m_owner[l] != UINT32_MAX) Resume(m_owner[l]);
+        if (m_users[l] > 0) alone = false;
+    }
+    Active &a = m_flows[flow.id];
+    a.flow = flow;
+    a.links = links;
+    a.forwarded = alone;
+    for (uint32_t l : links) {
+        m_users[l]++;
+        if (alone) m_owner[l] = flow.id;
+    }
+    if (alone) {
+        m_stats.nForwarded++;
+        if (!m_checkOnly) {
+            a.finish = Simulator::Schedule(flow.start + flow.fct - Simulator::Now(),
+                                           &FastForward::Finish, this, flow.id);
+        }
+    }
+    return alone;
+}
+
+void FastForward::Resume(uint32_t id) {
+    Active &a = m_flows[id];
+    uint64_t sent = 0;
+    if (!m_checkOnly) {
+        // whole packets out of the NIC so far
+        double pkts = (Simulator::Now() - a.flow.start).GetSeconds() * a.flow.bps / 8 /
+                      a.flow.pktBytes;
+        sent = std::min(a.flow.size, (uint64_t)floor(pkts) * a.flow.payload);
+        if (sent >= a.flow.size) return;  // only its last packets are left, in flight
+        a.finish.Cancel();
+    }
+    a.forwarded = false;
+    for (uint32_t l : a.links) m_owner[l] = UINT32_MAX;
+    m_stats.nResumed++;
+    m_stats.bytesForwarded += sent;
+    if (!m_checkOnly && m_resumeCb) m_resumeCb(a.flow, sent);
+}
+
+void FastForward::Finish(uint32_t id) {
+    auto it = m_flows.find(id);
+    Flow flow = it->second.flow;
+    Release(it->second);
+    m_flows.erase(it);
+    m_stats.nFinished++;
+    m_stats.bytesForwarded += flow.size;
+    AddBound(flow);
+    if (m_finishCb) m_finishCb(flow);
+}
+
+void FastForward::RemoveFlow(uint32_t id, Time fct) {
+    auto it = m_flows.find(id);
+    if (it == m_flows.end()) return;  // finished by Finish
+    const Active &a = it->second;
+    if (a.forwarded) {  // only with m_checkOnly
+        double err = fabs((fct - a.flow.fct).GetSeconds()) / fct.GetSeconds();
+        m_stats.nChecked++;
+        m_stats.errSum += err;
+        m_stats.errMax = std::max(m_stats.errMax, err);
+        AddBound(a.flow);
+    }
+    Release(a);
+    m_flows.erase(it);
+}
+
+void FastForward::Touch(uint32_t link) {
+    if (m_owner[link] != UINT32_MAX) Resume(m_owner[link]);
+}
+
+void FastForward::AddBound(const Flow &flow) {
+    double bound = flow.bound.GetSeconds() / flow.fct.GetSeconds();
+    m_stats.boundSum += bound;
+    m_stats.boundMax = std::max(m_stats.boundMax, bound);
+}
+
+void FastForward::Release(const Active &a) {
+    for (uint32_t l : a.links) {
+        m_users[l]--;
+        if (m_owner[l] == a.flow.id) m_owner[l] = UINT32_MAX;
+    }
+}
+
+}  // namespace ns3
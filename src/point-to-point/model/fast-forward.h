@@ -0,0 +1,123 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2023 NUS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Chahwan Song <songch@comp.nus.edu.sg>
+ */
+
+
+#pragma once
+
+#include <stdint.h>
+
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+/**
+ * @brief Flow-level fast-forward (FAST_FORWARD in the config): a flow that starts alone on
+ * idle links, i.e., no other flow uses any link its data or ACKs may take, is not simulated
+ * in packets. Its transfer is advanced analytically, at the bottleneck rate, and it finishes
+ * after its packet-free FCT (base RTT + serialization).
+ *
+ * As soon as another flow starts on one of its links, or the link is touched otherwise (a
+ * PFC pause, a link failure, see Touch), the flow goes back to packets: the resume callback
+ * continues it in packet mode after the whole packets it had sent by then. ECN marks need
+ * another flow's queue on the link, so they come after such a start.
+ *
+ * The FCT of a flow that finishes alone is off from its packet-level one by at most its
+ * bound: a base RTT (the ACK-clocked start and the last ACK) plus the serialization of one
+ * full packet (store-and-forward); GetStats reports it relative to the packet-free FCT.
+ *
+ * With SetCheckOnly, all flows stay in packets, and the FCT of each flow that was alone all
+ * along is compared to the one the fast-forward would have given it (GetStats).
+ */
+class FastForward {
+   public:
+    struct Flow {
+        uint32_t id;        // flow index
+        uint32_t src, dst;  // node IDs
+        uint16_t sport, dport, pg;
+        uint64_t size;      // bytes
+        Time start;
+        Time fct;           // packet-free FCT
+        uint64_t bps;       // bottleneck rate
+        uint32_t payload;   // bytes of a full packet, and with its headers
+        uint32_t pktBytes;
+        Time bound;         // FCT error bound: base RTT + a full packet's serialization
+    };
+    struct Stats {
+        uint64_t nForwarded;      // flows started alone
+        uint64_t nResumed;        // went back to packets
+        uint64_t nFinished;       // finished alone
+        uint64_t bytesForwarded;  // advanced analytically
+        uint64_t nChecked;        // SetCheckOnly: flows alone all along, and FCT error
+        double errSum, errMax;    // relative to the packet-level FCT
+        double boundSum, boundMax;  // FCT error bound of the flows finished alone (or checked),
+                                    // relative to their packet-free FCT
+    };
+
+    typedef std::function<void(const Flow &flow)> FinishCallback;
+    typedef std::function<void(const Flow &flow, uint64_t sent)> ResumeCallback;
+
+    FastForward();
+
+    void SetNLinks(uint32_t n);
+    void SetCheckOnly(bool checkOnly) { m_checkOnly = checkOnly; }
+    void SetFinishCallback(FinishCallback cb) { m_finishCb = cb; }
+    void SetResumeCallback(ResumeCallback cb) { m_resumeCb = cb; }
+
+    /**
+     * @brief A flow starts on the given links (no duplicates); the fast-forwarded flows on them
+     * go back to packets. Returns whether the flow is fast-forwarded: alone, and `idle`
+     * (e.g., no queue on the links and no slower link than its NIC).
+     */
+    bool AddFlow(const Flow &flow, const std::vector<uint32_t> &links, bool idle);
+    /** @brief A flow finished in packets, after fct */
+    void RemoveFlow(uint32_t id, Time fct);
+    /** @brief The fast-forwarded flow on the link (if any) goes back to packets */
+    void Touch(uint32_t link);
+
+    const Stats &GetStats() const { return m_stats; }
+
+   private:
+    struct Active {
+        Flow flow;
+        std::vector<uint32_t> links;
+        bool forwarded;
+        EventId finish;
+    };
+
+    void Resume(uint32_t id);
+    void Finish(uint32_t id);
+    void Release(const Active &a);  // off its links
+    void AddBound(const Flow &flow);
+
+    std::unordered_map<uint32_t, Active> m_flows;  // by flow index
+    std::vector<uint32_t> m_users;                 // number of flows of each link
+    std::vector<uint32_t> m_owner;                 // fast-forwarded flow of each link
+    bool m_checkOnly;
+    FinishCallback m_finishCb;
+    ResumeCallback m_resumeCb;
+    Stats m_stats;
+};
+
+}  // namespace ns3
@@ -0,0 +1,218 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2023 NUS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Chahwan Song <songch@comp.nus.edu.sg>
+ */
+
+#include "ns3/flow-generator.h"
+
+#include <math.h>
+
+#include <algorithm>
+#include <fstream>
+
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+NS_LOG_COMPONENT_DEFINE("FlowGenerator");
+
+namespace ns3 {
+
+FlowGenerator::FlowGenerator()
+    : m_pattern(POISSON),
+      m_fanIn(1),
+      m_stopNs(0),
+      m_meanIntervalNs(0),
+      m_uniform(0.0, 1.0),
+      m_nGenerated(0),
+      m_eventNs(0),
+      m_eventDst(0),
+      m_pos(0) {}
+
+bool FlowGenerator::LoadCdf(const std::string& cdfFile) {
+    std::ifstream f(cdfFile.c_str());
+    if (!f.is_open()) return false;
+    m_cdf.clear();
+    double x, y;
+    while (f >> x >> y) m_cdf.push_back(std::make_pair(x, y));
+
+    // same validity check as traffic_gen/custom_rand.py
+    if (m_cdf.size() < 2 || m_cdf.front().second != 0 || m_cdf.back().second != 100) return false;
+    for (uint32_t i = 1; i < m_cdf.size(); i++) {
+        if (m_cdf[i].first <= m_cdf[i - 1].first || m_cdf[i].second <= m_cdf[i - 1].second)
+            return false;
+    }
+    return true;
+}
+
+bool FlowGenerator::ParsePattern(const std::string& name, Pattern& pattern) {
+    if (name == "poisson") {
+        pattern = POISSON;
+    } else if (name == "incast") {
+        pattern = INCAST;
+    } else if (name == "alltoall") {
+        pattern = ALLTOALL;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+double FlowGenerator::GetAvgSize() const {
+    double s = 0;
+    for (uint32_t i = 1; i < m_cdf.size(); i++) {
+        s += (m_cdf[i].first + m_cdf[i - 1].first) / 2.0 * (m_cdf[i].second - m_cdf[i - 1].second);
+    }
+    return s / 100;
+}
+
+void FlowGenerator::Start(const std::vector<uint32_t>& hosts, uint64_t hostBps, double load,
+                          uint64_t startNs, uint64_t stopNs, uint64_t seed, Pattern pattern,
+                          uint32_t fanIn) {
+    NS_ASSERT_MSG(!m_cdf.empty(), "FlowGenerator: no CDF loaded");
+    NS_ASSERT_MSG(hosts.size() >= 2, "FlowGenerator: needs at least two hosts");
+    NS_ASSERT_MSG(load > 0 && hostBps > 0, "FlowGenerator: load and bandwidth must be positive");
+    NS_ASSERT_MSG(pattern != INCAST || (fanIn >= 1 && fanIn < hosts.size()),
+                  "FlowGenerator: incast fan-in must be in [1, #hosts - 1]");
+
+    m_hosts = hosts;
+    m_pattern = pattern;
+    m_fanIn = fanIn;
+    m_stopNs = stopNs;
+    m_rng.seed(seed);
+    m_nGenerated = 0;
+    m_pos = 0;
+
+    // mean gap between two flows of a host, as traffic_gen.py
+    double hostIntervalNs = GetAvgSize() * 8.0 / (hostBps * load) * 1e9;
+    uint32_t nHost = m_hosts.size();
+    switch (m_pattern) {
+        case POISSON:
+            m_meanIntervalNs = hostIntervalNs;
+            m_heap.resize(nHost);
+            for (uint32_t i = 0; i < nHost; i++) {
+                m_heap[i] = std::make_pair(startNs + SampleInterArrival(m_meanIntervalNs), i);
+            }
+            for (uint32_t i = nHost / 2; i-- > 0;) HeapSiftDown(i);
+            break;
+        case INCAST:
+            // fanIn flows per event, nHost hosts receiving
+            m_meanIntervalNs = hostIntervalNs * fanIn / nHost;
+            m_eventSrcs.resize(nHost);
+            for (uint32_t i = 0; i < nHost; i++) m_eventSrcs[i] = i;
+            m_eventNs = startNs + SampleInterArrival(m_meanIntervalNs);
+            m_pos = m_fanIn;  // draw the first event's hosts
+            break;
+        case ALLTOALL:
+            // every host sends (nHost - 1) flows per round
+            m_meanIntervalNs = hostIntervalNs * (nHost - 1);
+            m_eventNs = startNs;
+            break;
+    }
+}
+
+bool FlowGenerator::Next(Flow& flow) {
+    uint32_t nHost = m_hosts.size();
+    switch (m_pattern) {
+        case POISSON: {
+            if (m_heap.empty() || m_heap[0].first > m_stopNs) return false;
+            uint32_t src = m_heap[0].second;
+            flow.startNs = m_heap[0].first;
+            flow.src = m_hosts[src];
+            flow.dst = m_hosts[SampleOtherHost(src)];
+            m_heap[0].first += SampleInterArrival(m_meanIntervalNs);
+            HeapSiftDown(0);
+            break;
+        }
+        case INCAST: {
+            if (m_pos == m_fanIn) {  // next event
+                if (m_nGenerated > 0) m_eventNs += SampleInterArrival(m_meanIntervalNs);
+                // m_eventSrcs is a permutation of the hosts: the receiver goes last and the
+                // senders are a partial Fisher-Yates shuffle of the others
+                m_eventDst = std::uniform_int_distribution<uint32_t>(0, nHost - 1)(m_rng);
+                std::swap(*std::find(m_eventSrcs.begin(), m_eventSrcs.end(), m_eventDst),
+                          m_eventSrcs[nHost - 1]);
+                for (uint32_t i = 0; i < m_fanIn; i++) {
+                    uint32_t j = std::uniform_int_distribution<uint32_t>(i, nHost - 2)(m_rng);
+                    std::swap(m_eventSrcs[i], m_eventSrcs[j]);
+                }
+                m_pos = 0;
+            }
+            if (m_eventNs > m_stopNs) return false;
+            flow.startNs = m_eventNs;
+            flow.src = m_hosts[m_eventSrcs[m_pos++]];
+            flow.dst = m_hosts[m_eventDst];
+            break;
+        }
+        case ALLTOALL: {
+            if (m_pos == nHost * (nHost - 1)) {  // next round
+                m_eventNs += (uint64_t)m_meanIntervalNs;
+                m_pos = 0;
+            }
+            if (m_eventNs > m_stopNs) return false;
+            uint32_t src = m_pos / (nHost - 1);
+            uint32_t dst = (src + 1 + m_pos % (nHost - 1)) % nHost;
+            m_pos++;
+            flow.startNs = m_eventNs;
+            flow.src = m_hosts[src];
+            flow.dst = m_hosts[dst];
+            break;
+        }
+    }
+    flow.size = SampleSize();
+    m_nGenerated++;
+    return true;
+}
+
+uint64_t FlowGenerator::SampleSize() {
+    // inverse of the piecewise-linear CDF (custom_rand.py's getValueFromPercentile)
+    double y = m_uniform(m_rng) * 100;
+    uint32_t i = std::upper_bound(m_cdf.begin() + 1, m_cdf.end() - 1, y,
+                                  [](double v, const std::pair<double, double>& c) {
+                                      return v <= c.second;
+                                  }) -
+                 m_cdf.begin();
+    const std::pair<double, double>& c0 = m_cdf[i - 1];
+    const std::pair<double, double>& c1 = m_cdf[i];
+    uint64_t size = (uint64_t)(c0.first + (c1.first - c0.first) / (c1.second - c0.second) *
+                                              (y - c0.second));
+    return std::max<uint64_t>(size, 1);
+}
+
+uint64_t FlowGenerator::SampleInterArrival(double meanNs) {
+    return (uint64_t)(-log(1 - m_uniform(m_rng)) * meanNs);
+}
+
+uint32_t FlowGenerator::SampleOtherHost(uint32_t hostIdx) {
+    uint32_t other =
+        std::uniform_int_distribution<uint32_t>(0, m_hosts.size() - 2)(m_rng);
+    return other >= hostIdx ? other + 1 : other;
+}
+
+void FlowGenerator::HeapSiftDown(uint32_t i) {
+    uint32_t n = m_heap.size();
+    while (true) {
+        uint32_t l = 2 * i + 1, r = l + 1, m = i;
+        if (l < n && m_heap[l] < m_heap[m]) m = l;
+        if (r < n && m_heap[r] < m_heap[m]) m = r;
+        if (m == i) return;
+        std::swap(m_heap[i], m_heap[m]);
+        i = m;
+    }
+}
+
+}  // namespace ns3
@@ -0,0 +1,112 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2023 NUS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Chahwan Song <songch@comp.nus.edu.sg>
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * @brief Streaming flow generator, the in-simulator counterpart of
+ * traffic_gen/traffic_gen.py.
+ *
+ * Flows are produced one at a time in start-time order, so memory does not
+ * depend on the number of flows (run length or load). Flow sizes follow a
+ * piecewise-linear CDF file (traffic_gen/*.txt: "<size> <cdf percent>" per
+ * line). The generator has its own seeded RNG, so the same seed gives the
+ * same flows regardless of what else in the simulation draws random numbers.
+ *
+ * Patterns (all offer `load` x host bandwidth per host on average):
+ * - POISSON: each host starts flows with Poisson arrivals to a uniformly
+ *   random other host (as traffic_gen.py).
+ * - INCAST: Poisson incast events; each picks a random receiver and `fanIn`
+ *   distinct random senders, which all start a flow to it at the same time.
+ * - ALLTOALL: periodic rounds; in each round every host starts a flow to every
+ *   other host at the same time.
+ */
+class FlowGenerator {
+   public:
+    enum Pattern {
+        POISSON = 0,
+        INCAST = 1,
+        ALLTOALL = 2,
+    };
+
+    struct Flow {
+        uint32_t src, dst;  // node IDs
+        uint64_t size;      // bytes
+        uint64_t startNs;   // start time (ns)
+    };
+
+    FlowGenerator();
+
+    /** @brief Load the size CDF. Returns false if the file is missing or not a valid CDF */
+    bool LoadCdf(const std::string& cdfFile);
+    /** @brief Pattern from its name (poisson, incast, alltoall). Returns false if unknown */
+    static bool ParsePattern(const std::string& name, Pattern& pattern);
+
+    /**
+     * @brief Start generating. Hosts are node IDs; load is the fraction of hostBps
+     * offered per host; flows start within [startNs, stopNs].
+     */
+    void Start(const std::vector<uint32_t>& hosts, uint64_t hostBps, double load,
+               uint64_t startNs, uint64_t stopNs, uint64_t seed, Pattern pattern,
+               uint32_t fanIn = 1);
+
+    /** @brief Next flow in start-time order, or false when generation is over */
+    bool Next(Flow& flow);
+
+    double GetAvgSize() const;   // mean flow size (bytes) of the CDF
+    double GetMaxSize() const { return m_cdf.empty() ? 0 : m_cdf.back().first; }
+    uint64_t GetNGenerated() const { return m_nGenerated; }
+
+   private:
+    uint64_t SampleSize();
+    uint64_t SampleInterArrival(double meanNs);
+    uint32_t SampleOtherHost(uint32_t hostIdx);  // uniform host index != hostIdx
+    void HeapSiftDown(uint32_t i);
+
+    std::vector<std::pair<double, double> > m_cdf;  // (size, percent), increasing
+    std::vector<uint32_t> m_hosts;
+    Pattern m_pattern;
+    uint32_t m_fanIn;
+    uint64_t m_stopNs;
+    double m_meanIntervalNs;  // per host (POISSON), per event (INCAST), per round (ALLTOALL)
+    std::mt19937_64 m_rng;
+    std::uniform_real_distribution<double> m_uniform;  // [0, 1)
+    uint64_t m_nGenerated;
+
+    // POISSON: binary min-heap of (next start time, host index), one entry per host
+    std::vector<std::pair<uint64_t, uint32_t> > m_heap;
+
+    // INCAST/ALLTOALL: current event (round) and the position in it
+    uint64_t m_eventNs;
+    uint32_t m_eventDst;                 // INCAST: receiver (host index)
+    std::vector<uint32_t> m_eventSrcs;   // INCAST: senders of the event (fanIn)
+    uint32_t m_pos;                      // INCAST: next sender, ALLTOALL: next (src, dst) pair
+};
+
+}  // namespace ns3
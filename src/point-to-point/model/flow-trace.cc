@@ -0,0 +1,153 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2023 NUS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Chahwan Song <songch@comp.nus.edu.sg>
+ */
+
+#include "ns3/flow-trace.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <iostream>
+
+#include "ns3/assert.h"
+
+namespace ns3 {
+
+static const char FLOW_TRACE_MAGIC[8] = {'F', 'L', 'O', 'W', 'T', 'R', 'C', '\0'};
+static const uint32_t FLOW_TRACE_VERSION = 1;
+
+/*----- FlowTraceReader ------*/
+FlowTraceReader::FlowTraceReader()
+    : m_map(NULL), m_mapSize(0), m_header(NULL), m_records(NULL), m_cur(0), m_end(0) {}
+
+FlowTraceReader::~FlowTraceReader() { Close(); }
+
+bool FlowTraceReader::Open(const std::string& file) {
+    Close();
+    int fd = open(file.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "FlowTrace: cannot open " << file << std::endl;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(FlowTraceHeader)) {
+        std::cerr << "FlowTrace: " << file << " is too short" << std::endl;
+        close(fd);
+        return false;
+    }
+    m_mapSize = st.st_size;
+    m_map = mmap(NULL, m_mapSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);  // the mapping stays valid
+    if (m_map == MAP_FAILED) {
+        std::cerr << "FlowTrace: cannot mmap " << file << std::endl;
+        m_map = NULL;
+        return false;
+    }
+    madvise(m_map, m_mapSize, MADV_SEQUENTIAL);
+
+    const FlowTraceHeader* h = (const FlowTraceHeader*)m_map;
+    if (memcmp(h->magic, FLOW_TRACE_MAGIC, sizeof(FLOW_TRACE_MAGIC)) != 0 ||
+        h->version != FLOW_TRACE_VERSION || h->recordSize != sizeof(FlowTraceRecord) ||
+        m_mapSize != sizeof(FlowTraceHeader) + h->flowCount * sizeof(FlowTraceRecord)) {
+        std::cerr << "FlowTrace: " << file << " is not a (version " << FLOW_TRACE_VERSION
+                  << ") flow trace or is truncated" << std::endl;
+        Close();
+        return false;
+    }
+    m_header = h;
+    m_records = (const FlowTraceRecord*)((const char*)m_map + sizeof(FlowTraceHeader));
+    m_cur = 0;
+    m_end = h->flowCount;
+    return true;
+}
+
+void FlowTraceReader::Close() {
+    if (m_map != NULL) munmap(m_map, m_mapSize);
+    m_map = NULL;
+    m_mapSize = 0;
+    m_header = NULL;
+    m_records = NULL;
+    m_cur = m_end = 0;
+}
+
+uint64_t FlowTraceReader::LowerBound(uint64_t startNs) const {
+    uint64_t lo = 0, hi = m_header->flowCount;
+    while (lo < hi) {
+        uint64_t mid = lo + (hi - lo) / 2;
+        if (m_records[mid].startNs < startNs) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+void FlowTraceReader::SetWindow(uint64_t startNs, uint64_t stopNs) {
+    NS_ASSERT_MSG(IsOpen(), "FlowTrace: not open");
+    NS_ASSERT_MSG(m_header->flags & FlowTraceHeader::SORTED,
+                  "FlowTrace: a time window needs a trace sorted by start time");
+    m_cur = LowerBound(startNs);
+    m_end = stopNs == UINT64_MAX ? m_header->flowCount : LowerBound(stopNs + 1);
+    if (m_end < m_cur) m_end = m_cur;
+}
+
+/*----- FlowTraceWriter ------*/
+FlowTraceWriter::FlowTraceWriter() : m_file(NULL) {}
+
+FlowTraceWriter::~FlowTraceWriter() { Close(); }
+
+bool FlowTraceWriter::Open(const std::string& file, uint32_t hostCount) {
+    Close();
+    m_file = fopen(file.c_str(), "wb");
+    if (m_file == NULL) return false;
+    memset(&m_header, 0, sizeof(m_header));
+    memcpy(m_header.magic, FLOW_TRACE_MAGIC, sizeof(FLOW_TRACE_MAGIC));
+    m_header.version = FLOW_TRACE_VERSION;
+    m_header.recordSize = sizeof(FlowTraceRecord);
+    m_header.hostCount = hostCount;
+    m_header.flags = FlowTraceHeader::SORTED;  // until a record breaks the order
+    fwrite(&m_header, sizeof(m_header), 1, m_file);
+    return true;
+}
+
+void FlowTraceWriter::Write(const FlowTraceRecord& record) {
+    NS_ASSERT_MSG(m_file != NULL, "FlowTrace: writer is not open");
+    if (m_header.flowCount == 0) {
+        m_header.firstStartNs = record.startNs;
+    } else if (record.startNs < m_header.lastStartNs) {
+        m_header.flags &= ~FlowTraceHeader::SORTED;
+    }
+    m_header.lastStartNs = record.startNs;
+    m_header.flowCount++;
+    fwrite(&record, sizeof(record), 1, m_file);
+}
+
+void FlowTraceWriter::Close() {
+    if (m_file == NULL) return;
+    fseek(m_file, 0, SEEK_SET);
+    fwrite(&m_header, sizeof(m_header), 1, m_file);
+    fclose(m_file);
+    m_file = NULL;
+}
+
+}  // namespace ns3
@@ -0,0 +1,165 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2023 NUS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Chahwan Song <songch@comp.nus.edu.sg>
+ */
+
+#include "ns3/flowlet-table.h"
+
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+NS_LOG_COMPONENT_DEFINE("FlowletTable");
+
+namespace ns3 {
+
+static const uint32_t FLOWLET_TABLE_DEFAULT_CAPACITY = 1024;
+
+static uint32_t RoundUpPowerOfTwo(uint32_t v) {
+    uint32_t p = 1;
+    while (p < v) p <<= 1;
+    return p;
+}
+
+FlowletTable::FlowletTable() : m_mode(EXACT), m_mask(0), m_nOccupied(0), m_nCollisions(0) {
+    Configure(EXACT, FLOWLET_TABLE_DEFAULT_CAPACITY, Time(MilliSeconds(10)));
+}
+
+void FlowletTable::Configure(Mode mode, uint32_t capacity, Time agingTime) {
+    NS_ASSERT_MSG(capacity > 0, "Flowlet table needs at least one entry");
+    m_mode = mode;
+    m_agingTime = agingTime;
+    capacity = RoundUpPowerOfTwo(capacity);
+    m_slots.assign(capacity, Slot());
+    m_mask = capacity - 1;
+    Clear();
+}
+
+void FlowletTable::SetAgingTime(Time agingTime) { m_agingTime = agingTime; }
+
+uint64_t FlowletTable::Hash(uint64_t key) {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+    return key;
+}
+
+Flowlet* FlowletTable::Find(uint64_t key, Time now) {
+    uint32_t idx = Hash(key) & m_mask;
+
+    if (m_mode == HARDWARE) {
+        Slot& slot = m_slots[idx];
+        if (!slot.used || IsExpired(slot, now)) {
+            return NULL;
+        }
+        if (slot.key != key) {
+            m_nCollisions++;  // another flow's active entry, it will be overwritten
+            return NULL;
+        }
+        return &slot.flowlet;
+    }
+
+    // linear probing, load factor is kept below 1/2 so an empty slot always exists
+    while (true) {
+        Slot& slot = m_slots[idx];
+        if (!slot.used) {
+            return NULL;
+        }
+        if (slot.key == key) {
+            return IsExpired(slot, now) ? NULL : &slot.flowlet;
+        }
+        idx = (idx + 1) & m_mask;
+    }
+}
+
+Flowlet* FlowletTable::Insert(uint64_t key, Time now) {
+    if (m_mode == HARDWARE) {
+        Slot& slot = m_slots[Hash(key) & m_mask];
+        if (!slot.used) {
+            slot.used = true;
+            m_nOccupied++;
+        }
+        slot.key = key;
+        return &slot.flowlet;
+    }
+
+    if ((m_nOccupied + 1) * 2 > GetCapacity()) {
+        Rehash(now);
+    }
+
+    // reuse the first expired slot on the probe chain, so chains never break
+    uint32_t idx = Hash(key) & m_mask;
+    Slot* reuse = NULL;
+    while (true) {
+        Slot& slot = m_slots[idx];
+        if (!slot.used) {
+            if (reuse == NULL) {
+                reuse = &slot;
+                reuse->used = true;
+                m_nOccupied++;
+            }
+            break;
+        }
+        if (slot.key == key) {
+            if (reuse == NULL) reuse = &slot;
+            break;
+        }
+        if (reuse == NULL && IsExpired(slot, now)) {
+            reuse = &slot;
+        }
+        idx = (idx + 1) & m_mask;
+    }
+    reuse->key = key;
+    return &reuse->flowlet;
+}
+
+void FlowletTable::Rehash(Time now) {
+    std::vector<Slot> old;
+    old.swap(m_slots);
+
+    uint32_t nLive = 0;
+    for (auto& slot : old) {
+        if (slot.used && !IsExpired(slot, now)) nLive++;
+    }
+    // grow only when live entries (not the expired ones) fill the table
+    uint32_t capacity = old.size();
+    while (nLive * 4 >= capacity) capacity <<= 1;
+
+    NS_LOG_FUNCTION(this << old.size() << capacity << nLive << now);
+    m_slots.assign(capacity, Slot());
+    m_mask = capacity - 1;
+    m_nOccupied = 0;
+    for (auto& slot : old) {
+        if (!slot.used || IsExpired(slot, now)) continue;
+        uint32_t idx = Hash(slot.key) & m_mask;
+        while (m_slots[idx].used) idx = (idx + 1) & m_mask;
+        m_slots[idx] = slot;
+        m_nOccupied++;
+    }
+}
+
+void FlowletTable::Clear() {
+    for (auto& slot : m_slots) {
+        slot.used = false;
+    }
+    m_nOccupied = 0;
+    m_nCollisions = 0;
+}
+
+}  // namespace ns3
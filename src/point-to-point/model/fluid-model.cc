@@ -0,0 +1,160 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2023 NUS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Chahwan Song <songch@comp.nus.edu.sg>
+ */
+
+
+#include "ns3/fluid-model.h"
+
+#include <math.h>
+
+#include <algorithm>
+
+#include "ns3/simulator.h"
+
+namespace ns3 {
+
+FluidModel::FluidModel() : m_maxShare(0.9), m_nFinished(0) {}
+
+uint32_t FluidModel::AddLink(uint64_t bps) {
+    Link l = {(double)bps, 0, 0, false, 0, 0, 0};
+    m_links.push_back(l);
+    return m_links.size() - 1;
+}
+
+void FluidModel::AddFlow(const Flow &flow, const std::vector<uint32_t> &path) {
+    Advance();
+    ActiveFlow f = {flow, path, (double)std::max<uint64_t>(flow.size, 1), 0, 0};
+    m_flows.push_back(f);
+    Allocate();
+    m_flows.back().rate = m_flows.back().target;  // starts at its share
+    Apply();
+}
+
+void FluidModel::Advance() {
+    double dt = (Simulator::Now() - m_lastUpdate).GetSeconds();
+    m_lastUpdate = Simulator::Now();
+    if (dt <= 0) return;
+    double tau = m_tau.GetSeconds();
+    for (ActiveFlow &f : m_flows) {
+        if (f.rate >= f.target || tau <= 0) {
+            f.remaining -= f.rate * dt / 8;
+            continue;
+        }
+        // rate(t) = target - (target - rate) * exp(-t / tau)
+        double decay = exp(-dt / tau);
+        f.remaining -= (f.target * dt - (f.target - f.rate) * tau * (1 - decay)) / 8;
+        f.rate = f.target - (f.target - f.rate) * decay;
+    }
+}
+
+void FluidModel::Allocate() {
+    for (Link &l : m_links) {
+        l.left = l.capacity * m_maxShare;
+        l.nOpen = 0;
+    }
+    for (const ActiveFlow &f : m_flows) {
+        for (uint32_t l : f.path) m_links[l].nOpen++;
+    }
+    // progressive filling: the link with the smallest fair share fixes its open flows
+    std::vector<uint8_t> fixed(m_flows.size(), 0);
+    uint32_t nOpen = m_flows.size();
+    while (nOpen > 0) {
+        uint32_t bottleneck = UINT32_MAX;
+        double share = 0;
+        for (uint32_t i = 0; i < m_links.size(); i++) {
+            const Link &l = m_links[i];
+            if (l.nOpen == 0) continue;
+            double s = std::max(0.0, l.left) / l.nOpen;
+            if (bottleneck == UINT32_MAX || s < share) {
+                bottleneck = i;
+                share = s;
+            }
+        }
+        if (bottleneck == UINT32_MAX) break;  // only flows without links are left
+        for (uint32_t i = 0; i < m_flows.size(); i++) {
+            ActiveFlow &f = m_flows[i];
+            if (fixed[i] || std::find(f.path.begin(), f.path.end(), bottleneck) == f.path.end())
+                continue;
+            fixed[i] = 1;
+            nOpen--;
+            f.target = share;
+            for (uint32_t l : f.path) {
+                m_links[l].left -= share;
+                m_links[l].nOpen--;
+            }
+        }
+    }
+}
+
+void FluidModel::Apply() {
+    bool converging = false;
+    for (Link &l : m_links) l.sum = 0;
+    for (ActiveFlow &f : m_flows) {
+        // cuts are immediate, and so is everything without convergence
+        if (m_tau.IsZero() || f.rate > f.target || f.rate >= f.target * 0.999) {
+            f.rate = f.target;
+        } else {
+            converging = true;
+        }
+        for (uint32_t l : f.path) m_links[l].sum += f.rate;
+    }
+    for (uint32_t i = 0; i < m_links.size(); i++) {
+        Link &l = m_links[i];
+        bool saturated = l.sum > 0 && l.left <= l.capacity * 1e-6;  // a bottleneck of Allocate
+        if (fabs(l.sum - l.rate) < 1 && saturated == l.saturated) continue;
+        l.rate = l.sum;
+        l.saturated = saturated;
+        if (m_linkCb) m_linkCb(i, llround(l.sum), saturated ? l.queueBytes : 0);
+    }
+
+    // next update: the first flow to finish, or the next convergence step
+    m_next.Cancel();
+    double next = converging ? m_tau.GetSeconds() / 4 : -1;
+    for (const ActiveFlow &f : m_flows) {
+        if (f.rate <= 0) continue;
+        double t = std::max(0.0, f.remaining) * 8 / f.rate;
+        if (next < 0 || t < next) next = t;
+    }
+    if (next >= 0) {
+        m_next = Simulator::Schedule(NanoSeconds(std::max(1.0, ceil(next * 1e9))),
+                                     &FluidModel::Update, this);
+    }
+}
+
+void FluidModel::Update() {
+    Advance();
+    std::vector<Flow> finished;
+    for (uint32_t i = 0; i < m_flows.size();) {
+        if (m_flows[i].remaining < 1) {  // less than a byte left
+            finished.push_back(m_flows[i].flow);
+            m_flows[i] = m_flows.back();
+            m_flows.pop_back();
+        } else {
+            i++;
+        }
+    }
+    if (!finished.empty()) Allocate();
+    Apply();
+    m_nFinished += finished.size();
+    for (const Flow &f : finished) {
+        if (m_finishCb) m_finishCb(f);
+    }
+}
+
+}  // namespace ns3
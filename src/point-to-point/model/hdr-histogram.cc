@@ -0,0 +1,158 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2023 NUS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Chahwan Song <songch@comp.nus.edu.sg>
+ */
+
+
+#include "ns3/hdr-histogram.h"
+
+#include <algorithm>
+#include <sstream>
+
+#include "ns3/assert.h"
+
+namespace ns3 {
+
+HdrHistogram::HdrHistogram(uint32_t subBucketBits, uint32_t maxBits)
+    : m_subBucketBits(subBucketBits),
+      m_maxBits(maxBits),
+      m_count(0),
+      m_sum(0),
+      m_min(0),
+      m_max(0) {
+    NS_ASSERT_MSG(subBucketBits >= 1 && subBucketBits < maxBits && maxBits <= 63,
+                  "HdrHistogram: needs 1 <= subBucketBits < maxBits <= 63");
+    uint32_t n = (maxBits - subBucketBits + 2) << (subBucketBits - 1);
+    m_pos.assign(n, 0);
+    m_neg.assign(n, 0);
+}
+
+uint32_t HdrHistogram::GetIndex(uint64_t magnitude) const {
+    if (magnitude < (1ull << m_subBucketBits)) return magnitude;
+    uint32_t msb = 63 - __builtin_clzll(magnitude);
+    if (msb >= m_maxBits) return m_pos.size() - 1;
+    uint32_t shift = msb - m_subBucketBits + 1;
+    uint32_t half = 1u << (m_subBucketBits - 1);
+    return (shift + 1) * half + (uint32_t)(magnitude >> shift) - half;
+}
+
+uint64_t HdrHistogram::GetValue(uint32_t index) const {
+    if (index < (1u << m_subBucketBits)) return index;
+    uint32_t half = 1u << (m_subBucketBits - 1);
+    uint32_t shift = index / half - 1;
+    uint64_t lower = (uint64_t)(index % half + half) << shift;
+    return lower + (1ull << (shift - 1));
+}
+
+void HdrHistogram::Record(int64_t value) {
+    if (m_count == 0 || value < m_min) m_min = value;
+    if (m_count == 0 || value > m_max) m_max = value;
+    m_count++;
+    m_sum += value;
+    if (value >= 0) {
+        m_pos[GetIndex(value)]++;
+    } else {
+        m_neg[GetIndex(-(uint64_t)value)]++;
+    }
+}
+
+bool HdrHistogram::Merge(const HdrHistogram& other) {
+    if (other.m_subBucketBits != m_subBucketBits || other.m_maxBits != m_maxBits) return false;
+    if (other.m_count == 0) return true;
+    if (m_count == 0 || other.m_min < m_min) m_min = other.m_min;
+    if (m_count == 0 || other.m_max > m_max) m_max = other.m_max;
+    m_count += other.m_count;
+    m_sum += other.m_sum;
+    for (uint32_t i = 0; i < m_pos.size(); i++) {
+        m_pos[i] += other.m_pos[i];
+        m_neg[i] += other.m_neg[i];
+    }
+    return true;
+}
+
+void HdrHistogram::Clear() {
+    m_count = 0;
+    m_sum = 0;
+    std::fill(m_pos.begin(), m_pos.end(), 0);
+    std::fill(m_neg.begin(), m_neg.end(), 0);
+}
+
+int64_t HdrHistogram::GetQuantile(double q) const {
+    if (m_count == 0) return 0;
+    q = std::min(std::max(q, 0.0), 1.0);
+    uint64_t rank = (uint64_t)(q * (m_count - 1));
+    if (rank == 0) return m_min;
+    if (rank == m_count - 1) return m_max;
+    uint64_t seen = 0;
+    int64_t v = m_max;
+    bool found = false;
+    for (uint32_t i = m_neg.size(); i-- > 1 && !found;) {  // the most negative first
+        seen += m_neg[i];
+        if (seen > rank) {
+            v = -(int64_t)GetValue(i);
+            found = true;
+        }
+    }
+    for (uint32_t i = 0; i < m_pos.size() && !found; i++) {
+        seen += m_pos[i];
+        if (seen > rank) {
+            v = GetValue(i);
+            found = true;
+        }
+    }
+    return std::min(std::max(v, m_min), m_max);
+}
+
+std::string HdrHistogram::Serialize() const {
+    std::ostringstream os;
+    os.precision(17);
+    os << m_subBucketBits << " " << m_maxBits << " " << m_count << " " << m_sum << " "
+       << GetMin() << " " << GetMax();
+    for (uint32_t i = m_neg.size(); i-- > 1;) {
+        if (m_neg[i] > 0) os << " -" << i << ":" << m_neg[i];
+    }
+    for (uint32_t i = 0; i < m_pos.size(); i++) {
+        if (m_pos[i] > 0) os << " " << i << ":" << m_pos[i];
+    }
+    return os.str();
+}
+
+bool HdrHistogram::Deserialize(const std::string& s) {
+    std::istringstream is(s);
+    uint32_t subBucketBits, maxBits;
+    if (!(is >> subBucketBits >> maxBits) || subBucketBits < 1 || subBucketBits >= maxBits ||
+        maxBits > 63)
+        return false;
+    HdrHistogram h(subBucketBits, maxBits);
+    if (!(is >> h.m_count >> h.m_sum >> h.m_min >> h.m_max)) return false;
+    int64_t index;
+    char colon;
+    uint64_t count;
+    uint64_t nBucketed = 0;
+    while (is >> index >> colon >> count) {
+        uint64_t magnitude = index < 0 ? -index : index;
+        if (colon != ':' || magnitude >= h.m_pos.size()) return false;
+        (index < 0 ? h.m_neg : h.m_pos)[magnitude] += count;
+        nBucketed += count;
+    }
+    if (!is.eof() || nBucketed != h.m_count) return false;
+    *this = h;
+    return true;
+}
+
+}  // namespace ns3
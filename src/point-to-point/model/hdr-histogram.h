@@ -0,0 +1,80 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2023 NUS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Chahwan Song <songch@comp.nus.edu.sg>
+ */
+
+
+#pragma once
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * @brief Fixed-memory log-linear histogram (HDR-style) of integer values, e.g., counts and
+ * times in ns. Values under 2^subBucketBits are counted exactly; above, each power of two
+ * is split into 2^(subBucketBits-1) linear buckets, so a quantile is returned within a
+ * relative error of 2^-subBucketBits (0.8% for 7 bits). Magnitudes of 2^maxBits or more
+ * share the last bucket (min/max stay exact). Negative values have buckets of their own.
+ * The memory is allocated once, (maxBits - subBucketBits + 2) * 2^subBucketBits counters,
+ * and merging adds the buckets, hence a merge of histograms is exactly the histogram of
+ * all their values.
+ */
+class HdrHistogram {
+   public:
+    explicit HdrHistogram(uint32_t subBucketBits = 7, uint32_t maxBits = 32);
+
+    void Record(int64_t value);
+    /** @brief Add other's values; false (nothing merged) if the layouts differ */
+    bool Merge(const HdrHistogram& other);
+    void Clear();
+
+    /** @brief Value at quantile q in [0, 1] (0 if empty) */
+    int64_t GetQuantile(double q) const;
+    uint64_t GetCount() const { return m_count; }
+    double GetAvg() const { return m_count > 0 ? m_sum / m_count : 0; }
+    int64_t GetMin() const { return m_count > 0 ? m_min : 0; }
+    int64_t GetMax() const { return m_count > 0 ? m_max : 0; }
+    size_t GetMemoryUsage() const {
+        return (m_pos.capacity() + m_neg.capacity()) * sizeof(uint64_t);
+    }
+
+    /**
+     * @brief One-line text form "<subBucketBits> <maxBits> <count> <sum> <min> <max>
+     * <index>:<count>...", with negative indexes for the buckets of negative values
+     */
+    std::string Serialize() const;
+    bool Deserialize(const std::string& s);
+
+   private:
+    uint32_t GetIndex(uint64_t magnitude) const;
+    uint64_t GetValue(uint32_t index) const;  // middle of the bucket
+
+    uint32_t m_subBucketBits;
+    uint32_t m_maxBits;
+    uint64_t m_count;
+    double m_sum;
+    int64_t m_min, m_max;
+    std::vector<uint64_t> m_pos;  // counts of values >= 0, by index of the value
+    std::vector<uint64_t> m_neg;  // counts of values < 0, by index of the magnitude
+};
+
+}  // namespace ns3
@@ -21,16 +21,20 @@
 
 #include "ns3/letflow-routing.h"
 
+#include <algorithm>
+
 #include "assert.h"
 #include "ns3/assert.h"
 #include "ns3/event-id.h"
 #include "ns3/ipv4-header.h"
 #include "ns3/log.h"
+#include "ns3/mem-stats.h"
 #include "ns3/nstime.h"
 #include "ns3/object.h"
 #include "ns3/packet.h"
 #include "ns3/settings.h"
 #include "ns3/simulator.h"
+#include "ns3/switch-node.h"
 
 NS_LOG_COMPONENT_DEFINE("LetflowRouting");
 
@@ -38,6 +42,8 @@ namespace ns3 {
 
 /*---- letflowTag-Tag -----*/
 
+NS_OBJECT_ENSURE_REGISTERED(LetflowTag);
+
 LetflowTag::LetflowTag() {}
 LetflowTag::~LetflowTag() {}
 TypeId LetflowTag::GetTypeId(void) {
@@ -46,10 +52,10 @@ TypeId LetflowTag::GetTypeId(void) {
                             .AddConstructor<LetflowTag>();
     return tid;
 }
-void LetflowTag::SetPathId(uint32_t pathId) {
+void LetflowTag::SetPathId(PathId pathId) {
     m_pathId = pathId;
 }
-uint32_t LetflowTag::GetPathId(void) const {
+PathId LetflowTag::GetPathId(void) const {
     return m_pathId;
 }
 void LetflowTag::SetHopCount(uint32_t hopCount) {
@@ -62,15 +68,15 @@ TypeId LetflowTag::GetInstanceTypeId(void) const {
     return GetTypeId();
 }
 uint32_t LetflowTag::GetSerializedSize(void) const {
-    return sizeof(uint32_t) +
+    return PathCodec::GetSerializedSize() +
            sizeof(uint32_t);
 }
 void LetflowTag::Serialize(TagBuffer i) const {
-    i.WriteU32(m_pathId);
+    PathCodec::Serialize(i, m_pathId);
     i.WriteU32(m_hopCount);
 }
 void LetflowTag::Deserialize(TagBuffer i) {
-    m_pathId = i.ReadU32();
+    m_pathId = PathCodec::Deserialize(i);
     m_hopCount = i.ReadU32();
 }
 void LetflowTag::Print(std::ostream& os) const {
@@ -80,6 +86,7 @@ void LetflowTag::Print(std::ostream& os) const {
 
 /*----- Letflow-Route ------*/
 uint32_t LetflowRouting::nFlowletTimeout = 0;
+HdrHistogram LetflowRouting::m_flowletGapHist;
 LetflowRouting::LetflowRouting() {
     m_isToR = false;
     m_switch_id = (uint32_t)-1;
@@ -94,29 +101,77 @@ uint64_t LetflowRouting::GetQpKey(uint32_t dip, uint16_t sport, uint16_t dport,
     return ((uint64_t)dip << 32) | ((uint64_t)sport << 16) | (uint64_t)pg | (uint64_t)dport;
 }
 
+NS_LOAD_BALANCER_REGISTER(LetflowRouting, 6);
+
 TypeId LetflowRouting::GetTypeId(void) {
     static TypeId tid = TypeId("ns3::LetflowRouting")
-                            .SetParent<Object>()
+                            .SetParent<LoadBalancer>()
                             .AddConstructor<LetflowRouting>();
     return tid;
 }
 
 void LetflowRouting::SetSwitchInfo(bool isToR, uint32_t switch_id) {
+    LoadBalancer::SetSwitchInfo(isToR, switch_id);
     m_isToR = isToR;
     m_switch_id = switch_id;
 }
 
+void LetflowRouting::InstallTo(Ptr<SwitchNode> sw) {
+    m_switch = PeekPointer(sw);
+    sw->SetLoadBalancer(this, &SwitchNode::SendToDevSelect<LetflowRouting>);
+}
+
+void LetflowRouting::AddPath(uint32_t dstToRId, PathId pathId, Time baseRtt) {
+    m_letflowRoutingTable[dstToRId].insert(pathId);
+}
+
+void LetflowRouting::RemovePath(uint32_t dstToRId, PathId pathId) {
+    m_letflowRoutingTable[dstToRId].erase(pathId);
+}
+
+uint64_t LetflowRouting::GetPathTableBytes() const {
+    uint64_t bytes = TreeBytes(m_letflowRoutingTable.size(),
+                               sizeof(uint32_t) + sizeof(std::set<PathId>));
+    for (const auto& dst : m_letflowRoutingTable) {
+        bytes += TreeBytes(dst.second.size(), sizeof(PathId));
+    }
+    return bytes;
+}
+
+void LetflowRouting::ReportMemory(MemStats& stats) const {
+    uint64_t nPaths = 0;
+    for (const auto& dst : m_letflowRoutingTable) nPaths += dst.second.size();
+    stats.Add(MemStats::LB_PATH, nPaths, GetPathTableBytes());
+    stats.Add(MemStats::LB_FLOWLET, m_flowletTable.GetNOccupied(),
+              m_flowletTable.GetMemoryUsage());
+}
+
+uint32_t LetflowRouting::SelectOutPort(Ptr<Packet> p, CustomHeader& ch,
+                                       const std::vector<int>& nexthops) {
+    if (m_switch->m_isToR && nexthops.size() == 1) {
+        if (m_switch->m_isToR_hostIP.find(ch.sip) != m_switch->m_isToR_hostIP.end() &&
+            m_switch->m_isToR_hostIP.find(ch.dip) != m_switch->m_isToR_hostIP.end()) {
+            return nexthops[0];  // intra-pod traffic
+        }
+    }
+
+    /* ONLY called for inter-Pod traffic */
+    uint32_t outPort = RouteInput(p, ch);
+    if (outPort == LETFLOW_NULL) {
+        assert(nexthops.size() == 1);  // Receiver's TOR has only one interface to receiver-server
+        outPort = nexthops[0];         // has only one option
+    }
+    // agg/core switches follow the packet's path, which may have been removed (link failure)
+    assert(!m_isToR || std::find(nexthops.begin(), nexthops.end(), outPort) !=
+                           nexthops.end());  // Result of Letflow cannot be found in nexthops
+    return outPort;
+}
+
 /* LetflowRouting's main function */
 uint32_t LetflowRouting::RouteInput(Ptr<Packet> p, CustomHeader ch) {
     // Packet arrival time
     Time now = Simulator::Now();
 
-    // Turn on aging event scheduler if it is not running
-    if (!m_agingEvent.IsRunning()) {
-        NS_LOG_FUNCTION("Letflow routing restarts aging event scheduling:" << m_switch_id << now);
-        m_agingEvent = Simulator::Schedule(m_agingTime, &LetflowRouting::AgingEvent, this);
-    }
-
     // get srcToRId, dstToRId
     assert(Settings::hostIp2SwitchId.find(ch.sip) != Settings::hostIp2SwitchId.end());  // Misconfig of Settings::hostIp2SwitchId - sip"
     assert(Settings::hostIp2SwitchId.find(ch.dip) != Settings::hostIp2SwitchId.end());  // Misconfig of Settings::hostIp2SwitchId - dip"
@@ -137,23 +192,20 @@ uint32_t LetflowRouting::RouteInput(Ptr<Packet> p, CustomHeader ch) {
     if (m_isToR) {     // ToR switch
         if (!found) {  // sender-side
             /*---- choosing outPort ----*/
-            struct Flowlet* flowlet = NULL;
-            auto flowletItr = m_flowletTable.find(qpkey);
-            uint32_t selectedPath;
+            struct Flowlet* flowlet = m_flowletTable.Find(qpkey, now);
+            PathId selectedPath;
 
             // 1) when flowlet already exists
-            if (flowletItr != m_flowletTable.end()) {
-                flowlet = flowletItr->second;
-                NS_ASSERT_MSG(flowlet != NULL, "Impossible in normal cases - flowlet is not correctly registered");
-
-                if (now - flowlet->_activeTime <= m_flowletTimeout) {  // no timeout
+            if (flowlet != NULL) {
+                if (now - flowlet->_activeTime <= m_flowletTimeout &&
+                    HasPath(dstToRId, flowlet->_PathId)) {  // no timeout, path is not removed
                     // update flowlet info
                     flowlet->_activeTime = now;
                     flowlet->_nPackets++;
 
                     // update/measure CE of this outPort and add letflowTag
                     selectedPath = flowlet->_PathId;
-                    uint32_t outPort = GetOutPortFromPath(selectedPath, 0);  // sender switch is 0th hop
+                    uint32_t outPort = PathCodec::GetOutPort(selectedPath, 0);  // sender switch is 0th hop
                     letflowTag.SetPathId(selectedPath);
                     letflowTag.SetHopCount(0);
 
@@ -169,6 +221,7 @@ uint32_t LetflowRouting::RouteInput(Ptr<Packet> p, CustomHeader ch) {
                 // NS_LOG_FUNCTION("Flowlet expires, calculate the new port");
                 selectedPath = GetRandomPath(dstToRId);
                 LetflowRouting::nFlowletTimeout++;
+                m_flowletGapHist.Record((now - flowlet->_activeTime).GetNanoSeconds());
 
                 // update flowlet info
                 flowlet->_activatedTime = now;
@@ -177,7 +230,7 @@ uint32_t LetflowRouting::RouteInput(Ptr<Packet> p, CustomHeader ch) {
                 flowlet->_PathId = selectedPath;
 
                 // update/add letflowTag
-                uint32_t outPort = GetOutPortFromPath(selectedPath, 0);
+                uint32_t outPort = PathCodec::GetOutPort(selectedPath, 0);
                 letflowTag.SetPathId(selectedPath);
                 letflowTag.SetHopCount(0);
 
@@ -186,19 +239,18 @@ uint32_t LetflowRouting::RouteInput(Ptr<Packet> p, CustomHeader ch) {
                                 << m_switch_id
                                 << "Flowlet exists & Timeout"
                                 << "Path/outPort" << selectedPath << outPort << now);
-                return GetOutPortFromPath(selectedPath, letflowTag.GetHopCount());
+                return PathCodec::GetOutPort(selectedPath, letflowTag.GetHopCount());
             }
             // 2) flowlet does not exist, e.g., first packet of flow
             selectedPath = GetRandomPath(dstToRId);
-            struct Flowlet* newFlowlet = new Flowlet;
+            struct Flowlet* newFlowlet = m_flowletTable.Insert(qpkey, now);
             newFlowlet->_activeTime = now;
             newFlowlet->_activatedTime = now;
             newFlowlet->_nPackets = 1;
             newFlowlet->_PathId = selectedPath;
-            m_flowletTable[qpkey] = newFlowlet;
 
             // update/add letflowTag
-            uint32_t outPort = GetOutPortFromPath(selectedPath, 0);
+            uint32_t outPort = PathCodec::GetOutPort(selectedPath, 0);
             letflowTag.SetPathId(selectedPath);
             letflowTag.SetHopCount(0);
 
@@ -207,7 +259,7 @@ uint32_t LetflowRouting::RouteInput(Ptr<Packet> p, CustomHeader ch) {
                             << m_switch_id
                             << "Flowlet does not exist"
                             << "Path/outPort" << selectedPath << outPort << now);
-            return GetOutPortFromPath(selectedPath, letflowTag.GetHopCount());
+            return PathCodec::GetOutPort(selectedPath, letflowTag.GetHopCount());
         }
         /*---- receiver-side ----*/
         // remove letflowTag from header
@@ -224,7 +276,7 @@ uint32_t LetflowRouting::RouteInput(Ptr<Packet> p, CustomHeader ch) {
         letflowTag.SetHopCount(hopCount);
 
         // get outPort
-        uint32_t outPort = GetOutPortFromPath(letflowTag.GetPathId(), hopCount);
+        uint32_t outPort = PathCodec::GetOutPort(letflowTag.GetPathId(), hopCount);
         
         // Re-serialize letflowTag
         LetflowTag temp_tag;
@@ -238,51 +290,34 @@ uint32_t LetflowRouting::RouteInput(Ptr<Packet> p, CustomHeader ch) {
     NS_ASSERT_MSG("false", "This should not be occured");
 }
 
+bool LetflowRouting::HasPath(uint32_t dstToRId, PathId pathId) {
+    auto pathItr = m_letflowRoutingTable.find(dstToRId);
+    return pathItr != m_letflowRoutingTable.end() && pathItr->second.count(pathId);
+}
+
 // random selection
-uint32_t LetflowRouting::GetRandomPath(uint32_t dstToRId) {
+PathId LetflowRouting::GetRandomPath(uint32_t dstToRId) {
     auto pathItr = m_letflowRoutingTable.find(dstToRId);
     assert(pathItr != m_letflowRoutingTable.end());  // Cannot find dstToRId from ToLeafTable
 
     auto innerPathItr = pathItr->second.begin();
-    std::advance(innerPathItr, rand() % pathItr->second.size());
+    std::advance(innerPathItr, GetRandom(pathItr->second.size()));
     return *innerPathItr;
 }
 
-uint32_t LetflowRouting::GetOutPortFromPath(const uint32_t& path, const uint32_t& hopCount) {
-    return ((uint8_t*)&path)[hopCount];
-}
-
-void LetflowRouting::SetOutPortToPath(uint32_t& path, const uint32_t& hopCount, const uint32_t& outPort) {
-    ((uint8_t*)&path)[hopCount] = outPort;
-}
-
 void LetflowRouting::SetConstants(Time agingTime, Time flowletTimeout) {
     m_agingTime = agingTime;
     m_flowletTimeout = flowletTimeout;
+    m_flowletTable.SetAgingTime(agingTime);
 }
 
-void LetflowRouting::DoDispose() {
-    for (auto i : m_flowletTable) {
-        delete (i.second);
-    }
-    m_agingEvent.Cancel();
+void LetflowRouting::SetFlowletTableMode(FlowletTable::Mode mode, uint32_t capacity) {
+    m_flowletTable.Configure(mode, capacity, m_agingTime);
 }
 
-void LetflowRouting::AgingEvent() {
-    /**
-     * @brief This function is just to keep the flowlet table small as possible, to reduce memory overhead.
-     */
-    NS_LOG_FUNCTION(Simulator::Now());
-    auto now = Simulator::Now();
-    auto itr = m_flowletTable.begin();
-    while (itr != m_flowletTable.end()) {
-        if (now - ((itr->second)->_activeTime) > m_agingTime) {
-            itr = m_flowletTable.erase(itr);
-        } else {
-            ++itr;
-        }
-    }
-    m_agingEvent = Simulator::Schedule(m_agingTime, &LetflowRouting::AgingEvent, this);
+void LetflowRouting::DoDispose() {
+    m_flowletTable.Clear();
+    LoadBalancer::DoDispose();
 }
 
-}  // namespace ns3
\ No newline at end of file
+}  // namespace ns3
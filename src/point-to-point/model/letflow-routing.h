@@ -31,6 +31,9 @@
 #include "ns3/address.h"
 #include "ns3/callback.h"
 #include "ns3/event-id.h"
+#include "ns3/flowlet-table.h"
+#include "ns3/hdr-histogram.h"
+#include "ns3/load-balancer.h"
 #include "ns3/net-device.h"
 #include "ns3/object.h"
 #include "ns3/packet.h"
@@ -48,8 +51,8 @@ class LetflowTag : public Tag {
     LetflowTag();
     ~LetflowTag();
     static TypeId GetTypeId(void);
-    void SetPathId(uint32_t pathId);
-    uint32_t GetPathId(void) const;
+    void SetPathId(PathId pathId);
+    PathId GetPathId(void) const;
     void SetHopCount(uint32_t hopCount);
     uint32_t GetHopCount(void) const;
     virtual TypeId GetInstanceTypeId(void) const;
@@ -59,47 +62,49 @@ class LetflowTag : public Tag {
     virtual void Print(std::ostream& os) const;
 
    private:
-    uint32_t m_pathId;    // forward
+    PathId m_pathId;      // forward
     uint32_t m_hopCount;  // hopCount to get outPort
 };
 
 /**
- * @brief Conga object is created for each ToR Switch
+ * @brief Letflow object is created for each Switch (lb_mode = 6)
  */
-class LetflowRouting : public Object {
-    friend class SwitchMmu;
+class LetflowRouting : public LoadBalancer {
     friend class SwitchNode;
 
    public:
     LetflowRouting();
 
-    /** path <-> outPort **/
-    // uint8_t pathp[4] = {uint8_t[port0], uint8_t[port1], uint8_t[port2], uint8_t[port3]}
-    // uint32_t path = *((uint32_t*) pathp);
-    // (uint8_t*)&path[0] -> port0
+    /** path <-> outPort: PathCodec (path-id.h) **/
 
     /* static */
     static TypeId GetTypeId(void);
     static uint64_t GetQpKey(uint32_t dip, uint16_t sport, uint16_t dport, uint16_t pg);              // same as in rdma_hw.cc
-    static uint32_t GetOutPortFromPath(const uint32_t& path, const uint32_t& hopCount);               // decode outPort from path, given a hop's order
-    static void SetOutPortToPath(uint32_t& path, const uint32_t& hopCount, const uint32_t& outPort);  // encode outPort to path
     static uint32_t nFlowletTimeout;                                                                  // number of flowlet's timeout
+    static HdrHistogram m_flowletGapHist;                                                             // idle time (ns) before a new flowlet
 
     /* main function */
     uint32_t RouteInput(Ptr<Packet> p, CustomHeader ch);
-    uint32_t GetRandomPath(uint32_t dstTorId);
+    PathId GetRandomPath(uint32_t dstTorId);
+    bool HasPath(uint32_t dstToRId, PathId pathId);  // false once removed by RemovePath
+    uint32_t SelectOutPort(Ptr<Packet> p, CustomHeader& ch, const std::vector<int>& nexthops);
+    virtual void InstallTo(Ptr<SwitchNode> sw);
     virtual void DoDispose();
 
     /* SET functions */
     void SetConstants(Time agingTime, Time flowletTimeout);
-    void SetSwitchInfo(bool isToR, uint32_t switch_id);
-
-    // periodic events for flowlet timeout
-    EventId m_agingEvent;
-    void AgingEvent();
+    virtual void SetSwitchInfo(bool isToR, uint32_t switch_id);
+    virtual bool UsesPathTable() const { return true; }
+    virtual void AddPath(uint32_t dstToRId, PathId pathId, Time baseRtt);
+    virtual void RemovePath(uint32_t dstToRId, PathId pathId);
+    virtual uint32_t GetTagSize() const { return LetflowTag().GetSerializedSize(); }
+    virtual uint64_t GetPathTableBytes() const;
+    virtual void ReportMemory(MemStats& stats) const;
+    void SetFlowletTableMode(FlowletTable::Mode mode, uint32_t capacity);  // e.g., HARDWARE, 64K
+    const FlowletTable& GetFlowletTable() const { return m_flowletTable; }
 
     // topological info (should be initialized in the beginning)
-    std::map<uint32_t, std::set<uint32_t> > m_letflowRoutingTable;  // routing table (ToRId -> pathId) (stable)
+    std::map<uint32_t, std::set<PathId> > m_letflowRoutingTable;  // routing table (ToRId -> pathId) (stable)
 
     /*-----------*/
 
@@ -113,7 +118,7 @@ class LetflowRouting : public Object {
     Time m_flowletTimeout;  // flowlet timeout (e.g., 100us)
 
     // local
-    std::map<uint64_t, Flowlet*> m_flowletTable;  // QpKey -> Flowlet (at SrcToR)
+    FlowletTable m_flowletTable;  // QpKey -> Flowlet (at SrcToR), expired lazily after m_agingTime
 };
 
 }  // namespace ns3
\ No newline at end of file
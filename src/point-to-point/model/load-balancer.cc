@@ -0,0 +1,101 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2023 NUS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Chahwan Song <songch@comp.nus.edu.sg>
+ */
+
+#include "ns3/load-balancer.h"
+
+#include <assert.h>
+
+#include <iostream>
+#include <map>
+
+#include "ns3/object-factory.h"
+#include "ns3/switch-node.h"
+
+namespace ns3 {
+
+/*----- LoadBalancer ------*/
+static std::map<uint32_t, TypeId>& GetLbModeRegistry() {
+    static std::map<uint32_t, TypeId> registry;  // lb_mode -> TypeId
+    return registry;
+}
+
+void LoadBalancer::Register(uint32_t lbMode, TypeId tid) {
+    std::map<uint32_t, TypeId>& registry = GetLbModeRegistry();
+    assert(registry.find(lbMode) == registry.end() && "lb_mode is registered twice");
+    registry[lbMode] = tid;
+}
+
+Ptr<LoadBalancer> LoadBalancer::CreateByLbMode(uint32_t lbMode) {
+    std::map<uint32_t, TypeId>& registry = GetLbModeRegistry();
+    auto it = registry.find(lbMode);
+    if (it == registry.end()) {
+        std::cout << "Unknown lb_mode(" << lbMode << ")" << std::endl;
+        assert(false);
+    }
+    ObjectFactory factory;
+    factory.SetTypeId(it->second);
+    return factory.Create<LoadBalancer>();
+}
+
+TypeId LoadBalancer::GetTypeId(void) {
+    static TypeId tid = TypeId("ns3::LoadBalancer").SetParent<Object>();
+    return tid;
+}
+
+static const int64_t LB_RNG_STREAM = 1000;  // above the scratch's streams
+
+LoadBalancer::LoadBalancer() : m_switch(NULL) {
+    m_rand.SetStream(LB_RNG_STREAM);
+    // a member, not created by CreateObject: its attributes are not initialized
+    m_rand.SetAntithetic(false);
+}
+LoadBalancer::~LoadBalancer() {}
+
+void LoadBalancer::DoDispose() {
+    m_switch = NULL;
+    Object::DoDispose();
+}
+
+void LoadBalancer::SetSwitchInfo(bool isToR, uint32_t switch_id) {
+    m_rand.SetStream(LB_RNG_STREAM + switch_id);
+}
+
+/*----- ECMP ------*/
+NS_LOAD_BALANCER_REGISTER(EcmpRouting, 0);
+
+TypeId EcmpRouting::GetTypeId(void) {
+    static TypeId tid =
+        TypeId("ns3::EcmpRouting").SetParent<LoadBalancer>().AddConstructor<EcmpRouting>();
+    return tid;
+}
+
+EcmpRouting::EcmpRouting() {}
+
+void EcmpRouting::InstallTo(Ptr<SwitchNode> sw) {
+    m_switch = PeekPointer(sw);
+    sw->SetLoadBalancer(this, &SwitchNode::SendToDevSelect<EcmpRouting>);
+}
+
+uint32_t EcmpRouting::SelectOutPort(Ptr<Packet> p, CustomHeader& ch,
+                                    const std::vector<int>& nexthops) {
+    return m_switch->DoLbFlowECMP(p, ch, nexthops);
+}
+
+}  // namespace ns3
@@ -0,0 +1,115 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2023 NUS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Chahwan Song <songch@comp.nus.edu.sg>
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "ns3/nstime.h"
+#include "ns3/object.h"
+#include "ns3/packet.h"
+#include "ns3/ptr.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/settings.h"
+
+namespace ns3 {
+
+class MemStats;
+class SwitchNode;
+
+/**
+ * @brief Base class of the switch load balancers (lb_mode).
+ *
+ * One instance is created per switch at setup (LoadBalancer::CreateByLbMode) and
+ * installed with InstallTo(), which picks the switch's forwarding function,
+ * e.g. SwitchNode::SendToDevSelect<EcmpRouting>. The per-packet functions are
+ * therefore NOT virtual: each LB defines (non-virtual) either
+ *  - uint32_t SelectOutPort(Ptr<Packet>, CustomHeader&, const std::vector<int>& nexthops),
+ *    called for data packets by SwitchNode::SendToDevSelect<LB>, or
+ *  - void RouteInput(Ptr<Packet>, CustomHeader&), which takes over forwarding of
+ *    every packet (Conga, ConWeave), called by SwitchNode::SendToDevHijack<LB>.
+ * Only the setup-time functions below are virtual.
+ */
+class LoadBalancer : public Object {
+   public:
+    static TypeId GetTypeId(void);
+    LoadBalancer();
+    virtual ~LoadBalancer();
+
+    /** @brief Create the LB registered for the lb_mode (asserts on unknown modes) */
+    static Ptr<LoadBalancer> CreateByLbMode(uint32_t lbMode);
+    static void Register(uint32_t lbMode, TypeId tid);
+
+    /** @brief Attach to the switch and set its forwarding function */
+    virtual void InstallTo(Ptr<SwitchNode> sw) = 0;
+
+    /* SET functions (setup, and AddPath/RemovePath on link failure/recovery) */
+    /** @brief Overrides must call it: it also seeds the switch's random stream */
+    virtual void SetSwitchInfo(bool isToR, uint32_t switch_id);
+    virtual bool UsesPathTable() const { return false; }  // needs AddPath() at ToRs
+    virtual void AddPath(uint32_t dstToRId, PathId pathId, Time baseRtt) {}
+    virtual void RemovePath(uint32_t dstToRId, PathId pathId) {}
+    virtual void SetLinkCapacity(uint32_t outPort, uint64_t bitRate) {}
+
+    /* reporting (setup) */
+    virtual uint32_t GetTagSize() const { return 0; }         // bytes of its tag on data packets
+    virtual uint64_t GetPathTableBytes() const { return 0; }  // approximate, path tables only
+    virtual void ReportMemory(MemStats& stats) const {}       // all tables (MEM_MON_FILE)
+
+   protected:
+    virtual void DoDispose();
+    /** @brief Approximate bytes of n entries of valueSize bytes in a std::map/std::set */
+    static uint64_t TreeBytes(uint64_t n, uint64_t valueSize) {
+        return n * (4 * sizeof(void*) + valueSize);  // color and 3 links per node
+    }
+    /**
+     * @brief Uniform in [0, n), from the switch's own random stream (ns-3 stream
+     * LB_RNG_STREAM + switch ID), so that the draws of a switch depend only on the
+     * RANDOM_SEED and on its own packets, not on the other switches or the MPI partition
+     */
+    uint32_t GetRandom(uint32_t n) { return m_rand.GetInteger(0, n - 1); }
+
+    SwitchNode* m_switch;  // not a Ptr, the switch owns its LB
+    UniformRandomVariable m_rand;
+};
+
+/**
+ * @brief Register an LB class for an lb_mode (in the class's .cc file)
+ */
+#define NS_LOAD_BALANCER_REGISTER(type, lbMode)                \
+    static struct type##LbModeRegistrationClass {              \
+        type##LbModeRegistrationClass() {                      \
+            LoadBalancer::Register(lbMode, type::GetTypeId()); \
+        }                                                      \
+    } type##LbModeRegistrationVariable
+
+/**
+ * @brief Flow ECMP (lb_mode = 0), the switch's default hash-based forwarding
+ */
+class EcmpRouting : public LoadBalancer {
+   public:
+    static TypeId GetTypeId(void);
+    EcmpRouting();
+
+    virtual void InstallTo(Ptr<SwitchNode> sw);
+    uint32_t SelectOutPort(Ptr<Packet> p, CustomHeader& ch, const std::vector<int>& nexthops);
+};
+
+}  // namespace ns3
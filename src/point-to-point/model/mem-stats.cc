@@ -0,0 +1,61 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2023 NUS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Chahwan Song <songch@comp.nus.edu.sg>
+ */
+
+
+#include "ns3/mem-stats.h"
+
+#include <algorithm>
+
+namespace ns3 {
+
+MemStats::MemStats() : m_peakTotalBytes(0), m_nSnapshots(0) {
+    Clear();
+    std::fill(m_peakEntries, m_peakEntries + N_COMPONENTS, 0);
+    std::fill(m_peakBytes, m_peakBytes + N_COMPONENTS, 0);
+}
+
+void MemStats::Clear() {
+    std::fill(m_entries, m_entries + N_COMPONENTS, 0);
+    std::fill(m_bytes, m_bytes + N_COMPONENTS, 0);
+}
+
+void MemStats::UpdatePeaks() {
+    for (uint32_t c = 0; c < N_COMPONENTS; c++) {
+        m_peakEntries[c] = std::max(m_peakEntries[c], m_entries[c]);
+        m_peakBytes[c] = std::max(m_peakBytes[c], m_bytes[c]);
+    }
+    m_peakTotalBytes = std::max(m_peakTotalBytes, GetTotalBytes());
+    m_nSnapshots++;
+}
+
+uint64_t MemStats::GetTotalBytes() const {
+    uint64_t total = 0;
+    for (uint32_t c = 0; c < N_COMPONENTS; c++) total += m_bytes[c];
+    return total;
+}
+
+const char* MemStats::GetName(Component c) {
+    static const char* names[N_COMPONENTS] = {
+        "rdma_qp",   "rdma_rxqp",  "rdma_finished", "link_pause", "switch_mmu", "routes",
+        "lb_path",   "lb_flowlet", "lb_state",      "lb_voq",     "history"};
+    return names[c];
+}
+
+}  // namespace ns3
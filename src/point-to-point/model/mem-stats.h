@@ -0,0 +1,97 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2023 NUS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Chahwan Song <songch@comp.nus.edu.sg>
+ */
+
+
+#pragma once
+
+#include <stdint.h>
+
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * @brief Memory footprint of the simulator's data structures, by component (MEM_MON_FILE).
+ *
+ * A snapshot is a Clear(), then the components Add() their live entries and (approximate)
+ * bytes, e.g., RdmaHw::ReportMemory(), then UpdatePeaks(). The bytes are estimated from
+ * the container sizes, without the allocator's overhead, so they track growth (e.g., of
+ * the per-flow state that is never freed) rather than the RSS of the process.
+ */
+class MemStats {
+   public:
+    enum Component {
+        RDMA_QP = 0,    // RdmaHw: sender QPs (m_qpMap)
+        RDMA_RXQP,      // RdmaHw: receiver QPs (m_rxQpMap)
+        RDMA_FINISHED,  // RdmaHw: keys of the finished QPs (akashic_Qp/RxQp), never freed
+        LINK_PAUSE,     // per-flow PFC pause times (current_pause_time, acc_pause_time)
+        SWITCH_MMU,     // SwitchMmu: per port/queue state
+        ROUTES,         // routing tables of the nodes and of the program (hostRoutes, pair*)
+        LB_PATH,        // path tables of the load balancers
+        LB_FLOWLET,     // flowlet tables (Conga, LetFlow)
+        LB_STATE,       // other per-flow/per-port state of the load balancers
+        LB_VOQ,         // ConWeave VOQs; entries are the queued packets
+        HISTORY,        // histograms of the LB history reports (HdrHistogram)
+        N_COMPONENTS
+    };
+
+    MemStats();
+
+    void Clear();  // starts a snapshot
+    void Add(Component c, uint64_t entries, uint64_t bytes) {
+        m_entries[c] += entries;
+        m_bytes[c] += bytes;
+    }
+    void UpdatePeaks();  // ends a snapshot
+
+    uint64_t GetEntries(Component c) const { return m_entries[c]; }
+    uint64_t GetBytes(Component c) const { return m_bytes[c]; }
+    uint64_t GetTotalBytes() const;
+    uint64_t GetPeakEntries(Component c) const { return m_peakEntries[c]; }
+    uint64_t GetPeakBytes(Component c) const { return m_peakBytes[c]; }
+    uint64_t GetPeakTotalBytes() const { return m_peakTotalBytes; }  // of a single snapshot
+    uint32_t GetNSnapshots() const { return m_nSnapshots; }
+    static const char* GetName(Component c);
+
+    /* approximate bytes of containers (their nodes/buffers, not the container object) */
+    template <class V>
+    static uint64_t VectorBytes(const V& v) {
+        return v.capacity() * sizeof(typename V::value_type);
+    }
+    template <class H>  // std::unordered_map/set: buckets, and a node with a link per entry
+    static uint64_t HashBytes(const H& h) {
+        return h.bucket_count() * sizeof(void*) +
+               h.size() * (sizeof(void*) + sizeof(typename H::value_type));
+    }
+    template <class T>  // std::map/set: color and 3 links per node
+    static uint64_t TreeBytes(const T& t) {
+        return t.size() * (4 * sizeof(void*) + sizeof(typename T::value_type));
+    }
+
+   private:
+    uint64_t m_entries[N_COMPONENTS];
+    uint64_t m_bytes[N_COMPONENTS];
+    uint64_t m_peakEntries[N_COMPONENTS];
+    uint64_t m_peakBytes[N_COMPONENTS];
+    uint64_t m_peakTotalBytes;
+    uint32_t m_nSnapshots;
+};
+
+}  // namespace ns3
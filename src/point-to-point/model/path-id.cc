@@ -0,0 +1,59 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2023 NUS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Chahwan Song <songch@comp.nus.edu.sg>
+ */
+
+#include "ns3/path-id.h"
+
+#include "ns3/fatal-error.h"
+
+namespace ns3 {
+
+uint32_t PathCodec::m_portBits = 8;
+uint32_t PathCodec::m_portMask = 0xff;
+uint32_t PathCodec::m_wordBytes = 4;
+
+void PathCodec::Configure(uint32_t maxPort, uint32_t maxHops) {
+    uint32_t bits = 8;
+    while (bits < 32 && (maxPort >> bits) != 0) bits++;
+    if (bits * maxHops > 64) {
+        NS_FATAL_ERROR("PathCodec: paths of " << maxHops << " hops with " << bits
+                                              << "-bit ports do not fit in 64 bits");
+    }
+    m_portBits = bits;
+    m_portMask = (uint32_t)((1ULL << bits) - 1);
+    m_wordBytes = bits * maxHops <= 32 ? 4 : 8;
+}
+
+void PathCodec::Serialize(TagBuffer& i, PathId path) {
+    if (m_wordBytes == 4) {
+        i.WriteU32(path == PATH_ID_NULL ? UINT32_MAX : (uint32_t)path);
+    } else {
+        i.WriteU64(path);
+    }
+}
+
+PathId PathCodec::Deserialize(TagBuffer& i) {
+    if (m_wordBytes == 4) {
+        uint32_t path = i.ReadU32();
+        return path == UINT32_MAX ? PATH_ID_NULL : path;
+    }
+    return i.ReadU64();
+}
+
+}  // namespace ns3
@@ -0,0 +1,78 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2023 NUS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Chahwan Song <songch@comp.nus.edu.sg>
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "ns3/tag-buffer.h"
+
+namespace ns3 {
+
+/**
+ * @brief ToR-to-ToR source route of the path-based LBs (Conga, Letflow, ConWeave):
+ * the out port of each hop, hop 0 (the sender ToR) in the lowest bits.
+ */
+typedef uint64_t PathId;
+
+#define PATH_ID_NULL (UINT64_MAX)
+
+/**
+ * @brief Encoding of PathIds, shared by all switches and set once from the topology
+ * (Configure). Each hop takes GetPortBits() bits (at least 8, more for radix > 256),
+ * and a path is packed into a 32-bit word if the longest path fits, a 64-bit word
+ * otherwise. With 8-bit ports, a path has the same value as the former uint32_t
+ * encoding, one byte per hop.
+ *
+ * Tags carry a path in GetSerializedSize() bytes (Serialize/Deserialize); the
+ * 32-bit word maps UINT32_MAX to PATH_ID_NULL.
+ */
+class PathCodec {
+   public:
+    /**
+     * @brief Fit the encoding to the largest port index and the longest path (hops).
+     * Fatal error if such paths do not fit in 64 bits.
+     */
+    static void Configure(uint32_t maxPort, uint32_t maxHops);
+
+    static uint32_t GetOutPort(PathId path, uint32_t hop) {
+        return (uint32_t)(path >> (hop * m_portBits)) & m_portMask;
+    }
+    static void SetOutPort(PathId& path, uint32_t hop, uint32_t outPort) {
+        uint32_t shift = hop * m_portBits;
+        path = (path & ~((PathId)m_portMask << shift)) | ((PathId)outPort << shift);
+    }
+
+    static uint32_t GetPortBits() { return m_portBits; }
+    static uint32_t GetMaxHops() { return m_wordBytes * 8 / m_portBits; }  // hops in a word
+    static uint32_t GetMaxPort() { return m_portMask; }
+
+    /* in tags and hash keys: the low GetSerializedSize() bytes of the path */
+    static uint32_t GetSerializedSize() { return m_wordBytes; }
+    static void Serialize(TagBuffer& i, PathId path);
+    static PathId Deserialize(TagBuffer& i);
+
+   private:
+    static uint32_t m_portBits;
+    static uint32_t m_portMask;
+    static uint32_t m_wordBytes;  // 4 or 8
+};
+
+}  // namespace ns3
@@ -27,6 +27,7 @@
 #include <iostream>
 #include <unordered_map>
 
+#include "ns3/alloc-stats.h"
 #include "ns3/assert.h"
 #include "ns3/boolean.h"
 #include "ns3/cn-header.h"
@@ -66,10 +67,18 @@ extern std::unordered_map<unsigned, Time> acc_pause_time;
 // uint32_t RdmaEgressQueue::ack_q_idx = 3; // 3: Middle priority
 uint32_t RdmaEgressQueue::ack_q_idx = 0; // 0: high priority
 // RdmaEgressQueue
+NS_OBJECT_ENSURE_REGISTERED(RdmaEgressQueue);
+
 TypeId RdmaEgressQueue::GetTypeId(void) {
     static TypeId tid =
         TypeId("ns3::RdmaEgressQueue")
             .SetParent<Object>()
+            .AddAttribute("PauseTimeAccounting",
+                          "Accumulate per-flow PFC pause time into acc_pause_time "
+                          "(instrumentation, costs map lookups per dequeue)",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&RdmaEgressQueue::m_pauseTimeAccounting),
+                          MakeBooleanChecker())
             .AddTraceSource("RdmaEnqueue", "Enqueue a packet in the RdmaEgressQueue.",
                             MakeTraceSourceAccessor(&RdmaEgressQueue::m_traceRdmaEnqueue))
             .AddTraceSource("RdmaDequeue", "Dequeue a packet in the RdmaEgressQueue.",
@@ -81,6 +90,7 @@ RdmaEgressQueue::RdmaEgressQueue() {
     m_rrlast = 0;
     m_qlast = 0;
     m_mtu = 1000;
+    m_pauseTimeAccounting = false;
     m_ackQ = CreateObject<DropTailQueue>();
     m_ackQ->SetAttribute("MaxBytes",
                          UintegerValue(0xffffffff));  // queue limit is on a higher level, not here
@@ -122,7 +132,7 @@ int RdmaEgressQueue::GetNextQindex(bool paused[]) {
                 m_qpGrp->SetQpFinished((qIndex + m_rrlast) % fcount);
             }
         }
-        if (!cond1 && cond2) {
+        if (m_pauseTimeAccounting && !cond1 && cond2) {
             if (m_qpGrp->Get((qIndex + m_rrlast) % fcount)->m_nextAvail.GetTimeStep() >
                 Simulator::Now().GetTimeStep()) {
                 // not available now
@@ -137,7 +147,7 @@ int RdmaEgressQueue::GetNextQindex(bool paused[]) {
                 Simulator::Now().GetTimeStep())  // not available now
                 continue;
             // Check if the flow has been blocked by PFC
-            {
+            if (m_pauseTimeAccounting) {
                 int32_t flowid = m_qpGrp->Get((qIndex + m_rrlast) % fcount)->m_flow_id;
                 if (MAP_KEY_EXISTS(current_pause_time, flowid)) {
                     Time tdiff = Simulator::Now() - current_pause_time[flowid];
@@ -227,6 +237,7 @@ TypeId QbbNetDevice::GetTypeId(void) {
 QbbNetDevice::QbbNetDevice() {
     NS_LOG_FUNCTION(this);
     m_ecn_source = new std::vector<ECNAccount>;
+    m_fluidBps = 0;
     for (uint32_t i = 0; i < qCnt; i++) {
         m_paused[i] = false;
     }
@@ -244,6 +255,7 @@ void QbbNetDevice::DoDispose() {
 
 void QbbNetDevice::TransmitComplete(void) {
     NS_LOG_FUNCTION(this);
+    AllocStats::Scope allocScope(AllocStats::LINK);
     NS_ASSERT_MSG(m_txMachineState == BUSY, "Must be BUSY if transmitting");
     m_txMachineState = READY;
     NS_ASSERT_MSG(m_currentPkt != 0, "QbbNetDevice::TransmitComplete(): m_currentPkt zero");
@@ -254,6 +266,7 @@ void QbbNetDevice::TransmitComplete(void) {
 
 void QbbNetDevice::DequeueAndTransmit(void) {
     NS_LOG_FUNCTION(this);
+    AllocStats::Scope allocScope(AllocStats::LINK);
     if (!m_linkUp) return;                 // if link is down, return
     if (m_txMachineState == BUSY) return;  // Quit if channel busy
     Ptr<Packet> p;
@@ -348,6 +361,7 @@ void QbbNetDevice::Resume(unsigned qIndex) {
 
 void QbbNetDevice::Receive(Ptr<Packet> packet) {
     NS_LOG_FUNCTION(this << packet);
+    AllocStats::Scope allocScope(AllocStats::LINK);
     if (!m_linkUp) {
         m_traceDrop(packet, 0);
         return;
@@ -448,7 +462,7 @@ bool QbbNetDevice::TransmitStart(Ptr<Packet> p) {
     m_txMachineState = BUSY;
     m_currentPkt = p;
     m_phyTxBeginTrace(m_currentPkt);
-    Time txTime = Seconds(m_bps.CalculateTxTime(p->GetSize()));
+    Time txTime = Seconds((m_fluidBps ? m_packetBps : m_bps).CalculateTxTime(p->GetSize()));
     Time txCompleteTime = txTime + m_tInterframeGap;
     NS_LOG_LOGIC("Schedule TransmitCompleteEvent in " << txCompleteTime.GetSeconds() << "sec");
     Simulator::Schedule(txCompleteTime, &QbbNetDevice::TransmitComplete, this);
@@ -480,6 +494,17 @@ Ptr<BEgressQueue> QbbNetDevice::GetQueue() { return m_queue; }
 
 Ptr<RdmaEgressQueue> QbbNetDevice::GetRdmaQueue() { return m_rdmaEQ; }
 
+void QbbNetDevice::ReportMemory(MemStats &stats) const {
+    if (m_queue != NULL) {
+        stats.Add(MemStats::LINK_PAUSE, m_queue->current_pause_time.size(),
+                  MemStats::HashBytes(m_queue->current_pause_time));
+    }
+    if (m_rdmaEQ != NULL) {
+        stats.Add(MemStats::LINK_PAUSE, m_rdmaEQ->current_pause_time.size(),
+                  MemStats::HashBytes(m_rdmaEQ->current_pause_time));
+    }
+}
+
 void QbbNetDevice::RdmaEnqueueHighPrioQ(Ptr<Packet> p) {
     m_traceEnqueue(p, 0);
     m_rdmaEQ->EnqueueHighPrioQ(p);
@@ -505,6 +530,11 @@ void QbbNetDevice::TakeDown() {
     m_linkUp = false;
 }
 
+void QbbNetDevice::BringUp() {
+    m_linkUp = true;
+    DequeueAndTransmit();
+}
+
 void QbbNetDevice::UpdateNextAvail(Time t) {
     if (!m_nextSend.IsExpired() && t < m_nextSend.GetTs()) {
         Simulator::Cancel(m_nextSend);
@@ -512,4 +542,10 @@ void QbbNetDevice::UpdateNextAvail(Time t) {
         m_nextSend = Simulator::Schedule(delta, &QbbNetDevice::DequeueAndTransmit, this);
     }
 }
+
+void QbbNetDevice::SetFluidRate(uint64_t bps) {
+    NS_ASSERT_MSG(bps < m_bps.GetBitRate(), "the fluid flows must leave some rate to packets");
+    m_fluidBps = bps;
+    m_packetBps = DataRate(m_bps.GetBitRate() - bps);
+}
 }  // namespace ns3
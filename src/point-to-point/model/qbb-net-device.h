@@ -26,6 +26,7 @@
 //#include "ns3/fivetuple.h"
 #include "ns3/event-id.h"
 #include "ns3/broadcom-egress-queue.h"
+#include "ns3/mem-stats.h"
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-header.h"
 #include "ns3/udp-header.h"
@@ -46,6 +47,7 @@ public:
 	uint32_t m_rrlast;
 	Ptr<DropTailQueue> m_ackQ; // highest priority queue
 	Ptr<RdmaQueuePairGroup> m_qpGrp; // queue pairs
+	bool m_pauseTimeAccounting; // per-flow PFC pause time into acc_pause_time (instrumentation)
 	std::unordered_map<int32_t, Time> current_pause_time;
 
 	// callback for get next packet
@@ -193,6 +195,9 @@ public:
 
   std::vector<ECNAccount> *m_ecn_source;
 
+  uint64_t m_fluidBps;  //< rate of the fluid flows, see SetFluidRate
+  DataRate m_packetBps; //< m_bps - m_fluidBps
+
 public:
 	Ptr<RdmaEgressQueue> m_rdmaEQ;
 	void RdmaEnqueueHighPrioQ(Ptr<Packet> p);
@@ -209,7 +214,12 @@ public:
 
 	Ptr<RdmaEgressQueue> GetRdmaQueue();
 	void TakeDown(); // take down this device
+	void BringUp(); // bring this device up again (after TakeDown)
 	void UpdateNextAvail(Time t);
+	// hybrid fluid/packet mode: the packets get the rate that the fluid flows leave
+	void SetFluidRate(uint64_t bps);
+	uint64_t GetFluidRate(void) const { return m_fluidBps; }
+	void ReportMemory(MemStats &stats) const; // per-flow PFC pause times of its queues
 
 	TracedCallback<Ptr<const Packet>, Ptr<RdmaQueuePair> > m_traceQpDequeue; // the trace for printing dequeue
 };
@@ -0,0 +1,153 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2023 NUS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Chahwan Song <songch@comp.nus.edu.sg>
+ */
+
+#include "ns3/quantile-sketch.h"
+
+#include <math.h>
+
+#include <algorithm>
+#include <sstream>
+
+#include "ns3/assert.h"
+
+namespace ns3 {
+
+static const double MIN_INDEXABLE = 1e-9;  // smaller values go to the zero bin
+
+QuantileSketch::QuantileSketch(double relativeAccuracy)
+    : m_alpha(relativeAccuracy),
+      m_count(0),
+      m_zeroCount(0),
+      m_sum(0),
+      m_min(0),
+      m_max(0),
+      m_offset(0) {
+    NS_ASSERT_MSG(relativeAccuracy > 0 && relativeAccuracy < 1,
+                  "QuantileSketch: accuracy must be in (0, 1)");
+    m_gamma = (1 + m_alpha) / (1 - m_alpha);
+    m_invLogGamma = 1.0 / log(m_gamma);
+}
+
+int32_t QuantileSketch::GetIndex(double value) const {
+    return (int32_t)ceil(log(value) * m_invLogGamma);
+}
+
+void QuantileSketch::Add(double value) {
+    if (m_count == 0 || value < m_min) m_min = value;
+    if (m_count == 0 || value > m_max) m_max = value;
+    m_count++;
+    m_sum += value;
+    if (value <= MIN_INDEXABLE) {
+        m_zeroCount++;
+        return;
+    }
+    int32_t i = GetIndex(value);
+    if (m_bins.empty()) {
+        m_offset = i;
+        m_bins.assign(1, 0);
+    } else if (i < m_offset) {
+        m_bins.insert(m_bins.begin(), m_offset - i, 0);
+        m_offset = i;
+    } else if (i >= m_offset + (int32_t)m_bins.size()) {
+        m_bins.resize(i - m_offset + 1, 0);
+    }
+    m_bins[i - m_offset]++;
+}
+
+bool QuantileSketch::Merge(const QuantileSketch& other) {
+    if (other.m_alpha != m_alpha) return false;
+    if (other.m_count == 0) return true;
+    if (m_count == 0 || other.m_min < m_min) m_min = other.m_min;
+    if (m_count == 0 || other.m_max > m_max) m_max = other.m_max;
+    m_count += other.m_count;
+    m_sum += other.m_sum;
+    m_zeroCount += other.m_zeroCount;
+    if (other.m_bins.empty()) return true;
+    if (m_bins.empty()) {
+        m_offset = other.m_offset;
+        m_bins = other.m_bins;
+        return true;
+    }
+    int32_t lo = std::min(m_offset, other.m_offset);
+    int32_t hi = std::max(m_offset + (int32_t)m_bins.size(),
+                          other.m_offset + (int32_t)other.m_bins.size());
+    if (lo < m_offset) m_bins.insert(m_bins.begin(), m_offset - lo, 0);
+    m_offset = lo;
+    m_bins.resize(hi - lo, 0);
+    for (uint32_t i = 0; i < other.m_bins.size(); i++) {
+        m_bins[other.m_offset - m_offset + i] += other.m_bins[i];
+    }
+    return true;
+}
+
+double QuantileSketch::GetQuantile(double q) const {
+    if (m_count == 0) return 0;
+    q = std::min(std::max(q, 0.0), 1.0);
+    uint64_t rank = (uint64_t)(q * (m_count - 1));
+    if (rank < m_zeroCount) return m_min;
+    uint64_t seen = m_zeroCount;
+    for (uint32_t i = 0; i < m_bins.size(); i++) {
+        seen += m_bins[i];
+        if (seen > rank) {
+            // middle of the bin (gamma^(i-1), gamma^i], in relative terms
+            double v = 2 * pow(m_gamma, m_offset + (int32_t)i) / (m_gamma + 1);
+            return std::min(std::max(v, m_min), m_max);
+        }
+    }
+    return m_max;
+}
+
+std::string QuantileSketch::Serialize() const {
+    std::ostringstream os;
+    os.precision(17);
+    os << m_alpha << " " << m_count << " " << m_sum << " " << m_min << " " << m_max << " "
+       << m_zeroCount;
+    for (uint32_t i = 0; i < m_bins.size(); i++) {
+        if (m_bins[i] > 0) os << " " << m_offset + (int32_t)i << ":" << m_bins[i];
+    }
+    return os.str();
+}
+
+bool QuantileSketch::Deserialize(const std::string& s) {
+    std::istringstream is(s);
+    double alpha;
+    if (!(is >> alpha) || alpha <= 0 || alpha >= 1) return false;
+    QuantileSketch sketch(alpha);
+    if (!(is >> sketch.m_count >> sketch.m_sum >> sketch.m_min >> sketch.m_max >>
+          sketch.m_zeroCount))
+        return false;
+    int32_t index;
+    char colon;
+    uint64_t count;
+    uint64_t nBinned = 0;
+    while (is >> index >> colon >> count) {
+        if (colon != ':') return false;
+        if (sketch.m_bins.empty()) sketch.m_offset = index;
+        if (index < sketch.m_offset + (int32_t)sketch.m_bins.size()) return false;  // unsorted
+        sketch.m_bins.resize(index - sketch.m_offset + 1, 0);
+        sketch.m_bins.back() = count;
+        nBinned += count;
+    }
+    if (!is.eof() || nBinned + sketch.m_zeroCount != sketch.m_count) return false;
+    *this = sketch;
+    return true;
+}
+
+}  // namespace ns3
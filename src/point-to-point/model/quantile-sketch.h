@@ -0,0 +1,71 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2023 NUS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Chahwan Song <songch@comp.nus.edu.sg>
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * @brief Mergeable quantile sketch with relative error (DDSketch). A value v > 0
+ * is counted in bin ceil(log_gamma(v)), gamma = (1 + a) / (1 - a), so any
+ * quantile is returned within a relative error a of the exact one, whatever the
+ * distribution. Merging adds the bins, hence a sketch merged from several runs
+ * is exactly the sketch of all their values. Memory grows with log(max / min)
+ * (e.g. ~350 bins for slowdowns in [1, 1000] at a = 1%), not with the count.
+ */
+class QuantileSketch {
+   public:
+    explicit QuantileSketch(double relativeAccuracy = 0.01);
+
+    void Add(double value);
+    /** @brief Add other's values; false (nothing merged) if the accuracies differ */
+    bool Merge(const QuantileSketch& other);
+
+    /** @brief Value at quantile q in [0, 1] (0 if empty) */
+    double GetQuantile(double q) const;
+    uint64_t GetCount() const { return m_count; }
+    double GetAvg() const { return m_count > 0 ? m_sum / m_count : 0; }
+    double GetMin() const { return m_count > 0 ? m_min : 0; }
+    double GetMax() const { return m_count > 0 ? m_max : 0; }
+    double GetRelativeAccuracy() const { return m_alpha; }
+
+    /** @brief One-line text form "<accuracy> <count> <sum> <min> <max> <#zero> <index>:<count>..." */
+    std::string Serialize() const;
+    bool Deserialize(const std::string& s);
+
+   private:
+    int32_t GetIndex(double value) const;
+
+    double m_alpha;
+    double m_gamma;
+    double m_invLogGamma;  // 1 / ln(gamma)
+    uint64_t m_count;
+    uint64_t m_zeroCount;  // values too small for a bin (<= 0 included)
+    double m_sum, m_min, m_max;
+    int32_t m_offset;             // index of m_bins[0]
+    std::vector<uint64_t> m_bins;  // counts, dense from m_offset
+};
+
+}  // namespace ns3
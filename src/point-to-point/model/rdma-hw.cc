@@ -9,6 +9,7 @@
 
 #include "cn-header.h"
 #include "flow-stat-tag.h"
+#include "ns3/alloc-stats.h"
 #include "ns3/boolean.h"
 #include "ns3/data-rate.h"
 #include "ns3/double.h"
@@ -182,9 +183,12 @@ Ptr<RdmaQueuePair> RdmaHw::GetQp(uint64_t key) {
 }
 void RdmaHw::AddQueuePair(uint64_t size, uint16_t pg, Ipv4Address sip, Ipv4Address dip,
                           uint16_t sport, uint16_t dport, uint32_t win, uint64_t baseRtt,
-                          int32_t flow_id) {
+                          int32_t flow_id, Time start, uint64_t sent) {
+    AllocStats::Scope allocScope(AllocStats::RDMA);
     // create qp
     Ptr<RdmaQueuePair> qp = CreateObject<RdmaQueuePair>(pg, sip, dip, sport, dport);
+    qp->startTime = start;
+    qp->snd_nxt = qp->snd_una = sent;
     qp->SetSize(size);
     qp->SetWin(win);
     qp->SetBaseRtt(baseRtt);
@@ -197,7 +201,9 @@ void RdmaHw::AddQueuePair(uint64_t size, uint16_t pg, Ipv4Address sip, Ipv4Addre
         qp->irn.m_bdp = m_irn_bdp;
         qp->irn.m_rtoLow = m_irn_rtoLow;
         qp->irn.m_rtoHigh = m_irn_rtoHigh;
+        qp->irn.m_highest_ack = qp->irn.m_max_seq = sent;
     }
+    qp->hp.m_lastUpdateSeq = qp->tmly.m_lastUpdateSeq = qp->dctcp.m_lastUpdateSeq = sent;
 
     // add qp
     uint32_t nic_idx = GetNicIdxOfQp(qp);
@@ -277,6 +283,13 @@ uint32_t RdmaHw::GetNicIdxOfRxQp(Ptr<RdmaRxQueuePair> q) {
     exit(1);
 }
 
+void RdmaHw::AddRxQp(uint32_t sip, uint32_t dip, uint16_t sport, uint16_t dport, uint16_t pg,
+                     uint32_t received) {
+    Ptr<RdmaRxQueuePair> q = GetRxQp(sip, dip, sport, dport, pg, true);
+    q->ReceiverNextExpectedSeq = received;
+    q->m_milestone_rx = received;
+}
+
 // Receiver's perspective?
 void RdmaHw::DeleteRxQp(uint32_t dip, uint16_t dport, uint16_t sport, uint16_t pg) {
     uint64_t key = GetRxQpKey(dip, dport, sport, pg);
@@ -570,7 +583,29 @@ size_t RdmaHw::getIrnBufferOverhead() {
     return overhead;
 }
 
+void RdmaHw::ReportMemory(MemStats &stats) const {
+    stats.Add(MemStats::RDMA_QP, m_qpMap.size(),
+              MemStats::HashBytes(m_qpMap) + m_qpMap.size() * sizeof(RdmaQueuePair));
+    stats.Add(MemStats::RDMA_RXQP, m_rxQpMap.size(),
+              MemStats::HashBytes(m_rxQpMap) + m_rxQpMap.size() * sizeof(RdmaRxQueuePair));
+    // the QP groups of the NICs keep the finished QPs until a RedistributeQp()
+    uint64_t nGrouped = 0, groupBytes = 0;
+    for (const RdmaInterfaceMgr &nic : m_nic) {
+        if (nic.qpGrp == NULL) continue;
+        nGrouped += nic.qpGrp->m_qps.size();
+        groupBytes += MemStats::VectorBytes(nic.qpGrp->m_qps);
+    }
+    uint64_t nFinished = nGrouped > m_qpMap.size() ? nGrouped - m_qpMap.size() : 0;
+    stats.Add(MemStats::RDMA_FINISHED, akashic_Qp.size() + akashic_RxQp.size() + nFinished,
+              MemStats::HashBytes(akashic_Qp) + MemStats::HashBytes(akashic_RxQp) +
+                  nFinished * sizeof(RdmaQueuePair) + groupBytes);
+    uint64_t rtBytes = MemStats::HashBytes(m_rtTable);
+    for (const auto &dst : m_rtTable) rtBytes += MemStats::VectorBytes(dst.second);
+    stats.Add(MemStats::ROUTES, m_rtTable.size(), rtBytes);
+}
+
 int RdmaHw::Receive(Ptr<Packet> p, CustomHeader &ch) {
+    AllocStats::Scope allocScope(AllocStats::RDMA);
     // #if (SLB_DEBUG == true)
     //     std::cout << "[RdmaHw::Receive] Node(" << m_node->GetId() << ")," << PARSE_FIVE_TUPLE(ch)
     //     << "l3Prot:" << ch.l3Prot << ",at" << Simulator::Now() << std::endl;
@@ -733,6 +768,8 @@ void RdmaHw::AddTableEntry(Ipv4Address &dstAddr, uint32_t intf_idx) {
     m_rtTable[dip].push_back(intf_idx);
 }
 
+void RdmaHw::RemoveTableEntries(Ipv4Address &dstAddr) { m_rtTable.erase(dstAddr.Get()); }
+
 void RdmaHw::ClearTable() { m_rtTable.clear(); }
 
 void RdmaHw::RedistributeQp() {
@@ -753,6 +790,7 @@ void RdmaHw::RedistributeQp() {
 }
 
 Ptr<Packet> RdmaHw::GetNxtPacket(Ptr<RdmaQueuePair> qp) {
+    AllocStats::Scope allocScope(AllocStats::RDMA);
     uint32_t payload_size = qp->GetBytesLeft();
     if (m_mtu < payload_size) {  // possibly last packet
         payload_size = m_mtu;
@@ -829,6 +867,7 @@ Ptr<Packet> RdmaHw::GetNxtPacket(Ptr<RdmaQueuePair> qp) {
 }
 
 void RdmaHw::PktSent(Ptr<RdmaQueuePair> qp, Ptr<Packet> pkt, Time interframeGap) {
+    AllocStats::Scope allocScope(AllocStats::RDMA);
     qp->lastPktSize = pkt->GetSize();
     UpdateNextAvail(qp, interframeGap, pkt->GetSize());
 
@@ -853,6 +892,7 @@ void RdmaHw::PktSent(Ptr<RdmaQueuePair> qp, Ptr<Packet> pkt, Time interframeGap)
 }
 
 void RdmaHw::HandleTimeout(Ptr<RdmaQueuePair> qp, Time rto) {
+    AllocStats::Scope allocScope(AllocStats::RDMA);
     // Assume Outstanding Packets are lost
     // std::cerr << "Timeout on qp=" << qp << std::endl;
     if (qp->IsFinished()) {
@@ -9,6 +9,7 @@
 #include <unordered_map>
 #include <unordered_set>
 
+#include "ns3/mem-stats.h"
 #include "qbb-net-device.h"
 #include "rdma-queue-pair.h"
 
@@ -64,7 +65,15 @@ class RdmaHw : public Object {
 
     void AddQueuePair(uint64_t size, uint16_t pg, Ipv4Address _sip, Ipv4Address _dip,
                       uint16_t _sport, uint16_t _dport, uint32_t win, uint64_t baseRtt,
-                      int32_t flow_id);  // add a nw qp (new send)
+                      int32_t flow_id, Time start,
+                      uint64_t sent);  // a flow started at `start`, of which `sent` bytes are
+                                       // already acked (e.g., FastForward)
+    void AddQueuePair(uint64_t size, uint16_t pg, Ipv4Address _sip, Ipv4Address _dip,
+                      uint16_t _sport, uint16_t _dport, uint32_t win, uint64_t baseRtt,
+                      int32_t flow_id) {  // add a nw qp (new send)
+        this->AddQueuePair(size, pg, _sip, _dip, _sport, _dport, win, baseRtt, flow_id,
+                           Simulator::Now(), 0);
+    }
     void AddQueuePair(uint64_t size, uint16_t pg, Ipv4Address _sip, Ipv4Address _dip,
                       uint16_t _sport, uint16_t _dport, uint32_t win, uint64_t baseRtt) {
         this->AddQueuePair(size, pg, _sip, _dip, _sport, _dport, win, baseRtt, -1);
@@ -76,6 +85,8 @@ class RdmaHw : public Object {
                                  uint16_t pg, bool create);  // get a rxQp
     uint32_t GetNicIdxOfRxQp(Ptr<RdmaRxQueuePair> q);        // get the NIC index of the rxQp
     void DeleteRxQp(uint32_t dip, uint16_t dport, uint16_t sport, uint16_t pg);  // delete RxQP
+    void AddRxQp(uint32_t sip, uint32_t dip, uint16_t sport, uint16_t dport, uint16_t pg,
+                 uint32_t received);  // a rxQp of which `received` bytes already arrived
 
     int ReceiveUdp(Ptr<Packet> p, CustomHeader &ch);
     int ReceiveCnp(Ptr<Packet> p, CustomHeader &ch);
@@ -96,6 +107,7 @@ class RdmaHw : public Object {
 
     // call this function after the NIC is setup
     void AddTableEntry(Ipv4Address &dstAddr, uint32_t intf_idx);
+    void RemoveTableEntries(Ipv4Address &dstAddr);
     void ClearTable();
     void RedistributeQp();
 
@@ -111,6 +123,7 @@ class RdmaHw : public Object {
     uint32_t cnp_by_ooo;
     uint32_t cnp_total;
     size_t getIrnBufferOverhead();  // get buffer overhead for IRN
+    void ReportMemory(MemStats &stats) const;  // QPs (also finished ones), routing table
 
     /******************************
      * Mellanox's version of DCQCN
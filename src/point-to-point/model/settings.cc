@@ -24,6 +24,8 @@ uint32_t Settings::packet_payload = 1000;
 
 uint32_t Settings::dropped_pkt_sw_ingress = 0;
 uint32_t Settings::dropped_pkt_sw_egress = 0;
+uint32_t Settings::dropped_pkt_sw_linkdown = 0;
+uint64_t Settings::fwd_pkt_sw = 0;
 
 /* for load balancer */
 std::map<uint32_t, uint32_t> Settings::hostIp2SwitchId;
@@ -27,6 +27,7 @@
 #include "ns3/nstime.h"
 #include "ns3/object.h"
 #include "ns3/packet.h"
+#include "ns3/path-id.h"
 #include "ns3/ptr.h"
 #include "ns3/string.h"
 #include "ns3/tag.h"
@@ -67,7 +68,7 @@ namespace ns3 {
 struct Flowlet {
     Time _activeTime;     // to check creating a new flowlet
     Time _activatedTime;  // start time of new flowlet
-    uint32_t _PathId;     // current pathId
+    PathId _PathId;       // current pathId
     uint32_t _nPackets;   // for debugging
 };
 
@@ -137,6 +138,8 @@ class Settings {
 
     static uint32_t dropped_pkt_sw_ingress;
     static uint32_t dropped_pkt_sw_egress;
+    static uint32_t dropped_pkt_sw_linkdown;  // in flight on a path that went down
+    static uint64_t fwd_pkt_sw;               // enqueued to an egress port by a switch
 };
 
 }  // namespace ns3
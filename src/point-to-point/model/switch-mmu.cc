@@ -56,6 +56,8 @@ SwitchMmu::SwitchMmu(void) {
     // 32-port switch: 32 * 375kB = 12MB
     // m_maxBufferBytes = 4500 * 1000; //Originally: 9MB Current:4.5MB
     m_uniform_random_var.SetStream(0);
+    // a member, not created by CreateObject: its attributes are not initialized
+    m_uniform_random_var.SetAntithetic(false);
 
     // dynamic threshold
     m_dynamicth = false;
@@ -77,17 +79,13 @@ void SwitchMmu::InitSwitch(void) {
         m_port_max_shared_cell = 4800 * MTU;  // max buffer for an ingress port
     }
 
-    for (uint32_t i = 0; i < pCnt; i++)  // port 0 is not used
-    {
-        m_usedIngressPortBytes[i] = 0;
-        m_usedEgressPortBytes[i] = 0;
-        for (uint32_t j = 0; j < qCnt; j++) {
-            m_usedIngressPGBytes[i][j] = 0;
-            m_usedIngressPGHeadroomBytes[i][j] = 0;
-            m_usedEgressQMinBytes[i][j] = 0;
-            m_usedEgressQSharedBytes[i][j] = 0;
-        }
-    }
+    ResizePorts(m_activePortCnt + 1);  // port 0 is not used
+    std::fill(m_usedIngressPortBytes.begin(), m_usedIngressPortBytes.end(), 0);
+    std::fill(m_usedEgressPortBytes.begin(), m_usedEgressPortBytes.end(), 0);
+    std::fill(m_usedIngressPGBytes.begin(), m_usedIngressPGBytes.end(), 0);
+    std::fill(m_usedIngressPGHeadroomBytes.begin(), m_usedIngressPGHeadroomBytes.end(), 0);
+    std::fill(m_usedEgressQMinBytes.begin(), m_usedEgressQMinBytes.end(), 0);
+    std::fill(m_usedEgressQSharedBytes.begin(), m_usedEgressQSharedBytes.end(), 0);
     for (int i = 0; i < 4; i++) {
         m_usedIngressSPBytes[i] = 0;
         m_usedEgressSPBytes[i] = 0;
@@ -131,6 +129,40 @@ void SwitchMmu::InitSwitch(void) {
     m_log_step = 0.00001;
 }
 
+void SwitchMmu::ResizePorts(uint32_t portSlotCnt) {
+    if (portSlotCnt <= m_portSlotCnt) return;
+    m_portSlotCnt = portSlotCnt;
+
+    kmin.resize(portSlotCnt, 0);
+    kmax.resize(portSlotCnt, 0);
+    pmax.resize(portSlotCnt, 0);
+    m_pg_hdrm_limit.resize(portSlotCnt, m_pg_hdrm_limit_default);
+    paused.resize(portSlotCnt * qCnt, false);
+    resumeEvt.resize(portSlotCnt * qCnt);
+    m_pause_remote.resize(portSlotCnt * qCnt, false);
+
+    m_usedIngressPortBytes.resize(portSlotCnt, 0);
+    m_usedEgressPortBytes.resize(portSlotCnt, 0);
+    m_usedIngressPGBytes.resize(portSlotCnt * qCnt, 0);
+    m_usedIngressPGHeadroomBytes.resize(portSlotCnt * qCnt, 0);
+    m_usedEgressQMinBytes.resize(portSlotCnt * qCnt, 0);
+    m_usedEgressQSharedBytes.resize(portSlotCnt * qCnt, 0);
+    m_fluidQBytes.resize(portSlotCnt * qCnt, 0);
+}
+
+size_t SwitchMmu::GetMemoryUsage(void) const {
+    size_t perPort = 3 * sizeof(uint32_t) + sizeof(double);  // kmin, kmax, pmax, hdrm
+    perPort += 2 * sizeof(uint32_t);                         // port counters
+    perPort += qCnt * (2 * sizeof(uint8_t) + sizeof(EventId) + 5 * sizeof(uint32_t));
+    return m_portSlotCnt * perPort;
+}
+
+uint64_t SwitchMmu::GetReservedBytes(void) const {
+    uint64_t bytes = (uint64_t)m_activePortCnt * std::max(qCnt * m_pg_min_cell, m_port_min_cell);
+    for (uint32_t port = 1; port <= m_activePortCnt; port++) bytes += m_pg_hdrm_limit[port];
+    return bytes;
+}
+
 bool SwitchMmu::CheckIngressAdmission(uint32_t port, uint32_t qIndex, uint32_t psize) {
     NS_ASSERT(m_pg_shared_alpha_cell > 0);
 
@@ -139,20 +171,20 @@ bool SwitchMmu::CheckIngressAdmission(uint32_t port, uint32_t qIndex, uint32_t p
         std::cerr << "WARNING: Drop because ingress buffer full\n";
         return false;
     }
-    if (m_usedIngressPGBytes[port][qIndex] + psize > m_pg_min_cell &&
+    if (m_usedIngressPGBytes[PortQ(port, qIndex)] + psize > m_pg_min_cell &&
         m_usedIngressPortBytes[port] + psize >
             m_port_min_cell)  // exceed guaranteed, use share buffer
     {
         if (m_usedIngressSPBytes[GetIngressSP(port, qIndex)] >
             m_buffer_cell_limit_sp)  // check if headroom is already being used
         {
-            if (m_usedIngressPGHeadroomBytes[port][qIndex] + psize >
+            if (m_usedIngressPGHeadroomBytes[PortQ(port, qIndex)] + psize >
                 m_pg_hdrm_limit[port])  // exceed headroom space
             {
                 if (m_PFCenabled) {
                     std::cerr << "WARNING: Drop because ingress headroom full:"
-                              << m_usedIngressPGHeadroomBytes[port][qIndex] << "\t"
-                              << m_pg_hdrm_limit << "\n";
+                              << m_usedIngressPGHeadroomBytes[PortQ(port, qIndex)] << "\t"
+                              << m_pg_hdrm_limit[port] << "\n";
                 }
                 return false;
             }
@@ -179,7 +211,7 @@ bool SwitchMmu::CheckEgressAdmission(uint32_t port, uint32_t qIndex, uint32_t ps
                   << Simulator::Now() << std::endl;
         return false;
     }
-    if (m_usedEgressQSharedBytes[port][qIndex] + psize >
+    if (m_usedEgressQSharedBytes[PortQ(port, qIndex)] + psize >
         m_op_uc_port_config1_cell)  // exceed the queue limit
     {
         std::cerr << "WARNING: Drop because egress Q buffer full (exceed the queue limit), "
@@ -187,14 +219,15 @@ bool SwitchMmu::CheckEgressAdmission(uint32_t port, uint32_t qIndex, uint32_t ps
         return false;
     }
 
-    if ((double)m_usedEgressQSharedBytes[port][qIndex] + psize >
+    if ((double)m_usedEgressQSharedBytes[PortQ(port, qIndex)] +
+            m_fluidQBytes[PortQ(port, qIndex)] + psize >
         m_pg_shared_alpha_cell_egress * ((double)m_op_buffer_shared_limit_cell -
                                          m_usedEgressSPBytes[GetEgressSP(port, qIndex)])) {
 #if (SLB_DEBUG == true)
         // std::cerr << "WARNING: Drop because egress DT threshold exceed, Port:" << port
         //           << ", Queue:" << qIndex
         //           << ", QlenInfo:"
-        //           << ((double)m_usedEgressQSharedBytes[port][qIndex] + psize) << " > "
+        //           << ((double)m_usedEgressQSharedBytes[PortQ(port, qIndex)] + psize) << " > "
         //           << (m_pg_shared_alpha_cell_egress * ((double)m_op_buffer_shared_limit_cell -
         //           m_usedEgressSPBytes[GetEgressSP(port, qIndex)]))
         //           << ". Natural if not using PFC"
@@ -209,18 +242,18 @@ void SwitchMmu::UpdateIngressAdmission(uint32_t port, uint32_t qIndex, uint32_t
     m_usedTotalBytes += psize;  // count total buffer usage
     m_usedIngressSPBytes[GetIngressSP(port, qIndex)] += psize;
     m_usedIngressPortBytes[port] += psize;
-    m_usedIngressPGBytes[port][qIndex] += psize;
+    m_usedIngressPGBytes[PortQ(port, qIndex)] += psize;
     if (m_usedIngressSPBytes[GetIngressSP(port, qIndex)] >
         m_buffer_cell_limit_sp)  // begin to use headroom buffer
     {
-        m_usedIngressPGHeadroomBytes[port][qIndex] += psize;
+        m_usedIngressPGHeadroomBytes[PortQ(port, qIndex)] += psize;
     }
 }
 
 void SwitchMmu::UpdateEgressAdmission(uint32_t port, uint32_t qIndex, uint32_t psize) {
-    if (m_usedEgressQMinBytes[port][qIndex] + psize < m_q_min_cell)  // guaranteed
+    if (m_usedEgressQMinBytes[PortQ(port, qIndex)] + psize < m_q_min_cell)  // guaranteed
     {
-        m_usedEgressQMinBytes[port][qIndex] += psize;
+        m_usedEgressQMinBytes[PortQ(port, qIndex)] += psize;
         m_usedEgressPortBytes[port] = m_usedEgressPortBytes[port] + psize;
         return;
     } else {
@@ -229,20 +262,20 @@ void SwitchMmu::UpdateEgressAdmission(uint32_t port, uint32_t qIndex, uint32_t p
         First, when there is left space in q_min_cell, and we should use remaining space in
         q_min_cell and add rest to the shared_pool Second, just adding to shared pool
         */
-        if (m_usedEgressQMinBytes[port][qIndex] != m_q_min_cell) {
-            m_usedEgressQSharedBytes[port][qIndex] = m_usedEgressQSharedBytes[port][qIndex] +
-                                                     psize + m_usedEgressQMinBytes[port][qIndex] -
+        if (m_usedEgressQMinBytes[PortQ(port, qIndex)] != m_q_min_cell) {
+            m_usedEgressQSharedBytes[PortQ(port, qIndex)] = m_usedEgressQSharedBytes[PortQ(port, qIndex)] +
+                                                     psize + m_usedEgressQMinBytes[PortQ(port, qIndex)] -
                                                      m_q_min_cell;
             m_usedEgressPortBytes[port] =
                 m_usedEgressPortBytes[port] +
-                psize;  //+ m_usedEgressQMinBytes[port][qIndex] - m_q_min_cell ;
+                psize;  //+ m_usedEgressQMinBytes[PortQ(port, qIndex)] - m_q_min_cell ;
             m_usedEgressSPBytes[GetEgressSP(port, qIndex)] =
                 m_usedEgressSPBytes[GetEgressSP(port, qIndex)] + psize +
-                m_usedEgressQMinBytes[port][qIndex] - m_q_min_cell;
-            m_usedEgressQMinBytes[port][qIndex] = m_q_min_cell;
+                m_usedEgressQMinBytes[PortQ(port, qIndex)] - m_q_min_cell;
+            m_usedEgressQMinBytes[PortQ(port, qIndex)] = m_q_min_cell;
 
         } else {
-            m_usedEgressQSharedBytes[port][qIndex] += psize;
+            m_usedEgressQSharedBytes[PortQ(port, qIndex)] += psize;
             m_usedEgressPortBytes[port] += psize;
             m_usedEgressSPBytes[GetEgressSP(port, qIndex)] += psize;
         }
@@ -265,26 +298,26 @@ void SwitchMmu::RemoveFromIngressAdmission(uint32_t port, uint32_t qIndex, uint3
         m_usedIngressPortBytes[port] = psize;
         std::cerr << "Warning : Illegal Remove" << std::endl;
     }
-    if (m_usedIngressPGBytes[port][qIndex] < psize) {
-        m_usedIngressPGBytes[port][qIndex] = psize;
+    if (m_usedIngressPGBytes[PortQ(port, qIndex)] < psize) {
+        m_usedIngressPGBytes[PortQ(port, qIndex)] = psize;
         std::cerr << "Warning : Illegal Remove" << std::endl;
     }
     m_usedTotalBytes -= psize;
     m_usedIngressSPBytes[GetIngressSP(port, qIndex)] -= psize;
     m_usedIngressPortBytes[port] -= psize;
-    m_usedIngressPGBytes[port][qIndex] -= psize;
-    if ((double)m_usedIngressPGHeadroomBytes[port][qIndex] - psize > 0)
-        m_usedIngressPGHeadroomBytes[port][qIndex] -= psize;
+    m_usedIngressPGBytes[PortQ(port, qIndex)] -= psize;
+    if ((double)m_usedIngressPGHeadroomBytes[PortQ(port, qIndex)] - psize > 0)
+        m_usedIngressPGHeadroomBytes[PortQ(port, qIndex)] -= psize;
     else
-        m_usedIngressPGHeadroomBytes[port][qIndex] = 0;
+        m_usedIngressPGHeadroomBytes[PortQ(port, qIndex)] = 0;
 }
 void SwitchMmu::RemoveFromEgressAdmission(uint32_t port, uint32_t qIndex, uint32_t psize) {
-    if (m_usedEgressQMinBytes[port][qIndex] < m_q_min_cell)  // guaranteed
+    if (m_usedEgressQMinBytes[PortQ(port, qIndex)] < m_q_min_cell)  // guaranteed
     {
-        if (m_usedEgressQMinBytes[port][qIndex] < psize) {
+        if (m_usedEgressQMinBytes[PortQ(port, qIndex)] < psize) {
             std::cerr << "STOP overflow\n";
         }
-        m_usedEgressQMinBytes[port][qIndex] -= psize;
+        m_usedEgressQMinBytes[PortQ(port, qIndex)] -= psize;
         m_usedEgressPortBytes[port] -= psize;
         return;
     } else {
@@ -295,26 +328,26 @@ void SwitchMmu::RemoveFromEgressAdmission(uint32_t port, uint32_t qIndex, uint32
         */
 
         // first case
-        if (m_usedEgressQMinBytes[port][qIndex] == m_q_min_cell &&
-            m_usedEgressQSharedBytes[port][qIndex] < psize) {
-            m_usedEgressQMinBytes[port][qIndex] = m_usedEgressQMinBytes[port][qIndex] +
-                                                  m_usedEgressQSharedBytes[port][qIndex] - psize;
+        if (m_usedEgressQMinBytes[PortQ(port, qIndex)] == m_q_min_cell &&
+            m_usedEgressQSharedBytes[PortQ(port, qIndex)] < psize) {
+            m_usedEgressQMinBytes[PortQ(port, qIndex)] = m_usedEgressQMinBytes[PortQ(port, qIndex)] +
+                                                  m_usedEgressQSharedBytes[PortQ(port, qIndex)] - psize;
             m_usedEgressSPBytes[GetEgressSP(port, qIndex)] =
                 m_usedEgressSPBytes[GetEgressSP(port, qIndex)] -
-                m_usedEgressQSharedBytes[port][qIndex];
-            m_usedEgressQSharedBytes[port][qIndex] = 0;
+                m_usedEgressQSharedBytes[PortQ(port, qIndex)];
+            m_usedEgressQSharedBytes[PortQ(port, qIndex)] = 0;
             if (m_usedEgressPortBytes[port] < psize) {
                 std::cerr << "STOP overflow\n";
             }
             m_usedEgressPortBytes[port] -= psize;
 
         } else {
-            if (m_usedEgressQSharedBytes[port][qIndex] < psize ||
+            if (m_usedEgressQSharedBytes[PortQ(port, qIndex)] < psize ||
                 m_usedEgressPortBytes[port] < psize ||
                 m_usedEgressSPBytes[GetEgressSP(port, qIndex)] < psize) {
                 std::cerr << "STOP overflow\n";
             }
-            m_usedEgressQSharedBytes[port][qIndex] -= psize;
+            m_usedEgressQSharedBytes[PortQ(port, qIndex)] -= psize;
             m_usedEgressPortBytes[port] -= psize;
             m_usedEgressSPBytes[GetEgressSP(port, qIndex)] -= psize;
         }
@@ -329,17 +362,17 @@ void SwitchMmu::GetPauseClasses(uint32_t port, uint32_t qIndex, bool pClasses[])
     if (m_dynamicth) {
         for (uint32_t i = 0; i < qCnt; i++) {
             pClasses[i] = false;
-            if (m_usedIngressPGBytes[port][i] <= m_pg_min_cell + m_port_min_cell) continue;
+            if (m_usedIngressPGBytes[PortQ(port, i)] <= m_pg_min_cell + m_port_min_cell) continue;
 
-            // std::cerr << "BCM : Used=" << m_usedIngressPGBytes[port][i] << ", thresh=" <<
+            // std::cerr << "BCM : Used=" << m_usedIngressPGBytes[PortQ(port, i)] << ", thresh=" <<
             // m_pg_shared_alpha_cell*((double)m_buffer_cell_limit_sp -
             // m_usedIngressSPBytes[GetIngressSP(port, qIndex)]) + m_pg_min_cell+m_port_min_cell <<
             // std::endl;
 
-            if ((double)m_usedIngressPGBytes[port][i] - m_pg_min_cell - m_port_min_cell >
+            if ((double)m_usedIngressPGBytes[PortQ(port, i)] - m_pg_min_cell - m_port_min_cell >
                     m_pg_shared_alpha_cell * ((double)m_buffer_cell_limit_sp -
                                               m_usedIngressSPBytes[GetIngressSP(port, qIndex)]) ||
-                m_usedIngressPGHeadroomBytes[port][qIndex] != 0) {
+                m_usedIngressPGHeadroomBytes[PortQ(port, qIndex)] != 0) {
                 pClasses[i] = true;
             }
         }
@@ -355,7 +388,7 @@ void SwitchMmu::GetPauseClasses(uint32_t port, uint32_t qIndex, bool pClasses[])
                 pClasses[i] = false;
             }
         }
-        if (m_usedIngressPGBytes[port][qIndex] > m_pg_shared_limit_cell) {
+        if (m_usedIngressPGBytes[PortQ(port, qIndex)] > m_pg_shared_limit_cell) {
             pClasses[qIndex] = true;
         }
     }
@@ -363,17 +396,17 @@ void SwitchMmu::GetPauseClasses(uint32_t port, uint32_t qIndex, bool pClasses[])
 }
 
 bool SwitchMmu::GetResumeClasses(uint32_t port, uint32_t qIndex) {
-    if (!paused[port][qIndex]) return false;
+    if (!paused[PortQ(port, qIndex)]) return false;
     if (m_dynamicth) {
-        if ((double)m_usedIngressPGBytes[port][qIndex] - m_pg_min_cell - m_port_min_cell <
+        if ((double)m_usedIngressPGBytes[PortQ(port, qIndex)] - m_pg_min_cell - m_port_min_cell <
                 m_pg_shared_alpha_cell * ((double)m_buffer_cell_limit_sp -
                                           m_usedIngressSPBytes[GetIngressSP(port, qIndex)] -
                                           m_pg_shared_alpha_cell_off_diff) &&
-            m_usedIngressPGHeadroomBytes[port][qIndex] == 0) {
+            m_usedIngressPGHeadroomBytes[PortQ(port, qIndex)] == 0) {
             return true;
         }
     } else {
-        if (m_usedIngressPGBytes[port][qIndex] < m_pg_shared_limit_cell_off &&
+        if (m_usedIngressPGBytes[PortQ(port, qIndex)] < m_pg_shared_limit_cell_off &&
             m_usedIngressPortBytes[port] < m_port_min_cell_off) {
             return true;
         }
@@ -399,12 +432,13 @@ bool SwitchMmu::ShouldSendCN(uint32_t ifindex, uint32_t qIndex) {
     if (qIndex == 0)  // qidx=0 as highest priority
         return false;
 
-    if (m_usedEgressQSharedBytes[ifindex][qIndex] > kmax[ifindex]) {
+    uint32_t qBytes =
+        m_usedEgressQSharedBytes[PortQ(ifindex, qIndex)] + m_fluidQBytes[PortQ(ifindex, qIndex)];
+    if (qBytes > kmax[ifindex]) {
         return true;
-    } else if (m_usedEgressQSharedBytes[ifindex][qIndex] > kmin[ifindex] &&
-               kmin[ifindex] != kmax[ifindex]) {
-        double p = 1.0 * (m_usedEgressQSharedBytes[ifindex][qIndex] - kmin[ifindex]) /
-                   (kmax[ifindex] - kmin[ifindex]) * pmax[ifindex];
+    } else if (qBytes > kmin[ifindex] && kmin[ifindex] != kmax[ifindex]) {
+        double p = 1.0 * (qBytes - kmin[ifindex]) / (kmax[ifindex] - kmin[ifindex]) *
+                   pmax[ifindex];
         if (m_uniform_random_var.GetValue(0, 1) < p) return true;
     }
     return false;
@@ -431,7 +465,8 @@ void SwitchMmu::SetBroadcomParams(
     m_port_min_cell = port_min_cell;
     m_pg_shared_limit_cell = pg_shared_limit_cell;
     m_port_max_shared_cell = port_max_shared_cell;
-    for (int i = 0; i < pCnt; i++) m_pg_hdrm_limit[i] = pg_hdrm_limit;
+    m_pg_hdrm_limit_default = pg_hdrm_limit;
+    std::fill(m_pg_hdrm_limit.begin(), m_pg_hdrm_limit.end(), pg_hdrm_limit);
     m_port_max_pkt_size = port_max_pkt_size;
     m_q_min_cell = q_min_cell;
     m_op_uc_port_config1_cell = op_uc_port_config1_cell;
@@ -450,23 +485,25 @@ void SwitchMmu::SetDynamicThreshold(bool v) {
 }
 
 void SwitchMmu::ConfigEcn(uint32_t port, uint32_t _kmin, uint32_t _kmax, double _pmax) {
+    ResizePorts(port + 1);  // may be called before ConfigNPort
     kmin[port] = _kmin * 1000;
     kmax[port] = _kmax * 1000;
     pmax[port] = _pmax;
 }
 
 void SwitchMmu::SetPause(uint32_t port, uint32_t qIndex, uint32_t pause_time) {
-    paused[port][qIndex] = true;
-    Simulator::Cancel(resumeEvt[port][qIndex]);
-    resumeEvt[port][qIndex] =
+    paused[PortQ(port, qIndex)] = true;
+    Simulator::Cancel(resumeEvt[PortQ(port, qIndex)]);
+    resumeEvt[PortQ(port, qIndex)] =
         Simulator::Schedule(MicroSeconds(pause_time), &SwitchMmu::SetResume, this, port, qIndex);
 }
 void SwitchMmu::SetResume(uint32_t port, uint32_t qIndex) {
-    paused[port][qIndex] = false;
-    Simulator::Cancel(resumeEvt[port][qIndex]);
+    paused[PortQ(port, qIndex)] = false;
+    Simulator::Cancel(resumeEvt[PortQ(port, qIndex)]);
 }
 
 void SwitchMmu::ConfigHdrm(uint32_t port, uint32_t size) {
+    ResizePorts(port + 1);  // may be called before ConfigNPort
     m_pg_hdrm_limit[port] = size;
     InitSwitch();
 }
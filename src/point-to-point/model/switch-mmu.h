@@ -1,15 +1,15 @@
 #ifndef SWITCH_MMU_H
 #define SWITCH_MMU_H
 
+#include <ns3/event-id.h>
 #include <ns3/node.h>
 #include <ns3/random-variable-stream.h>
 
+#include <algorithm>
 #include <list>
 #include <unordered_map>
+#include <vector>
 
-#include "ns3/conga-routing.h"
-#include "ns3/conweave-routing.h"
-#include "ns3/letflow-routing.h"
 #include "ns3/settings.h"
 
 
@@ -20,7 +20,6 @@ class Packet;
 class SwitchMmu : public Object {
    public:
     static const unsigned qCnt = 8;    // Number of queues/priorities used
-    static const unsigned pCnt = 128;  // port 0 is not used so + 1	// Number of ports used
     static const unsigned MTU = 1048;  // 1000 + headers
 
     static TypeId GetTypeId(void);
@@ -76,17 +75,30 @@ class SwitchMmu : public Object {
     uint32_t GetIngressSP(uint32_t port, uint32_t pgIndex);
     uint32_t GetEgressSP(uint32_t port, uint32_t qIndex);
 
-    // config
-    uint32_t node_id;
+    // egress queue occupancy in bytes (guaranteed + shared)
+    uint32_t GetEgressQBytes(uint32_t port, uint32_t qIndex) const {
+        return m_usedEgressQMinBytes[PortQ(port, qIndex)] +
+               m_usedEgressQSharedBytes[PortQ(port, qIndex)];
+    }
+
+    // whether we have paused the upstream of (port, qIndex)
+    bool GetPauseRemote(uint32_t port, uint32_t qIndex) const {
+        return m_pause_remote[PortQ(port, qIndex)];
+    }
+    void SetPauseRemote(uint32_t port, uint32_t qIndex, bool v) {
+        m_pause_remote[PortQ(port, qIndex)] = v;
+    }
 
-    uint32_t kmin[pCnt], kmax[pCnt];
-    double pmax[pCnt];
-    uint32_t paused[pCnt][qCnt];
-    EventId resumeEvt[pCnt][qCnt];
-    bool m_pause_remote[pCnt][qCnt];
+    /**
+     * @brief Standing queue of the fluid flows on (port, qIndex), in the hybrid fluid/packet
+     * mode. It counts for ECN marking and the egress dynamic threshold, but takes no buffer.
+     */
+    void SetFluidQueue(uint32_t port, uint32_t qIndex, uint32_t bytes) {
+        m_fluidQBytes[PortQ(port, qIndex)] = bytes;
+    }
 
-    uint32_t pfc_a_shift[pCnt];         // legacy: not used anymore
-    uint32_t egress_bytes[pCnt][qCnt];  // legacy: not used anymore
+    // config
+    uint32_t node_id;
 
     uint32_t GetActivePortCnt(void) const { return m_activePortCnt; }
     void SetActivePortCnt(uint32_t v) {
@@ -101,22 +113,35 @@ class SwitchMmu : public Object {
         InitSwitch();
     }
 
-    uint32_t GetPgHdrmLimit(void) const { return m_pg_hdrm_limit[0]; }
+    uint32_t GetPgHdrmLimit(void) const { return m_pg_hdrm_limit_default; }
     void SetPgHdrmLimit(uint32_t v) {
-        for (int i = 0; i < pCnt; i++) m_pg_hdrm_limit[i] = v;
+        m_pg_hdrm_limit_default = v;
+        std::fill(m_pg_hdrm_limit.begin(), m_pg_hdrm_limit.end(), v);
         InitSwitch();
     }
 
-    /*------------ Conga Objects-------------*/
-    CongaRouting m_congaRouting;
-
-    /*------------ Letflow Objects-------------*/
-    LetflowRouting m_letflowRouting;
-
-    /*------------ ConWeave Objects-------------*/
-    ConWeaveRouting m_conweaveRouting;
+    uint32_t GetPortSlotCnt(void) const { return m_portSlotCnt; }
+    size_t GetMemoryUsage(void) const;  // bytes of the per-port state
+    /** @brief PFC headroom and guarantees of the active ports; the buffer must be larger */
+    uint64_t GetReservedBytes(void) const;
 
    private:
+    /**
+     * Per-port state is sized at setup from the number of ports (port 0 is not
+     * used), see ConfigNPort. Per-(port, queue) arrays are flat with stride qCnt.
+     */
+    static uint32_t PortQ(uint32_t port, uint32_t qIndex) { return port * qCnt + qIndex; }
+    void ResizePorts(uint32_t portSlotCnt);  // grow-only, keeps the port configs
+
+    uint32_t m_portSlotCnt{0};
+
+    // per-port config
+    std::vector<uint32_t> kmin, kmax;
+    std::vector<double> pmax;
+    std::vector<uint8_t> paused;        // [PortQ]
+    std::vector<EventId> resumeEvt;     // [PortQ]
+    std::vector<uint8_t> m_pause_remote;  // [PortQ]
+
     bool m_PFCenabled;
 
     uint32_t m_maxBufferBytes{0};
@@ -126,14 +151,16 @@ class SwitchMmu : public Object {
     uint32_t m_maxBufferBytesPerPort{0};  // use this to calculate m_maxBufferBytes
     uint32_t m_staticMaxBufferBytes{0};   // use this to calculate m_maxBufferBytes
 
-    uint32_t m_usedIngressPGBytes[pCnt][qCnt];
-    uint32_t m_usedIngressPortBytes[pCnt];
+    // admission counters, one array per counter (touched per packet)
+    std::vector<uint32_t> m_usedIngressPGBytes;  // [PortQ]
+    std::vector<uint32_t> m_usedIngressPortBytes;
     uint32_t m_usedIngressSPBytes[4];
-    uint32_t m_usedIngressPGHeadroomBytes[pCnt][qCnt];
+    std::vector<uint32_t> m_usedIngressPGHeadroomBytes;  // [PortQ]
 
-    uint32_t m_usedEgressQMinBytes[pCnt][qCnt];
-    uint32_t m_usedEgressQSharedBytes[pCnt][qCnt];
-    uint32_t m_usedEgressPortBytes[pCnt];
+    std::vector<uint32_t> m_usedEgressQMinBytes;     // [PortQ]
+    std::vector<uint32_t> m_usedEgressQSharedBytes;  // [PortQ]
+    std::vector<uint32_t> m_fluidQBytes;             // [PortQ], see SetFluidQueue
+    std::vector<uint32_t> m_usedEgressPortBytes;
     uint32_t m_usedEgressSPBytes[4];
 
     // ingress params
@@ -144,7 +171,8 @@ class SwitchMmu : public Object {
     uint32_t m_port_min_cell;           // ingress port guarantee
     uint32_t m_pg_shared_limit_cell;    // max buffer for an ingress pg
     uint32_t m_port_max_shared_cell;    // max buffer for an ingress port
-    uint32_t m_pg_hdrm_limit[pCnt];     // ingress pg headroom
+    std::vector<uint32_t> m_pg_hdrm_limit;  // ingress pg headroom
+    uint32_t m_pg_hdrm_limit_default{0};    // for ports not set by ConfigHdrm
     uint32_t m_port_max_pkt_size;       // ingress global headroom
     // still needs reset limits..
     uint32_t m_port_min_cell_off;  // PAUSE off threshold
@@ -1,14 +1,14 @@
 #include "switch-node.h"
 
 #include "assert.h"
+#include "ns3/alloc-stats.h"
 #include "ns3/boolean.h"
-#include "ns3/conweave-routing.h"
 #include "ns3/double.h"
 #include "ns3/flow-id-tag.h"
 #include "ns3/int-header.h"
+#include "ns3/mem-stats.h"
 #include "ns3/ipv4-header.h"
 #include "ns3/ipv4.h"
-#include "ns3/letflow-routing.h"
 #include "ns3/packet.h"
 #include "ns3/pause-header.h"
 #include "ns3/settings.h"
@@ -34,25 +34,29 @@ TypeId SwitchNode::GetTypeId(void) {
     return tid;
 }
 
-SwitchNode::SwitchNode() {
+SwitchNode::SwitchNode() : SwitchNode(0) {}
+
+SwitchNode::SwitchNode(uint32_t systemId) : Node(systemId) {
     m_ecmpSeed = m_id;
     m_isToR = false;
     m_node_type = 1;
     m_isToR = false;
-    m_drill_candidate = 2;
     m_mmu = CreateObject<SwitchMmu>();
-    // Conga's Callback for switch functions
-    m_mmu->m_congaRouting.SetSwitchSendCallback(MakeCallback(&SwitchNode::DoSwitchSend, this));
-    m_mmu->m_congaRouting.SetSwitchSendToDevCallback(
-        MakeCallback(&SwitchNode::SendToDevContinue, this));
-    // ConWeave's Callback for switch functions
-    m_mmu->m_conweaveRouting.SetSwitchSendCallback(MakeCallback(&SwitchNode::DoSwitchSend, this));
-    m_mmu->m_conweaveRouting.SetSwitchSendToDevCallback(
-        MakeCallback(&SwitchNode::SendToDevContinue, this));
-
-    for (uint32_t i = 0; i < pCnt; i++) {
-        m_txBytes[i] = 0;
+    m_sendToDev = &SwitchNode::SendToDevContinue;  // flow ECMP until an LB is installed
+}
+
+void SwitchNode::DoDispose(void) {
+    if (m_lb) {
+        m_lb->Dispose();
+        m_lb = 0;
     }
+    m_sendToDev = &SwitchNode::SendToDevContinue;
+    Node::DoDispose();
+}
+
+void SwitchNode::SetLoadBalancer(Ptr<LoadBalancer> lb, SendToDevFunction sendToDev) {
+    m_lb = lb;
+    m_sendToDev = sendToDev;
 }
 
 /**
@@ -85,73 +89,6 @@ uint32_t SwitchNode::DoLbFlowECMP(Ptr<const Packet> p, const CustomHeader &ch,
     return nexthops[idx];
 }
 
-/*-----------------CONGA-----------------*/
-uint32_t SwitchNode::DoLbConga(Ptr<Packet> p, CustomHeader &ch, const std::vector<int> &nexthops) {
-    return DoLbFlowECMP(p, ch, nexthops);  // flow ECMP (dummy)
-}
-
-/*-----------------Letflow-----------------*/
-uint32_t SwitchNode::DoLbLetflow(Ptr<Packet> p, CustomHeader &ch,
-                                 const std::vector<int> &nexthops) {
-    if (m_isToR && nexthops.size() == 1) {
-        if (m_isToR_hostIP.find(ch.sip) != m_isToR_hostIP.end() &&
-            m_isToR_hostIP.find(ch.dip) != m_isToR_hostIP.end()) {
-            return nexthops[0];  // intra-pod traffic
-        }
-    }
-
-    /* ONLY called for inter-Pod traffic */
-    uint32_t outPort = m_mmu->m_letflowRouting.RouteInput(p, ch);
-    if (outPort == LETFLOW_NULL) {
-        assert(nexthops.size() == 1);  // Receiver's TOR has only one interface to receiver-server
-        outPort = nexthops[0];         // has only one option
-    }
-    assert(std::find(nexthops.begin(), nexthops.end(), outPort) !=
-           nexthops.end());  // Result of Letflow cannot be found in nexthops
-    return outPort;
-}
-
-/*-----------------DRILL-----------------*/
-uint32_t SwitchNode::CalculateInterfaceLoad(uint32_t interface) {
-    Ptr<QbbNetDevice> device = DynamicCast<QbbNetDevice>(m_devices[interface]);
-    NS_ASSERT_MSG(!!device && !!device->GetQueue(),
-                  "Error of getting a egress queue for calculating interface load");
-    return device->GetQueue()->GetNBytesTotal();  // also used in HPCC
-}
-
-uint32_t SwitchNode::DoLbDrill(Ptr<const Packet> p, const CustomHeader &ch,
-                               const std::vector<int> &nexthops) {
-    // find the Egress (output) link with the smallest local Egress Queue length
-    uint32_t leastLoadInterface = 0;
-    uint32_t leastLoad = std::numeric_limits<uint32_t>::max();
-    auto rand_nexthops = nexthops;
-    std::random_shuffle(rand_nexthops.begin(), rand_nexthops.end());
-
-    std::map<uint32_t, uint32_t>::iterator itr = m_previousBestInterfaceMap.find(ch.dip);
-    if (itr != m_previousBestInterfaceMap.end()) {
-        leastLoadInterface = itr->second;
-        leastLoad = CalculateInterfaceLoad(itr->second);
-    }
-
-    uint32_t sampleNum =
-        m_drill_candidate < rand_nexthops.size() ? m_drill_candidate : rand_nexthops.size();
-    for (uint32_t samplePort = 0; samplePort < sampleNum; samplePort++) {
-        uint32_t sampleLoad = CalculateInterfaceLoad(rand_nexthops[samplePort]);
-        if (sampleLoad < leastLoad) {
-            leastLoad = sampleLoad;
-            leastLoadInterface = rand_nexthops[samplePort];
-        }
-    }
-    m_previousBestInterfaceMap[ch.dip] = leastLoadInterface;
-    return leastLoadInterface;
-}
-
-/*------------------ConWeave Dummy ----------------*/
-uint32_t SwitchNode::DoLbConWeave(Ptr<const Packet> p, const CustomHeader &ch,
-                                  const std::vector<int> &nexthops) {
-    return DoLbFlowECMP(p, ch, nexthops);  // flow ECMP (dummy)
-}
-/*----------------------------------*/
 
 void SwitchNode::CheckAndSendPfc(uint32_t inDev, uint32_t qIndex) {
     Ptr<QbbNetDevice> device = DynamicCast<QbbNetDevice>(m_devices[inDev]);
@@ -161,18 +98,18 @@ void SwitchNode::CheckAndSendPfc(uint32_t inDev, uint32_t qIndex) {
         if (pClasses[j]) {
             uint32_t paused_time = device->SendPfc(j, 0);
             m_mmu->SetPause(inDev, j, paused_time);
-            m_mmu->m_pause_remote[inDev][j] = true;
+            m_mmu->SetPauseRemote(inDev, j, true);
             /** PAUSE SEND COUNT ++ */
         }
     }
 
     for (int j = 0; j < qCnt; j++) {
-        if (!m_mmu->m_pause_remote[inDev][j]) continue;
+        if (!m_mmu->GetPauseRemote(inDev, j)) continue;
 
         if (m_mmu->GetResumeClasses(inDev, j)) {
             device->SendPfc(j, 1);
             m_mmu->SetResume(inDev, j);
-            m_mmu->m_pause_remote[inDev][j] = false;
+            m_mmu->SetPauseRemote(inDev, j, false);
         }
     }
 }
@@ -191,58 +128,31 @@ void SwitchNode::CheckAndSendResume(uint32_t inDev, uint32_t qIndex) {
 // This function can only be called in switch mode
 bool SwitchNode::SwitchReceiveFromDevice(Ptr<NetDevice> device, Ptr<Packet> packet,
                                          CustomHeader &ch) {
+    AllocStats::Scope allocScope(AllocStats::LB);
     SendToDev(packet, ch);
     return true;
 }
 
-void SwitchNode::SendToDev(Ptr<Packet> p, CustomHeader &ch) {
-    /** HIJACK: hijack the packet and run DoSwitchSend internally for Conga and ConWeave.
-     * Note that DoLbConWeave() and DoLbConga() are flow-ECMP function for control packets
-     * or intra-ToR traffic.
-     */
-
-    // Conga
-    if (Settings::lb_mode == 3) {
-        m_mmu->m_congaRouting.RouteInput(p, ch);
-        return;
-    }
-
-    // ConWeave
-    if (Settings::lb_mode == 9) {
-        m_mmu->m_conweaveRouting.RouteInput(p, ch);
-        return;
-    }
-
-    // Others
-    SendToDevContinue(p, ch);
-}
-
 void SwitchNode::SendToDevContinue(Ptr<Packet> p, CustomHeader &ch) {
-    int idx = GetOutDev(p, ch);
-    if (idx >= 0) {
-        NS_ASSERT_MSG(m_devices[idx]->IsLinkUp(),
-                      "The routing table look up should return link that is up");
-
-        // determine the qIndex
-        uint32_t qIndex;
-        if (ch.l3Prot == 0xFF || ch.l3Prot == 0xFE ||
-            (m_ackHighPrio &&
-             (ch.l3Prot == 0xFD ||
-              ch.l3Prot == 0xFC))) {  // QCN or PFC or ACK/NACK, go highest priority
-            qIndex = 0;               // high priority
-        } else {
-            qIndex = (ch.l3Prot == 0x06 ? 1 : ch.udp.pg);  // if TCP, put to queue 1. Otherwise, it
-                                                           // would be 3 (refer to trafficgen)
-        }
+    SendToOutDev(p, ch, DoLbFlowECMP(p, ch, GetNexthops(ch)));
+}
 
-        DoSwitchSend(p, ch, idx, qIndex);  // m_devices[idx]->SwitchSend(qIndex, p, ch);
-        return;
+void SwitchNode::SendToOutDev(Ptr<Packet> p, CustomHeader &ch, uint32_t outDev) {
+    // determine the qIndex
+    uint32_t qIndex;
+    if (ch.l3Prot == 0xFF || ch.l3Prot == 0xFE ||
+        (m_ackHighPrio &&
+         (ch.l3Prot == 0xFD || ch.l3Prot == 0xFC))) {  // QCN or PFC or ACK/NACK, go highest priority
+        qIndex = 0;                                    // high priority
+    } else {
+        qIndex = (ch.l3Prot == 0x06 ? 1 : ch.udp.pg);  // if TCP, put to queue 1. Otherwise, it
+                                                       // would be 3 (refer to trafficgen)
     }
-    std::cout << "WARNING - Drop occurs in SendToDevContinue()" << std::endl;
-    return;  // Drop otherwise
+
+    DoSwitchSend(p, ch, outDev, qIndex);  // m_devices[outDev]->SwitchSend(qIndex, p, ch);
 }
 
-int SwitchNode::GetOutDev(Ptr<Packet> p, CustomHeader &ch) {
+const std::vector<int> &SwitchNode::GetNexthops(const CustomHeader &ch) {
     // look up entries
     auto entry = m_rtTable.find(ch.dip);
 
@@ -253,35 +163,21 @@ int SwitchNode::GetOutDev(Ptr<Packet> p, CustomHeader &ch) {
                   << ")" << std::endl;
         assert(false);
     }
-
-    // entry found
-    const auto &nexthops = entry->second;
-    bool control_pkt =
-        (ch.l3Prot == 0xFF || ch.l3Prot == 0xFE || ch.l3Prot == 0xFD || ch.l3Prot == 0xFC);
-
-    if (Settings::lb_mode == 0 || control_pkt) {  // control packet (ACK, NACK, PFC, QCN)
-        return DoLbFlowECMP(p, ch, nexthops);     // ECMP routing path decision (4-tuple)
-    }
-
-    switch (Settings::lb_mode) {
-        case 2:
-            return DoLbDrill(p, ch, nexthops);
-        case 3:
-            return DoLbConga(p, ch, nexthops); /** DUMMY: Do ECMP */
-        case 6:
-            return DoLbLetflow(p, ch, nexthops);
-        case 9:
-            return DoLbConWeave(p, ch, nexthops); /** DUMMY: Do ECMP */
-        default:
-            std::cout << "Unknown lb_mode(" << Settings::lb_mode << ")" << std::endl;
-            assert(false);
-    }
+    return entry->second;
 }
 
 /*
  * The (possible) callback point when conweave dequeues packets from buffer
  */
 void SwitchNode::DoSwitchSend(Ptr<Packet> p, CustomHeader &ch, uint32_t outDev, uint32_t qIndex) {
+    AllocStats::Scope allocScope(AllocStats::SWITCH);
+    if (!m_devices[outDev]->IsLinkUp()) {
+        /** DROP: routing tables only hold links that are up, but the path LBs (Conga, Letflow,
+         * ConWeave) forward by the pathId of the packet, which may cross a failed link */
+        Settings::dropped_pkt_sw_linkdown++;
+        return;
+    }
+
     // admission control
     FlowIdTag t;
     p->PeekPacketTag(t);
@@ -327,10 +223,12 @@ void SwitchNode::DoSwitchSend(Ptr<Packet> p, CustomHeader &ch, uint32_t outDev,
         CheckAndSendPfc(inDev, qIndex);
     }
 
+    Settings::fwd_pkt_sw++;
     m_devices[outDev]->SwitchSend(qIndex, p, ch);
 }
 
 void SwitchNode::SwitchNotifyDequeue(uint32_t ifIndex, uint32_t qIndex, Ptr<Packet> p) {
+    AllocStats::Scope allocScope(AllocStats::SWITCH);
     FlowIdTag t;
     p->PeekPacketTag(t);
     if (qIndex != 0) {
@@ -359,6 +257,8 @@ void SwitchNode::SwitchNotifyDequeue(uint32_t ifIndex, uint32_t qIndex, Ptr<Pack
         }
     }
 
+    if (ifIndex >= m_txBytes.size()) m_txBytes.resize(m_devices.size(), 0);  // after setup
+
     // HPCC's INT
     if (1) {
         uint8_t *buf = p->GetBuffer();
@@ -420,11 +320,24 @@ void SwitchNode::AddTableEntry(Ipv4Address &dstAddr, uint32_t intf_idx) {
     m_rtTable[dip].push_back(intf_idx);
 }
 
+void SwitchNode::RemoveTableEntries(Ipv4Address &dstAddr) { m_rtTable.erase(dstAddr.Get()); }
+
 void SwitchNode::ClearTable() { m_rtTable.clear(); }
 
 uint64_t SwitchNode::GetTxBytesOutDev(uint32_t outdev) {
-    assert(outdev < pCnt);
-    return m_txBytes[outdev];
+    return outdev < m_txBytes.size() ? m_txBytes[outdev] : 0;
+}
+
+void SwitchNode::AddTxBytesOutDev(uint32_t outdev, uint64_t bytes) {
+    if (outdev < m_txBytes.size()) m_txBytes[outdev] += bytes;
+}
+
+void SwitchNode::ReportMemory(MemStats &stats) const {
+    stats.Add(MemStats::SWITCH_MMU, m_mmu->GetPortSlotCnt(), m_mmu->GetMemoryUsage());
+    uint64_t rtBytes = MemStats::HashBytes(m_rtTable);
+    for (const auto &dst : m_rtTable) rtBytes += MemStats::VectorBytes(dst.second);
+    stats.Add(MemStats::ROUTES, m_rtTable.size(), rtBytes);
+    if (m_lb != NULL) m_lb->ReportMemory(stats);
 }
 
 } /* namespace ns3 */
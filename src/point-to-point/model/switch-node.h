@@ -6,6 +6,7 @@
 #include <unordered_map>
 #include <unordered_set>
 
+#include "ns3/load-balancer.h"
 #include "qbb-net-device.h"
 #include "switch-mmu.h"
 
@@ -15,13 +16,12 @@ class Packet;
 
 class SwitchNode : public Node {
     static const unsigned qCnt = 8;    // Number of queues/priorities used
-    static const unsigned pCnt = 128;  // port 0 is not used so + 1	// Number of ports used
     uint32_t m_ecmpSeed;
     std::unordered_map<uint32_t, std::vector<int> >
         m_rtTable;  // map from ip address (u32) to possible ECMP port (index of dev)
 
     // monitor uplinks
-    uint64_t m_txBytes[pCnt];  // counter of tx bytes, for HPCC
+    std::vector<uint64_t> m_txBytes;  // counter of tx bytes per device, for HPCC
 
    protected:
     bool m_ecnEnabled;
@@ -29,33 +29,43 @@ class SwitchNode : public Node {
     uint32_t m_ackHighPrio;  // set high priority for ACK/NACK
 
    private:
-    int GetOutDev(Ptr<Packet>, CustomHeader &ch);
-    void SendToDev(Ptr<Packet> p, CustomHeader &ch);
-    void SendToDevContinue(Ptr<Packet> p, CustomHeader &ch);
+    const std::vector<int> &GetNexthops(const CustomHeader &ch);
+    void SendToDev(Ptr<Packet> p, CustomHeader &ch) { (this->*m_sendToDev)(p, ch); }
+    void SendToOutDev(Ptr<Packet> p, CustomHeader &ch, uint32_t outDev);
     static uint32_t EcmpHash(const uint8_t *key, size_t len, uint32_t seed);
     void CheckAndSendPfc(uint32_t inDev, uint32_t qIndex);
     void CheckAndSendResume(uint32_t inDev, uint32_t qIndex);
+    static bool IsControlPacket(const CustomHeader &ch) {  // ACK, NACK, PFC, QCN
+        return ch.l3Prot == 0xFF || ch.l3Prot == 0xFE || ch.l3Prot == 0xFD || ch.l3Prot == 0xFC;
+    }
+
+    /*----- Load balancer -----*/
+    typedef void (SwitchNode::*SendToDevFunction)(Ptr<Packet> p, CustomHeader &ch);
+    Ptr<LoadBalancer> m_lb;          // installed once at setup, see LoadBalancer::InstallTo
+    SendToDevFunction m_sendToDev;  // SendToDevSelect<LB> or SendToDevHijack<LB>
 
+   protected:
+    virtual void DoDispose(void);
+
+   public:
     /* Sending packet to Egress port */
     void DoSwitchSend(Ptr<Packet> p, CustomHeader &ch, uint32_t outDev, uint32_t qIndex);
-
-    /*----- Load balancer -----*/
-    // Flow ECMP (lb_mode = 0)
+    // Flow ECMP, also used for control packets (ACK, NACK, PFC, QCN) under any LB
     uint32_t DoLbFlowECMP(Ptr<const Packet> p, const CustomHeader &ch,
                           const std::vector<int> &nexthops);
-    // DRILL (lb_mode = 2)
-    uint32_t DoLbDrill(Ptr<const Packet> p, const CustomHeader &ch,
-                       const std::vector<int> &nexthops);     // choose egress port
-    uint32_t m_drill_candidate;                               // always 2 (power of two)
-    std::map<uint32_t, uint32_t> m_previousBestInterfaceMap;  // <dip, previousBestInterface>
-    uint32_t CalculateInterfaceLoad(uint32_t interface);      // Get the load of a interface
-    // Conga (lb_mode = 3)
-    uint32_t DoLbConga(Ptr<Packet> p, CustomHeader &ch, const std::vector<int> &nexthops);
-    // Conga (lb_mode = 6)
-    uint32_t DoLbLetflow(Ptr<Packet> p, CustomHeader &ch, const std::vector<int> &nexthops);
-    // ConWeave (lb_mode = 9)
-    uint32_t DoLbConWeave(Ptr<const Packet> p, const CustomHeader &ch,
-                           const std::vector<int> &nexthops);  // dummy
+    // forward with flow ECMP (callback target of Conga/ConWeave for control, intra-ToR traffic)
+    void SendToDevContinue(Ptr<Packet> p, CustomHeader &ch);
+
+    /**
+     * Per-LB forwarding paths, instantiated in each LB's .cc so that the LB's
+     * (non-virtual) SelectOutPort/RouteInput is inlined into the forward path.
+     */
+    template <class LB>
+    void SendToDevSelect(Ptr<Packet> p, CustomHeader &ch);
+    template <class LB>
+    void SendToDevHijack(Ptr<Packet> p, CustomHeader &ch);
+    void SetLoadBalancer(Ptr<LoadBalancer> lb, SendToDevFunction sendToDev);
+    Ptr<LoadBalancer> GetLoadBalancer() const { return m_lb; }
 
    public:
     // Ptr<BroadcomNode> m_broadcom;
@@ -65,14 +75,34 @@ class SwitchNode : public Node {
 
     static TypeId GetTypeId(void);
     SwitchNode();
+    /** @brief systemId: MPI rank that owns the switch in a distributed simulation */
+    explicit SwitchNode(uint32_t systemId);
     void SetEcmpSeed(uint32_t seed);
     void AddTableEntry(Ipv4Address &dstAddr, uint32_t intf_idx);
+    void RemoveTableEntries(Ipv4Address &dstAddr);
     void ClearTable();
     bool SwitchReceiveFromDevice(Ptr<NetDevice> device, Ptr<Packet> packet, CustomHeader &ch);
     void SwitchNotifyDequeue(uint32_t ifIndex, uint32_t qIndex, Ptr<Packet> p);
     uint64_t GetTxBytesOutDev(uint32_t outdev);
+    void AddTxBytesOutDev(uint32_t outdev, uint64_t bytes);  // sent without packets
+    void ReportMemory(MemStats &stats) const;  // MMU, routing table and LB (not the devices)
 };
 
+template <class LB>
+void SwitchNode::SendToDevSelect(Ptr<Packet> p, CustomHeader &ch) {
+    LB *lb = static_cast<LB *>(PeekPointer(m_lb));
+    const std::vector<int> &nexthops = GetNexthops(ch);
+    uint32_t outDev = IsControlPacket(ch) ? DoLbFlowECMP(p, ch, nexthops)
+                                          : lb->LB::SelectOutPort(p, ch, nexthops);
+    SendToOutDev(p, ch, outDev);
+}
+
+/** HIJACK: the LB runs DoSwitchSend (or SendToDevContinue) internally, e.g., Conga, ConWeave */
+template <class LB>
+void SwitchNode::SendToDevHijack(Ptr<Packet> p, CustomHeader &ch) {
+    static_cast<LB *>(PeekPointer(m_lb))->LB::RouteInput(p, ch);
+}
+
 } /* namespace ns3 */
 
 #endif /* SWITCH_NODE_H */
@@ -3,6 +3,17 @@
 #include "ns3/simulator.h"
 #include "ns3/point-to-point-net-device.h"
 #include "ns3/point-to-point-channel.h"
+#include "ns3/hdr-histogram.h"
+#include "ns3/path-id.h"
+#include "ns3/quantile-sketch.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
 
 namespace ns3 {
 
@@ -56,6 +67,247 @@ PointToPointTest::DoRun (void)
   Simulator::Destroy ();
 }
 //-----------------------------------------------------------------------------
+// bucket of a single value, from the last "<index>:<count>" of the text form
+static int64_t
+HdrBucket (int64_t value)
+{
+  HdrHistogram h (7, 32);
+  h.Record (value);
+  std::string s = h.Serialize ();
+  return std::atoll (s.c_str () + s.rfind (' ') + 1);
+}
+
+// middle of the bucket of a value: the median of {0, value, 2^40}
+static int64_t
+HdrMiddle (int64_t value)
+{
+  HdrHistogram h (7, 32);
+  h.Record (0);
+  h.Record (value);
+  h.Record (1ll << 40);
+  return h.GetQuantile (0.5);
+}
+
+class HdrHistogramTestCase : public TestCase
+{
+public:
+  HdrHistogramTestCase ();
+
+  virtual void DoRun (void);
+};
+
+HdrHistogramTestCase::HdrHistogramTestCase ()
+  : TestCase ("HdrHistogram buckets, quantiles, merge and serialization")
+{
+}
+
+void
+HdrHistogramTestCase::DoRun (void)
+{
+  // 7 sub-bucket bits: exact under 128, then 64 buckets per power of two
+  NS_TEST_ASSERT_MSG_EQ (HdrBucket (127), 127, "values under 2^7 are exact");
+  NS_TEST_ASSERT_MSG_EQ (HdrMiddle (127), 127, "values under 2^7 are exact");
+  NS_TEST_ASSERT_MSG_EQ (HdrBucket (128), 128, "first bucket of width 2");
+  NS_TEST_ASSERT_MSG_EQ (HdrBucket (129), 128, "first bucket of width 2");
+  NS_TEST_ASSERT_MSG_EQ (HdrBucket (130), 129, "second bucket of width 2");
+  NS_TEST_ASSERT_MSG_EQ (HdrMiddle (128), 129, "middle of [128, 130)");
+  NS_TEST_ASSERT_MSG_EQ (HdrMiddle (130), 131, "middle of [130, 132)");
+  NS_TEST_ASSERT_MSG_EQ (HdrBucket (255), 191, "last bucket of width 2");
+  NS_TEST_ASSERT_MSG_EQ (HdrBucket (256), 192, "first bucket of width 4");
+  NS_TEST_ASSERT_MSG_EQ (HdrBucket (259), 192, "first bucket of width 4");
+  NS_TEST_ASSERT_MSG_EQ (HdrMiddle (256), 258, "middle of [256, 260)");
+  NS_TEST_ASSERT_MSG_EQ (HdrBucket (-256), -192, "negative values have buckets of their own");
+  NS_TEST_ASSERT_MSG_EQ (HdrBucket ((1ll << 32) - 1), (32 - 7 + 2) * 64 - 1,
+                         "2^32 - 1 is in the last bucket");
+  NS_TEST_ASSERT_MSG_EQ (HdrBucket (1ll << 40), (32 - 7 + 2) * 64 - 1,
+                         "magnitudes of 2^maxBits or more share the last bucket");
+  for (int64_t v = 1; v < (1ll << 32); v = v * 3 + 1)
+    {
+      NS_TEST_ASSERT_MSG_EQ (HdrBucket (HdrMiddle (v)), HdrBucket (v), "the middle of a bucket is in it");
+      NS_TEST_ASSERT_MSG_EQ_TOL ((double) HdrMiddle (v), (double) v, v / 128.0,
+                                 "a bucket's middle is within 2^-7 of its values");
+    }
+
+  // a single value: min, max and all the quantiles are exact
+  HdrHistogram one;
+  one.Record (1000003);
+  NS_TEST_ASSERT_MSG_EQ (one.GetMin (), 1000003, "min of a single value");
+  NS_TEST_ASSERT_MSG_EQ (one.GetMax (), 1000003, "max of a single value");
+  NS_TEST_ASSERT_MSG_EQ (one.GetQuantile (0.5), 1000003, "median of a single value");
+
+  // quantiles of values spread over 9 orders of magnitude, against the exact ones
+  std::mt19937_64 rng (1);
+  std::lognormal_distribution<double> dist (10, 3);
+  std::vector<int64_t> values;
+  HdrHistogram a, b;
+  for (uint32_t n = 0; n < 20000; n++)
+    {
+      int64_t v = (int64_t) std::min (dist (rng), 4e9);
+      if (n % 5 == 0)
+        {
+          v = -v;  // negative values have buckets of their own
+        }
+      values.push_back (v);
+      (n % 2 ? a : b).Record (v);
+    }
+  std::sort (values.begin (), values.end ());
+
+  HdrHistogram all;
+  NS_TEST_ASSERT_MSG_EQ (all.Merge (a), true, "merge into an empty histogram");
+  NS_TEST_ASSERT_MSG_EQ (all.Merge (b), true, "merge of the same layout");
+  NS_TEST_ASSERT_MSG_EQ (all.Merge (HdrHistogram (8, 32)), false, "merge of another layout");
+  NS_TEST_ASSERT_MSG_EQ (all.GetCount (), values.size (), "merged count");
+  NS_TEST_ASSERT_MSG_EQ (all.GetMin (), values.front (), "merged min");
+  NS_TEST_ASSERT_MSG_EQ (all.GetMax (), values.back (), "merged max");
+  for (double q = 0; q <= 1; q += 0.01)
+    {
+      int64_t exact = values[(size_t)(q * (values.size () - 1))];
+      NS_TEST_ASSERT_MSG_EQ_TOL ((double) all.GetQuantile (q), (double) exact,
+                                 std::fabs ((double) exact) / 128.0, "quantile " << q << " within 0.8%");
+    }
+
+  HdrHistogram copy;
+  NS_TEST_ASSERT_MSG_EQ (copy.Deserialize (all.Serialize ()), true, "deserialize");
+  NS_TEST_ASSERT_MSG_EQ (copy.Serialize (), all.Serialize (), "serialization round trip");
+  NS_TEST_ASSERT_MSG_EQ (copy.GetQuantile (0.1), all.GetQuantile (0.1), "round trip quantile");
+  NS_TEST_ASSERT_MSG_EQ (copy.Deserialize ("7 32 2 0 1 1 1:1"), false,
+                         "counts that do not add up are rejected");
+}
+//-----------------------------------------------------------------------------
+class QuantileSketchTestCase : public TestCase
+{
+public:
+  QuantileSketchTestCase ();
+
+  virtual void DoRun (void);
+};
+
+QuantileSketchTestCase::QuantileSketchTestCase ()
+  : TestCase ("QuantileSketch merge and serialization")
+{
+}
+
+void
+QuantileSketchTestCase::DoRun (void)
+{
+  // two runs of slowdowns with different spreads, merged as the ensemble does
+  std::mt19937_64 rng (1);
+  std::lognormal_distribution<double> narrow (0.5, 0.5), wide (1, 2);
+  std::vector<double> values;
+  QuantileSketch a (0.01), b (0.01);
+  for (uint32_t n = 0; n < 10000; n++)
+    {
+      double va = 1 + narrow (rng), vb = 1 + wide (rng);
+      a.Add (va);
+      b.Add (vb);
+      values.push_back (va);
+      values.push_back (vb);
+    }
+  a.Add (0);  // in the zero bin
+  values.push_back (0);
+  std::sort (values.begin (), values.end ());
+
+  NS_TEST_ASSERT_MSG_EQ (a.Merge (QuantileSketch (0.02)), false, "merge of another accuracy");
+  NS_TEST_ASSERT_MSG_EQ (a.Merge (b), true, "merge of the same accuracy");
+  NS_TEST_ASSERT_MSG_EQ (a.GetCount (), values.size (), "merged count");
+  NS_TEST_ASSERT_MSG_EQ (a.GetMin (), values.front (), "merged min");
+  NS_TEST_ASSERT_MSG_EQ (a.GetMax (), values.back (), "merged max");
+  for (double q = 0; q <= 1; q += 0.01)
+    {
+      double exact = values[(size_t)(q * (values.size () - 1))];
+      NS_TEST_ASSERT_MSG_EQ_TOL (a.GetQuantile (q), exact, exact * 0.01 * (1 + 1e-9),
+                                 "quantile " << q << " within 1%");
+    }
+
+  QuantileSketch copy;
+  NS_TEST_ASSERT_MSG_EQ (copy.Deserialize (a.Serialize ()), true, "deserialize");
+  NS_TEST_ASSERT_MSG_EQ (copy.Serialize (), a.Serialize (), "serialization round trip");
+  NS_TEST_ASSERT_MSG_EQ (copy.GetRelativeAccuracy (), 0.01, "round trip accuracy");
+  NS_TEST_ASSERT_MSG_EQ (copy.GetQuantile (0.99), a.GetQuantile (0.99), "round trip quantile");
+  NS_TEST_ASSERT_MSG_EQ (copy.Deserialize ("0.01 1 2 2 2 0 5:1 4:1"), false,
+                         "unsorted bins are rejected");
+}
+//-----------------------------------------------------------------------------
+class PathCodecTestCase : public TestCase
+{
+public:
+  PathCodecTestCase ();
+
+  virtual void DoRun (void);
+
+private:
+  /* the path read back from a tag buffer, checking that it took GetSerializedSize() bytes */
+  PathId RoundTrip (PathId path);
+};
+
+PathCodecTestCase::PathCodecTestCase ()
+  : TestCase ("PathCodec port bits, word size and serialization")
+{
+}
+
+PathId
+PathCodecTestCase::RoundTrip (PathId path)
+{
+  uint8_t buf[16];
+  TagBuffer w (buf, buf + sizeof (buf));
+  PathCodec::Serialize (w, path);
+  w.WriteU8 (0xab);
+  TagBuffer r (buf, buf + sizeof (buf));
+  PathId read = PathCodec::Deserialize (r);
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t) r.ReadU8 (), 0xab,
+                         "a path takes " << PathCodec::GetSerializedSize () << " bytes");
+  return read;
+}
+
+void
+PathCodecTestCase::DoRun (void)
+{
+  // radix <= 256 and 4 hops: the former encoding, one byte per hop in 32 bits
+  PathCodec::Configure (255, 4);
+  NS_TEST_ASSERT_MSG_EQ (PathCodec::GetPortBits (), 8, "8-bit ports");
+  NS_TEST_ASSERT_MSG_EQ (PathCodec::GetSerializedSize (), 4, "32-bit words");
+  NS_TEST_ASSERT_MSG_EQ (PathCodec::GetMaxHops (), 4, "4 hops in a word");
+  PathId path = 0;
+  for (uint32_t hop = 0; hop < 4; hop++)
+    {
+      PathCodec::SetOutPort (path, hop, hop + 1);
+    }
+  NS_TEST_ASSERT_MSG_EQ (path, 0x04030201, "one byte per hop, hop 0 in the lowest bits");
+  PathCodec::SetOutPort (path, 3, 255);
+  NS_TEST_ASSERT_MSG_EQ (PathCodec::GetOutPort (path, 3), 255, "last hop of the word");
+  NS_TEST_ASSERT_MSG_EQ (PathCodec::GetOutPort (path, 2), 3, "the other hops are kept");
+  NS_TEST_ASSERT_MSG_EQ ((path >> 32), 0, "the path fits in 32 bits");
+  NS_TEST_ASSERT_MSG_EQ (RoundTrip (path), path, "32-bit round trip");
+  NS_TEST_ASSERT_MSG_EQ (RoundTrip (PATH_ID_NULL), PATH_ID_NULL, "PATH_ID_NULL in 32 bits");
+
+  // radix > 256: 9-bit ports, still in 32 bits for 3 hops
+  PathCodec::Configure (256, 3);
+  NS_TEST_ASSERT_MSG_EQ (PathCodec::GetPortBits (), 9, "9-bit ports");
+  NS_TEST_ASSERT_MSG_EQ (PathCodec::GetSerializedSize (), 4, "27 bits in a 32-bit word");
+  NS_TEST_ASSERT_MSG_EQ (PathCodec::GetMaxPort (), 511, "9-bit port mask");
+
+  // 8-bit ports but 5 hops, then 10-bit ports: 64-bit words
+  PathCodec::Configure (255, 5);
+  NS_TEST_ASSERT_MSG_EQ (PathCodec::GetPortBits (), 8, "8-bit ports");
+  NS_TEST_ASSERT_MSG_EQ (PathCodec::GetSerializedSize (), 8, "40 bits in a 64-bit word");
+  PathCodec::Configure (1000, 4);
+  NS_TEST_ASSERT_MSG_EQ (PathCodec::GetPortBits (), 10, "10-bit ports");
+  NS_TEST_ASSERT_MSG_EQ (PathCodec::GetSerializedSize (), 8, "40 bits in a 64-bit word");
+  uint32_t last = PathCodec::GetMaxHops () - 1;
+  NS_TEST_ASSERT_MSG_EQ (last, 5, "6 hops of 10 bits in a 64-bit word");
+  path = 0;
+  PathCodec::SetOutPort (path, 0, 1000);
+  PathCodec::SetOutPort (path, last, 1023);
+  PathCodec::SetOutPort (path, last, 999);
+  NS_TEST_ASSERT_MSG_EQ (PathCodec::GetOutPort (path, last), 999, "last hop overwritten");
+  NS_TEST_ASSERT_MSG_EQ (PathCodec::GetOutPort (path, 0), 1000, "first hop kept");
+  NS_TEST_ASSERT_MSG_EQ (PathCodec::GetOutPort (path, 1), 0, "empty hop");
+  NS_TEST_ASSERT_MSG_EQ (RoundTrip (path), path, "64-bit round trip");
+  NS_TEST_ASSERT_MSG_EQ (RoundTrip (PATH_ID_NULL), PATH_ID_NULL, "PATH_ID_NULL in 64 bits");
+
+  PathCodec::Configure (255, 4);  // back to the default encoding
+}
+//-----------------------------------------------------------------------------
 class PointToPointTestSuite : public TestSuite
 {
 public:
@@ -66,6 +318,9 @@ PointToPointTestSuite::PointToPointTestSuite ()
   : TestSuite ("devices-point-to-point", UNIT)
 {
   AddTestCase (new PointToPointTest);
+  AddTestCase (new HdrHistogramTestCase);
+  AddTestCase (new QuantileSketchTestCase);
+  AddTestCase (new PathCodecTestCase);
 }
 
 static PointToPointTestSuite g_pointToPointTestSuite;
@@ -0,0 +1,192 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2023 NUS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Chahwan Song <songch@comp.nus.edu.sg>
+ */
+
+/*
+ * Compares the flowlet table used by Conga/Letflow (ns3::FlowletTable) against
+ * the former std::map<uint64_t, Flowlet*> with a periodic full-table aging scan.
+ *
+ * Each packet belongs to one of --flows concurrently active flows; every
+ * --churn packets the set of active flows is replaced, so stale entries pile up
+ * as in a long simulation.
+ */
+
+#include "ns3/command-line.h"
+#include "ns3/flowlet-table.h"
+#include "ns3/simulator.h"
+#include "ns3/system-wall-clock-ms.h"
+
+#include <stdlib.h>
+#include <iostream>
+#include <map>
+
+using namespace ns3;
+
+static uint32_t g_flows = 1000;
+static uint32_t g_churn = 100000;
+static uint64_t g_pktGapNs = 10;
+static Time g_flowletTimeout = MicroSeconds (100);
+static Time g_agingTime = MilliSeconds (2);
+
+static inline uint64_t
+PacketKey (uint32_t i)
+{
+  uint64_t epoch = i / g_churn;
+  return epoch * g_flows + (rand () % g_flows);
+}
+
+static uint64_t
+BenchMap (uint32_t n)
+{
+  std::map<uint64_t, Flowlet *> table;
+  Time nextAging = g_agingTime;
+  uint64_t nNewFlowlet = 0;
+  srand (1);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Time now = NanoSeconds (g_pktGapNs * i);
+      if (now >= nextAging)
+        {
+          std::map<uint64_t, Flowlet *>::iterator itr = table.begin ();
+          while (itr != table.end ())
+            {
+              if (now - itr->second->_activeTime > g_agingTime)
+                {
+                  delete itr->second;
+                  table.erase (itr++);
+                }
+              else
+                {
+                  ++itr;
+                }
+            }
+          nextAging += g_agingTime;
+        }
+      uint64_t key = PacketKey (i);
+      std::map<uint64_t, Flowlet *>::iterator itr = table.find (key);
+      if (itr != table.end ())
+        {
+          Flowlet *flowlet = itr->second;
+          if (now - flowlet->_activeTime > g_flowletTimeout)
+            {
+              flowlet->_activatedTime = now;
+              flowlet->_PathId = i;
+              nNewFlowlet++;
+            }
+          flowlet->_activeTime = now;
+          flowlet->_nPackets++;
+          continue;
+        }
+      Flowlet *flowlet = new Flowlet;
+      flowlet->_activeTime = now;
+      flowlet->_activatedTime = now;
+      flowlet->_nPackets = 1;
+      flowlet->_PathId = i;
+      table[key] = flowlet;
+      nNewFlowlet++;
+    }
+  for (std::map<uint64_t, Flowlet *>::iterator itr = table.begin (); itr != table.end (); ++itr)
+    {
+      delete itr->second;
+    }
+  return nNewFlowlet;
+}
+
+static uint64_t
+BenchTable (uint32_t n, FlowletTable &table)
+{
+  uint64_t nNewFlowlet = 0;
+  srand (1);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Time now = NanoSeconds (g_pktGapNs * i);
+      uint64_t key = PacketKey (i);
+      Flowlet *flowlet = table.Find (key, now);
+      if (flowlet != NULL)
+        {
+          if (now - flowlet->_activeTime > g_flowletTimeout)
+            {
+              flowlet->_activatedTime = now;
+              flowlet->_PathId = i;
+              nNewFlowlet++;
+            }
+          flowlet->_activeTime = now;
+          flowlet->_nPackets++;
+          continue;
+        }
+      flowlet = table.Insert (key, now);
+      flowlet->_activeTime = now;
+      flowlet->_activatedTime = now;
+      flowlet->_nPackets = 1;
+      flowlet->_PathId = i;
+      nNewFlowlet++;
+    }
+  return nNewFlowlet;
+}
+
+static void
+Report (char const *name, uint32_t n, uint64_t deltaMs, uint64_t nNewFlowlet)
+{
+  double nsPerPkt = deltaMs * 1e6 / n;
+  std::cout << name << "\t" << nsPerPkt << " ns/pkt (" << deltaMs << " ms elapsed), "
+            << nNewFlowlet << " new flowlets" << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 10000000;
+  uint32_t hwEntries = 65536;
+
+  CommandLine cmd;
+  cmd.AddValue ("n", "Number of packets", n);
+  cmd.AddValue ("flows", "Number of concurrently active flows", g_flows);
+  cmd.AddValue ("churn", "Packets before the set of active flows is replaced", g_churn);
+  cmd.AddValue ("hwEntries", "Number of entries of the HARDWARE mode table", hwEntries);
+  cmd.Parse (argc, argv);
+
+  // Time objects are tracked until the simulator starts; stop that as a real run does
+  Simulator::Run ();
+
+  std::cout << "Running bench-flowlet-table with n=" << n << ", flows=" << g_flows
+            << ", churn=" << g_churn << std::endl;
+
+  SystemWallClockMs time;
+  time.Start ();
+  uint64_t nNew = BenchMap (n);
+  Report ("std::map + AgingEvent", n, time.End (), nNew);
+
+  FlowletTable exact;
+  exact.Configure (FlowletTable::EXACT, 1024, g_agingTime);
+  time.Start ();
+  nNew = BenchTable (n, exact);
+  Report ("FlowletTable EXACT   ", n, time.End (), nNew);
+  std::cout << "\tcapacity " << exact.GetCapacity () << ", "
+            << exact.GetMemoryUsage () << " bytes" << std::endl;
+
+  FlowletTable hardware;
+  hardware.Configure (FlowletTable::HARDWARE, hwEntries, g_agingTime);
+  time.Start ();
+  nNew = BenchTable (n, hardware);
+  Report ("FlowletTable HARDWARE", n, time.End (), nNew);
+  std::cout << "\tcapacity " << hardware.GetCapacity () << ", "
+            << hardware.GetNCollisions () << " colliding packets" << std::endl;
+
+  Simulator::Destroy ();
+  return 0;
+}
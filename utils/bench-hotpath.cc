@@ -0,0 +1,735 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2023 NUS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Chahwan Song <songch@comp.nus.edu.sg>
+ */
+
+/*
+ * Per-packet cost of the RDMA and load-balancing hot paths, in ns/op and heap
+ * allocations/op (operator new calls, counted by this program).
+ *
+ * Inputs are synthetic but shaped like a run of the simulator: --flows flows
+ * from the hosts of one ToR to --dstTors other ToRs with --paths paths each,
+ * 1000-byte packets of DCQCN (no INT) in rounds of --batch packets that are
+ * --roundGap ns apart in simulated time. Only the calls under test are timed;
+ * building packets and scheduling rounds is not.
+ *
+ *   ./waf --run "bench-hotpath"
+ *   ./waf --run "bench-hotpath --filter=ConWeave --n=200000"
+ */
+
+#include "ns3/boolean.h"
+#include "ns3/command-line.h"
+#include "ns3/conga-routing.h"
+#include "ns3/conweave-routing.h"
+#include "ns3/custom-header.h"
+#include "ns3/int-header.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/letflow-routing.h"
+#include "ns3/ppp-header.h"
+#include "ns3/qbb-net-device.h"
+#include "ns3/rdma-hw.h"
+#include "ns3/rdma-queue-pair.h"
+#include "ns3/seq-ts-header.h"
+#include "ns3/settings.h"
+#include "ns3/simulator.h"
+#include "ns3/switch-mmu.h"
+#include "ns3/udp-header.h"
+#include "ns3/uinteger.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+/* every heap allocation of the program, ns-3 libraries included */
+static uint64_t g_nAlloc = 0;
+
+void *
+operator new (size_t size)
+{
+  g_nAlloc++;
+  void *p = malloc (size ? size : 1);
+  if (p == NULL)
+    {
+      throw std::bad_alloc ();
+    }
+  return p;
+}
+
+void
+operator delete (void *p) noexcept
+{
+  free (p);
+}
+
+static uint32_t g_n = 1000000;
+static uint32_t g_batch = 1000;
+static uint32_t g_flows = 1000;
+static uint32_t g_dstTors = 16;
+static uint32_t g_paths = 8;
+static uint64_t g_roundGapNs = 1000;
+static std::string g_filter;
+
+static const uint32_t HOSTS_PER_TOR = 16;
+static const uint32_t TX_TOR = 1000;  // switch IDs, above the host IDs
+static const uint32_t RX_TOR = 1001;  // first destination ToR
+static const uint32_t PKT_PAYLOAD = 1000;
+static const uint16_t DATA_PG = 3;
+
+/**
+ * Wall-clock time and allocations of the timed sections of a benchmark.
+ */
+class BenchTimer
+{
+public:
+  BenchTimer ()
+    : m_ns (0),
+      m_allocs (0),
+      m_ops (0),
+      m_allocStart (0)
+  {}
+  void Start (void)
+  {
+    m_allocStart = g_nAlloc;
+    m_start = std::chrono::steady_clock::now ();
+  }
+  void Stop (uint64_t ops)
+  {
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now ();
+    m_ns += std::chrono::duration_cast<std::chrono::nanoseconds> (end - m_start).count ();
+    m_allocs += g_nAlloc - m_allocStart;
+    m_ops += ops;
+  }
+  void Report (const std::string &name) const
+  {
+    printf ("%-48s %10.1f %12.2f %12lu\n", name.c_str (), m_ops ? (double)m_ns / m_ops : 0.,
+            m_ops ? (double)m_allocs / m_ops : 0., m_ops);
+  }
+
+private:
+  uint64_t m_ns;
+  uint64_t m_allocs;
+  uint64_t m_ops;
+  uint64_t m_allocStart;
+  std::chrono::steady_clock::time_point m_start;
+};
+
+static bool
+Selected (const std::string &name)
+{
+  return g_filter.empty () || name.find (g_filter) != std::string::npos;
+}
+
+/*------------------------ workload ------------------------*/
+
+static uint32_t
+HostIp (uint32_t tor, uint32_t host)
+{
+  return 0x0b000001 + (((tor - TX_TOR) * HOSTS_PER_TOR + host) << 8);
+}
+
+struct BenchFlow
+{
+  uint32_t sip, dip;
+  uint16_t sport, dport;
+  uint32_t seq;
+};
+
+static std::vector<BenchFlow>
+MakeFlows (void)
+{
+  std::vector<BenchFlow> flows (g_flows);
+  for (uint32_t f = 0; f < g_flows; f++)
+    {
+      flows[f].sip = HostIp (TX_TOR, f % HOSTS_PER_TOR);
+      flows[f].dip = HostIp (RX_TOR + f % g_dstTors, (f / g_dstTors) % HOSTS_PER_TOR);
+      flows[f].sport = 10000 + f;
+      flows[f].dport = 100;
+      flows[f].seq = 0;
+    }
+  return flows;
+}
+
+/* hosts on their ToRs, as the simulator sets up Settings::hostIp2SwitchId */
+static void
+SetupHosts (void)
+{
+  Settings::hostIp2SwitchId.clear ();
+  for (uint32_t tor = TX_TOR; tor < RX_TOR + g_dstTors; tor++)
+    {
+      for (uint32_t h = 0; h < HOSTS_PER_TOR; h++)
+        {
+          Settings::hostIp2SwitchId[HostIp (tor, h)] = tor;
+        }
+    }
+}
+
+/* a data packet as RdmaHw::GetNxtPacket builds it */
+static Ptr<Packet>
+MakeDataPacket (BenchFlow &flow)
+{
+  Ptr<Packet> p = Create<Packet> (PKT_PAYLOAD);
+  SeqTsHeader seqTs;
+  seqTs.SetSeq (flow.seq);
+  seqTs.SetPG (DATA_PG);
+  p->AddHeader (seqTs);
+  UdpHeader udpHeader;
+  udpHeader.SetDestinationPort (flow.dport);
+  udpHeader.SetSourcePort (flow.sport);
+  p->AddHeader (udpHeader);
+  Ipv4Header ipHeader;
+  ipHeader.SetSource (Ipv4Address (flow.sip));
+  ipHeader.SetDestination (Ipv4Address (flow.dip));
+  ipHeader.SetProtocol (0x11);
+  ipHeader.SetPayloadSize (p->GetSize ());
+  ipHeader.SetTtl (64);
+  ipHeader.SetTos (0);
+  p->AddHeader (ipHeader);
+  PppHeader ppp;
+  ppp.SetProtocol (0x0021);
+  p->AddHeader (ppp);
+  flow.seq += PKT_PAYLOAD;
+  return p;
+}
+
+static CustomHeader
+Parse (Ptr<Packet> p)
+{
+  CustomHeader ch (CustomHeader::L2_Header | CustomHeader::L3_Header | CustomHeader::L4_Header);
+  ch.getInt = 1;
+  p->PeekHeader (ch);
+  return ch;
+}
+
+/* the next batch: packets of uniformly random flows */
+static void
+MakeBatch (std::vector<BenchFlow> &flows, std::vector<Ptr<Packet> > &pkts,
+           std::vector<CustomHeader> &chs)
+{
+  pkts.clear ();
+  chs.clear ();
+  for (uint32_t i = 0; i < g_batch; i++)
+    {
+      Ptr<Packet> p = MakeDataPacket (flows[rand () % flows.size ()]);
+      pkts.push_back (p);
+      chs.push_back (Parse (p));
+    }
+}
+
+/* the path to every destination ToR: uplink i at hop 0, then the ToR's downlink */
+static void
+AddPaths (Ptr<LoadBalancer> lb)
+{
+  for (uint32_t t = 0; t < g_dstTors; t++)
+    {
+      for (uint32_t i = 0; i < g_paths; i++)
+        {
+          PathId path = 0;
+          PathCodec::SetOutPort (path, 0, HOSTS_PER_TOR + 1 + i);
+          PathCodec::SetOutPort (path, 1, 1 + t % 8);
+          lb->AddPath (RX_TOR + t, path, NanoSeconds (8000));
+        }
+    }
+}
+
+/*------------------------ load balancers ------------------------*/
+
+/* what the switch would send: kept when captured, e.g., ConWeave's TxToR -> RxToR */
+struct SentPacket
+{
+  Ptr<Packet> p;
+  CustomHeader ch;
+};
+static std::vector<SentPacket> *g_sendCapture = NULL;
+static std::vector<SentPacket> *g_sendToDevCapture = NULL;
+
+static void
+SinkSend (Ptr<Packet> p, CustomHeader &ch, uint32_t outDev, uint32_t qIndex)
+{
+  if (g_sendCapture != NULL)
+    {
+      SentPacket s = {p, ch};
+      g_sendCapture->push_back (s);
+    }
+}
+
+static void
+SinkSendToDev (Ptr<Packet> p, CustomHeader &ch)
+{
+  if (g_sendToDevCapture != NULL && ch.l3Prot == 0xFD)  // ConWeave's replies
+    {
+      SentPacket s = {p, ch};
+      g_sendToDevCapture->push_back (s);
+    }
+}
+
+template <class LB>
+static void
+SetupLb (Ptr<LB> lb, uint32_t switchId)
+{
+  lb->SetSwitchInfo (true, switchId);
+  lb->SetSwitchSendCallback (MakeCallback (&SinkSend));
+  lb->SetSwitchSendToDevCallback (MakeCallback (&SinkSendToDev));
+}
+
+template <class LB>
+static void
+RouteRound (Ptr<LB> lb, BenchTimer *timer, std::vector<BenchFlow> *flows)
+{
+  std::vector<Ptr<Packet> > pkts;
+  std::vector<CustomHeader> chs;
+  MakeBatch (*flows, pkts, chs);
+  timer->Start ();
+  for (uint32_t i = 0; i < pkts.size (); i++)
+    {
+      lb->RouteInput (pkts[i], chs[i]);
+    }
+  timer->Stop (pkts.size ());
+}
+
+/* runs the rounds in simulated time from 2s, as flows start in the simulator, so that
+ * flowlets and timers expire */
+template <class LB>
+static void
+RunRounds (Ptr<LB> lb, void (*round) (Ptr<LB>, BenchTimer *, std::vector<BenchFlow> *),
+           BenchTimer *timer)
+{
+  std::vector<BenchFlow> flows = MakeFlows ();
+  uint32_t nRound = (g_n + g_batch - 1) / g_batch;
+  srand (1);
+  for (uint32_t r = 0; r < nRound; r++)
+    {
+      Simulator::Schedule (Seconds (2) + NanoSeconds (g_roundGapNs * r), round, lb, timer, &flows);
+    }
+  Simulator::Stop (Seconds (2) + NanoSeconds (g_roundGapNs * nRound));
+  Simulator::Run ();
+  lb->Dispose ();
+  Simulator::Destroy ();
+}
+
+static void
+BenchConga (void)
+{
+  std::string name = "CongaRouting::RouteInput TxToR";
+  if (!Selected (name))
+    {
+      return;
+    }
+  Ptr<CongaRouting> conga = CreateObject<CongaRouting> ();
+  SetupLb (conga, TX_TOR);
+  conga->SetConstants (MicroSeconds (50), MicroSeconds (500), MicroSeconds (100), 3, 0.2);
+  for (uint32_t port = 1; port <= HOSTS_PER_TOR + g_paths; port++)
+    {
+      conga->SetLinkCapacity (port, 100000000000lu);
+    }
+  AddPaths (conga);
+  BenchTimer timer;
+  RunRounds<CongaRouting> (conga, &RouteRound<CongaRouting>, &timer);
+  timer.Report (name);
+}
+
+static void
+BenchLetflow (void)
+{
+  std::string name = "LetflowRouting::RouteInput TxToR";
+  if (!Selected (name))
+    {
+      return;
+    }
+  Ptr<LetflowRouting> letflow = CreateObject<LetflowRouting> ();
+  letflow->SetSwitchInfo (true, TX_TOR);
+  letflow->SetConstants (MilliSeconds (2), MicroSeconds (100));
+  AddPaths (letflow);
+  BenchTimer timer;
+  RunRounds<LetflowRouting> (letflow, &RouteRound<LetflowRouting>, &timer);
+  timer.Report (name);
+}
+
+/* ConWeave's TxToR and RxToR exchange DATA and REPLY packets, as over a fabric without delay */
+static Ptr<ConWeaveRouting> g_conweaveRx;
+static BenchTimer g_conweaveRxTimer;
+
+static void
+ConWeaveRound (Ptr<ConWeaveRouting> tx, BenchTimer *timer, std::vector<BenchFlow> *flows)
+{
+  static std::vector<SentPacket> data, replies;
+  std::vector<Ptr<Packet> > pkts;
+  std::vector<CustomHeader> chs;
+  MakeBatch (*flows, pkts, chs);
+  for (uint32_t i = 0; i < replies.size (); i++)  // replies of the previous round
+    {
+      pkts.push_back (replies[i].p);
+      chs.push_back (replies[i].ch);
+    }
+  replies.clear ();
+  data.clear ();
+  data.reserve (pkts.size ());
+  g_sendCapture = &data;
+  timer->Start ();
+  for (uint32_t i = 0; i < pkts.size (); i++)
+    {
+      tx->RouteInput (pkts[i], chs[i]);
+    }
+  timer->Stop (pkts.size ());
+  g_sendCapture = NULL;
+
+  replies.reserve (data.size ());
+  g_sendToDevCapture = &replies;
+  g_conweaveRxTimer.Start ();
+  for (uint32_t i = 0; i < data.size (); i++)
+    {
+      g_conweaveRx->RouteInput (data[i].p, data[i].ch);
+    }
+  g_conweaveRxTimer.Stop (data.size ());
+  g_sendToDevCapture = NULL;
+}
+
+static void
+BenchConWeave (void)
+{
+  std::string txName = "ConWeaveRouting::RouteInput TxToR";
+  std::string rxName = "ConWeaveRouting::RouteInput RxToR";
+  if (!Selected (txName) && !Selected (rxName))
+    {
+      return;
+    }
+  Ptr<ConWeaveRouting> tx = CreateObject<ConWeaveRouting> ();
+  uint32_t nRx = g_dstTors;
+  g_dstTors = 1;  // a single RxToR, which then sees every flow
+  SetupLb (tx, TX_TOR);
+  g_conweaveRx = CreateObject<ConWeaveRouting> ();
+  SetupLb (g_conweaveRx, RX_TOR);
+  Ptr<ConWeaveRouting> lbs[2] = {tx, g_conweaveRx};
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      lbs[i]->SetConstants (MicroSeconds (4), MicroSeconds (32), MicroSeconds (1000),
+                            MicroSeconds (500), MicroSeconds (8), true);
+    }
+  AddPaths (tx);
+  BenchTimer timer;
+  g_conweaveRxTimer = BenchTimer ();
+  RunRounds<ConWeaveRouting> (tx, &ConWeaveRound, &timer);
+  g_conweaveRx->Dispose ();
+  g_conweaveRx = 0;
+  g_dstTors = nRx;
+  timer.Report (txName + " (+replies)");
+  g_conweaveRxTimer.Report (rxName);
+}
+
+/*------------------------ switch MMU ------------------------*/
+
+/* admission of a packet at a 32-port switch, and its release 64 packets later */
+static void
+BenchSwitchMmu (void)
+{
+  std::string name = "SwitchMmu::Check{Ingress,Egress}Admission";
+  if (!Selected (name))
+    {
+      return;
+    }
+  const uint32_t nPort = 32, inFlight = 64;
+  Ptr<SwitchMmu> mmu = CreateObject<SwitchMmu> ();
+  for (uint32_t port = 1; port <= nPort; port++)
+    {
+      mmu->ConfigEcn (port, 100, 400, 0.2);
+      mmu->ConfigHdrm (port, 25000 + 2 * mmu->MTU);  // 2 * 1us * 100Gbps, as the simulator
+    }
+  mmu->ConfigNPort (nPort);
+  mmu->SetDynamicThreshold (true);
+  mmu->ConfigBufferSize (9 * 1024 * 1024);
+
+  struct Admitted
+  {
+    uint32_t in, out;
+  };
+  std::vector<Admitted> fifo (inFlight);
+  uint32_t head = 0, nDrop = 0;
+  uint32_t psize = PKT_PAYLOAD + 48;
+  std::vector<uint32_t> ports (g_batch * 2);
+  BenchTimer timer;
+  srand (1);
+  for (uint32_t done = 0; done < g_n; done += g_batch)
+    {
+      for (uint32_t i = 0; i < ports.size (); i++)
+        {
+          ports[i] = 1 + rand () % nPort;
+        }
+      timer.Start ();
+      for (uint32_t i = 0; i < g_batch; i++)
+        {
+          Admitted &slot = fifo[head];
+          if (slot.in != 0)  // dequeued
+            {
+              mmu->RemoveFromIngressAdmission (slot.in, DATA_PG, psize);
+              mmu->RemoveFromEgressAdmission (slot.out, DATA_PG, psize);
+              slot.in = 0;
+            }
+          uint32_t in = ports[2 * i], out = ports[2 * i + 1];
+          if (mmu->CheckEgressAdmission (out, DATA_PG, psize) &&
+              mmu->CheckIngressAdmission (in, DATA_PG, psize))
+            {
+              mmu->UpdateIngressAdmission (in, DATA_PG, psize);
+              mmu->UpdateEgressAdmission (out, DATA_PG, psize);
+              slot.in = in;
+              slot.out = out;
+            }
+          else
+            {
+              nDrop++;
+            }
+          head = (head + 1) % inFlight;
+        }
+      timer.Stop (g_batch);
+    }
+  timer.Report (name);
+  if (nDrop > 0)
+    {
+      std::cout << "\t" << nDrop << " packets not admitted" << std::endl;
+    }
+}
+
+/*------------------------ NIC ------------------------*/
+
+static void
+BenchCustomHeader (void)
+{
+  std::string name = "CustomHeader::Deserialize (UDP data)";
+  if (!Selected (name))
+    {
+      return;
+    }
+  std::vector<BenchFlow> flows = MakeFlows ();
+  std::vector<Ptr<Packet> > pkts;
+  std::vector<CustomHeader> chs;
+  MakeBatch (flows, pkts, chs);
+  BenchTimer timer;
+  uint64_t sum = 0;
+  for (uint32_t done = 0; done < g_n; done += g_batch)
+    {
+      timer.Start ();
+      for (uint32_t i = 0; i < pkts.size (); i++)
+        {
+          CustomHeader ch (CustomHeader::L2_Header | CustomHeader::L3_Header |
+                           CustomHeader::L4_Header);
+          ch.getInt = 1;  // as QbbNetDevice::Receive
+          pkts[i]->PeekHeader (ch);
+          sum += ch.udp.seq;
+        }
+      timer.Stop (pkts.size ());
+    }
+  timer.Report (name);
+  if (sum == 1)
+    {
+      std::cout << sum << std::endl;  // keeps the loop
+    }
+}
+
+/* round-robin over --flows / 16 QPs of a NIC, as QbbNetDevice::DequeueAndTransmit */
+static void
+BenchEgressQueue (void)
+{
+  std::string name = "RdmaEgressQueue::GetNextQindex";
+  if (!Selected (name))
+    {
+      return;
+    }
+  uint32_t nQp = std::max (g_flows / HOSTS_PER_TOR, 1u);
+  Ptr<RdmaEgressQueue> queue = CreateObject<RdmaEgressQueue> ();
+  queue->m_qpGrp = CreateObject<RdmaQueuePairGroup> ();
+  for (uint32_t i = 0; i < nQp; i++)
+    {
+      Ptr<RdmaQueuePair> qp = CreateObject<RdmaQueuePair> (DATA_PG, Ipv4Address (HostIp (TX_TOR, 0)),
+                                                           Ipv4Address (HostIp (RX_TOR, 0)),
+                                                           10000 + i, 100);
+      qp->SetSize (1ull << 40);
+      qp->irn.m_enabled = false;
+      queue->m_qpGrp->AddQp (qp);
+    }
+  bool paused[QbbNetDevice::qCnt] = {false};
+  BenchTimer timer;
+  uint64_t nIdle = 0;
+  for (uint32_t done = 0; done < g_n; done += g_batch)
+    {
+      timer.Start ();
+      for (uint32_t i = 0; i < g_batch; i++)
+        {
+          int qIndex = queue->GetNextQindex (paused);
+          if (qIndex < 0)
+            {
+              nIdle++;
+              continue;
+            }
+          queue->m_rrlast = qIndex;
+          queue->m_qpGrp->Get (qIndex)->snd_nxt += PKT_PAYLOAD;
+        }
+      timer.Stop (g_batch);
+    }
+  timer.Report (name);
+  if (nIdle > 0)
+    {
+      std::cout << "\t" << nIdle << " calls without a QP to send" << std::endl;
+    }
+}
+
+/*
+ * The receiver's sequence check of a flow that loses one packet in --lossEvery, whose
+ * retransmission arrives 32 packets later (IRN), or which go-back-N resends (GBN).
+ */
+static uint32_t g_lossEvery = 1000;
+
+static void
+BenchReceiverCheckSeq (bool irn)
+{
+  std::string name = std::string ("RdmaHw::ReceiverCheckSeq ") + (irn ? "IRN" : "GBN");
+  if (!Selected (name))
+    {
+      return;
+    }
+  const uint32_t lossDelay = 32;
+  Ptr<RdmaHw> rdmaHw = CreateObject<RdmaHw> ();
+  rdmaHw->SetAttribute ("IrnEnable", BooleanValue (irn));
+  rdmaHw->SetAttribute ("L2ChunkSize", UintegerValue (4000));
+  rdmaHw->SetAttribute ("L2AckInterval", UintegerValue (1));
+  Ptr<RdmaRxQueuePair> q = CreateObject<RdmaRxQueuePair> ();
+
+  /* arrival order of the sequence numbers */
+  std::vector<uint32_t> seqs;
+  uint32_t seq = 0;
+  while (seqs.size () < g_n)
+    {
+      uint32_t lost = seq + (g_lossEvery - 1) * PKT_PAYLOAD;
+      for (; seq < lost; seq += PKT_PAYLOAD)
+        {
+          seqs.push_back (seq);
+        }
+      for (uint32_t i = 1; i <= lossDelay; i++)
+        {
+          seqs.push_back (lost + i * PKT_PAYLOAD);
+        }
+      seqs.push_back (lost);  // retransmission
+      if (!irn)
+        {
+          for (uint32_t i = 1; i <= lossDelay; i++)  // go-back-N
+            {
+              seqs.push_back (lost + i * PKT_PAYLOAD);
+            }
+        }
+      seq = lost + (lossDelay + 1) * PKT_PAYLOAD;
+    }
+  seqs.resize (g_n);
+
+  BenchTimer timer;
+  uint32_t nNack = 0;
+  for (uint32_t done = 0; done < g_n; done += g_batch)
+    {
+      uint32_t end = std::min (done + g_batch, g_n);
+      timer.Start ();
+      for (uint32_t i = done; i < end; i++)
+        {
+          bool cnp = false;
+          nNack += rdmaHw->ReceiverCheckSeq (seqs[i], q, PKT_PAYLOAD, cnp) == 2;
+        }
+      timer.Stop (end - done);
+    }
+  timer.Report (name);
+  std::cout << "\t" << nNack << " NACKs/SACKs" << std::endl;
+}
+
+/* the SACK table of an IRN receiver with --holes lost packets per window of 64 */
+static void
+BenchIrnSack (void)
+{
+  std::string name = "IrnSackManager sack/blockExists/discardUpTo";
+  if (!Selected (name))
+    {
+      return;
+    }
+  const uint32_t window = 64, holes = 4;
+  IrnSackManager sack;
+  BenchTimer timer;
+  uint64_t ops = 0, base = 0;
+  std::vector<uint32_t> order;
+  for (uint32_t i = 0; i < window; i++)
+    {
+      if (i % (window / holes) != 0)
+        {
+          order.push_back (i);
+        }
+    }
+  while (ops < g_n)
+    {
+      timer.Start ();
+      for (uint32_t i = 0; i < order.size (); i++)
+        {
+          uint32_t seq = base + order[i] * PKT_PAYLOAD;
+          if (!sack.blockExists (seq, PKT_PAYLOAD))
+            {
+              sack.sack (seq, PKT_PAYLOAD);
+            }
+        }
+      uint32_t pseq, psize;
+      sack.peekFrontBlock (&pseq, &psize);
+      base += window * PKT_PAYLOAD;
+      sack.discardUpTo (base);  // the holes are retransmitted
+      timer.Stop (2 * order.size () + 2);
+      ops += 2 * order.size () + 2;
+    }
+  timer.Report (name);
+}
+
+int main (int argc, char *argv[])
+{
+  CommandLine cmd;
+  cmd.AddValue ("n", "Operations per benchmark", g_n);
+  cmd.AddValue ("filter", "Run the benchmarks whose name contains this", g_filter);
+  cmd.AddValue ("batch", "Packets per round (untimed setup between rounds)", g_batch);
+  cmd.AddValue ("flows", "Number of flows", g_flows);
+  cmd.AddValue ("dstTors", "Number of destination ToRs", g_dstTors);
+  cmd.AddValue ("paths", "Paths to each destination ToR", g_paths);
+  cmd.AddValue ("roundGap", "Simulated time between rounds (ns)", g_roundGapNs);
+  cmd.AddValue ("lossEvery", "Packets per lost packet in ReceiverCheckSeq", g_lossEvery);
+  cmd.Parse (argc, argv);
+  if (g_batch == 0 || g_flows == 0 || g_dstTors == 0 || g_paths == 0 || g_lossEvery < 2)
+    {
+      std::cerr << "batch, flows, dstTors and paths must be positive, lossEvery > 1"
+                << std::endl;
+      return 1;
+    }
+
+  IntHeader::mode = 5;  // DCQCN, no INT
+  Settings::packet_payload = PKT_PAYLOAD;
+  SetupHosts ();
+
+  printf ("%-48s %10s %12s %12s\n", "Benchmark", "ns/op", "allocs/op", "ops");
+  BenchConga ();
+  BenchLetflow ();
+  BenchConWeave ();
+  BenchSwitchMmu ();
+  BenchCustomHeader ();
+  BenchEgressQueue ();
+  BenchReceiverCheckSeq (false);
+  BenchReceiverCheckSeq (true);
+  BenchIrnSack ();
+  return 0;
+}
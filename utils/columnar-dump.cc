@@ -0,0 +1,74 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2023 NUS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Chahwan Song <songch@comp.nus.edu.sg>
+ */
+
+/*
+ * Prints a columnar monitoring file (MONITOR_FORMAT columnar, ns3::ColumnarReader)
+ * as the CSV text the simulator writes otherwise, or its columns and size with --info.
+ *
+ *   ./waf --run "columnar-dump --in=mix/output/1/1_out_uplink.col" > uplink.txt
+ */
+
+#include <stdio.h>
+
+#include <iostream>
+#include <string>
+
+#include "ns3/columnar-output.h"
+#include "ns3/command-line.h"
+
+using namespace ns3;
+
+int main(int argc, char* argv[]) {
+    std::string in;
+    bool info = false;
+
+    CommandLine cmd;
+    cmd.AddValue("in", "columnar file", in);
+    cmd.AddValue("info", "print the columns, #rows and #blocks only", info);
+    cmd.Parse(argc, argv);
+
+    ColumnarReader reader;
+    if (in.empty() || !reader.Open(in)) {
+        std::cerr << "usage: columnar-dump --in=<columnar file> [--info]" << std::endl;
+        return 1;
+    }
+    const std::vector<std::string>& columns = reader.GetColumns();
+
+    if (info) {
+        uint64_t nRow = 0, nBlock = 0;
+        while (reader.NextBlock()) {
+            nRow += reader.GetNRows();
+            nBlock++;
+        }
+        std::cout << "columns:";
+        for (const auto& c : columns) std::cout << " " << c;
+        std::cout << std::endl << "rows: " << nRow << ", blocks: " << nBlock << std::endl;
+        return 0;
+    }
+
+    std::vector<uint64_t> row(columns.size());
+    while (reader.Next(row.data())) {
+        for (uint32_t c = 0; c < row.size(); c++) {
+            printf(c == 0 ? "%lu" : ",%lu", row[c]);
+        }
+        putchar('\n');
+    }
+    return 0;
+}
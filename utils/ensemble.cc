@@ -0,0 +1,452 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2023 NUS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Chahwan Song <songch@comp.nus.edu.sg>
+ */
+
+/*
+ * Runs a sweep of network-load-balance runs (the cartesian product of LB, CC, load, seed
+ * and topology) in parallel, and streams a summary line per run into one results file.
+ *
+ *   ./waf --run "ensemble --spec=sweep.txt"     (from the top directory, like run.py)
+ *
+ * Sweep spec, one "KEY values..." per line ('#' for comments):
+ *   BASE_CONFIG mix/config.txt   a config of the simulator with all the other keys, e.g.,
+ *                                run.py's or bench.py's; its output files are replaced
+ *   OUTPUT_DIR mix/ensemble      runs/<run>/ (config, log and outputs) and results.tsv
+ *   LB 0 3 6 9                   LB_MODE
+ *   CC 1 3 8                     CC_MODE, with the window/INT/gain keys of bench.py's CCs
+ *   LOAD 0.25 0.4                FLOWGEN_LOAD (host load)
+ *   SEED 1 2 3                   RANDOM_SEED
+ *   TOPOLOGY leaf_spine:leaves=8,spines=8,hosts=16 config/fat_k8_100G_OS2.txt
+ *                                TOPOLOGY_GEN if it has a ':', TOPOLOGY_FILE otherwise
+ *   SET STOP_WALLCLOCK 3600      any other key, for all the runs
+ * A dimension that is not given keeps the value of the base config. ConWeave runs only with
+ * DCQCN, so the other CCs are skipped for LB 9.
+ *
+ * The runs are taken, in the order of the spec, by a pool of workers as they become idle
+ * (an atomic index, no lock), each run pinned to a CPU of the worker. There are as many
+ * workers as CPUs (--jobs) and as the available memory allows (MemAvailable over --mem_per_run,
+ * or over the largest peak RSS of the runs so far, which also holds back a run while the
+ * memory is short). A failed run is retried --retries times. Each finished run appends a line
+ * to results.tsv with a single write(), so the file is always whole lines; rerunning the same
+ * spec skips the runs already "ok" there, e.g., after an interruption (SIGINT/SIGTERM stop
+ * the running simulations, which are then not recorded).
+ */
+
+#include <fcntl.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ns3/command-line.h"
+#include "ns3/quantile-sketch.h"
+
+using namespace ns3;
+
+struct Run {
+    std::string name;
+    std::vector<std::pair<std::string, std::string> > keys;  // overrides of the base config
+    std::string lb, cc, load, seed, topology;                 // "-": the base config's
+};
+
+// output files of the simulator, put in the run's directory (always: even if not in the base)
+static const struct {
+    const char* key;
+    const char* file;
+    bool always;
+} outputs[] = {
+    {"FLOW_INPUT_FILE", "in.txt", true},
+    {"FCT_OUTPUT_FILE", "fct.txt", true},
+    {"PFC_OUTPUT_FILE", "pfc.txt", true},
+    {"CNP_OUTPUT_FILE", "cnp.txt", true},
+    {"QLEN_MON_FILE", "qlen.txt", true},
+    {"VOQ_MON_FILE", "voq.txt", true},
+    {"VOQ_MON_DETAIL_FILE", "voq_per_dst.txt", true},
+    {"UPLINK_MON_FILE", "uplink.txt", true},
+    {"CONN_MON_FILE", "conn.txt", true},
+    {"EST_ERROR_MON_FILE", "est_error.txt", true},
+    {"PERF_OUTPUT_FILE", "perf.json", true},
+    {"FCT_SKETCH_FILE", "fct_sketch.txt", true},
+    {"MEM_MON_FILE", "mem.txt", false},
+};
+
+static std::atomic<bool> g_stop(false);
+static void OnSignal(int) { g_stop = true; }
+
+static std::vector<std::pair<std::string, std::string> > CcKeys(const std::string& cc) {
+    std::map<std::string, std::string> keys = {{"HAS_WIN", "0"},   {"VAR_WIN", "0"},
+                                               {"FAST_REACT", "0"}, {"INT_MULTI", "1"},
+                                               {"EWMA_GAIN", "0.00390625"}};
+    if (cc == "3") {  // HPCC
+        keys["HAS_WIN"] = keys["VAR_WIN"] = keys["FAST_REACT"] = "1";
+        keys["INT_MULTI"] = "4";
+    } else if (cc == "8") {  // DCTCP
+        keys["HAS_WIN"] = keys["VAR_WIN"] = "1";
+        keys["EWMA_GAIN"] = "0.0625";
+    }
+    return std::vector<std::pair<std::string, std::string> >(keys.begin(), keys.end());
+}
+
+static bool ReadSpec(const std::string& file, std::map<std::string, std::vector<std::string> >& dims,
+                     std::vector<std::pair<std::string, std::string> >& sets) {
+    static const std::set<std::string> known = {"BASE_CONFIG", "OUTPUT_DIR", "LB",      "CC",
+                                                "LOAD",        "SEED",       "TOPOLOGY", "SET"};
+    std::ifstream f(file.c_str());
+    if (!f.is_open()) {
+        std::cerr << "cannot open " << file << std::endl;
+        return false;
+    }
+    std::string line;
+    while (std::getline(f, line)) {
+        std::istringstream is(line.substr(0, line.find('#')));
+        std::string key, v;
+        if (!(is >> key)) continue;
+        if (known.count(key) == 0) {
+            std::cerr << file << ": unknown key " << key << std::endl;
+            return false;
+        }
+        if (key == "SET") {
+            std::string setKey, rest;
+            std::getline(is >> setKey, rest);
+            size_t b = rest.find_first_not_of(" \t\r");
+            if (setKey.empty() || b == std::string::npos) {
+                std::cerr << file << ": SET <key> <value>" << std::endl;
+                return false;
+            }
+            size_t e = rest.find_last_not_of(" \t\r");
+            sets.push_back(std::make_pair(setKey, rest.substr(b, e + 1 - b)));
+            continue;
+        }
+        while (is >> v) dims[key].push_back(v);
+    }
+    if (dims["BASE_CONFIG"].size() != 1 || dims["OUTPUT_DIR"].size() != 1) {
+        std::cerr << file << ": needs one BASE_CONFIG and one OUTPUT_DIR" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+static std::vector<Run> MakeRuns(std::map<std::string, std::vector<std::string> >& dims,
+                                 const std::vector<std::pair<std::string, std::string> >& sets) {
+    for (const char* d : {"LB", "CC", "LOAD", "SEED", "TOPOLOGY"}) {
+        if (dims[d].empty()) dims[d].push_back("-");
+    }
+    std::vector<Run> runs;
+    const std::vector<std::string>& topos = dims["TOPOLOGY"];
+    for (uint32_t t = 0; t < topos.size(); t++) {
+        for (const std::string& lb : dims["LB"]) {
+            for (const std::string& cc : dims["CC"]) {
+                if (lb == "9" && cc != "-" && cc != "1") continue;  // ConWeave: DCQCN only
+                for (const std::string& load : dims["LOAD"]) {
+                    for (const std::string& seed : dims["SEED"]) {
+                        Run r = {"", sets, lb, cc, load, seed, topos[t]};
+                        // named by the swept dimensions, e.g., lb3-cc1-load0.3-seed1
+                        std::ostringstream name;
+                        if (lb != "-") name << "-lb" << lb;
+                        if (cc != "-") name << "-cc" << cc;
+                        if (load != "-") name << "-load" << load;
+                        if (seed != "-") name << "-seed" << seed;
+                        if (topos.size() > 1) name << "-topo" << t;
+                        r.name = name.str().empty() ? "base" : name.str().substr(1);
+                        if (lb != "-") r.keys.push_back(std::make_pair("LB_MODE", lb));
+                        if (cc != "-") {
+                            r.keys.push_back(std::make_pair("CC_MODE", cc));
+                            for (const auto& k : CcKeys(cc)) r.keys.push_back(k);
+                        }
+                        if (load != "-") r.keys.push_back(std::make_pair("FLOWGEN_LOAD", load));
+                        if (seed != "-") r.keys.push_back(std::make_pair("RANDOM_SEED", seed));
+                        if (topos[t] != "-") {
+                            bool gen = topos[t].find(':') != std::string::npos;
+                            r.keys.push_back(
+                                std::make_pair(gen ? "TOPOLOGY_GEN" : "TOPOLOGY_FILE", topos[t]));
+                        }
+                        runs.push_back(r);
+                    }
+                }
+            }
+        }
+    }
+    return runs;
+}
+
+// the base config with the run's keys (and output files) replaced
+static bool WriteConfig(const std::string& base, const Run& run, const std::string& dir) {
+    std::map<std::string, std::string> keys(run.keys.begin(), run.keys.end());
+    std::ifstream in(base.c_str());
+    if (!in.is_open()) {
+        std::cerr << "cannot open " << base << std::endl;
+        return false;
+    }
+    std::set<std::string> baseKeys, outputKeys;
+    for (const auto& o : outputs) outputKeys.insert(o.key);
+    std::ostringstream os;
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream is(line);
+        std::string key;
+        if (!(is >> key)) continue;
+        baseKeys.insert(key);
+        // a topology of the run replaces both forms of the base's
+        bool topo = (key == "TOPOLOGY_GEN" || key == "TOPOLOGY_FILE") &&
+                    (keys.count("TOPOLOGY_GEN") || keys.count("TOPOLOGY_FILE"));
+        if (keys.count(key) == 0 && outputKeys.count(key) == 0 && !topo) os << line << "\n";
+    }
+    for (const auto& o : outputs) {
+        if (o.always || baseKeys.count(o.key)) keys[o.key] = dir + "/" + o.file;
+    }
+    for (const auto& k : keys) os << k.first << " " << k.second << "\n";
+    std::ofstream out((dir + "/config.txt").c_str());
+    out << os.str();
+    return out.good();
+}
+
+// the run's exit status (-1: could not start); interrupted by g_stop if it returns -2
+static int Simulate(const std::string& sim, const std::string& dir, int cpu) {
+    std::string config = dir + "/config.txt", log = dir + "/log.txt";
+    pid_t pid = fork();
+    if (pid < 0) return -1;
+    if (pid == 0) {  // only async-signal-safe calls until exec
+        int fd = open(log.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd >= 0) {
+            dup2(fd, 1);
+            dup2(fd, 2);
+        }
+        if (cpu >= 0) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cpu, &set);
+            sched_setaffinity(0, sizeof(set), &set);
+        }
+        execl(sim.c_str(), sim.c_str(), config.c_str(), (char*)NULL);
+        _exit(127);
+    }
+    int status;
+    bool killed = false;
+    while (waitpid(pid, &status, WNOHANG) == 0) {
+        if (g_stop && !killed) {
+            kill(pid, SIGTERM);
+            killed = true;
+        }
+        usleep(100000);
+    }
+    if (killed) return -2;
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+}
+
+static std::string ReadFile(const std::string& file) {
+    std::ifstream f(file.c_str());
+    std::ostringstream os;
+    os << f.rdbuf();
+    return os.str();
+}
+
+// a number of the flat JSON of PERF_OUTPUT_FILE ("-" if absent)
+static std::string JsonNumber(const std::string& json, const std::string& key) {
+    size_t pos = json.find("\"" + key + "\":");
+    if (pos == std::string::npos) return "-";
+    std::istringstream is(json.substr(pos + key.size() + 3));
+    std::string v;
+    is >> v;
+    return v.substr(0, v.find_first_of(",}"));
+}
+
+// the slowdown sketch of all flows, in the last snapshot of FCT_SKETCH_FILE
+static QuantileSketch ReadSlowdown(const std::string& file) {
+    std::ifstream f(file.c_str());
+    QuantileSketch last;
+    std::string line;
+    while (std::getline(f, line)) {
+        std::istringstream is(line);
+        uint64_t t, lo, hi;
+        uint32_t lb, cc;
+        std::string metric, text;
+        if (!(is >> t >> lb >> cc >> lo >> hi >> metric) || !std::getline(is, text)) continue;
+        if (metric != "slowdown" || lo != 0 || hi != UINT64_MAX) continue;
+        QuantileSketch s;
+        if (s.Deserialize(text)) last = s;
+    }
+    return last;
+}
+
+static uint64_t MemAvailableKb() {
+    std::ifstream f("/proc/meminfo");
+    std::string key;
+    uint64_t kb;
+    while (f >> key >> kb) {
+        if (key == "MemAvailable:") return kb;
+        f.ignore(256, '\n');
+    }
+    return UINT64_MAX;
+}
+
+static void AtomicMax(std::atomic<uint64_t>& a, uint64_t v) {
+    uint64_t cur = a.load();
+    while (v > cur && !a.compare_exchange_weak(cur, v)) {
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::string spec, sim = "build/scratch/network-load-balance";
+    uint32_t jobs = 0, retries = 2;
+    uint64_t memPerRun = 1024;  // MB
+
+    CommandLine cmd;
+    cmd.AddValue("spec", "sweep spec file", spec);
+    cmd.AddValue("sim", "simulator binary", sim);
+    cmd.AddValue("jobs", "parallel runs (0: by CPUs and memory)", jobs);
+    cmd.AddValue("mem_per_run", "memory of a run (MB) until one has finished", memPerRun);
+    cmd.AddValue("retries", "attempts after a failed run", retries);
+    cmd.Parse(argc, argv);
+
+    if (spec.empty()) {
+        std::cerr << "usage: ensemble --spec=<file> [--jobs=N] [--mem_per_run=MB] [--retries=N]"
+                  << std::endl;
+        return 1;
+    }
+    std::map<std::string, std::vector<std::string> > dims;
+    std::vector<std::pair<std::string, std::string> > sets;
+    if (!ReadSpec(spec, dims, sets)) return 1;
+    std::string base = dims["BASE_CONFIG"][0], outDir = dims["OUTPUT_DIR"][0];
+    std::vector<Run> all = MakeRuns(dims, sets);
+
+    // resume: skip the runs that are already ok
+    std::string resultsFile = outDir + "/results.tsv";
+    std::set<std::string> done;
+    bool exists = false;
+    {
+        std::ifstream f(resultsFile.c_str());
+        std::string line;
+        while (std::getline(f, line)) {
+            exists = true;
+            std::istringstream is(line);
+            std::string name, lb, cc, load, seed, topo, status;
+            if (line[0] != '#' && is >> name >> lb >> cc >> load >> seed >> topo >> status &&
+                status == "ok")
+                done.insert(name);
+        }
+    }
+    std::vector<Run> runs;
+    for (const Run& r : all) {
+        if (done.count(r.name) == 0) runs.push_back(r);
+    }
+
+    mkdir(outDir.c_str(), 0755);
+    mkdir((outDir + "/runs").c_str(), 0755);
+    int results = open(resultsFile.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (results < 0) {
+        std::cerr << "cannot write " << resultsFile << std::endl;
+        return 1;
+    }
+    if (!exists) {
+        std::string header =
+            "# run\tlb\tcc\tload\tseed\ttopology\tstatus\tattempts\twall_run_s\tpeak_rss_kb\t"
+            "events\tfinished_flows\tslowdown_avg\tslowdown_p50\tslowdown_p99\tslowdown_p999\n";
+        if (write(results, header.c_str(), header.size()) < 0) return 1;
+    }
+
+    // workers: by CPUs (pinned) and by memory
+    cpu_set_t allowed;
+    std::vector<int> cpus;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+        for (int c = 0; c < CPU_SETSIZE; c++) {
+            if (CPU_ISSET(c, &allowed)) cpus.push_back(c);
+        }
+    }
+    if (cpus.empty()) cpus.push_back(-1);  // not pinned
+    std::atomic<uint64_t> runKb(memPerRun * 1024);
+    if (jobs == 0) {
+        uint64_t byMem = std::max<uint64_t>(1, MemAvailableKb() / runKb);
+        jobs = std::min<uint64_t>(cpus.size(), byMem);
+    }
+    jobs = std::max<uint32_t>(1, std::min<uint32_t>(jobs, runs.size()));
+    std::cout << all.size() << " runs, " << all.size() - runs.size() << " already done, "
+              << jobs << " workers" << std::endl;
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = OnSignal;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    std::atomic<uint32_t> next(0), running(0), nOk(0), nFailed(0);
+    auto worker = [&](uint32_t w) {
+        int cpu = cpus[w % cpus.size()];
+        for (uint32_t i = next++; i < runs.size() && !g_stop; i = next++) {
+            const Run& run = runs[i];
+            // hold back while another run would not fit in memory
+            while (!g_stop && running > 0 && MemAvailableKb() < runKb) usleep(500000);
+            if (g_stop) break;
+            std::string dir = outDir + "/runs/" + run.name;
+            mkdir(dir.c_str(), 0755);
+            int ret = -1;
+            uint32_t attempts = 0;
+            if (WriteConfig(base, run, dir)) {
+                running++;
+                do {
+                    attempts++;
+                    remove((dir + "/perf.json").c_str());
+                    ret = Simulate(sim, dir, cpu);
+                } while (ret != 0 && ret != -2 && attempts <= retries);
+                running--;
+            }
+            if (ret == -2) break;  // interrupted: not recorded, rerun on resume
+
+            std::string perf = ReadFile(dir + "/perf.json");
+            std::string rss = JsonNumber(perf, "peak_rss_kb");
+            if (rss != "-") AtomicMax(runKb, strtoull(rss.c_str(), NULL, 10));
+            QuantileSketch slowdown = ReadSlowdown(dir + "/fct_sketch.txt");
+            char line[1024];
+            snprintf(line, sizeof(line),
+                     "%s\t%s\t%s\t%s\t%s\t%s\t%s\t%u\t%s\t%s\t%s\t%s\t%.3f\t%.3f\t%.3f\t%.3f\n",
+                     run.name.c_str(), run.lb.c_str(), run.cc.c_str(), run.load.c_str(),
+                     run.seed.c_str(), run.topology.c_str(), ret == 0 ? "ok" : "failed",
+                     attempts, JsonNumber(perf, "wall_run_s").c_str(), rss.c_str(),
+                     JsonNumber(perf, "events").c_str(), JsonNumber(perf, "finished_flows").c_str(),
+                     slowdown.GetAvg(), slowdown.GetQuantile(0.5), slowdown.GetQuantile(0.99),
+                     slowdown.GetQuantile(0.999));
+            if (write(results, line, strlen(line)) < 0) perror("results");
+            (ret == 0 ? nOk : nFailed)++;
+            printf("%s: %s (%u attempts)\n", run.name.c_str(),
+                   ret == 0 ? "ok" : ("exit code " + std::to_string(ret)).c_str(), attempts);
+            fflush(stdout);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (uint32_t w = 0; w < jobs; w++) pool.push_back(std::thread(worker, w));
+    for (auto& t : pool) t.join();
+    close(results);
+
+    std::cout << nOk << " ok, " << nFailed << " failed";
+    if (g_stop) std::cout << ", interrupted: rerun with the same spec to resume";
+    std::cout << std::endl;
+    return nFailed > 0 || g_stop ? 1 : 0;
+}
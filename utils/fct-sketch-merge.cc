@@ -0,0 +1,143 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2023 NUS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Chahwan Song <songch@comp.nus.edu.sg>
+ */
+
+/*
+ * Merges the FCT sketches (FCT_SKETCH_FILE) of several runs, e.g. seeds or parallel
+ * shards of one experiment, and prints the quantiles per (LB, CC, size bucket, metric).
+ * Each file contributes its last snapshot. --out writes the merged sketches in the
+ * same format, so merges can be merged again.
+ *
+ *   ./waf --run "fct-sketch-merge --in=1_out_fct_sketch.txt,2_out_fct_sketch.txt"
+ */
+
+#include <stdio.h>
+
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <tuple>
+
+#include "ns3/command-line.h"
+#include "ns3/quantile-sketch.h"
+
+using namespace ns3;
+
+// lb, cc, size_lo, size_hi, metric
+typedef std::tuple<uint32_t, uint32_t, uint64_t, uint64_t, std::string> SketchKey;
+
+// the sketches of the last snapshot of a file
+static bool ReadLastSnapshot(const std::string& file, std::map<SketchKey, QuantileSketch>& out,
+                             uint64_t& time) {
+    std::ifstream f(file.c_str());
+    if (!f.is_open()) {
+        std::cerr << "cannot open " << file << std::endl;
+        return false;
+    }
+    time = 0;
+    std::string line;
+    while (std::getline(f, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream is(line);
+        uint64_t t;
+        uint32_t lb, cc;
+        uint64_t lo, hi;
+        std::string metric, sketchText;
+        if (!(is >> t >> lb >> cc >> lo >> hi >> metric) || !std::getline(is, sketchText)) {
+            std::cerr << file << ": bad line: " << line << std::endl;
+            return false;
+        }
+        QuantileSketch sketch;
+        if (!sketch.Deserialize(sketchText)) {
+            std::cerr << file << ": bad sketch: " << line << std::endl;
+            return false;
+        }
+        if (t > time) out.clear();  // a newer snapshot
+        time = std::max(time, t);
+        if (t == time) out[SketchKey(lb, cc, lo, hi, metric)] = sketch;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    std::string in, out;
+
+    CommandLine cmd;
+    cmd.AddValue("in", "comma-separated FCT sketch files", in);
+    cmd.AddValue("out", "write the merged sketches to this file", out);
+    cmd.Parse(argc, argv);
+
+    if (in.empty()) {
+        std::cerr << "usage: fct-sketch-merge --in=<file>[,<file>...] [--out=<file>]" << std::endl;
+        return 1;
+    }
+
+    std::map<SketchKey, QuantileSketch> merged;
+    uint64_t lastTime = 0;
+    uint32_t nFile = 0;
+    std::istringstream files(in);
+    std::string file;
+    while (std::getline(files, file, ',')) {
+        std::map<SketchKey, QuantileSketch> sketches;
+        uint64_t time;
+        if (!ReadLastSnapshot(file, sketches, time)) return 1;
+        for (const auto& s : sketches) {
+            auto it = merged.find(s.first);
+            if (it == merged.end()) {
+                merged.insert(s);
+            } else if (!it->second.Merge(s.second)) {
+                std::cerr << file << ": sketches of a different accuracy cannot be merged"
+                          << std::endl;
+                return 1;
+            }
+        }
+        lastTime = std::max(lastTime, time);
+        nFile++;
+    }
+
+    std::cout << "merged " << nFile << " files" << std::endl;
+    std::cout << "lb\tcc\tsize range\tmetric\t#flows\tavg\tp50\tp95\tp99\tp99.9" << std::endl;
+    for (const auto& s : merged) {
+        const QuantileSketch& q = s.second;
+        uint64_t hi = std::get<3>(s.first);
+        printf("%u\t%u\t[%lu, %s)\t%s\t%lu\t%.3f\t%.3f\t%.3f\t%.3f\t%.3f\n", std::get<0>(s.first),
+               std::get<1>(s.first), std::get<2>(s.first),
+               hi == UINT64_MAX ? "inf" : std::to_string(hi).c_str(), std::get<4>(s.first).c_str(),
+               q.GetCount(), q.GetAvg(), q.GetQuantile(0.5), q.GetQuantile(0.95),
+               q.GetQuantile(0.99), q.GetQuantile(0.999));
+    }
+
+    if (!out.empty()) {
+        FILE* f = fopen(out.c_str(), "w");
+        if (f == NULL) {
+            std::cerr << "cannot write " << out << std::endl;
+            return 1;
+        }
+        fprintf(f, "# time lb cc size_lo size_hi metric sketch\n");
+        for (const auto& s : merged) {
+            fprintf(f, "%lu %u %u %lu %lu %s %s\n", lastTime, std::get<0>(s.first),
+                    std::get<1>(s.first), std::get<2>(s.first), std::get<3>(s.first),
+                    std::get<4>(s.first).c_str(), s.second.Serialize().c_str());
+        }
+        fclose(f);
+    }
+    return 0;
+}
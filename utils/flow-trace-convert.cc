@@ -0,0 +1,121 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2023 NUS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Chahwan Song <songch@comp.nus.edu.sg>
+ */
+
+/*
+ * Converts a text flow file (FLOW_FILE, as written by traffic_gen/traffic_gen.py:
+ * "<#flows>" then "<src> <dst> <pg> <size> <start time (s)>" per line) into the
+ * binary flow trace read by FLOW_TRACE_FILE (ns3::FlowTraceReader), or prints a
+ * binary trace's header with --info.
+ *
+ *   ./waf --run "flow-trace-convert --in=config/flow.txt --out=flow.bin --hosts=128"
+ */
+
+#include <stdlib.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "ns3/command-line.h"
+#include "ns3/flow-trace.h"
+
+using namespace ns3;
+
+// "2.000000101" -> 2000000101, without going through a double
+static bool ParseSecondsToNs(const std::string& s, uint64_t& ns) {
+    size_t dot = s.find('.');
+    std::string intPart = s.substr(0, dot);
+    std::string fracPart = dot == std::string::npos ? "" : s.substr(dot + 1);
+    if (intPart.empty() && fracPart.empty()) return false;
+    if (intPart.find_first_not_of("0123456789") != std::string::npos ||
+        fracPart.find_first_not_of("0123456789") != std::string::npos)
+        return false;
+    fracPart = (fracPart + "000000000").substr(0, 9);  // beyond ns is truncated
+    ns = strtoull(intPart.c_str(), NULL, 10) * 1000000000ULL + strtoull(fracPart.c_str(), NULL, 10);
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    std::string in, out;
+    uint32_t hosts = 0;
+    bool info = false;
+
+    CommandLine cmd;
+    cmd.AddValue("in", "text flow file (or binary trace with --info)", in);
+    cmd.AddValue("out", "binary flow trace to write", out);
+    cmd.AddValue("hosts", "number of hosts of the topology (default: max host ID + 1)", hosts);
+    cmd.AddValue("info", "print the header of the binary trace --in", info);
+    cmd.Parse(argc, argv);
+
+    if (info) {
+        FlowTraceReader reader;
+        if (!reader.Open(in)) return 1;
+        const FlowTraceHeader& h = reader.GetHeader();
+        std::cout << "flows: " << h.flowCount << ", hosts: " << h.hostCount
+                  << ", sorted: " << ((h.flags & FlowTraceHeader::SORTED) ? "yes" : "no")
+                  << ", start: " << h.firstStartNs << "ns ~ " << h.lastStartNs << "ns"
+                  << std::endl;
+        return 0;
+    }
+
+    std::ifstream fin(in.c_str());
+    if (!fin.is_open() || out.empty()) {
+        std::cerr << "usage: flow-trace-convert --in=<text flow file> --out=<binary trace>"
+                  << std::endl;
+        return 1;
+    }
+    uint64_t nFlow;
+    fin >> nFlow;
+
+    FlowTraceWriter writer;
+    if (!writer.Open(out, hosts)) {
+        std::cerr << "cannot write " << out << std::endl;
+        return 1;
+    }
+    uint32_t maxHost = 0;
+    FlowTraceRecord r = FlowTraceRecord();
+    std::string start;
+    uint64_t i = 0;
+    for (; i < nFlow && fin >> r.src >> r.dst >> r.pg >> r.size >> start; i++) {
+        if (!ParseSecondsToNs(start, r.startNs)) {
+            std::cerr << "flow " << i << ": bad start time " << start << std::endl;
+            return 1;
+        }
+        if (r.size > FlowTraceRecord::MAX_SIZE) {
+            std::cerr << "flow " << i << ": size " << r.size << " is above "
+                      << FlowTraceRecord::MAX_SIZE << " bytes" << std::endl;
+            return 1;
+        }
+        maxHost = std::max(maxHost, std::max(r.src, r.dst));
+        writer.Write(r);
+    }
+    if (i < nFlow) {
+        std::cerr << "WARNING: " << in << " announces " << nFlow << " flows, but has " << i
+                  << std::endl;
+    }
+    if (hosts != 0 && maxHost >= hosts) {
+        std::cerr << "WARNING: host ID " << maxHost << " >= --hosts " << hosts << std::endl;
+    }
+    if (hosts == 0) writer.SetHostCount(maxHost + 1);
+    writer.Close();
+    std::cout << "converted " << i << " flows into " << out << std::endl;
+    return 0;
+}
@@ -0,0 +1,59 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2023 NUS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Chahwan Song <songch@comp.nus.edu.sg>
+ */
+
+/*
+ * Builds a topology from a spec (see ns3::DcTopology, same as TOPOLOGY_GEN) and writes
+ * it in the text format of config/ (TOPOLOGY_FILE), or checks an existing file with --in.
+ *
+ *   ./waf --run "topology-gen --spec=fat_tree:k=16,os=2 --out=config/fat_k16_100G_OS2.txt"
+ *   ./waf --run "topology-gen --in=config/fat_k8_100G_OS2.txt"
+ */
+
+#include <iostream>
+#include <string>
+
+#include "ns3/command-line.h"
+#include "ns3/dc-topology.h"
+
+using namespace ns3;
+
+int main(int argc, char* argv[]) {
+    std::string spec, in, out;
+
+    CommandLine cmd;
+    cmd.AddValue("spec", "topology spec, e.g. leaf_spine:leaves=8,spines=8,hosts=16", spec);
+    cmd.AddValue("in", "topology file to check instead", in);
+    cmd.AddValue("out", "write the topology to this file", out);
+    cmd.Parse(argc, argv);
+
+    if (spec.empty() == in.empty()) {
+        std::cerr << "usage: topology-gen --spec=<spec> [--out=<file>] | --in=<file>" << std::endl;
+        return 1;
+    }
+    DcTopology topo;
+    if (!(spec.empty() ? topo.Load(in) : topo.Build(spec)) || !topo.Validate()) return 1;
+
+    uint32_t nSwitch = topo.GetNSwitches();
+    std::cout << topo.GetNNodes() - nSwitch << " hosts, " << nSwitch << " switches, "
+              << topo.GetLinks().size() << " links, up to " << topo.GetMaxSwitchPorts()
+              << " ports per switch" << std::endl;
+    if (!out.empty() && !topo.Save(out)) return 1;
+    return 0;
+}